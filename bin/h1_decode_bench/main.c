@@ -0,0 +1,241 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * Microbenchmark for HTTP/1.1 header line scanning.
+ * Compares the previous byte-at-a-time approach (memchr for '\n', then splitting on ':')
+ * against aws_strutil_scan_for_newline(), and measures the full decoder on a header-heavy response.
+ *
+ * usage: h1_decode_bench [iterations]
+ */
+
+#include <aws/common/clock.h>
+#include <aws/common/string.h>
+#include <aws/http/private/h1_decoder.h>
+#include <aws/http/private/strutil.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#    else
+#        include <x86intrin.h>
+#    endif
+#    define BENCH_HAS_CYCLE_COUNTER
+static uint64_t s_cycles(void) {
+    return __rdtsc();
+}
+#else
+static uint64_t s_cycles(void) {
+    return 0;
+}
+#endif
+
+enum {
+    NUM_HEADERS = 64,
+    DEFAULT_ITERATIONS = 20000,
+};
+
+/* Keeps results "used" so the compiler can't optimize the loops away */
+static volatile size_t s_sink;
+
+static void s_build_response(struct aws_byte_buf *buf) {
+    const char *status_line = "HTTP/1.1 200 OK\r\n";
+    aws_byte_buf_write(buf, (const uint8_t *)status_line, strlen(status_line));
+
+    char line[256];
+    for (int i = 0; i < NUM_HEADERS; ++i) {
+        int len = snprintf(
+            line,
+            sizeof(line),
+            "x-amz-meta-header-%d: value-%d-0123456789abcdefghijklmnopqrstuvwxyz;q=0.%d\r\n",
+            i,
+            i * 7919,
+            i % 10);
+        aws_byte_buf_write(buf, (const uint8_t *)line, (size_t)len);
+    }
+
+    const char *end = "Content-Length: 0\r\n\r\n";
+    aws_byte_buf_write(buf, (const uint8_t *)end, strlen(end));
+}
+
+/* The scanning previously done by h1_decoder: memchr for '\n', check for '\r', then split on ':' */
+static void s_scan_lines_memchr(struct aws_byte_cursor input) {
+    while (input.len > 0) {
+        uint8_t *newline = memchr(input.ptr, '\n', input.len);
+        if (!newline) {
+            break;
+        }
+
+        struct aws_byte_cursor line = aws_byte_cursor_advance(&input, (size_t)(newline - input.ptr) + 1);
+        if (line.len < 2 || line.ptr[line.len - 2] != '\r') {
+            continue;
+        }
+        line.len -= 2;
+
+        struct aws_byte_cursor split;
+        AWS_ZERO_STRUCT(split);
+        if (aws_byte_cursor_next_split(&line, ':', &split)) {
+            s_sink += split.len;
+        }
+    }
+}
+
+/* The single pass scan that h1_decoder does now */
+static void s_scan_lines_single_pass(struct aws_byte_cursor input) {
+    while (input.len > 0) {
+        size_t colon_index;
+        size_t newline_index = aws_strutil_scan_for_newline(input, &colon_index);
+        if (newline_index == input.len) {
+            break;
+        }
+
+        struct aws_byte_cursor line = aws_byte_cursor_advance(&input, newline_index + 1);
+        if (line.len < 2 || line.ptr[line.len - 2] != '\r') {
+            continue;
+        }
+
+        if (colon_index != SIZE_MAX) {
+            s_sink += colon_index;
+        }
+    }
+}
+
+static int s_on_header(const struct aws_h1_decoded_header *header, void *user_data) {
+    (void)user_data;
+    s_sink += header->value_data.len;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_on_body(const struct aws_byte_cursor *data, bool finished, void *user_data) {
+    (void)data;
+    (void)finished;
+    (void)user_data;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_on_response(int status_code, void *user_data) {
+    (void)user_data;
+    s_sink += (size_t)status_code;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_on_done(void *user_data) {
+    (void)user_data;
+    return AWS_OP_SUCCESS;
+}
+
+struct bench_ctx {
+    struct aws_byte_cursor input;
+    struct aws_h1_decoder *decoder;
+};
+
+static void s_run_memchr(struct bench_ctx *ctx) {
+    s_scan_lines_memchr(ctx->input);
+}
+
+static void s_run_single_pass(struct bench_ctx *ctx) {
+    s_scan_lines_single_pass(ctx->input);
+}
+
+static void s_run_decoder(struct bench_ctx *ctx) {
+    struct aws_byte_cursor input = ctx->input;
+    if (aws_h1_decode(ctx->decoder, &input)) {
+        fprintf(stderr, "Decode failed: %s\n", aws_error_name(aws_last_error()));
+        exit(1);
+    }
+}
+
+static void s_bench(const char *name, void (*fn)(struct bench_ctx *), struct bench_ctx *ctx, size_t iterations) {
+    /* warm up */
+    for (size_t i = 0; i < iterations / 10 + 1; ++i) {
+        fn(ctx);
+    }
+
+    uint64_t start_ns = 0;
+    aws_high_res_clock_get_ticks(&start_ns);
+    uint64_t start_cycles = s_cycles();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        fn(ctx);
+    }
+
+    uint64_t end_cycles = s_cycles();
+    uint64_t end_ns = 0;
+    aws_high_res_clock_get_ticks(&end_ns);
+
+    double total_bytes = (double)ctx->input.len * (double)iterations;
+    double ns = (double)(end_ns - start_ns);
+    printf("%-24s %10.3f bytes/ns", name, ns > 0 ? total_bytes / ns : 0.0);
+#ifdef BENCH_HAS_CYCLE_COUNTER
+    double cycles = (double)(end_cycles - start_cycles);
+    printf("  %8.3f bytes/cycle", cycles > 0 ? total_bytes / cycles : 0.0);
+#else
+    (void)start_cycles;
+    (void)end_cycles;
+#endif
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    size_t iterations = DEFAULT_ITERATIONS;
+    if (argc > 1) {
+        iterations = (size_t)strtoull(argv[1], NULL, 10);
+    }
+
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_http_library_init(allocator);
+
+    struct aws_byte_buf response;
+    aws_byte_buf_init(&response, allocator, 16 * 1024);
+    s_build_response(&response);
+
+    struct aws_h1_decoder_params params = {
+        .alloc = allocator,
+        .scratch_space_initial_size = 256,
+        .is_decoding_requests = false,
+        .user_data = NULL,
+        .vtable =
+            {
+                .on_header = s_on_header,
+                .on_body = s_on_body,
+                .on_response = s_on_response,
+                .on_done = s_on_done,
+            },
+    };
+
+    struct bench_ctx ctx = {
+        .input = aws_byte_cursor_from_buf(&response),
+        .decoder = aws_h1_decoder_new(&params),
+    };
+    if (!ctx.decoder) {
+        fprintf(stderr, "Failed to create decoder: %s\n", aws_error_name(aws_last_error()));
+        return 1;
+    }
+
+    printf("response: %zu bytes, %d headers, %zu iterations\n", ctx.input.len, NUM_HEADERS, iterations);
+    s_bench("memchr + split", s_run_memchr, &ctx, iterations);
+    s_bench("single pass scan", s_run_single_pass, &ctx, iterations);
+    s_bench("full h1 decode", s_run_decoder, &ctx, iterations);
+
+    aws_h1_decoder_destroy(ctx.decoder);
+    aws_byte_buf_clean_up(&response);
+    aws_http_library_clean_up();
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * Microbenchmark for preparing HTTP/1.1 request heads.
+ * Compares validating and serializing a whole request each time (aws_h1_encoder_message_init_from_request())
+ * against splicing the path and a few variable headers into a pre-serialized aws_http1_request_template.
+ *
+ * usage: h1_encode_bench [iterations]
+ */
+
+#include <aws/common/clock.h>
+#include <aws/http/private/h1_encoder.h>
+#include <aws/http/request_response.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+    NUM_INVARIANT_HEADERS = 12,
+    DEFAULT_ITERATIONS = 200000,
+};
+
+/* Keeps results "used" so the compiler can't optimize the loops away */
+static volatile size_t s_sink;
+
+struct bench_ctx {
+    struct aws_allocator *allocator;
+    struct aws_linked_list chunk_list;
+
+    /* request with every header, for the non-template path */
+    struct aws_http_message *full_request;
+
+    /* request with only the variable parts, for the template path */
+    struct aws_http_message *variable_request;
+    struct aws_http1_request_template *request_template;
+};
+
+static void s_add_invariant_headers(struct aws_http_message *request) {
+    char name[64];
+    char value[128];
+    for (int i = 0; i < NUM_INVARIANT_HEADERS; ++i) {
+        snprintf(name, sizeof(name), "x-amz-invariant-%d", i);
+        snprintf(value, sizeof(value), "value-%d-0123456789abcdefghijklmnopqrstuvwxyz", i);
+        struct aws_http_header header = {
+            .name = aws_byte_cursor_from_c_str(name),
+            .value = aws_byte_cursor_from_c_str(value),
+        };
+        aws_http_message_add_header(request, header);
+    }
+}
+
+static void s_add_variable_headers(struct aws_http_message *request) {
+    struct aws_http_header headers[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("x-amz-request-id"),
+            .value = aws_byte_cursor_from_c_str("4442587FB7D0A2F9"),
+        },
+        {
+            .name = aws_byte_cursor_from_c_str("x-amz-date"),
+            .value = aws_byte_cursor_from_c_str("20191016T000000Z"),
+        },
+    };
+    aws_http_message_add_header_array(request, headers, AWS_ARRAY_SIZE(headers));
+}
+
+static void s_run_full_request(struct bench_ctx *ctx) {
+    struct aws_h1_encoder_message message;
+    if (aws_h1_encoder_message_init_from_request(&message, ctx->allocator, ctx->full_request, &ctx->chunk_list)) {
+        fprintf(stderr, "Encode failed: %s\n", aws_error_name(aws_last_error()));
+        exit(1);
+    }
+    s_sink += message.outgoing_head_buf.len;
+    aws_h1_encoder_message_clean_up(&message);
+}
+
+static void s_run_template(struct bench_ctx *ctx) {
+    struct aws_h1_encoder_message message;
+    if (aws_h1_encoder_message_init_from_template(
+            &message, ctx->allocator, ctx->request_template, ctx->variable_request, &ctx->chunk_list)) {
+        fprintf(stderr, "Encode failed: %s\n", aws_error_name(aws_last_error()));
+        exit(1);
+    }
+    s_sink += message.outgoing_head_buf.len;
+    aws_h1_encoder_message_clean_up(&message);
+}
+
+static void s_bench(const char *name, void (*fn)(struct bench_ctx *), struct bench_ctx *ctx, size_t iterations) {
+    /* warm up */
+    for (size_t i = 0; i < iterations / 10 + 1; ++i) {
+        fn(ctx);
+    }
+
+    uint64_t start_ns = 0;
+    aws_high_res_clock_get_ticks(&start_ns);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        fn(ctx);
+    }
+
+    uint64_t end_ns = 0;
+    aws_high_res_clock_get_ticks(&end_ns);
+
+    double ns = (double)(end_ns - start_ns);
+    printf("%-24s %10.1f ns/request\n", name, iterations > 0 ? ns / (double)iterations : 0.0);
+}
+
+int main(int argc, char **argv) {
+    size_t iterations = DEFAULT_ITERATIONS;
+    if (argc > 1) {
+        iterations = (size_t)strtoull(argv[1], NULL, 10);
+    }
+
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_http_library_init(allocator);
+
+    struct bench_ctx ctx = {
+        .allocator = allocator,
+        .full_request = aws_http_message_new_request(allocator),
+        .variable_request = aws_http_message_new_request(allocator),
+    };
+    aws_linked_list_init(&ctx.chunk_list);
+
+    struct aws_byte_cursor method = aws_byte_cursor_from_c_str("GET");
+    struct aws_byte_cursor path = aws_byte_cursor_from_c_str("/bucket/some/object/key.txt");
+
+    aws_http_message_set_request_method(ctx.full_request, method);
+    aws_http_message_set_request_path(ctx.full_request, path);
+    s_add_invariant_headers(ctx.full_request);
+    s_add_variable_headers(ctx.full_request);
+
+    struct aws_http_message *prototype = aws_http_message_new_request(allocator);
+    aws_http_message_set_request_method(prototype, method);
+    s_add_invariant_headers(prototype);
+    ctx.request_template = aws_http1_request_template_new(allocator, prototype);
+    aws_http_message_release(prototype);
+    if (!ctx.request_template) {
+        fprintf(stderr, "Failed to create template: %s\n", aws_error_name(aws_last_error()));
+        return 1;
+    }
+
+    aws_http_message_set_request_path(ctx.variable_request, path);
+    s_add_variable_headers(ctx.variable_request);
+
+    printf(
+        "request: %d invariant headers, 2 variable headers, %zu iterations\n", NUM_INVARIANT_HEADERS, iterations);
+    s_bench("full request", s_run_full_request, &ctx, iterations);
+    s_bench("request template", s_run_template, &ctx, iterations);
+
+    aws_http1_request_template_destroy(ctx.request_template);
+    aws_http_message_release(ctx.variable_request);
+    aws_http_message_release(ctx.full_request);
+    aws_http_library_clean_up();
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * Microbenchmark for looking up headers by name in aws_http_headers.
+ * Cost per lookup should stay flat as the number of headers grows, once the headers are indexed.
+ *
+ * usage: headers_bench [iterations]
+ */
+
+#include <aws/common/clock.h>
+#include <aws/http/request_response.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+    MAX_HEADERS = 256,
+    DEFAULT_ITERATIONS = 1000000,
+};
+
+/* Keeps results "used" so the compiler can't optimize the loops away */
+static volatile size_t s_sink;
+
+static void s_bench(struct aws_allocator *allocator, size_t num_headers, size_t iterations) {
+    struct aws_http_headers *headers = aws_http_headers_new(allocator);
+
+    /* Query with different case than what's stored */
+    static char s_names[MAX_HEADERS][32];
+    static char s_query_names[MAX_HEADERS][32];
+    struct aws_byte_cursor queries[MAX_HEADERS];
+    for (size_t i = 0; i < num_headers; ++i) {
+        snprintf(s_names[i], sizeof(s_names[i]), "X-Amz-Meta-Header-%zu", i);
+        aws_http_headers_add(headers, aws_byte_cursor_from_c_str(s_names[i]), aws_byte_cursor_from_c_str("value"));
+
+        snprintf(s_query_names[i], sizeof(s_query_names[i]), "x-amz-meta-header-%zu", i);
+        queries[i] = aws_byte_cursor_from_c_str(s_query_names[i]);
+    }
+    struct aws_byte_cursor missing = aws_byte_cursor_from_c_str("X-Not-Present");
+
+    uint64_t start_ns = 0;
+    aws_high_res_clock_get_ticks(&start_ns);
+
+    struct aws_byte_cursor value;
+    for (size_t i = 0; i < iterations; ++i) {
+        if (aws_http_headers_get(headers, queries[i % num_headers], &value) == AWS_OP_SUCCESS) {
+            s_sink += value.len;
+        }
+    }
+
+    uint64_t mid_ns = 0;
+    aws_high_res_clock_get_ticks(&mid_ns);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        s_sink += aws_http_headers_has(headers, missing);
+    }
+
+    uint64_t end_ns = 0;
+    aws_high_res_clock_get_ticks(&end_ns);
+
+    double hit_ns = (double)(mid_ns - start_ns) / (double)iterations;
+    double miss_ns = (double)(end_ns - mid_ns) / (double)iterations;
+    printf("%4zu headers: %8.1f ns/hit %8.1f ns/miss\n", num_headers, hit_ns, miss_ns);
+
+    aws_http_headers_release(headers);
+}
+
+int main(int argc, char **argv) {
+    size_t iterations = DEFAULT_ITERATIONS;
+    if (argc > 1) {
+        iterations = (size_t)strtoull(argv[1], NULL, 10);
+    }
+    if (iterations == 0) {
+        return 0;
+    }
+
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_http_library_init(allocator);
+
+    printf("%zu lookups per measurement\n", iterations);
+    for (size_t num_headers = 4; num_headers <= MAX_HEADERS; num_headers *= 2) {
+        s_bench(allocator, num_headers, iterations);
+    }
+
+    aws_http_library_clean_up();
+    return 0;
+}
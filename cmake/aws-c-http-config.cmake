@@ -3,6 +3,10 @@ include(CMakeFindDependencyMacro)
 find_dependency(aws-c-io)
 find_dependency(aws-c-compression)
 
+if (@AWS_HTTP_HAS_ZLIB@)
+    find_dependency(ZLIB)
+endif()
+
 if (BUILD_SHARED_LIBS)
     include(${CMAKE_CURRENT_LIST_DIR}/shared/@PROJECT_NAME@-targets.cmake)
 else()
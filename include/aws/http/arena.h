@@ -0,0 +1,55 @@
+#ifndef AWS_HTTP_ARENA_H
+#define AWS_HTTP_ARENA_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/http/http.h>
+
+enum {
+    /* Block size used when 0 is passed to aws_http_arena_allocator_new() */
+    AWS_HTTP_ARENA_DEFAULT_BLOCK_SIZE = 4 * 1024,
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Create a bump-pointer "arena" allocator.
+ * Memory is carved from blocks of `block_size` bytes (0 for the default), obtained from `parent` as needed.
+ * Allocations larger than a block get a block of their own.
+ * aws_mem_release() only gives memory back if it was the most recent allocation,
+ * everything else is returned to `parent` all at once by aws_http_arena_allocator_destroy().
+ *
+ * This suits a burst of small allocations that all die together, such as the headers and strings of one message.
+ *
+ * The arena is NOT thread-safe, it takes no lock. Only one thread may acquire or release memory at a time.
+ * Keep in mind that a connection may release an arena-allocated message on its event-loop thread,
+ * so don't use the arena from other threads while a message allocated from it is in flight.
+ * The arena behind aws_http_make_request_options.arena_block_size is private to its stream,
+ * and the connection takes care of using it from one thread at a time.
+ */
+AWS_HTTP_API
+struct aws_allocator *aws_http_arena_allocator_new(struct aws_allocator *parent, size_t block_size);
+
+/**
+ * Release all memory ever acquired from the arena, and the arena itself.
+ * Anything still using that memory must already be cleaned up.
+ */
+AWS_HTTP_API
+void aws_http_arena_allocator_destroy(struct aws_allocator *arena);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_HTTP_ARENA_H */
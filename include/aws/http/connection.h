@@ -22,6 +22,11 @@ struct aws_client_bootstrap;
 struct aws_socket_options;
 struct aws_tls_connection_options;
 
+enum {
+    /* Cap on HTTP/2 flow-control windows used when 0 is passed for `http2_max_window_size` */
+    AWS_HTTP2_DEFAULT_MAX_WINDOW_SIZE = 16 * 1024 * 1024,
+};
+
 /**
  * An HTTP connection.
  * This type is used by both server-side and client-side connections.
@@ -74,6 +79,19 @@ struct aws_http_connection_monitoring_options {
     uint32_t allowable_throughput_failure_interval_seconds;
 };
 
+/**
+ * How an HTTP/2 connection chooses which stream sends the next DATA frame,
+ * when several streams have DATA to send. See `aws_http2_stream_priority`.
+ */
+enum aws_http2_stream_scheduler {
+    /* Streams take turns, one DATA frame each. Stream priority is ignored. */
+    AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN,
+    /* Dependency tree and weights, as described in RFC-7540 5.3 */
+    AWS_HTTP2_STREAM_SCHEDULER_DEPENDENCY,
+    /* Urgency and incremental flags, modeled on RFC-9218 */
+    AWS_HTTP2_STREAM_SCHEDULER_URGENCY,
+};
+
 /**
  * Supported proxy authentication modes
  */
@@ -219,6 +237,38 @@ struct aws_http_client_connection_options {
      * reaches 0, no further data will be received.
      **/
     bool manual_window_management;
+
+    /**
+     * Optional.
+     * HTTP/1.1 only. Max number of requests that may be in flight at once,
+     * where "in flight" means the request has been sent but its response is not yet complete.
+     *
+     * Requests are pipelined (sent without waiting for earlier responses) up to this depth.
+     * Set to 1 to disable pipelining, so that each request waits until the previous response is complete.
+     * If 0, there is no limit and each request is sent as soon as the one before it has been sent.
+     *
+     * If the connection closes, any requests still awaiting a response complete with an error.
+     * Only idempotent requests should be pipelined, since the server may close the connection
+     * before processing them.
+     */
+    size_t http1_max_pipelined_requests;
+
+    /**
+     * Optional.
+     * HTTP/2 only. If manual_window_management is false, flow-control windows grow automatically
+     * toward the connection's bandwidth-delay product, so that a single stream can fill a long, fat pipe.
+     * Windows never grow past this many bytes, which bounds the memory that DATA in flight may use.
+     * This also bounds the `initial_window_size`.
+     * If 0, AWS_HTTP2_DEFAULT_MAX_WINDOW_SIZE is used.
+     */
+    size_t http2_max_window_size;
+
+    /**
+     * Optional.
+     * HTTP/2 only. How the connection chooses which request sends DATA next.
+     * Defaults to AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN.
+     */
+    enum aws_http2_stream_scheduler http2_stream_scheduler;
 };
 
 /**
@@ -279,6 +329,23 @@ void aws_http_connection_update_window(struct aws_http_connection *connection, s
 AWS_HTTP_API
 enum aws_http_version aws_http_connection_get_version(const struct aws_http_connection *connection);
 
+/**
+ * HTTP/2 only, returns 0 for other versions.
+ * Returns the number of requests that have been activated, but are queued
+ * because the server's SETTINGS_MAX_CONCURRENT_STREAMS has been reached.
+ * Queued requests are sent, in order, as earlier requests complete.
+ */
+AWS_HTTP_API
+size_t aws_http_connection_get_pending_stream_count(const struct aws_http_connection *connection);
+
+/**
+ * Returns the number of requests the server allows to be in progress at once on this connection.
+ * For HTTP/2 this is the server's SETTINGS_MAX_CONCURRENT_STREAMS, which is UINT32_MAX until the server sets a limit.
+ * For HTTP/1.x this is 1.
+ */
+AWS_HTTP_API
+uint32_t aws_http_connection_get_max_concurrent_streams(const struct aws_http_connection *connection);
+
 /**
  * Returns the channel hosting the HTTP connection.
  * Do not expose this function to language bindings.
@@ -54,6 +54,8 @@ enum aws_http_errors {
     AWS_ERROR_HTTP_STREAM_IDS_EXHAUSTED,
     AWS_ERROR_HTTP_INVALID_FRAME_SIZE,
     AWS_ERROR_HTTP_COMPRESSION,
+    AWS_ERROR_HTTP_STREAM_HAS_COMPLETED,
+    AWS_ERROR_HTTP_FLOW_CONTROL_ERROR,
 
     AWS_ERROR_HTTP_END_RANGE = AWS_ERROR_ENUM_END_RANGE(AWS_C_HTTP_PACKAGE_ID)
 };
@@ -78,6 +80,36 @@ enum aws_http_version {
     AWS_HTTP_VERSION_COUNT,
 };
 
+/**
+ * Headers that affect internal processing.
+ * This is NOT a definitive list of headers.
+ * Names are recognized case-insensitively. Any other name is AWS_HTTP_HEADER_UNKNOWN.
+ * New values are only ever added just before AWS_HTTP_HEADER_COUNT, existing values never change.
+ */
+enum aws_http_header_name {
+    AWS_HTTP_HEADER_UNKNOWN, /* Unrecognized value */
+
+    /* Request pseudo-headers */
+    AWS_HTTP_HEADER_METHOD,
+    AWS_HTTP_HEADER_SCHEME,
+    AWS_HTTP_HEADER_AUTHORITY,
+    AWS_HTTP_HEADER_PATH,
+
+    /* Response pseudo-headers */
+    AWS_HTTP_HEADER_STATUS,
+
+    /* Regular headers */
+    AWS_HTTP_HEADER_CONNECTION,
+    AWS_HTTP_HEADER_CONTENT_LENGTH,
+    AWS_HTTP_HEADER_EXPECT,
+    AWS_HTTP_HEADER_TRANSFER_ENCODING,
+    AWS_HTTP_HEADER_COOKIE,
+    AWS_HTTP_HEADER_CONTENT_ENCODING,
+    AWS_HTTP_HEADER_DATE,
+
+    AWS_HTTP_HEADER_COUNT, /* Number of enums */
+};
+
 AWS_EXTERN_C_BEGIN
 
 /**
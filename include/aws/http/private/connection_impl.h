@@ -85,6 +85,7 @@ struct aws_http_connection {
         struct aws_http_connection_server_data {
             aws_http_on_incoming_request_fn *on_incoming_request;
             aws_http_on_server_connection_shutdown_fn *on_shutdown;
+            bool add_date_header;
         } server;
     } client_or_server_data;
 
@@ -103,6 +104,9 @@ struct aws_http_client_bootstrap {
     bool is_using_tls;
     bool manual_window_management;
     size_t initial_window_size;
+    size_t http1_max_pipelined_requests;
+    size_t http2_max_window_size;
+    enum aws_http2_stream_scheduler http2_stream_scheduler;
     struct aws_http_connection_monitoring_options monitoring_options;
     void *user_data;
     aws_http_on_client_connection_setup_fn *on_setup;
@@ -24,6 +24,9 @@ typedef int(aws_http_connection_manager_create_connection_fn)(const struct aws_h
 typedef void(aws_http_connection_manager_close_connection_fn)(struct aws_http_connection *connection);
 typedef void(aws_http_connection_manager_release_connection_fn)(struct aws_http_connection *connection);
 typedef bool(aws_http_connection_manager_is_connection_open_fn)(const struct aws_http_connection *connection);
+typedef enum aws_http_version(aws_http_connection_manager_get_version_fn)(const struct aws_http_connection *connection);
+typedef uint32_t(aws_http_connection_manager_get_max_concurrent_streams_fn)(
+    const struct aws_http_connection *connection);
 
 struct aws_http_connection_manager_system_vtable {
     /*
@@ -33,6 +36,8 @@ struct aws_http_connection_manager_system_vtable {
     aws_http_connection_manager_close_connection_fn *close_connection;
     aws_http_connection_manager_release_connection_fn *release_connection;
     aws_http_connection_manager_is_connection_open_fn *is_connection_open;
+    aws_http_connection_manager_get_version_fn *get_version;
+    aws_http_connection_manager_get_max_concurrent_streams_fn *get_max_concurrent_streams;
 };
 
 AWS_HTTP_API
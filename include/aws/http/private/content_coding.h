@@ -0,0 +1,102 @@
+#ifndef AWS_HTTP_CONTENT_CODING_H
+#define AWS_HTTP_CONTENT_CODING_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/http/http.h>
+
+struct aws_input_stream;
+
+/**
+ * Body codings (RFC-7230 4.2, RFC-7231 3.1.2.1) that may appear in Content-Encoding or Transfer-Encoding.
+ * Compression is provided by zlib. If aws-c-http was built without zlib, creating a (de)compressor
+ * fails with AWS_ERROR_UNSUPPORTED_OPERATION.
+ */
+enum aws_http_content_coding {
+    AWS_HTTP_CONTENT_CODING_IDENTITY,
+    AWS_HTTP_CONTENT_CODING_GZIP,
+    AWS_HTTP_CONTENT_CODING_DEFLATE,
+    AWS_HTTP_CONTENT_CODING_UNSUPPORTED,
+};
+
+enum {
+    /* Decompressed data is delivered in pieces no larger than this */
+    AWS_HTTP_DECOMPRESSOR_OUTPUT_CHUNK_SIZE = 16 * 1024,
+
+    /* Data is read from the source of a compressing stream in pieces no larger than this */
+    AWS_HTTP_COMPRESSOR_INPUT_CHUNK_SIZE = 16 * 1024,
+};
+
+struct aws_http_decompressor;
+
+/* Called repeatedly as decompressed data is produced. The data is only valid for the duration of the callback. */
+typedef int(aws_http_decompressor_on_data_fn)(struct aws_byte_cursor data, void *user_data);
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Returns the coding named by a Content-Encoding header value.
+ * Only a single coding is understood, a list of codings returns AWS_HTTP_CONTENT_CODING_UNSUPPORTED.
+ * Not case-sensitive.
+ */
+AWS_HTTP_API
+enum aws_http_content_coding aws_http_str_to_content_coding(struct aws_byte_cursor value);
+
+/**
+ * Create a streaming decompressor for GZIP or DEFLATE data.
+ * Memory use is bounded: zlib's window plus one AWS_HTTP_DECOMPRESSOR_OUTPUT_CHUNK_SIZE output buffer.
+ */
+AWS_HTTP_API
+struct aws_http_decompressor *aws_http_decompressor_new(
+    struct aws_allocator *allocator,
+    enum aws_http_content_coding coding);
+
+AWS_HTTP_API
+void aws_http_decompressor_destroy(struct aws_http_decompressor *decompressor);
+
+/**
+ * Decompress all of `input`, invoking `on_data` each time the output buffer fills, and once more for any remainder.
+ * Raises AWS_ERROR_HTTP_COMPRESSION if the data is malformed.
+ */
+AWS_HTTP_API
+int aws_http_decompressor_process(
+    struct aws_http_decompressor *decompressor,
+    struct aws_byte_cursor input,
+    aws_http_decompressor_on_data_fn *on_data,
+    void *user_data);
+
+/**
+ * Call when there is no more input.
+ * Raises AWS_ERROR_HTTP_COMPRESSION if the compressed data ended before the end of the compressed stream.
+ */
+AWS_HTTP_API
+int aws_http_decompressor_finish(struct aws_http_decompressor *decompressor);
+
+/**
+ * Create an input stream whose data is `source`'s data, compressed with GZIP or DEFLATE.
+ * `source` is not owned, it must outlive the new stream.
+ * The compressed length isn't known in advance, so get_length() is unsupported.
+ * The stream may only be seeked to the beginning, which seeks `source` to its beginning as well.
+ */
+AWS_HTTP_API
+struct aws_input_stream *aws_http_compressing_stream_new(
+    struct aws_allocator *allocator,
+    struct aws_input_stream *source,
+    enum aws_http_content_coding coding);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_HTTP_CONTENT_CODING_H */
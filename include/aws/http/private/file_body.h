@@ -0,0 +1,42 @@
+#ifndef AWS_HTTP_FILE_BODY_H
+#define AWS_HTTP_FILE_BODY_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/http/http.h>
+
+struct aws_input_stream;
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Create an input stream over `length` bytes of an open file descriptor, starting at `offset`.
+ * Data is read with pread(2) into the caller's buffer, without stdio buffering,
+ * and without moving the descriptor's file offset, so one descriptor may back many streams at once.
+ * `fd` is not owned, it must stay open until the stream is destroyed.
+ * If the file turns out to be shorter than expected, the stream ends early.
+ * Only available on POSIX platforms, otherwise AWS_ERROR_UNSUPPORTED_OPERATION is raised.
+ */
+AWS_HTTP_API
+struct aws_input_stream *aws_http_file_body_stream_new(
+    struct aws_allocator *allocator,
+    int fd,
+    uint64_t offset,
+    uint64_t length);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_HTTP_FILE_BODY_H */
@@ -30,7 +30,8 @@ AWS_HTTP_API
 struct aws_http_connection *aws_http_connection_new_http1_1_client(
     struct aws_allocator *allocator,
     bool manual_window_management,
-    size_t initial_window_size);
+    size_t initial_window_size,
+    size_t max_pipelined_requests);
 
 AWS_EXTERN_C_END
 
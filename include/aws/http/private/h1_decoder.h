@@ -67,6 +67,11 @@ struct aws_h1_decoder_vtable {
 struct aws_h1_decoder_params {
     struct aws_allocator *alloc;
     size_t scratch_space_initial_size;
+    /* Max length of any incoming line (request-line, status-line, header, or chunk-size line), including CRLF.
+     * Lines that arrive whole are passed along without copying. Only a line split across multiple calls
+     * to aws_h1_decode() is copied into scratch space, which never grows beyond this size.
+     * If 0, AWS_H1_DECODER_DEFAULT_MAX_LINE_SIZE is used. */
+    size_t max_line_size;
     /* Set false if decoding responses */
     bool is_decoding_requests;
     void *user_data;
@@ -75,6 +80,10 @@ struct aws_h1_decoder_params {
 
 struct aws_h1_decoder;
 
+enum {
+    AWS_H1_DECODER_DEFAULT_MAX_LINE_SIZE = 64 * 1024,
+};
+
 AWS_EXTERN_C_BEGIN
 
 AWS_HTTP_API struct aws_h1_decoder *aws_h1_decoder_new(struct aws_h1_decoder_params *params);
@@ -18,6 +18,33 @@
 #include <aws/http/private/http_impl.h>
 #include <aws/http/private/request_response_impl.h>
 
+#include <aws/common/linked_list.h>
+
+enum {
+    /* Max length of a chunk-size line: 16 hex digits for a uint64_t + "\r\n" */
+    AWS_H1_ENCODER_CHUNK_LINE_MAX_SIZE = 18,
+
+    /* Length of an RFC-1123 date, ex: "Sun, 06 Nov 1994 08:49:37 GMT" */
+    AWS_H1_DATE_VALUE_LEN = 29,
+};
+
+/**
+ * An HTTP/1.1 chunk waiting to be sent.
+ * Chunks are queued by aws_http1_stream_write_chunk() and processed by the encoder in order.
+ */
+struct aws_h1_chunk {
+    struct aws_allocator *allocator;
+    struct aws_input_stream *data;
+    uint64_t data_size;
+    aws_http1_stream_write_chunk_complete_fn *on_complete;
+    void *user_data;
+    struct aws_linked_list_node node;
+
+    /* Pre-encoded chunk-size line: "{hex size}\r\n" */
+    struct aws_byte_buf chunk_line;
+    uint8_t chunk_line_storage[AWS_H1_ENCODER_CHUNK_LINE_MAX_SIZE];
+};
+
 /**
  * Message to be submitted to encoder.
  * Contains data necessary for encoder to write an outgoing request or response.
@@ -25,15 +52,47 @@
 struct aws_h1_encoder_message {
     /* Upon creation, the "head" (everything preceding body) is buffered here. */
     struct aws_byte_buf outgoing_head_buf;
+    /* Single stream used for body. If the message is chunked, its data is sent as a series of chunks */
     struct aws_input_stream *body;
+
+    /* If the unchunked body is in caller-owned memory (see aws_http_message_set_body_data()),
+     * it's sent from here instead of `body`, and lent out without copying when it doesn't fit in a message.
+     * `body_data_owner` is the message that owns it, which must be kept alive while the memory is in use. */
+    struct aws_byte_cursor body_data;
+    struct aws_http_message *body_data_owner;
+
+    /* Pointer to list of `struct aws_h1_chunk`, used for chunked encoding.
+     * List is owned by aws_h1_stream.
+     * Encoder completes/frees/pops front chunk when it's done sending.
+     * If list goes empty, encoder waits for more chunks to arrive.
+     * A chunk with data_size=0 means "final chunk" */
+    struct aws_linked_list *pending_chunk_list;
+
     uint64_t content_length;
     bool has_connection_close_header;
+    bool has_chunked_encoding_header;
+
+    /* Request has "Expect: 100-continue", so the body is held back until the server says to send it */
+    bool has_expect_continue_header;
+
+    bool has_date_header;
+
+    /* If non-zero, a "Date" header-line was reserved in outgoing_head_buf and its value starts at this offset.
+     * The value must be filled in by aws_h1_encoder_message_set_date() before the message is sent. */
+    size_t date_value_offset;
 };
 
 enum aws_h1_encoder_state {
     AWS_H1_ENCODER_STATE_INIT,
     AWS_H1_ENCODER_STATE_HEAD,
-    AWS_H1_ENCODER_STATE_BODY,
+    AWS_H1_ENCODER_STATE_AWAIT_CONTINUE,
+    AWS_H1_ENCODER_STATE_UNCHUNKED_BODY,
+    AWS_H1_ENCODER_STATE_CHUNKED_BODY_STREAM,
+    AWS_H1_ENCODER_STATE_CHUNK_NEXT,
+    AWS_H1_ENCODER_STATE_CHUNK_LINE,
+    AWS_H1_ENCODER_STATE_CHUNK_BODY,
+    AWS_H1_ENCODER_STATE_CHUNK_END,
+    AWS_H1_ENCODER_STATE_CHUNK_TRAILER,
     AWS_H1_ENCODER_STATE_DONE,
 };
 
@@ -41,25 +100,99 @@ struct aws_h1_encoder {
     struct aws_allocator *allocator;
 
     enum aws_h1_encoder_state state;
+    /* Current message being encoded */
     struct aws_h1_encoder_message *message;
+    /* Used by states that need to track progress */
     uint64_t progress_bytes;
+    /* Current chunk */
+    struct aws_h1_chunk *current_chunk;
+    /* Stream that owns the current message, chunk callbacks are invoked with it */
+    struct aws_http_stream *current_stream;
     const void *logging_id;
 };
 
 AWS_EXTERN_C_BEGIN
 
-/* Validate request and cache any info the encoder will need later in the "encoder message". */
+/* Pre-render the response-line for every known status code. Called by aws_http_library_init() */
+AWS_HTTP_API
+void aws_h1_status_lines_init(struct aws_allocator *allocator);
+
+AWS_HTTP_API
+void aws_h1_status_lines_clean_up(void);
+
+/**
+ * Create a chunk from the user's options.
+ * The chunk's data stream is NOT owned, it must stay alive until the chunk completes.
+ */
+AWS_HTTP_API
+struct aws_h1_chunk *aws_h1_chunk_new(struct aws_allocator *allocator, const struct aws_http1_chunk_options *options);
+
+/* Just destroy the chunk, without invoking its completion callback */
+AWS_HTTP_API
+void aws_h1_chunk_destroy(struct aws_h1_chunk *chunk);
+
+/* Destroy chunk and invoke its completion callback */
+AWS_HTTP_API
+void aws_h1_chunk_complete_and_destroy(struct aws_h1_chunk *chunk, struct aws_http_stream *http_stream, int error_code);
+
+/**
+ * Validate request and cache any info the encoder will need later in the "encoder message".
+ * `pending_chunk_list` is only used if the request has a "Transfer-Encoding: chunked" header and no body stream.
+ */
 AWS_HTTP_API
 int aws_h1_encoder_message_init_from_request(
     struct aws_h1_encoder_message *message,
     struct aws_allocator *allocator,
-    const struct aws_http_message *request);
+    const struct aws_http_message *request,
+    struct aws_linked_list *pending_chunk_list);
+
+/**
+ * Like aws_h1_encoder_message_init_from_request(), but the method and leading headers come from a template
+ * that was validated and serialized in advance. Only the request's path and own headers are processed.
+ * Raises AWS_ERROR_INVALID_ARGUMENT if the request has a method that differs from the template's.
+ */
+AWS_HTTP_API
+int aws_h1_encoder_message_init_from_template(
+    struct aws_h1_encoder_message *message,
+    struct aws_allocator *allocator,
+    const struct aws_http1_request_template *request_template,
+    const struct aws_http_message *request,
+    struct aws_linked_list *pending_chunk_list);
+
+/**
+ * Returns the method of requests made with this template.
+ * The cursor is valid until the template is destroyed.
+ */
+AWS_HTTP_API
+struct aws_byte_cursor aws_h1_request_template_get_method(const struct aws_http1_request_template *request_template);
 
+/**
+ * Validate response and cache any info the encoder will need later in the "encoder message".
+ * If `add_date_header` is true and the response has no "Date" header, room is reserved for one,
+ * see aws_h1_encoder_message_set_date().
+ */
+AWS_HTTP_API
 int aws_h1_encoder_message_init_from_response(
     struct aws_h1_encoder_message *message,
     struct aws_allocator *allocator,
     const struct aws_http_message *response,
-    bool body_headers_ignored);
+    bool body_headers_ignored,
+    bool add_date_header,
+    struct aws_linked_list *pending_chunk_list);
+
+/**
+ * Fill in the "Date" header reserved by aws_h1_encoder_message_init_from_response().
+ * `date` must be AWS_H1_DATE_VALUE_LEN bytes. Does nothing if no header was reserved.
+ */
+AWS_HTTP_API
+void aws_h1_encoder_message_set_date(struct aws_h1_encoder_message *message, struct aws_byte_cursor date);
+
+/**
+ * Remove the "Date" header reserved by aws_h1_encoder_message_init_from_response(),
+ * for when no date value can be produced. Does nothing if no header was reserved.
+ */
+AWS_HTTP_API
+void aws_h1_encoder_message_omit_date(struct aws_h1_encoder_message *message);
 
 AWS_HTTP_API
 void aws_h1_encoder_message_clean_up(struct aws_h1_encoder_message *message);
@@ -74,7 +207,7 @@ AWS_HTTP_API
 int aws_h1_encoder_start_message(
     struct aws_h1_encoder *encoder,
     struct aws_h1_encoder_message *message,
-    void *log_as_stream);
+    struct aws_http_stream *stream);
 
 AWS_HTTP_API
 int aws_h1_encoder_process(struct aws_h1_encoder *encoder, struct aws_byte_buf *out_buf);
@@ -82,6 +215,46 @@ int aws_h1_encoder_process(struct aws_h1_encoder *encoder, struct aws_byte_buf *
 AWS_HTTP_API
 bool aws_h1_encoder_is_message_in_progress(const struct aws_h1_encoder *encoder);
 
+/**
+ * Return true if the encoder is stuck waiting for more chunks to be added to the current message.
+ * If this is true, the connection should stop writing until aws_http1_stream_write_chunk() is called again.
+ */
+AWS_HTTP_API
+bool aws_h1_encoder_is_waiting_for_chunks(const struct aws_h1_encoder *encoder);
+
+/**
+ * If the current message's body is in caller-owned memory, and it didn't fit in the previous out_buf,
+ * lend out the next slice of it (up to max_size bytes) and treat that slice as sent.
+ * The slice must be written out without copying, and the caller must hold a reference to `out_owner`
+ * until it's done with the slice's memory.
+ * Returns false if there's nothing to lend, in which case aws_h1_encoder_process() should be called as usual.
+ */
+AWS_HTTP_API
+bool aws_h1_encoder_lend_body_data(
+    struct aws_h1_encoder *encoder,
+    size_t max_size,
+    struct aws_byte_cursor *out_slice,
+    struct aws_http_message **out_owner);
+
+/**
+ * Return true if the head of an "Expect: 100-continue" request has been written,
+ * and the body is being held back until aws_h1_encoder_continue_body() or aws_h1_encoder_skip_body() is called.
+ * If this is true, the connection should stop writing until one of those is called.
+ */
+AWS_HTTP_API
+bool aws_h1_encoder_is_waiting_for_continue(const struct aws_h1_encoder *encoder);
+
+/* Stop waiting and send the body. Only valid while aws_h1_encoder_is_waiting_for_continue() is true */
+AWS_HTTP_API
+void aws_h1_encoder_continue_body(struct aws_h1_encoder *encoder);
+
+/**
+ * Stop waiting and finish the message without sending its body. Only valid while waiting for continue.
+ * The request is incomplete on the wire, so the connection must not send any further requests.
+ */
+AWS_HTTP_API
+void aws_h1_encoder_skip_body(struct aws_h1_encoder *encoder);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_HTTP_H1_ENCODER_H */
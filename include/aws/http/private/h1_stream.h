@@ -15,18 +15,31 @@
  * permissions and limitations under the License.
  */
 
+#include <aws/http/private/content_coding.h>
 #include <aws/http/private/h1_encoder.h>
 #include <aws/http/private/http_impl.h>
 #include <aws/http/private/request_response_impl.h>
 
+enum {
+    /* Used when aws_http_make_request_options.expect_continue_timeout_ms is 0 */
+    AWS_H1_DEFAULT_EXPECT_CONTINUE_TIMEOUT_MS = 1000,
+};
+
 struct aws_h1_stream {
     struct aws_http_stream base;
 
+    /* If the stream has its own arena, base.alloc points to it, and it's destroyed along with the stream */
+    struct aws_allocator *arena;
+
     struct aws_linked_list_node node;
 
     /* Message (derived from outgoing request or response) to be submitted to encoder */
     struct aws_h1_encoder_message encoder_message;
 
+    /* Chunks of a "Transfer-Encoding: chunked" message, waiting for the encoder.
+     * Only the connection's event-loop thread may touch this list. */
+    struct aws_linked_list pending_chunk_list;
+
     bool is_outgoing_message_done;
 
     bool is_incoming_message_done;
@@ -36,13 +49,55 @@ struct aws_h1_stream {
      * See RFC-7230 Section 6: Connection Management. */
     bool is_final_stream;
 
+    /* If true, the connection stops writing this stream when its body has no data available,
+     * until aws_http_stream_resume_outgoing_body() is called. Otherwise, the body is polled each tick. */
+    bool pause_outgoing_body_when_empty;
+
+    /* If the request has "Expect: 100-continue", how long to hold back the body waiting for "100 Continue" */
+    uint64_t expect_continue_timeout_ms;
+
     /* Buffer for incoming data that needs to stick around. */
     struct aws_byte_buf incoming_storage_buf;
 
+    /* User's buffers to write incoming body data into, see aws_http_make_request_options.response_body_buffers.
+     * They're filled as a ring. Buffers the connection has finished belong to the user until they're recycled,
+     * the rest belong to the connection's event-loop thread. */
+    struct aws_byte_buf *incoming_body_buffers;
+    size_t num_incoming_body_buffers;
+    /* Number of bytes the window was shrunk by for each buffer's data */
+    size_t *incoming_body_buffer_window_sizes;
+    /* Count of buffers ever started, so the one being filled is at (count % num_incoming_body_buffers).
+     * Only the connection's event-loop thread may touch this. */
+    size_t incoming_body_buffer_index;
+    /* Count of buffers finished by the connection, and count recycled by the user */
+    struct aws_atomic_var incoming_body_buffers_finished;
+    struct aws_atomic_var incoming_body_buffers_recycled;
+
+    /* Whether to decompress incoming body data, see aws_http_make_request_options.decompress_response_body.
+     * Only the connection's event-loop thread may touch the decompression state. */
+    bool decompress_incoming_body;
+    enum aws_http_content_coding incoming_content_coding;     /* From Content-Encoding header */
+    enum aws_http_content_coding incoming_body_coding;        /* Coding being undone, set when head is done */
+    struct aws_http_decompressor *incoming_body_decompressor; /* Created when first body data arrives */
+    /* Size on the wire of body data that hasn't been delivered to the user yet */
+    size_t undelivered_incoming_body_wire_bytes;
+
     /* Any thread may touch this data, but the lock must be held */
     struct {
         /* Whether a "request handler" stream has a response to send. */
         bool has_outgoing_response;
+
+        /* Chunks from aws_http1_stream_write_chunk() that haven't been moved to the event-loop thread yet */
+        struct aws_linked_list pending_chunk_list;
+
+        /* Whether the final (zero-length) chunk has been submitted */
+        bool has_final_chunk;
+
+        /* Whether the stream has completed, in which case no more chunks may be submitted */
+        bool is_complete;
+
+        /* Whether aws_http_stream_resume_outgoing_body() has been called since the body last ran dry */
+        bool has_pending_body_resume;
     } synced_data;
 };
 
@@ -62,4 +117,8 @@ AWS_EXTERN_C_END
  * units. it is defined in h1_connection.c */
 int aws_h1_stream_activate(struct aws_http_stream *stream);
 
+int aws_h1_stream_write_chunk(struct aws_http_stream *stream, const struct aws_http1_chunk_options *options);
+
+int aws_h1_stream_resume_outgoing_body(struct aws_http_stream *stream);
+
 #endif /* AWS_HTTP_H1_STREAM_H */
@@ -22,9 +22,11 @@
 
 #include <aws/http/private/connection_impl.h>
 #include <aws/http/private/h2_frames.h>
+#include <aws/http/statistics.h>
 
 struct aws_h2_decoder;
 struct aws_h2_stream;
+struct aws_h2_stream_scheduler_vtable;
 
 struct aws_h2_connection {
     struct aws_http_connection base;
@@ -48,16 +50,80 @@ struct aws_h2_connection {
         /* My settings to send/sent to peer, which affects the decoding */
         uint32_t settings_self[AWS_H2_SETTINGS_END_RANGE];
 
+        /* Connection-level flow-control window for DATA we may send (RFC-7540 6.9) */
+        size_t window_size_peer;
+
+        /* Connection-level flow-control window for DATA peer may send us.
+         * This is always replenished automatically, manual window management is done per-stream. */
+        size_t window_size_self;
+
+        /* Sizing of our receive windows, when they're replenished automatically (manual_window_management is false).
+         * Windows grow toward the bandwidth-delay product (BDP) of the connection.
+         * To measure it, a PING is sent when DATA arrives, and the DATA received before its ACK is what
+         * peer can have in flight per round-trip. If that nearly fills the window, the window is too small. */
+        struct {
+            /* Streams' windows are topped up to this size. It starts at our SETTINGS_INITIAL_WINDOW_SIZE */
+            uint32_t stream_window_size;
+
+            /* Connection's window is topped up to this size */
+            size_t connection_window_size;
+
+            /* Windows never grow past this size */
+            size_t max_window_size;
+
+            bool is_ping_in_flight;
+            uint64_t ping_count;
+            uint64_t ping_timestamp_ns;
+            size_t bytes_received_since_ping;
+
+            /* Pings are spaced further apart while the windows aren't growing */
+            uint64_t next_ping_timestamp_ns;
+            uint64_t ping_backoff_ns;
+
+            /* When our SETTINGS frame was sent, its ACK gives the first RTT measurement */
+            uint64_t settings_timestamp_ns;
+
+            uint64_t rtt_ns;
+            uint64_t max_bandwidth_bytes_per_sec;
+        } window_autotune;
+
+        struct aws_crt_statistics_http2_channel stats;
+
         /* Maps stream-id to aws_h2_stream*.
          * Contains all streams in the open, reserved, and half-closed states (terms from RFC-7540 5.1).
          * Once a stream enters closed state, it is removed from this map. */
         struct aws_hash_table active_streams_map;
 
+        /* List using aws_h2_stream.node.
+         * Contains streams that were activated by the user, but can't be opened yet because
+         * peer's SETTINGS_MAX_CONCURRENT_STREAMS has been reached. They're opened in order, as slots free up. */
+        struct aws_linked_list waiting_streams_list;
+
         /* List using aws_h2_stream.node.
          * Contains all streams with DATA frames to send.
          * Any stream in this list is also in the active_streams_map. */
         struct aws_linked_list outgoing_streams_list;
 
+        /* Chooses which stream in outgoing_streams_list sends the next DATA frame */
+        const struct aws_h2_stream_scheduler_vtable *stream_scheduler;
+        struct {
+            /* Virtual time of the stream most recently chosen by a fair-queueing scheduler.
+             * For the dependency scheduler, that's among the streams at the root of the tree. */
+            double virtual_time;
+
+            /* Incremented each time shares are computed */
+            uint64_t pass;
+
+            /* Streams at the root of the dependency tree with DATA ready somewhere in their subtree */
+            struct aws_linked_list root_active_children;
+        } stream_scheduler_data;
+
+        /* List using aws_h2_stream.node.
+         * Contains streams with DATA frames to send, whose flow-control window is exhausted.
+         * They move back to outgoing_streams_list when peer sends WINDOW_UPDATE.
+         * Any stream in this list is also in the active_streams_map. */
+        struct aws_linked_list stalled_window_streams_list;
+
         /* List using aws_h2_frame.node.
          * Queues all frames (except DATA frames) for connection to send.
          * When queue is empty, then we send DATA frames from the outgoing_streams_list */
@@ -84,6 +150,18 @@ struct aws_h2_connection {
         /* New `aws_h2_stream *` that haven't moved to `thread_data` yet */
         struct aws_linked_list pending_stream_list;
 
+        /* Number of streams activated by the user, but not yet opened.
+         * Includes streams in pending_stream_list and thread_data.waiting_streams_list. */
+        struct aws_atomic_var pending_stream_count;
+
+        /* Copy of peer's SETTINGS_MAX_CONCURRENT_STREAMS, for checking from outside the event-loop thread */
+        struct aws_atomic_var max_concurrent_streams_peer;
+
+        /* List using aws_h2_stream.synced_data.window_update_node.
+         * Contains streams with aws_http_stream_update_window() calls that haven't been applied yet.
+         * Each stream holds a refcount while it's in this list. */
+        struct aws_linked_list window_update_stream_list;
+
         bool is_cross_thread_work_task_scheduled;
 
     } synced_data;
@@ -106,13 +184,17 @@ AWS_HTTP_API
 struct aws_http_connection *aws_http_connection_new_http2_server(
     struct aws_allocator *allocator,
     bool manual_window_management,
-    size_t initial_window_size);
+    size_t initial_window_size,
+    size_t max_window_size,
+    enum aws_http2_stream_scheduler stream_scheduler);
 
 AWS_HTTP_API
 struct aws_http_connection *aws_http_connection_new_http2_client(
     struct aws_allocator *allocator,
     bool manual_window_management,
-    size_t initial_window_size);
+    size_t initial_window_size,
+    size_t max_window_size,
+    enum aws_http2_stream_scheduler stream_scheduler);
 
 AWS_EXTERN_C_END
 
@@ -126,6 +208,19 @@ AWS_EXTERN_C_END
  */
 void aws_h2_connection_enqueue_outgoing_frame(struct aws_h2_connection *connection, struct aws_h2_frame *frame);
 
+/**
+ * Returns number of streams activated by the user, but not yet opened
+ * because peer's SETTINGS_MAX_CONCURRENT_STREAMS has been reached.
+ * May be called from any thread.
+ */
+size_t aws_h2_connection_get_pending_stream_count(const struct aws_h2_connection *connection);
+
+/**
+ * Returns peer's SETTINGS_MAX_CONCURRENT_STREAMS.
+ * May be called from any thread.
+ */
+uint32_t aws_h2_connection_get_max_concurrent_streams(const struct aws_h2_connection *connection);
+
 /**
  * Invoked immediately after a stream enters the CLOSED state.
  * The connection will remove the stream from its "active" datastructures,
@@ -56,6 +56,16 @@ struct aws_h2_decoder_vtable {
         void *userdata);
     int (*on_push_promise_end)(uint32_t stream_id, bool malformed, void *userdata);
 
+    /* Called once at the start of each DATA frame, before any on_data() calls.
+     * `payload_len` is the whole frame payload (counted against flow-control windows),
+     * of which `total_padding_bytes` are padding (including the 1-byte Pad Length) */
+    int (*on_data_begin)(
+        uint32_t stream_id,
+        uint32_t payload_len,
+        uint32_t total_padding_bytes,
+        bool end_stream,
+        void *userdata);
+
     /* Called repeatedly as DATA frames are processed.
      * This may fire multiple times per actual DATA frame. */
     int (*on_data)(uint32_t stream_id, struct aws_byte_cursor data, void *userdata);
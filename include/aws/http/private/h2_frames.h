@@ -221,6 +221,9 @@ int aws_h2_encode_frame(
  * AWS_OP_ERR is returned if encoder encounters an unrecoverable error.
  * body_complete will be set true if encoder reaches the end of the body_stream.
  *
+ * The frame's payload (padding included) will not exceed the peer's flow-control windows for the stream
+ * and the connection. Both windows are reduced by the size of the payload that was encoded.
+ *
  * Each call to this function encodes a complete DATA frame, or nothing at all,
  * so it's always safe to encode a different frame type or the body of a different stream
  * after calling this.
@@ -232,6 +235,8 @@ int aws_h2_encode_data_frame(
     struct aws_input_stream *body_stream,
     bool body_ends_stream,
     uint8_t pad_length,
+    int32_t *stream_window_size_peer,
+    size_t *connection_window_size_peer,
     struct aws_byte_buf *output,
     bool *body_complete);
 
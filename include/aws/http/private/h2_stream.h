@@ -63,10 +63,54 @@ struct aws_h2_stream {
     /* Only the event-loop thread may touch this data */
     struct {
         enum aws_h2_stream_state state;
-        uint64_t window_size; /* #TODO try to figure out how this actually works, and then implement it */
+
+        /* Flow-control window for DATA we may send (RFC-7540 6.9).
+         * Can go negative if peer shrinks SETTINGS_INITIAL_WINDOW_SIZE. */
+        int32_t window_size_peer;
+
+        /* Flow-control window for DATA peer may send us */
+        int32_t window_size_self;
+
+        /* Window updates from the user, made before the stream was opened. Applied once it's opened. */
+        size_t window_update_before_open;
+
+        /* True while the stream has DATA to send, but is parked until peer sends WINDOW_UPDATE */
+        bool is_waiting_for_window_update;
+
+        /* Priority of outgoing DATA, relative to other streams */
+        struct aws_http2_stream_priority priority;
+
+        /* Bookkeeping for the connection's stream scheduler */
+        struct {
+            /* Fair-queueing schedulers choose the stream that's furthest behind.
+             * Virtual time advances by bytes sent, divided by the stream's share of bandwidth */
+            double virtual_time;
+            double share;
+
+            /* Scratch space, only valid when the pass number matches the connection's */
+            uint64_t active_pass;
+
+            /* Dependency scheduler's view of the tree. Virtual time is relative to siblings there.
+             * A stream is linked into its parent's active_children while its subtree has DATA ready. */
+            bool is_ready;
+            uint32_t ready_count; /* Number of ready streams in the subtree, including this one */
+            double children_virtual_time;
+            struct aws_linked_list active_children;
+            struct aws_linked_list_node active_sibling_node;
+        } scheduler;
+
         struct aws_http_message *outgoing_message;
         bool received_main_headers;
     } thread_data;
+
+    /* Any thread may touch this data, but the connection's lock must be held */
+    struct {
+        /* Sum of aws_http_stream_update_window() calls not yet applied on the event-loop thread */
+        size_t pending_window_update_size;
+
+        /* Node in connection's synced_data.window_update_stream_list, next is NULL when not in the list */
+        struct aws_linked_list_node window_update_node;
+    } synced_data;
 };
 
 const char *aws_h2_stream_state_to_str(enum aws_h2_stream_state state);
@@ -93,9 +137,28 @@ int aws_h2_stream_on_decoder_headers_end(
     bool malformed,
     enum aws_http_header_block block_type);
 
+int aws_h2_stream_on_decoder_data_begin(
+    struct aws_h2_stream *stream,
+    uint32_t payload_len,
+    uint32_t total_padding_bytes,
+    bool end_stream);
+
 int aws_h2_stream_on_decoder_data(struct aws_h2_stream *stream, struct aws_byte_cursor data);
 int aws_h2_stream_on_decoder_end_stream(struct aws_h2_stream *stream);
 
+/* Sets `out_window_resumed` true if the window had been exhausted, and is open again */
+int aws_h2_stream_on_decoder_window_update(
+    struct aws_h2_stream *stream,
+    uint32_t window_size_increment,
+    bool *out_window_resumed);
+
+/* Connection has sent the stream's last DATA frame, with the END_STREAM flag */
+int aws_h2_stream_on_end_stream_sent(struct aws_h2_stream *stream);
+
+/* Apply increment from aws_http_stream_update_window(), once connection has brought it to the event-loop thread */
+int aws_h2_stream_apply_window_update(struct aws_h2_stream *stream, size_t increment_size);
+
 int aws_h2_stream_activate(struct aws_http_stream *stream);
+void aws_h2_stream_update_window(struct aws_http_stream *stream, size_t increment_size);
 
 #endif /* AWS_HTTP_H2_STREAM_H */
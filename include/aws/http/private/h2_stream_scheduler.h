@@ -0,0 +1,65 @@
+#ifndef AWS_HTTP_H2_STREAM_SCHEDULER_H
+#define AWS_HTTP_H2_STREAM_SCHEDULER_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/http/connection.h>
+
+struct aws_h2_connection;
+struct aws_h2_stream;
+
+/**
+ * Chooses which stream sends the next DATA frame, among the streams in the connection's outgoing_streams_list.
+ * Every DATA frame carries at most one scheduling quantum, so the scheduler gets to choose again often.
+ * All functions are called on the connection's event-loop thread.
+ */
+struct aws_h2_stream_scheduler_vtable {
+    /* Stream was just activated. Called before its HEADERS frame is created. */
+    void (*on_stream_activated)(struct aws_h2_connection *connection, struct aws_h2_stream *stream);
+
+    /* Stream joined outgoing_streams_list. It's a candidate for choose_stream() until on_stream_unready(). */
+    void (*on_stream_ready)(struct aws_h2_connection *connection, struct aws_h2_stream *stream);
+
+    /* Stream left outgoing_streams_list. Not called while the chosen stream is briefly removed to send a frame. */
+    void (*on_stream_unready)(struct aws_h2_connection *connection, struct aws_h2_stream *stream);
+
+    /* Stream is complete. Called before it's removed from active_streams_map, if it was in there at all.
+     * If the stream was still ready, on_stream_unready() isn't called first. */
+    void (*on_stream_complete)(struct aws_h2_connection *connection, struct aws_h2_stream *stream);
+
+    /* Return stream that should send the next DATA frame. outgoing_streams_list is not empty. */
+    struct aws_h2_stream *(*choose_stream)(struct aws_h2_connection *connection);
+
+    /* Stream sent a DATA frame with this much payload */
+    void (*on_data_sent)(struct aws_h2_connection *connection, struct aws_h2_stream *stream, size_t payload_len);
+
+    /* Whether the stream's dependency and weight are sent to peer in its HEADERS frame */
+    bool sends_priority;
+};
+
+enum {
+    /* Max payload of a DATA frame, before the scheduler chooses again */
+    AWS_H2_STREAM_SCHEDULER_QUANTUM = 16 * 1024,
+};
+
+AWS_EXTERN_C_BEGIN
+
+/* Returns NULL and raises AWS_ERROR_INVALID_ARGUMENT if the type is unknown */
+const struct aws_h2_stream_scheduler_vtable *aws_h2_stream_scheduler_get(enum aws_http2_stream_scheduler type);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_HTTP_H2_STREAM_SCHEDULER_H */
@@ -30,32 +30,6 @@ enum aws_http_method {
     AWS_HTTP_METHOD_COUNT, /* Number of enums */
 };
 
-/**
- * Headers that affect internal processing.
- * This is NOT a definitive list of headers.
- */
-enum aws_http_header_name {
-    AWS_HTTP_HEADER_UNKNOWN, /* Unrecognized value */
-
-    /* Request pseudo-headers */
-    AWS_HTTP_HEADER_METHOD,
-    AWS_HTTP_HEADER_SCHEME,
-    AWS_HTTP_HEADER_AUTHORITY,
-    AWS_HTTP_HEADER_PATH,
-
-    /* Response pseudo-headers */
-    AWS_HTTP_HEADER_STATUS,
-
-    /* Regular headers */
-    AWS_HTTP_HEADER_CONNECTION,
-    AWS_HTTP_HEADER_CONTENT_LENGTH,
-    AWS_HTTP_HEADER_EXPECT,
-    AWS_HTTP_HEADER_TRANSFER_ENCODING,
-    AWS_HTTP_HEADER_COOKIE,
-
-    AWS_HTTP_HEADER_COUNT, /* Number of enums */
-};
-
 AWS_EXTERN_C_BEGIN
 
 AWS_HTTP_API void aws_http_fatal_assert_library_initialized(void);
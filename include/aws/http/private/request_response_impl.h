@@ -20,12 +20,29 @@
 
 #include <aws/http/private/http_impl.h>
 
+#include <aws/common/array_list.h>
 #include <aws/common/atomics.h>
 
+/**
+ * Incoming headers, buffered so that a whole header block can be delivered at once.
+ * See aws_http_on_incoming_header_block_fn.
+ */
+struct aws_http_header_block_buffer {
+    /* struct aws_http_header. Cursors aren't valid until aws_http_header_block_buffer_get() points them at `storage` */
+    struct aws_array_list headers;
+    /* enum aws_http_header_name */
+    struct aws_array_list name_ids;
+    /* Each header's name and value, back to back */
+    struct aws_byte_buf storage;
+};
+
 struct aws_http_stream_vtable {
     void (*destroy)(struct aws_http_stream *stream);
     void (*update_window)(struct aws_http_stream *stream, size_t increment_size);
     int (*activate)(struct aws_http_stream *stream);
+    int (*http1_write_chunk)(struct aws_http_stream *http1_stream, const struct aws_http1_chunk_options *options);
+    int (*resume_outgoing_body)(struct aws_http_stream *stream);
+    int (*http1_recycle_response_body_buffer)(struct aws_http_stream *http1_stream);
 };
 
 /**
@@ -44,6 +61,7 @@ struct aws_http_stream {
     void *user_data;
     aws_http_on_incoming_headers_fn *on_incoming_headers;
     aws_http_on_incoming_header_block_done_fn *on_incoming_header_block_done;
+    aws_http_on_incoming_header_block_fn *on_incoming_header_block;
     aws_http_on_incoming_body_fn *on_incoming_body;
     aws_http_on_stream_complete_fn *on_complete;
 
@@ -65,6 +83,51 @@ struct aws_http_stream {
      * Opposite is true on server connections */
     struct aws_http_stream_client_data *client_data;
     struct aws_http_stream_server_data *server_data;
+
+    /* Only used if `on_incoming_header_block` is set. Only the connection's event-loop thread may touch this. */
+    struct aws_http_header_block_buffer incoming_header_block;
+
+    /* See aws_http_stream_get_incoming_body_wire_bytes(). Only the connection's event-loop thread may touch this. */
+    size_t incoming_body_wire_bytes;
 };
 
+AWS_EXTERN_C_BEGIN
+
+AWS_HTTP_API
+int aws_http_header_block_buffer_init(struct aws_http_header_block_buffer *buffer, struct aws_allocator *allocator);
+
+/* Safe to call on a zeroed buffer */
+AWS_HTTP_API
+void aws_http_header_block_buffer_clean_up(struct aws_http_header_block_buffer *buffer);
+
+/* Copy the header into the buffer */
+AWS_HTTP_API
+int aws_http_header_block_buffer_add(
+    struct aws_http_header_block_buffer *buffer,
+    const struct aws_http_header *header,
+    enum aws_http_header_name name_id);
+
+/* Get the buffered headers. They remain valid until the buffer is modified */
+AWS_HTTP_API
+void aws_http_header_block_buffer_get(
+    struct aws_http_header_block_buffer *buffer,
+    const struct aws_http_header **out_headers,
+    const enum aws_http_header_name **out_name_ids,
+    size_t *out_count);
+
+/* Forget the buffered headers, keeping the memory for the next block. Safe to call on a zeroed buffer */
+AWS_HTTP_API
+void aws_http_header_block_buffer_reset(struct aws_http_header_block_buffer *buffer);
+
+/**
+ * If the stream has an `on_incoming_header_block` callback, invoke it with the buffered headers.
+ * The headers stay buffered, call aws_http_header_block_buffer_reset() when they're no longer needed.
+ */
+AWS_HTTP_API
+int aws_http_stream_deliver_incoming_header_block(
+    struct aws_http_stream *stream,
+    enum aws_http_header_block header_block);
+
+AWS_EXTERN_C_END
+
 #endif /* AWS_HTTP_REQUEST_RESPONSE_IMPL_H */
@@ -69,6 +69,20 @@ int aws_strutil_read_unsigned_hex(struct aws_byte_cursor cursor, uint64_t *dst);
 AWS_HTTP_API
 struct aws_byte_cursor aws_strutil_trim_http_whitespace(struct aws_byte_cursor cursor);
 
+/**
+ * Scan for the first '\n' in the cursor, noting the first ':' that precedes it along the way.
+ * Returns the index of the '\n', or cursor.len if there isn't one.
+ * `out_colon_index` is set to the index of the first ':' before the returned index, or SIZE_MAX if there isn't one.
+ *
+ * Both characters are found in a single pass, 16 or 32 bytes at a time when built with SSE2 or AVX2.
+ * Examples:
+ * "Host: a:b\r\n" -> 10, colon 4
+ * "Host\r\n" -> 5, colon SIZE_MAX
+ * "a\nb:" -> 1, colon SIZE_MAX
+ */
+AWS_HTTP_API
+size_t aws_strutil_scan_for_newline(struct aws_byte_cursor cursor, size_t *out_colon_index);
+
 /**
  * Return whether this is a valid token, as defined by RFC7230 section 3.2.6:
  *  token          = 1*tchar
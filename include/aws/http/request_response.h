@@ -101,6 +101,14 @@ enum aws_http_header_block {
     AWS_HTTP_HEADER_BLOCK_TRAILING,
 };
 
+/**
+ * Codings that may be applied to an outgoing body, see aws_http_message_set_compressed_body_stream().
+ */
+enum aws_http_body_compression {
+    AWS_HTTP_BODY_COMPRESSION_GZIP,
+    AWS_HTTP_BODY_COMPRESSION_DEFLATE,
+};
+
 /**
  * The definition for an outgoing HTTP request or response.
  * The message may be transformed (ex: signing the request) before its data is eventually sent.
@@ -113,6 +121,25 @@ enum aws_http_header_block {
  */
 struct aws_http_message;
 
+/**
+ * The invariant parts of an HTTP/1.1 request head (method and headers), validated and serialized once.
+ * Use this when sending many requests that differ only in their path and a few header values.
+ * See aws_http1_request_template_new() and aws_http_make_request_options.request_template.
+ */
+struct aws_http1_request_template;
+
+/**
+ * A pool of recycled messages. Messages from the pool return to it when their last hold is released,
+ * keeping their header storage for the next user. See aws_http_message_pool_new().
+ */
+struct aws_http_message_pool;
+
+/**
+ * Invoked when a message with body data from aws_http_message_set_body_data() is destroyed,
+ * and the body data's memory is no longer in use.
+ */
+typedef void(aws_http_message_body_data_release_fn)(void *user_data);
+
 /**
  * Function to invoke when a message transformation completes.
  * This function MUST be invoked or the application will soft-lock.
@@ -154,6 +181,28 @@ typedef int(aws_http_on_incoming_headers_fn)(
     size_t num_headers,
     void *user_data);
 
+/**
+ * Invoked once per incoming header block, with every header in the block, in the order received.
+ * An alternative to `aws_http_on_incoming_headers_fn` that avoids a callback per header.
+ * `header_name_ids[i]` identifies the name of `header_array[i]`, or is AWS_HTTP_HEADER_UNKNOWN
+ * if the name isn't one the library recognizes.
+ * This is invoked just before `aws_http_on_incoming_header_block_done_fn`.
+ * The arrays, and the strings they point to, are owned by the stream. They remain valid until the
+ * header-block-done callback returns (HTTP/1.1 trailing headers have no header-block-done callback,
+ * so those are only valid until this callback returns).
+ * This is always invoked on the HTTP connection's event-loop thread.
+ *
+ * Return AWS_OP_SUCCESS to continue processing the stream.
+ * Return AWS_OP_ERR to indicate failure and cancel the stream.
+ */
+typedef int(aws_http_on_incoming_header_block_fn)(
+    struct aws_http_stream *stream,
+    enum aws_http_header_block header_block,
+    const struct aws_http_header *header_array,
+    const enum aws_http_header_name *header_name_ids,
+    size_t num_headers,
+    void *user_data);
+
 /**
  * Invoked when the incoming header block of this type(informational/main/trailing) has been completely read.
  * This is always invoked on the HTTP connection's event-loop thread.
@@ -174,7 +223,8 @@ typedef int(aws_http_on_incoming_header_block_done_fn)(
  * Note that, if the connection is using manual_window_management then the window
  * size has shrunk by the amount of body data received. If the window size
  * reaches 0 no further data will be received. Increment the window size with
- * aws_http_stream_update_window().
+ * aws_http_stream_update_window(). If the body is being decompressed, the window shrank by
+ * the size of the data on the wire, see aws_http_stream_get_incoming_body_wire_bytes().
  *
  * Return AWS_OP_SUCCESS to continue processing the stream.
  * Return AWS_OP_ERR to indicate failure and cancel the stream.
@@ -197,6 +247,36 @@ typedef int(aws_http_on_incoming_request_done_fn)(struct aws_http_stream *stream
  */
 typedef void(aws_http_on_stream_complete_fn)(struct aws_http_stream *stream, int error_code, void *user_data);
 
+/**
+ * Priority of an HTTP/2 request's outgoing DATA, relative to other requests on the same connection.
+ * Which fields are used depends on the connection's `http2_stream_scheduler`, the rest are ignored.
+ * Initialize with AWS_HTTP2_STREAM_PRIORITY_INIT to get the defaults.
+ */
+struct aws_http2_stream_priority {
+    /**
+     * Used by AWS_HTTP2_STREAM_SCHEDULER_DEPENDENCY (RFC-7540 5.3), and also sent to the server.
+     * A stream only sends DATA when the stream it depends on can't.
+     * Streams that depend on the same stream share bandwidth in proportion to their weight (1-256, default 16).
+     * If `exclusive`, this stream becomes the sole dependency of its parent, adopting the parent's other dependents.
+     * A `dependency_stream_id` of 0, or of a stream that's closed or newer than this one, means no dependency.
+     */
+    uint32_t dependency_stream_id;
+    uint16_t weight;
+    bool exclusive;
+
+    /**
+     * Used by AWS_HTTP2_STREAM_SCHEDULER_URGENCY, modeled on RFC-9218.
+     * Only streams with the lowest `urgency` (0-7, default 3) send DATA.
+     * Among those, non-incremental streams send one at a time in the order they were made,
+     * then incremental streams share bandwidth equally.
+     */
+    uint8_t urgency;
+    bool incremental;
+};
+
+#define AWS_HTTP2_STREAM_PRIORITY_INIT                                                                                 \
+    { .weight = 16, .urgency = 3, }
+
 /**
  * Options for creating a stream which sends a request from the client and receives a response from the server.
  */
@@ -243,6 +323,91 @@ struct aws_http_make_request_options {
      * See `aws_http_on_stream_complete_fn`.
      */
     aws_http_on_stream_complete_fn *on_complete;
+
+    /**
+     * If false (default), when the request's body stream has no data available,
+     * the connection will poll it again on the next tick of the event-loop.
+     *
+     * If true, when the body stream has no data available, the connection stops
+     * reading from it until aws_http_stream_resume_outgoing_body() is called.
+     * Use this when body data is produced slowly (ex: from disk or another network source)
+     * to avoid burning CPU while waiting.
+     */
+    bool pause_outgoing_body_when_empty;
+
+    /**
+     * Pre-serialized method and headers to send ahead of the request's own headers.
+     * Optional, only supported on HTTP/1.1 connections.
+     * When set, the method comes from the template, while the path, additional headers,
+     * and body come from `request`. If `request` has a method too, it must match the template's,
+     * or AWS_ERROR_INVALID_ARGUMENT is raised. The template is only read during aws_http_connection_make_request().
+     * See aws_http1_request_template_new().
+     */
+    const struct aws_http1_request_template *request_template;
+
+    /**
+     * Buffers to write the response body into, filled in order, wrapping around from the last to the first.
+     * Optional, only supported on HTTP/1.1 connections.
+     * Each buffer's `len` grows as data arrives. A buffer is finished once it's full, or once the stream completes.
+     * Finished buffers belong to the user until they're handed back with
+     * aws_http1_stream_recycle_response_body_buffer(), which makes them available to fill again.
+     * If body data arrives and the next buffer hasn't been recycled yet, the stream fails with AWS_ERROR_SHORT_BUFFER.
+     * With manual window management, the window shrinks as data is written to the buffers,
+     * and recycling a buffer increments it again, so an initial window no larger than the buffers' total capacity
+     * keeps the body from outgrowing them. Without manual window management, nothing holds back the data,
+     * so the buffers must be recycled quickly enough or be big enough for the whole body.
+     * If `on_response_body` is also set, it's invoked with cursors pointing into these buffers.
+     * The array and its buffers must stay valid until on_complete is called, and the user is done recycling them.
+     */
+    struct aws_byte_buf *response_body_buffers;
+    size_t num_response_body_buffers;
+
+    /**
+     * Set to true to decompress a response body whose Content-Encoding or Transfer-Encoding is "gzip" or "deflate".
+     * Optional, only supported on HTTP/1.1 connections, and only if aws-c-http was built with zlib.
+     * Data is decompressed as it arrives, and decompressed data is passed to `on_response_body`
+     * (or written into `response_body_buffers`). Response headers are delivered unaltered.
+     * Only one coding is undone: if the body has a Transfer-Encoding coding, its Content-Encoding is left alone.
+     * Bodies with other codings are delivered as-is.
+     * With manual window management, the window is shrunk by the compressed size of the data, not the size delivered.
+     * From `on_response_body`, aws_http_stream_get_incoming_body_wire_bytes() tells how much to increment it by.
+     * A stream whose body can't be decompressed fails with AWS_ERROR_HTTP_COMPRESSION.
+     */
+    bool decompress_response_body;
+
+    /**
+     * How long to wait for "100 Continue" before sending the body anyway,
+     * if the request has an "Expect: 100-continue" header.
+     * Optional, 0 means the default of 1 second. Only applies to HTTP/1.1 connections.
+     * The body is held back until the server responds with "100 Continue", or this much time has passed
+     * since the request's head was written. If the server sends a final response first (ex: 401, 413, 417),
+     * the body is never sent, and the connection closes once the response is complete.
+     */
+    uint32_t expect_continue_timeout_ms;
+
+    /**
+     * Invoked once per response header block, with all of the block's headers at once.
+     * Optional. May be used instead of, or along with, `on_response_headers`.
+     * See `aws_http_on_incoming_header_block_fn`.
+     */
+    aws_http_on_incoming_header_block_fn *on_response_header_block;
+
+    /**
+     * If non-zero, the stream's own memory is carved from an arena with blocks of this size (see arena.h),
+     * and released all at once when the stream is destroyed.
+     * This covers the stream object and the buffers used to encode the request and decode the response.
+     * Chunks from aws_http1_stream_write_chunk() are not included, since a long upload may send any number of them.
+     * To get the same benefit for the request message, create it with an arena allocator too.
+     * Optional, only used on HTTP/1.1 connections, ignored on HTTP/2.
+     */
+    size_t arena_block_size;
+
+    /**
+     * Priority of the request's outgoing DATA, see `aws_http2_stream_priority`.
+     * Optional, NULL means AWS_HTTP2_STREAM_PRIORITY_INIT. Only used on HTTP/2 connections.
+     * The struct is copied during aws_http_connection_make_request().
+     */
+    const struct aws_http2_stream_priority *http2_priority;
 };
 
 struct aws_http_request_handler_options {
@@ -294,11 +459,72 @@ struct aws_http_request_handler_options {
      * See `aws_http_on_stream_complete_fn`.
      */
     aws_http_on_stream_complete_fn *on_complete;
+
+    /**
+     * If true, the connection stops reading from the response's body stream when it has no data available,
+     * until aws_http_stream_resume_outgoing_body() is called.
+     * See aws_http_make_request_options.pause_outgoing_body_when_empty.
+     */
+    bool pause_outgoing_body_when_empty;
+
+    /**
+     * Invoked once per request header block, with all of the block's headers at once.
+     * Optional. May be used instead of, or along with, `on_request_headers`.
+     * See `aws_http_on_incoming_header_block_fn`.
+     */
+    aws_http_on_incoming_header_block_fn *on_request_header_block;
+
+    /**
+     * If non-zero, the stream's own memory is carved from an arena with blocks of this size.
+     * See aws_http_make_request_options.arena_block_size.
+     */
+    size_t arena_block_size;
 };
 
 #define AWS_HTTP_REQUEST_HANDLER_OPTIONS_INIT                                                                          \
     { .self_size = sizeof(struct aws_http_request_handler_options), }
 
+/**
+ * Invoked when the data of an outgoing HTTP/1.1 chunk is no longer in use.
+ * This is always invoked on the HTTP connection's event-loop thread.
+ *
+ * If error_code is AWS_ERROR_SUCCESS (0), the chunk was successfully written.
+ * AWS_ERROR_HTTP_STREAM_HAS_COMPLETED indicates that the stream ended before the chunk could be sent.
+ * Any other error_code indicates a problem with this chunk's data, or the connection.
+ */
+typedef void(aws_http1_stream_write_chunk_complete_fn)(struct aws_http_stream *stream, int error_code, void *user_data);
+
+/**
+ * Options for writing a chunk to an HTTP/1.1 stream whose message has a "Transfer-Encoding: chunked" header.
+ * See aws_http1_stream_write_chunk().
+ */
+struct aws_http1_chunk_options {
+    /**
+     * The data stream to be sent in a single chunk.
+     * The aws_input_stream must remain valid until on_complete is invoked.
+     * May be NULL in the final chunk with size 0.
+     */
+    struct aws_input_stream *chunk_data;
+
+    /**
+     * Size of chunk_data, in bytes.
+     * A chunk_data_size of 0 ends the message body.
+     */
+    uint64_t chunk_data_size;
+
+    /**
+     * Invoked when the chunk data is no longer in use, whether or not it was successfully sent.
+     * Optional.
+     * See `aws_http1_stream_write_chunk_complete_fn`.
+     */
+    aws_http1_stream_write_chunk_complete_fn *on_complete;
+
+    /**
+     * User provided data passed to the on_complete callback on its invocation.
+     */
+    void *user_data;
+};
+
 AWS_EXTERN_C_BEGIN
 
 /**
@@ -382,6 +608,9 @@ size_t aws_http_headers_count(const struct aws_http_headers *headers);
  *   If "A: one" is seen before "B: bee" in one iteration, you might see "B: bee" before "A: one" on the next.
  *
  * AWS_ERROR_INVALID_INDEX is raised if the index is invalid.
+ *
+ * The header's strings belong to the headers object. Adding headers never moves them,
+ * but erasing or setting headers may, so they're only valid until then.
  */
 AWS_HTTP_API
 int aws_http_headers_get_index(
@@ -392,6 +621,7 @@ int aws_http_headers_get_index(
 /**
  * Get the first value for this name, ignoring any additional values.
  * AWS_ERROR_HTTP_HEADER_NOT_FOUND is raised if the name is not found.
+ * The value is only valid until headers are erased or set, see aws_http_headers_get_index().
  */
 AWS_HTTP_API
 int aws_http_headers_get(
@@ -483,6 +713,57 @@ void aws_http_message_release(struct aws_http_message *message);
 AWS_HTTP_API
 void aws_http_message_destroy(struct aws_http_message *message);
 
+/**
+ * Create a pool of recycled messages, for code that creates and releases many messages.
+ * Up to `max_pooled_messages` idle requests, and as many idle responses, are kept for reuse.
+ *
+ * The pool is thread-safe, but for least contention give each event-loop (or thread) its own pool.
+ * The caller has a hold on the pool and must call aws_http_message_pool_release() when done with it.
+ * Messages still in use keep the pool alive until they're released.
+ * A message is recycled on whichever thread releases its last hold.
+ * Its headers are reused only if no one else still holds them; otherwise the pooled message gets fresh headers.
+ */
+AWS_HTTP_API
+struct aws_http_message_pool *aws_http_message_pool_new(struct aws_allocator *allocator, size_t max_pooled_messages);
+
+/**
+ * Release a hold on the pool. Idle messages are freed once the pool is no longer in use.
+ */
+AWS_HTTP_API
+void aws_http_message_pool_release(struct aws_http_message_pool *pool);
+
+/**
+ * Get a blank request message, recycled from the pool if possible.
+ * Use it just like a message from aws_http_message_new_request().
+ * When its last hold is released, the message is reset (method, path, headers, and body are cleared)
+ * and returned to the pool. Its header storage is kept, unless the headers were acquired by someone else.
+ */
+AWS_HTTP_API
+struct aws_http_message *aws_http_message_pool_acquire_request(struct aws_http_message_pool *pool);
+
+/**
+ * Get a blank response message, recycled from the pool if possible.
+ * See aws_http_message_pool_acquire_request().
+ */
+AWS_HTTP_API
+struct aws_http_message *aws_http_message_pool_acquire_response(struct aws_http_message_pool *pool);
+
+/**
+ * Create an HTTP/1.1 request template from a prototype request.
+ * The prototype's method and headers are validated and serialized now, so they needn't be for each request.
+ * The prototype's path and body stream are ignored. The prototype may be destroyed once this returns.
+ *
+ * The template may be shared by many requests, on any number of connections,
+ * as long as it isn't destroyed during a call to aws_http_connection_make_request().
+ */
+AWS_HTTP_API
+struct aws_http1_request_template *aws_http1_request_template_new(
+    struct aws_allocator *allocator,
+    const struct aws_http_message *prototype);
+
+AWS_HTTP_API
+void aws_http1_request_template_destroy(struct aws_http1_request_template *request_template);
+
 AWS_HTTP_API
 bool aws_http_message_is_request(const struct aws_http_message *message);
 
@@ -546,6 +827,68 @@ struct aws_input_stream *aws_http_message_get_body_stream(const struct aws_http_
 AWS_HTTP_API
 void aws_http_message_set_body_stream(struct aws_http_message *message, struct aws_input_stream *body_stream);
 
+/**
+ * Set the body to data in caller-owned memory.
+ * HTTP/1.1 connections send this memory directly, without copying it into the channel's messages.
+ * The message also creates a body stream over this memory (see aws_http_message_get_body_stream()),
+ * for any code that only understands body streams.
+ *
+ * The memory is NOT copied. It must remain valid and unmodified until the message is destroyed,
+ * which may be after a stream using the message completes, since the connection holds references
+ * to the message while data is in flight. `on_release` (optional) is invoked when the message is destroyed,
+ * at which point the memory may be freed.
+ */
+AWS_HTTP_API
+int aws_http_message_set_body_data(
+    struct aws_http_message *message,
+    struct aws_byte_cursor data,
+    aws_http_message_body_data_release_fn *on_release,
+    void *user_data);
+
+/**
+ * Set the body stream, compressing its data as it's sent.
+ * Adds "gzip" or "deflate" to the "Content-Encoding" header. If the message already has a "Content-Encoding",
+ * the body stream's data is assumed to be encoded that way already, so the new coding is listed after the
+ * existing ones (ex: "br, gzip"), as RFC-9110 8.4 requires.
+ * The compressed length isn't known in advance, so any "Content-Length" header is removed,
+ * and "Transfer-Encoding: chunked" is set. HTTP/1.1 connections send the compressed data as a series of chunks.
+ * Only available if aws-c-http was built with zlib, otherwise AWS_ERROR_UNSUPPORTED_OPERATION is raised.
+ * If this fails, the message is unchanged.
+ *
+ * HTTP/1.1 only: "Transfer-Encoding" is forbidden in HTTP/2 (RFC-7540 8.1.2.2),
+ * so don't send the message on an HTTP/2 connection.
+ *
+ * Note: The message does NOT take ownership of `body_stream`.
+ * The stream must not be destroyed until the message is complete.
+ */
+AWS_HTTP_API
+int aws_http_message_set_compressed_body_stream(
+    struct aws_http_message *message,
+    struct aws_input_stream *body_stream,
+    enum aws_http_body_compression compression);
+
+/**
+ * Set the body to `length` bytes of an open file, starting at `offset`, and set "Content-Length" to `length`.
+ * This is an ordinary body stream that reads the file with pread(2) as the connection needs data.
+ * It is not zero-copy: data is copied from the page cache into the connection's outgoing aws_io_messages,
+ * same as any other body stream. It saves opening the file by path and stdio buffering, nothing more.
+ * The file descriptor's own offset is neither used nor modified, so one descriptor may back many messages at once.
+ * If the file turns out to be shorter than `length`, the stream sending it fails.
+ * Only available on POSIX platforms, otherwise AWS_ERROR_UNSUPPORTED_OPERATION is raised.
+ *
+ * Note: The message does NOT take ownership of `fd`.
+ * It must stay open until the message is destroyed.
+ */
+AWS_HTTP_API
+int aws_http_message_set_body_from_fd(struct aws_http_message *message, int fd, uint64_t offset, uint64_t length);
+
+/**
+ * Get the body data set by aws_http_message_set_body_data().
+ * Returns false if the body was not set that way.
+ */
+AWS_HTTP_API
+bool aws_http_message_get_body_data(const struct aws_http_message *message, struct aws_byte_cursor *out_data);
+
 /**
  * Get the message's aws_http_headers.
  *
@@ -674,6 +1017,46 @@ int aws_http_stream_get_incoming_request_uri(const struct aws_http_stream *strea
 AWS_HTTP_API
 int aws_http_stream_send_response(struct aws_http_stream *stream, struct aws_http_message *response);
 
+/**
+ * Submit a chunk of data to be sent on an HTTP/1.1 stream.
+ * The stream's message must have a "Transfer-Encoding: chunked" header and no body stream.
+ * Client streams must be activated before chunks are written.
+ *
+ * Chunks are sent in the order they are submitted, as soon as the connection is ready for them.
+ * Chunks may be submitted from any thread, and the stream's data will not be sent
+ * any faster than chunks are made available, so memory use stays bounded by what the user has queued.
+ * To end the message body, submit a chunk whose chunk_data_size is 0.
+ *
+ * The on_complete callback is always invoked if this call succeeds.
+ * If this call fails, on_complete will not be invoked.
+ */
+AWS_HTTP_API
+int aws_http1_stream_write_chunk(struct aws_http_stream *http1_stream, const struct aws_http1_chunk_options *options);
+
+/**
+ * Tell the connection that a paused outgoing body has more data available.
+ * Only meaningful for streams created with `pause_outgoing_body_when_empty` set.
+ * When the body stream (or a chunk's data stream) has no data available, the connection stops
+ * reading from it until this is called. This may be called from any thread,
+ * and it is safe to call even if the connection has not noticed the body was empty yet.
+ *
+ * Currently only supported on HTTP/1.x streams.
+ */
+AWS_HTTP_API
+int aws_http_stream_resume_outgoing_body(struct aws_http_stream *stream);
+
+/**
+ * Hand the oldest finished response body buffer back to an HTTP/1.1 stream,
+ * for streams made with `response_body_buffers`. See aws_http_make_request_options.response_body_buffers.
+ * Buffers must be recycled in the order they're filled. The buffer's `len` is reset to 0,
+ * and with manual window management, the window is incremented by as much as it shrank for the buffer's data.
+ * The user must not touch the buffer again until the connection finishes filling it again.
+ * Raises AWS_ERROR_INVALID_STATE if there's no finished buffer to recycle.
+ * This may be called from any thread, even after the stream completes, but calls must not overlap.
+ */
+AWS_HTTP_API
+int aws_http1_stream_recycle_response_body_buffer(struct aws_http_stream *http1_stream);
+
 /**
  * Manually issue a window update.
  * Note that the stream's default behavior is to issue updates which keep the window at its original size.
@@ -682,6 +1065,18 @@ int aws_http_stream_send_response(struct aws_http_stream *stream, struct aws_htt
 AWS_HTTP_API
 void aws_http_stream_update_window(struct aws_http_stream *stream, size_t increment_size);
 
+/**
+ * Get the number of bytes the read window shrank by for the body data passed to the current `on_response_body`.
+ * Only valid from within the callback. Usually that's the length of the data, but data being decompressed
+ * (see aws_http_make_request_options.decompress_response_body) is a different size on the wire.
+ * One piece of wire data may decompress to several callbacks, in which case its whole size is reported with
+ * the first and 0 with the rest. Wire data that decompresses to nothing doesn't shrink the window at all.
+ * With manual window management, pass this to aws_http_stream_update_window() once the data is consumed.
+ * Always 0 for streams with `response_body_buffers`, whose window re-opens as the buffers are recycled.
+ */
+AWS_HTTP_API
+size_t aws_http_stream_get_incoming_body_wire_bytes(const struct aws_http_stream *stream);
+
 /**
  * Gets the Http/2 id associated with a stream.  Even h1 streams have an id (using the same allocation procedure
  * as http/2) for easier tracking purposes. For client streams, this will only be non-zero after a successful call
@@ -165,6 +165,14 @@ struct aws_http_server_connection_options {
      * Optional.
      */
     aws_http_on_server_connection_shutdown_fn *on_shutdown;
+
+    /**
+     * Set to true to add a "Date" header to each outgoing response that doesn't already have one.
+     * Optional.
+     * The value is formatted at most once per second per event-loop, and shared by all its connections.
+     * Currently only applies to HTTP/1.1 connections.
+     */
+    bool add_date_header;
 };
 
 /**
@@ -22,6 +22,7 @@
 
 enum aws_crt_http_statistics_category {
     AWSCRT_STAT_CAT_HTTP1_CHANNEL = AWS_CRT_STATISTICS_CATEGORY_BEGIN_RANGE(AWS_C_HTTP_PACKAGE_ID),
+    AWSCRT_STAT_CAT_HTTP2_CHANNEL,
 };
 
 /**
@@ -36,6 +37,32 @@ struct aws_crt_statistics_http1_channel {
 
     uint32_t current_outgoing_stream_id;
     uint32_t current_incoming_stream_id;
+
+    /* Number of aws_io_messages written to the channel, and the number of HTTP messages (requests or responses)
+     * finished by those writes. Small messages are coalesced, so messages-per-write is
+     * num_outgoing_messages / num_outgoing_writes. */
+    uint64_t num_outgoing_writes;
+    uint64_t num_outgoing_messages;
+};
+
+/**
+ * A statistics struct for HTTP/2 connections. Tracks the flow-control windows we offer the peer,
+ * and the measurements used to size them when windows are managed automatically.
+ */
+struct aws_crt_statistics_http2_channel {
+    aws_crt_statistics_category_t category;
+
+    /* Size that streams' receive windows are kept topped up to */
+    uint32_t stream_window_size;
+
+    /* Size that the connection's receive window is kept topped up to */
+    uint64_t connection_window_size;
+
+    /* Smoothed round-trip time to peer, 0 if not measured yet */
+    uint64_t rtt_ms;
+
+    /* Highest rate at which DATA has been received, in bytes per second */
+    uint64_t max_bandwidth_bytes_per_sec;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -58,6 +85,24 @@ void aws_crt_statistics_http1_channel_cleanup(struct aws_crt_statistics_http1_ch
 AWS_HTTP_API
 void aws_crt_statistics_http1_channel_reset(struct aws_crt_statistics_http1_channel *stats);
 
+/**
+ * Initializes a http/2 channel handler statistics struct
+ */
+AWS_HTTP_API
+int aws_crt_statistics_http2_channel_init(struct aws_crt_statistics_http2_channel *stats);
+
+/**
+ * Cleans up a http/2 channel handler statistics struct
+ */
+AWS_HTTP_API
+void aws_crt_statistics_http2_channel_cleanup(struct aws_crt_statistics_http2_channel *stats);
+
+/**
+ * Resets a http/2 channel handler statistics struct's statistics
+ */
+AWS_HTTP_API
+void aws_crt_statistics_http2_channel_reset(struct aws_crt_statistics_http2_channel *stats);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_HTTP_STATISTICS_H */
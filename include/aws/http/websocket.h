@@ -335,6 +335,15 @@ struct aws_websocket_send_frame_options {
      * MUST be 0 unless an extension is negotiated that defines meanings for non-zero values.
      */
     bool rsv[3];
+
+    /**
+     * If false (default), when `stream_outgoing_payload` writes no data, the websocket
+     * invokes it again on the next tick of the event-loop.
+     *
+     * If true, when `stream_outgoing_payload` writes no data, the websocket stops invoking it
+     * until aws_websocket_resume_outgoing_payload() is called.
+     */
+    bool pause_payload_when_empty;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -391,6 +400,15 @@ int aws_websocket_send_frame(struct aws_websocket *websocket, const struct aws_w
 AWS_HTTP_API
 void aws_websocket_increment_read_window(struct aws_websocket *websocket, size_t size);
 
+/**
+ * Tell the websocket that the current frame's payload has more data available.
+ * Only meaningful for frames sent with `pause_payload_when_empty` set.
+ * It is safe to call this before the websocket has noticed the payload was empty.
+ * This function may be called from any thread.
+ */
+AWS_HTTP_API
+void aws_websocket_resume_outgoing_payload(struct aws_websocket *websocket);
+
 /**
  * Convert the websocket into a mid-channel handler.
  * The websocket will stop being usable via its public API and become just another handler in the channel.
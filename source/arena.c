@@ -0,0 +1,162 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/http/arena.h>
+
+#include <string.h>
+
+/* Every allocation is aligned suitably for any type */
+static const size_t s_arena_alignment = 2 * sizeof(void *);
+
+/* Header of each block acquired from the parent allocator. The block's data follows it. */
+struct arena_block {
+    struct arena_block *next;
+    size_t capacity;
+    size_t used;
+};
+
+struct http_arena {
+    /* base.impl points at this struct */
+    struct aws_allocator base;
+    struct aws_allocator *parent;
+    size_t block_size;
+
+    /* New allocations are carved from the head block. Oversized allocations get a block inserted behind the head. */
+    struct arena_block *blocks;
+
+    /* Most recent allocation from the head block, which can be grown or given back in place */
+    uint8_t *last_allocation;
+};
+
+static size_t s_align_up(size_t size) {
+    return (size + s_arena_alignment - 1) & ~(s_arena_alignment - 1);
+}
+
+static uint8_t *s_block_data(struct arena_block *block) {
+    return (uint8_t *)block + s_align_up(sizeof(struct arena_block));
+}
+
+static void *s_acquire(struct http_arena *arena, size_t size) {
+    if (size > SIZE_MAX - s_arena_alignment - s_align_up(sizeof(struct arena_block))) {
+        aws_raise_error(AWS_ERROR_OOM);
+        return NULL;
+    }
+
+    size_t aligned_size = s_align_up(size);
+
+    /* Common case, carve from head block */
+    struct arena_block *head = arena->blocks;
+    if (head && (head->capacity - head->used >= aligned_size)) {
+        uint8_t *ptr = s_block_data(head) + head->used;
+        head->used += aligned_size;
+        arena->last_allocation = ptr;
+        return ptr;
+    }
+
+    /* Need a new block */
+    bool is_oversized = aligned_size > arena->block_size;
+    size_t capacity = is_oversized ? aligned_size : arena->block_size;
+    struct arena_block *block = aws_mem_acquire(arena->parent, s_align_up(sizeof(struct arena_block)) + capacity);
+    if (!block) {
+        return NULL;
+    }
+
+    block->capacity = capacity;
+    block->used = aligned_size;
+
+    if (is_oversized && head) {
+        /* Keep carving from the current head, it probably has plenty of room left */
+        block->next = head->next;
+        head->next = block;
+    } else {
+        block->next = head;
+        arena->blocks = block;
+        arena->last_allocation = s_block_data(block);
+    }
+
+    return s_block_data(block);
+}
+
+static void *s_arena_acquire(struct aws_allocator *allocator, size_t size) {
+    return s_acquire(allocator->impl, size);
+}
+
+static void s_arena_release(struct aws_allocator *allocator, void *ptr) {
+    struct http_arena *arena = allocator->impl;
+
+    /* Only the most recent allocation can be given back, anything else waits until the arena is destroyed */
+    if (ptr && ptr == arena->last_allocation) {
+        arena->blocks->used = (size_t)(arena->last_allocation - s_block_data(arena->blocks));
+        arena->last_allocation = NULL;
+    }
+}
+
+static void *s_arena_realloc(struct aws_allocator *allocator, void *oldptr, size_t oldsize, size_t newsize) {
+    struct http_arena *arena = allocator->impl;
+
+    if (oldptr && oldptr == arena->last_allocation) {
+        /* Grow or shrink in place, if the head block has room */
+        size_t offset = (size_t)(arena->last_allocation - s_block_data(arena->blocks));
+        if (newsize <= arena->blocks->capacity - offset) {
+            arena->blocks->used = offset + s_align_up(newsize);
+            return oldptr;
+        }
+    } else if (newsize <= oldsize) {
+        return oldptr;
+    }
+
+    void *newptr = s_acquire(arena, newsize);
+    if (newptr && oldptr) {
+        memcpy(newptr, oldptr, oldsize < newsize ? oldsize : newsize);
+    }
+
+    return newptr;
+}
+
+struct aws_allocator *aws_http_arena_allocator_new(struct aws_allocator *parent, size_t block_size) {
+    AWS_PRECONDITION(parent);
+
+    struct http_arena *arena = aws_mem_calloc(parent, 1, sizeof(struct http_arena));
+    if (!arena) {
+        return NULL;
+    }
+
+    arena->parent = parent;
+    arena->block_size = s_align_up(block_size ? block_size : AWS_HTTP_ARENA_DEFAULT_BLOCK_SIZE);
+
+    arena->base.mem_acquire = s_arena_acquire;
+    arena->base.mem_release = s_arena_release;
+    arena->base.mem_realloc = s_arena_realloc;
+    arena->base.impl = arena;
+
+    return &arena->base;
+}
+
+void aws_http_arena_allocator_destroy(struct aws_allocator *allocator) {
+    if (!allocator) {
+        return;
+    }
+
+    struct http_arena *arena = allocator->impl;
+
+    struct arena_block *block = arena->blocks;
+    while (block) {
+        struct arena_block *next = block->next;
+        aws_mem_release(arena->parent, block);
+        block = next;
+    }
+
+    aws_mem_release(arena->parent, arena);
+}
@@ -85,7 +85,10 @@ static struct aws_http_connection *s_connection_new(
     bool is_server,
     bool is_using_tls,
     bool manual_window_management,
-    size_t initial_window_size) {
+    size_t initial_window_size,
+    size_t http1_max_pipelined_requests,
+    size_t http2_max_window_size,
+    enum aws_http2_stream_scheduler http2_stream_scheduler) {
 
     struct aws_channel_slot *connection_slot = NULL;
     struct aws_http_connection *connection = NULL;
@@ -151,16 +154,25 @@ static struct aws_http_connection *s_connection_new(
                 connection =
                     aws_http_connection_new_http1_1_server(alloc, manual_window_management, initial_window_size);
             } else {
-                connection =
-                    aws_http_connection_new_http1_1_client(alloc, manual_window_management, initial_window_size);
+                connection = aws_http_connection_new_http1_1_client(
+                    alloc, manual_window_management, initial_window_size, http1_max_pipelined_requests);
             }
             break;
         case AWS_HTTP_VERSION_2:
-            AWS_FATAL_ASSERT(false && "H2 is not currently supported"); /* lol nice try */
             if (is_server) {
-                connection = aws_http_connection_new_http2_server(alloc, manual_window_management, initial_window_size);
+                connection = aws_http_connection_new_http2_server(
+                    alloc,
+                    manual_window_management,
+                    initial_window_size,
+                    http2_max_window_size,
+                    http2_stream_scheduler);
             } else {
-                connection = aws_http_connection_new_http2_client(alloc, manual_window_management, initial_window_size);
+                connection = aws_http_connection_new_http2_client(
+                    alloc,
+                    manual_window_management,
+                    initial_window_size,
+                    http2_max_window_size,
+                    http2_stream_scheduler);
             }
             break;
         default:
@@ -303,7 +315,10 @@ static void s_server_bootstrap_on_accept_channel_setup(
         true,
         server->is_using_tls,
         server->manual_window_management,
-        server->initial_window_size);
+        server->initial_window_size,
+        0 /*http1_max_pipelined_requests*/,
+        0 /*http2_max_window_size*/,
+        AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN);
     if (!connection) {
         AWS_LOGF_ERROR(
             AWS_LS_HTTP_SERVER,
@@ -629,7 +644,10 @@ static void s_client_bootstrap_on_channel_setup(
         false,
         http_bootstrap->is_using_tls,
         http_bootstrap->manual_window_management,
-        http_bootstrap->initial_window_size);
+        http_bootstrap->initial_window_size,
+        http_bootstrap->http1_max_pipelined_requests,
+        http_bootstrap->http2_max_window_size,
+        http_bootstrap->http2_stream_scheduler);
     if (!http_bootstrap->connection) {
         AWS_LOGF_ERROR(
             AWS_LS_HTTP_CONNECTION,
@@ -761,6 +779,9 @@ int aws_http_client_connect_internal(
     http_bootstrap->is_using_tls = options->tls_options != NULL;
     http_bootstrap->manual_window_management = options->manual_window_management;
     http_bootstrap->initial_window_size = options->initial_window_size;
+    http_bootstrap->http1_max_pipelined_requests = options->http1_max_pipelined_requests;
+    http_bootstrap->http2_max_window_size = options->http2_max_window_size;
+    http_bootstrap->http2_stream_scheduler = options->http2_stream_scheduler;
     http_bootstrap->user_data = options->user_data;
     http_bootstrap->on_setup = options->on_setup;
     http_bootstrap->on_shutdown = options->on_shutdown;
@@ -828,6 +849,24 @@ enum aws_http_version aws_http_connection_get_version(const struct aws_http_conn
     return connection->http_version;
 }
 
+size_t aws_http_connection_get_pending_stream_count(const struct aws_http_connection *connection) {
+    if (connection->http_version != AWS_HTTP_VERSION_2) {
+        return 0;
+    }
+
+    return aws_h2_connection_get_pending_stream_count(
+        AWS_CONTAINER_OF(connection, const struct aws_h2_connection, base));
+}
+
+uint32_t aws_http_connection_get_max_concurrent_streams(const struct aws_http_connection *connection) {
+    if (connection->http_version != AWS_HTTP_VERSION_2) {
+        return 1;
+    }
+
+    return aws_h2_connection_get_max_concurrent_streams(
+        AWS_CONTAINER_OF(connection, const struct aws_h2_connection, base));
+}
+
 int aws_http_connection_configure_server(
     struct aws_http_connection *connection,
     const struct aws_http_server_connection_options *options) {
@@ -853,6 +892,7 @@ int aws_http_connection_configure_server(
     connection->user_data = options->connection_user_data;
     connection->server_data->on_incoming_request = options->on_incoming_request;
     connection->server_data->on_shutdown = options->on_shutdown;
+    connection->server_data->add_date_header = options->add_date_header;
 
     return AWS_OP_SUCCESS;
 }
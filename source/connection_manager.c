@@ -39,14 +39,16 @@ static struct aws_http_connection_manager_system_vtable s_default_system_vtable
     .create_connection = aws_http_client_connect,
     .release_connection = aws_http_connection_release,
     .close_connection = aws_http_connection_close,
-    .is_connection_open = aws_http_connection_is_open};
+    .is_connection_open = aws_http_connection_is_open,
+    .get_version = aws_http_connection_get_version,
+    .get_max_concurrent_streams = aws_http_connection_get_max_concurrent_streams};
 
 const struct aws_http_connection_manager_system_vtable *g_aws_http_connection_manager_default_system_vtable_ptr =
     &s_default_system_vtable;
 
 bool aws_http_connection_manager_system_vtable_is_valid(const struct aws_http_connection_manager_system_vtable *table) {
     return table->create_connection && table->close_connection && table->release_connection &&
-           table->is_connection_open;
+           table->is_connection_open && table->get_version && table->get_max_concurrent_streams;
 }
 
 enum aws_http_connection_manager_state_type { AWS_HCMST_UNINITIALIZED, AWS_HCMST_READY, AWS_HCMST_SHUTTING_DOWN };
@@ -60,6 +62,9 @@ enum aws_http_connection_manager_state_type { AWS_HCMST_UNINITIALIZED, AWS_HCMST
  *    Vended Connection - a successfully established connection that is currently in use by something; must
  *      be released (through the connection manager) by the user before anyone else can use it.  The connection
  *      manager does not explicitly track vended connections.
+ *    Multiplexed Connection - an HTTP/2 connection, which can carry many requests at once.  It is vended to
+ *      many users at once, up to the server's max concurrent streams, and each vending is a Lease.  The
+ *      connection manager tracks multiplexed connections, and their lease counts, for as long as they're open.
  *    Task Set - A set of operations that should be attempted once the lock is released.  A task set includes
  *      completion callbacks (which can't fail) and connection attempts (which can fail either immediately or
  *      asynchronously).
@@ -104,8 +109,10 @@ enum aws_http_connection_manager_state_type { AWS_HCMST_UNINITIALIZED, AWS_HCMST
  *   open_connection_count - the # of connections for whom the release callback (from http) has not been invoked
  *   vended_connection_count - the # of connections held by external users that haven't been released.  Under correct
  *      usage this should be zero before SHUTTING_DOWN is entered, but we attempt to handle incorrect usage gracefully.
+ *   multiplexed_lease_count - same as vended_connection_count, but for leases of multiplexed connections.
  *
- *  While shutting down, as pending connects resolve, we immediately release new incoming (from http) connections
+ *  While shutting down, as pending connects resolve, we immediately release new incoming (from http) connections.
+ *  Multiplexed connections are released as soon as they have no leases.
  *
  *  During the transition from READY to SHUTTING_DOWN, we flush the pending acquisition queue (with failure callbacks)
  *   and since we disallow new acquires, pending_acquisition_count should always be zero after the transition.
@@ -147,6 +154,12 @@ struct aws_http_connection_manager {
      */
     struct aws_array_list connections;
 
+    /*
+     * The set of all multiplexed connections, whether or not they're leased.
+     * Contains struct aws_http_connection_manager_multiplexed_connection.
+     */
+    struct aws_array_list multiplexed_connections;
+
     /*
      * The set of all incomplete connection acquisition requests
      */
@@ -166,9 +179,28 @@ struct aws_http_connection_manager {
 
     /*
      * The number of connections currently being used by external users.
+     * Multiplexed connections are not included.
      */
     size_t vended_connection_count;
 
+    /*
+     * The number of leases of multiplexed connections currently held by external users.
+     */
+    size_t multiplexed_lease_count;
+
+    /*
+     * The number of acquisitions each pending connect is expected to satisfy.
+     * 1, unless the most recent new connection was multiplexed, in which case it's how many leases that
+     * connection allowed.
+     */
+    size_t acquisitions_per_connect;
+
+    /*
+     * Whether any connection has been established yet. Until then, if ALPN might negotiate HTTP/2,
+     * acquisitions_per_connect is just a guess, so only one connection is made at a time.
+     */
+    bool has_established_connection;
+
     /*
      * Always equal to # of connection shutdown callbacks not yet invoked
      * or equivalently:
@@ -222,6 +254,8 @@ struct aws_http_connection_manager_snapshot {
     size_t pending_connects_count;
     size_t vended_connection_count;
     size_t open_connection_count;
+    size_t multiplexed_connection_count;
+    size_t multiplexed_lease_count;
 
     size_t external_ref_count;
 };
@@ -239,6 +273,8 @@ static void s_aws_http_connection_manager_get_snapshot(
     snapshot->pending_connects_count = manager->pending_connects_count;
     snapshot->vended_connection_count = manager->vended_connection_count;
     snapshot->open_connection_count = manager->open_connection_count;
+    snapshot->multiplexed_connection_count = aws_array_list_length(&manager->multiplexed_connections);
+    snapshot->multiplexed_lease_count = manager->multiplexed_lease_count;
 
     snapshot->external_ref_count = manager->external_ref_count;
 }
@@ -250,7 +286,8 @@ static void s_aws_http_connection_manager_log_snapshot(
         AWS_LOGF_DEBUG(
             AWS_LS_HTTP_CONNECTION_MANAGER,
             "id=%p: snapshot - state=%d, held_connection_count=%zu, pending_acquire_count=%zu, "
-            "pending_connect_count=%zu, vended_connection_count=%zu, open_connection_count=%zu, ref_count=%zu",
+            "pending_connect_count=%zu, vended_connection_count=%zu, open_connection_count=%zu, "
+            "multiplexed_connection_count=%zu, multiplexed_lease_count=%zu, ref_count=%zu",
             (void *)manager,
             (int)snapshot->state,
             snapshot->held_connection_count,
@@ -258,6 +295,8 @@ static void s_aws_http_connection_manager_log_snapshot(
             snapshot->pending_connects_count,
             snapshot->vended_connection_count,
             snapshot->open_connection_count,
+            snapshot->multiplexed_connection_count,
+            snapshot->multiplexed_lease_count,
             snapshot->external_ref_count);
     } else {
         AWS_LOGF_DEBUG(
@@ -289,14 +328,131 @@ static bool s_aws_http_connection_manager_should_destroy(struct aws_http_connect
         return false;
     }
 
-    if (manager->vended_connection_count > 0 || manager->pending_connects_count > 0 ||
-        manager->open_connection_count > 0) {
+    if (manager->vended_connection_count > 0 || manager->multiplexed_lease_count > 0 ||
+        manager->pending_connects_count > 0 || manager->open_connection_count > 0) {
         return false;
     }
 
     return true;
 }
 
+/*
+ * An HTTP/2 connection, which is vended to many users at once.
+ */
+struct aws_http_connection_manager_multiplexed_connection {
+    struct aws_http_connection *connection;
+
+    /* The number of external users currently holding this connection */
+    size_t lease_count;
+
+    /* The number of users that may hold this connection at once */
+    size_t max_lease_count;
+
+    /* Once the connection is closed, no new leases are granted. It's released when the last lease is */
+    bool is_closed;
+};
+
+/*
+ * Until an HTTP/2 server states its limit, assume the minimum that RFC-7540 6.5.2 recommends servers allow.
+ */
+static const uint32_t s_default_max_concurrent_streams = 100;
+
+/*
+ * Soft Requirement: The manager's lock must not be held in the callstack.
+ */
+static size_t s_aws_http_connection_manager_get_max_lease_count(
+    struct aws_http_connection_manager *manager,
+    struct aws_http_connection *connection) {
+
+    uint32_t max_concurrent_streams = manager->system_vtable->get_max_concurrent_streams(connection);
+    if (max_concurrent_streams == UINT32_MAX) {
+        max_concurrent_streams = s_default_max_concurrent_streams;
+    }
+
+    return max_concurrent_streams;
+}
+
+/*
+ * Returns the multiplexed connection with room for another lease that has the fewest leases, or NULL if all are full.
+ *
+ * Hard Requirement: Manager's lock must held somewhere in the call stack
+ */
+static struct aws_http_connection_manager_multiplexed_connection *s_aws_http_connection_manager_find_least_loaded(
+    struct aws_http_connection_manager *manager) {
+
+    struct aws_http_connection_manager_multiplexed_connection *least_loaded = NULL;
+
+    size_t multiplexed_count = aws_array_list_length(&manager->multiplexed_connections);
+    for (size_t i = 0; i < multiplexed_count; ++i) {
+        struct aws_http_connection_manager_multiplexed_connection *multiplexed = NULL;
+        aws_array_list_get_at_ptr(&manager->multiplexed_connections, (void **)&multiplexed, i);
+
+        if (multiplexed->is_closed || multiplexed->lease_count >= multiplexed->max_lease_count) {
+            continue;
+        }
+
+        if (least_loaded == NULL || multiplexed->lease_count < least_loaded->lease_count) {
+            least_loaded = multiplexed;
+        }
+    }
+
+    return least_loaded;
+}
+
+/*
+ * Returns the multiplexed connection tracking this connection, or NULL if it's not multiplexed.
+ *
+ * Hard Requirement: Manager's lock must held somewhere in the call stack
+ */
+static struct aws_http_connection_manager_multiplexed_connection *s_aws_http_connection_manager_find_multiplexed(
+    struct aws_http_connection_manager *manager,
+    struct aws_http_connection *connection,
+    size_t *out_index) {
+
+    size_t multiplexed_count = aws_array_list_length(&manager->multiplexed_connections);
+    for (size_t i = 0; i < multiplexed_count; ++i) {
+        struct aws_http_connection_manager_multiplexed_connection *multiplexed = NULL;
+        aws_array_list_get_at_ptr(&manager->multiplexed_connections, (void **)&multiplexed, i);
+
+        if (multiplexed->connection == connection) {
+            *out_index = i;
+            return multiplexed;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Hard Requirement: Manager's lock must held somewhere in the call stack
+ */
+static void s_aws_http_connection_manager_remove_multiplexed(
+    struct aws_http_connection_manager *manager,
+    size_t index) {
+    size_t last_index = aws_array_list_length(&manager->multiplexed_connections) - 1;
+    aws_array_list_swap(&manager->multiplexed_connections, index, last_index);
+    aws_array_list_pop_back(&manager->multiplexed_connections);
+}
+
+/*
+ * The number of pending acquisitions that the pending connects are expected to satisfy.
+ *
+ * Hard Requirement: Manager's lock must held somewhere in the call stack
+ */
+static size_t s_aws_http_connection_manager_get_pending_connect_capacity(struct aws_http_connection_manager *manager) {
+    return manager->pending_connects_count * manager->acquisitions_per_connect;
+}
+
+/*
+ * Whether the manager should make just one connection, to learn if connections are multiplexed,
+ * rather than one per pending acquisition. Only TLS connections may negotiate HTTP/2, via ALPN.
+ *
+ * Hard Requirement: Manager's lock must held somewhere in the call stack
+ */
+static bool s_aws_http_connection_manager_is_probing(struct aws_http_connection_manager *manager) {
+    return !manager->has_established_connection && manager->tls_connection_options != NULL;
+}
+
 /*
  * A struct that functions as both the pending acquisition tracker and the about-to-complete data.
  *
@@ -443,9 +599,31 @@ static void s_aws_http_connection_manager_build_transaction(struct aws_connectio
 
     if (manager->state == AWS_HCMST_READY) {
         /*
-         * Step 1 - If there's free connections, complete acquisition requests
+         * Step 1 - If there's free connections, complete acquisition requests.
+         * Multiplexed connections with room for another lease are preferred, least-loaded first.
          */
-        while (aws_array_list_length(&manager->connections) > 0 && manager->pending_acquisition_count > 0) {
+        while (manager->pending_acquisition_count > 0) {
+            struct aws_http_connection_manager_multiplexed_connection *multiplexed =
+                s_aws_http_connection_manager_find_least_loaded(manager);
+            if (multiplexed != NULL) {
+                ++multiplexed->lease_count;
+                ++manager->multiplexed_lease_count;
+
+                AWS_LOGF_DEBUG(
+                    AWS_LS_HTTP_CONNECTION_MANAGER,
+                    "id=%p: Leasing multiplexed connection (%p), lease count now %zu",
+                    (void *)manager,
+                    (void *)multiplexed->connection,
+                    multiplexed->lease_count);
+                s_aws_http_connection_manager_move_front_acquisition(
+                    manager, multiplexed->connection, AWS_ERROR_SUCCESS, &work->completions);
+                continue;
+            }
+
+            if (aws_array_list_length(&manager->connections) == 0) {
+                break;
+            }
+
             struct aws_http_connection *connection = NULL;
             aws_array_list_back(&manager->connections, &connection);
 
@@ -462,15 +640,26 @@ static void s_aws_http_connection_manager_build_transaction(struct aws_connectio
         }
 
         /*
-         * Step 2 - if there's excess pending acquisitions and we have room to make more, make more
+         * Step 2 - if there's excess pending acquisitions and we have room to make more, make more.
+         * Each new connection is expected to satisfy as many acquisitions as the last one established did.
+         * While probing, make one connection at a time until one is established.
          */
-        if (manager->pending_acquisition_count > manager->pending_connects_count) {
-            AWS_FATAL_ASSERT(
-                manager->max_connections >= manager->vended_connection_count + manager->pending_connects_count);
-
-            work->new_connections = manager->pending_acquisition_count - manager->pending_connects_count;
-            size_t max_new_connections =
-                manager->max_connections - (manager->vended_connection_count + manager->pending_connects_count);
+        size_t pending_connect_capacity = s_aws_http_connection_manager_get_pending_connect_capacity(manager);
+        bool is_probing = s_aws_http_connection_manager_is_probing(manager);
+        bool is_probe_pending = is_probing && manager->pending_connects_count > 0;
+        if (!is_probe_pending && manager->pending_acquisition_count > pending_connect_capacity) {
+            size_t connections_in_use = manager->vended_connection_count +
+                                        aws_array_list_length(&manager->multiplexed_connections) +
+                                        manager->pending_connects_count;
+            AWS_FATAL_ASSERT(manager->max_connections >= connections_in_use);
+
+            size_t excess_acquisitions = manager->pending_acquisition_count - pending_connect_capacity;
+            work->new_connections = (excess_acquisitions + manager->acquisitions_per_connect - 1) /
+                                    manager->acquisitions_per_connect;
+            size_t max_new_connections = manager->max_connections - connections_in_use;
+            if (is_probing && max_new_connections > 1) {
+                max_new_connections = 1;
+            }
 
             if (work->new_connections > max_new_connections) {
                 work->new_connections = max_new_connections;
@@ -484,6 +673,26 @@ static void s_aws_http_connection_manager_build_transaction(struct aws_connectio
          */
         aws_array_list_swap_contents(&manager->connections, &work->connections_to_release);
 
+        /*
+         * Multiplexed connections are released once nobody holds a lease
+         */
+        size_t multiplexed_count = aws_array_list_length(&manager->multiplexed_connections);
+        for (size_t i = multiplexed_count; i > 0; --i) {
+            struct aws_http_connection_manager_multiplexed_connection *multiplexed = NULL;
+            aws_array_list_get_at_ptr(&manager->multiplexed_connections, (void **)&multiplexed, i - 1);
+
+            if (multiplexed->lease_count > 0) {
+                continue;
+            }
+
+            if (aws_array_list_push_back(&work->connections_to_release, &multiplexed->connection)) {
+                /* Try again during a later transaction */
+                continue;
+            }
+
+            s_aws_http_connection_manager_remove_multiplexed(manager, i - 1);
+        }
+
         /*
          * Move all manager pending acquisitions to the work completion list
          */
@@ -520,12 +729,15 @@ static void s_aws_http_connection_manager_destroy(struct aws_http_connection_man
 
     AWS_ASSERT(manager->pending_connects_count == 0);
     AWS_ASSERT(manager->vended_connection_count == 0);
+    AWS_ASSERT(manager->multiplexed_lease_count == 0);
     AWS_ASSERT(manager->pending_acquisition_count == 0);
     AWS_ASSERT(manager->open_connection_count == 0);
     AWS_ASSERT(aws_linked_list_empty(&manager->pending_acquisitions));
     AWS_ASSERT(aws_array_list_length(&manager->connections) == 0);
+    AWS_ASSERT(aws_array_list_length(&manager->multiplexed_connections) == 0);
 
     aws_array_list_clean_up(&manager->connections);
+    aws_array_list_clean_up(&manager->multiplexed_connections);
 
     aws_string_destroy(manager->host);
     if (manager->tls_connection_options) {
@@ -581,6 +793,16 @@ struct aws_http_connection_manager *aws_http_connection_manager_new(
         goto on_error;
     }
 
+    if (aws_array_list_init_dynamic(
+            &manager->multiplexed_connections,
+            allocator,
+            options->max_connections,
+            sizeof(struct aws_http_connection_manager_multiplexed_connection))) {
+        goto on_error;
+    }
+
+    manager->acquisitions_per_connect = 1;
+
     aws_linked_list_init(&manager->pending_acquisitions);
 
     manager->host = aws_string_new_from_array(allocator, options->host.ptr, options->host.len);
@@ -797,12 +1019,14 @@ static void s_aws_http_connection_manager_execute_transaction(struct aws_connect
          * Rather than failing one acquisition for each connection failure, if there's at least one
          * connection failure, we instead fail all excess acquisitions, since there's no pending
          * connect that will necessarily resolve them.
+         * This goes for probes too, since a connection that failed to even start would fail the same way again.
          *
          * Try to correspond an error with the acquisition failure, but as a fallback just use the
          * representative error.
          */
         size_t i = 0;
-        while (manager->pending_acquisition_count > manager->pending_connects_count) {
+        while (manager->pending_acquisition_count >
+               s_aws_http_connection_manager_get_pending_connect_capacity(manager)) {
             int error = representative_error;
             if (i < aws_array_list_length(&errors)) {
                 aws_array_list_get_at(&errors, &error, i);
@@ -892,12 +1116,47 @@ int aws_http_connection_manager_release_connection(
 
     int result = AWS_OP_ERR;
     bool should_release_connection = !manager->system_vtable->is_connection_open(connection);
+    size_t max_lease_count = s_aws_http_connection_manager_get_max_lease_count(manager, connection);
 
     AWS_LOGF_DEBUG(
         AWS_LS_HTTP_CONNECTION_MANAGER, "id=%p: Releasing connection (id=%p)", (void *)manager, (void *)connection);
 
     aws_mutex_lock(&manager->lock);
 
+    size_t multiplexed_index = 0;
+    struct aws_http_connection_manager_multiplexed_connection *multiplexed =
+        s_aws_http_connection_manager_find_multiplexed(manager, connection, &multiplexed_index);
+    if (multiplexed != NULL) {
+        if (multiplexed->lease_count == 0) {
+            AWS_LOGF_FATAL(
+                AWS_LS_HTTP_CONNECTION_MANAGER,
+                "id=%p: Multiplexed connection (id=%p) released when its lease count is zero",
+                (void *)manager,
+                (void *)connection);
+            aws_raise_error(AWS_ERROR_HTTP_CONNECTION_MANAGER_VENDED_CONNECTION_UNDERFLOW);
+            goto release;
+        }
+
+        result = AWS_OP_SUCCESS;
+
+        --multiplexed->lease_count;
+        --manager->multiplexed_lease_count;
+
+        /* Peer may have changed its max concurrent streams since the connection was added */
+        multiplexed->max_lease_count = max_lease_count;
+        if (should_release_connection) {
+            multiplexed->is_closed = true;
+        }
+
+        if (multiplexed->lease_count == 0 && (multiplexed->is_closed || manager->state != AWS_HCMST_READY)) {
+            s_aws_http_connection_manager_remove_multiplexed(manager, multiplexed_index);
+            work.connection_to_release = connection;
+        }
+
+        s_aws_http_connection_manager_build_transaction(&work);
+        goto release;
+    }
+
     /* We're probably hosed in this case, but let's not underflow */
     if (manager->vended_connection_count == 0) {
         AWS_LOGF_FATAL(
@@ -956,6 +1215,13 @@ static void s_aws_http_connection_manager_on_connection_setup(
             aws_error_str(error_code));
     }
 
+    bool is_multiplexed = false;
+    size_t max_lease_count = 0;
+    if (connection != NULL && manager->system_vtable->get_version(connection) == AWS_HTTP_VERSION_2) {
+        is_multiplexed = true;
+        max_lease_count = s_aws_http_connection_manager_get_max_lease_count(manager, connection);
+    }
+
     aws_mutex_lock(&manager->lock);
 
     bool is_shutting_down = manager->state == AWS_HCMST_SHUTTING_DOWN;
@@ -964,9 +1230,23 @@ static void s_aws_http_connection_manager_on_connection_setup(
     --manager->pending_connects_count;
 
     if (connection != NULL) {
-        if (!is_shutting_down) {
+        manager->has_established_connection = true;
+        if (!is_shutting_down && is_multiplexed) {
+            struct aws_http_connection_manager_multiplexed_connection multiplexed = {
+                .connection = connection,
+                .max_lease_count = max_lease_count,
+            };
+
+            /* We reserved enough room for max_connections, this should never fail */
+            AWS_FATAL_ASSERT(
+                aws_array_list_push_back(&manager->multiplexed_connections, &multiplexed) == AWS_OP_SUCCESS);
+
+            /* Never 0, even if the peer currently allows no streams, or pending connects would be worthless */
+            manager->acquisitions_per_connect = max_lease_count > 0 ? max_lease_count : 1;
+        } else if (!is_shutting_down) {
             /* We reserved enough room for max_connections, this should never fail */
             AWS_FATAL_ASSERT(aws_array_list_push_back(&manager->connections, &connection) == AWS_OP_SUCCESS);
+            manager->acquisitions_per_connect = 1;
         } else {
             /*
              * We won't add the connection to the pool; just release it immediately
@@ -981,13 +1261,26 @@ static void s_aws_http_connection_manager_on_connection_setup(
         ++manager->open_connection_count;
     } else {
         /*
-         * To be safe, if we have an excess of pending acquisitions (beyond the number of pending
-         * connects), we need to fail all of the excess.  Technically, we might be able to try and
-         * make a new connection, if there's room, but that could lead to some bad failure loops.
+         * To be safe, if we have an excess of pending acquisitions (beyond what the pending
+         * connects are expected to satisfy), we need to fail all of the excess.  Technically, we might be able
+         * to try and make a new connection, if there's room, but that could lead to some bad failure loops.
+         *
+         * A failed probe is the exception. It was only expected to satisfy the front acquisitions, so only those
+         * fail, and the transaction below makes another probe for the rest. Every probe that fails fails at least
+         * one acquisition, so this can't loop forever.
          *
          * This won't happen during shutdown since there are no pending acquisitions at that point.
          */
-        while (manager->pending_acquisition_count > manager->pending_connects_count) {
+        size_t max_failures = SIZE_MAX;
+        if (s_aws_http_connection_manager_is_probing(manager)) {
+            max_failures = manager->acquisitions_per_connect;
+        }
+
+        size_t failure_count = 0;
+        while (failure_count < max_failures &&
+               manager->pending_acquisition_count >
+                   s_aws_http_connection_manager_get_pending_connect_capacity(manager)) {
+            ++failure_count;
             AWS_LOGF_DEBUG(
                 AWS_LS_HTTP_CONNECTION_MANAGER,
                 "id=%p: Failing excess connection acquisition with error code %d",
@@ -1057,6 +1350,21 @@ static void s_aws_http_connection_manager_on_connection_shutdown(
         }
     }
 
+    /*
+     * A multiplexed connection is released now if nobody holds a lease, otherwise when the last lease is released
+     */
+    size_t multiplexed_index = 0;
+    struct aws_http_connection_manager_multiplexed_connection *multiplexed =
+        s_aws_http_connection_manager_find_multiplexed(manager, connection, &multiplexed_index);
+    if (multiplexed != NULL) {
+        if (multiplexed->lease_count == 0) {
+            s_aws_http_connection_manager_remove_multiplexed(manager, multiplexed_index);
+            work.connection_to_release = connection;
+        } else {
+            multiplexed->is_closed = true;
+        }
+    }
+
     s_aws_http_connection_manager_build_transaction(&work);
 
     aws_mutex_unlock(&manager->lock);
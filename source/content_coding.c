@@ -0,0 +1,499 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/http/private/content_coding.h>
+
+#include <aws/http/private/strutil.h>
+#include <aws/io/logging.h>
+#include <aws/io/stream.h>
+
+#ifdef AWS_HTTP_HAS_ZLIB
+#    include <zlib.h>
+#endif
+
+enum aws_http_content_coding aws_http_str_to_content_coding(struct aws_byte_cursor value) {
+    value = aws_strutil_trim_http_whitespace(value);
+
+    if (value.len == 0 || aws_byte_cursor_eq_c_str_ignore_case(&value, "identity")) {
+        return AWS_HTTP_CONTENT_CODING_IDENTITY;
+    }
+
+    /* RFC-7230 4.2.3: "x-gzip" should be treated as "gzip" */
+    if (aws_byte_cursor_eq_c_str_ignore_case(&value, "gzip") ||
+        aws_byte_cursor_eq_c_str_ignore_case(&value, "x-gzip")) {
+        return AWS_HTTP_CONTENT_CODING_GZIP;
+    }
+
+    if (aws_byte_cursor_eq_c_str_ignore_case(&value, "deflate")) {
+        return AWS_HTTP_CONTENT_CODING_DEFLATE;
+    }
+
+    return AWS_HTTP_CONTENT_CODING_UNSUPPORTED;
+}
+
+#ifdef AWS_HTTP_HAS_ZLIB
+
+struct aws_http_decompressor {
+    struct aws_allocator *allocator;
+    enum aws_http_content_coding coding;
+    z_stream zstream;
+    bool is_zstream_initialized;
+
+    /* Whether zlib reached the end of the compressed stream */
+    bool is_stream_end;
+
+    /* Some servers send "deflate" as raw DEFLATE data, without the zlib wrapper that RFC-7230 4.2.2 calls for.
+     * The first 2 bytes are held here until we can tell whether the wrapper is present. */
+    uint8_t deflate_prefix[2];
+    size_t deflate_prefix_len;
+
+    uint8_t output[AWS_HTTP_DECOMPRESSOR_OUTPUT_CHUNK_SIZE];
+};
+
+/* Route zlib's allocations through the aws allocator */
+static voidpf s_zlib_alloc(voidpf opaque, uInt items, uInt size) {
+    return aws_mem_calloc(opaque, items, size);
+}
+
+static void s_zlib_free(voidpf opaque, voidpf address) {
+    aws_mem_release(opaque, address);
+}
+
+static int s_init_zstream(struct aws_http_decompressor *decompressor, int window_bits) {
+    decompressor->zstream.zalloc = s_zlib_alloc;
+    decompressor->zstream.zfree = s_zlib_free;
+    decompressor->zstream.opaque = decompressor->allocator;
+
+    if (inflateInit2(&decompressor->zstream, window_bits) != Z_OK) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_DECODER,
+            "id=%p: Failed to initialize zlib: %s",
+            (void *)decompressor,
+            decompressor->zstream.msg ? decompressor->zstream.msg : "unknown error");
+        return aws_raise_error(AWS_ERROR_HTTP_COMPRESSION);
+    }
+
+    decompressor->is_zstream_initialized = true;
+    return AWS_OP_SUCCESS;
+}
+
+struct aws_http_decompressor *aws_http_decompressor_new(
+    struct aws_allocator *allocator,
+    enum aws_http_content_coding coding) {
+
+    AWS_PRECONDITION(allocator);
+
+    if (coding != AWS_HTTP_CONTENT_CODING_GZIP && coding != AWS_HTTP_CONTENT_CODING_DEFLATE) {
+        AWS_LOGF_ERROR(AWS_LS_HTTP_DECODER, "Cannot create decompressor for unsupported coding %d.", (int)coding);
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_http_decompressor *decompressor = aws_mem_calloc(allocator, 1, sizeof(struct aws_http_decompressor));
+    if (!decompressor) {
+        return NULL;
+    }
+
+    decompressor->allocator = allocator;
+    decompressor->coding = coding;
+
+    /* DEFLATE waits to initialize zlib until it knows whether the zlib wrapper is present.
+     * Adding 16 to windowBits tells zlib to expect the gzip wrapper */
+    if (coding == AWS_HTTP_CONTENT_CODING_GZIP) {
+        if (s_init_zstream(decompressor, MAX_WBITS + 16)) {
+            aws_mem_release(allocator, decompressor);
+            return NULL;
+        }
+    }
+
+    return decompressor;
+}
+
+void aws_http_decompressor_destroy(struct aws_http_decompressor *decompressor) {
+    if (!decompressor) {
+        return;
+    }
+
+    if (decompressor->is_zstream_initialized) {
+        inflateEnd(&decompressor->zstream);
+    }
+    aws_mem_release(decompressor->allocator, decompressor);
+}
+
+static int s_inflate(
+    struct aws_http_decompressor *decompressor,
+    struct aws_byte_cursor input,
+    aws_http_decompressor_on_data_fn *on_data,
+    void *user_data) {
+
+    z_stream *zstream = &decompressor->zstream;
+
+    /* Keep going while there's input, or while the last pass filled the output buffer (zlib may have more to give) */
+    bool output_was_full = false;
+    while (input.len > 0 || output_was_full) {
+        if (decompressor->is_stream_end) {
+            if (input.len == 0) {
+                break;
+            }
+
+            /* RFC-1952: a gzip file may consist of several members, one after the other */
+            if (decompressor->coding != AWS_HTTP_CONTENT_CODING_GZIP) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_HTTP_DECODER,
+                    "id=%p: Received %zu bytes after end of compressed data.",
+                    (void *)decompressor,
+                    input.len);
+                return aws_raise_error(AWS_ERROR_HTTP_COMPRESSION);
+            }
+
+            inflateReset(zstream);
+            decompressor->is_stream_end = false;
+        }
+
+        zstream->next_in = (Bytef *)input.ptr;
+        zstream->avail_in = (uInt)aws_min_size(input.len, UINT32_MAX);
+        zstream->next_out = decompressor->output;
+        zstream->avail_out = sizeof(decompressor->output);
+
+        uInt avail_in_before = zstream->avail_in;
+        int zerr = inflate(zstream, Z_NO_FLUSH);
+
+        /* Z_BUF_ERROR just means no progress was possible, which is expected when zlib had no more output to give */
+        if (zerr == Z_BUF_ERROR && zstream->avail_in == 0) {
+            zerr = Z_OK;
+        }
+
+        if (zerr != Z_OK && zerr != Z_STREAM_END) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_DECODER,
+                "id=%p: Failed to decompress data, zlib error %d (%s).",
+                (void *)decompressor,
+                zerr,
+                zstream->msg ? zstream->msg : "no message");
+            return aws_raise_error(AWS_ERROR_HTTP_COMPRESSION);
+        }
+
+        aws_byte_cursor_advance(&input, avail_in_before - zstream->avail_in);
+        decompressor->is_stream_end = (zerr == Z_STREAM_END);
+        output_was_full = (zstream->avail_out == 0);
+
+        size_t output_len = sizeof(decompressor->output) - zstream->avail_out;
+        if (output_len > 0) {
+            if (on_data(aws_byte_cursor_from_array(decompressor->output, output_len), user_data)) {
+                return AWS_OP_ERR;
+            }
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_http_decompressor_process(
+    struct aws_http_decompressor *decompressor,
+    struct aws_byte_cursor input,
+    aws_http_decompressor_on_data_fn *on_data,
+    void *user_data) {
+
+    AWS_PRECONDITION(decompressor);
+    AWS_PRECONDITION(on_data);
+
+    /* Gather the first 2 bytes of DEFLATE data, then check whether they're a valid zlib header (RFC-1950 2.2) */
+    while (!decompressor->is_zstream_initialized && input.len > 0) {
+        decompressor->deflate_prefix[decompressor->deflate_prefix_len++] = *input.ptr;
+        aws_byte_cursor_advance(&input, 1);
+
+        if (decompressor->deflate_prefix_len == sizeof(decompressor->deflate_prefix)) {
+            const uint8_t cmf = decompressor->deflate_prefix[0];
+            const uint8_t flg = decompressor->deflate_prefix[1];
+            bool has_zlib_wrapper = ((cmf & 0x0F) == Z_DEFLATED) && ((((unsigned)cmf << 8) | flg) % 31 == 0);
+            if (!has_zlib_wrapper) {
+                AWS_LOGF_TRACE(
+                    AWS_LS_HTTP_DECODER,
+                    "id=%p: DEFLATE data lacks zlib wrapper, decoding as raw DEFLATE.",
+                    (void *)decompressor);
+            }
+
+            /* Negative windowBits tells zlib to expect raw DEFLATE data */
+            if (s_init_zstream(decompressor, has_zlib_wrapper ? MAX_WBITS : -MAX_WBITS)) {
+                return AWS_OP_ERR;
+            }
+
+            struct aws_byte_cursor prefix =
+                aws_byte_cursor_from_array(decompressor->deflate_prefix, sizeof(decompressor->deflate_prefix));
+            if (s_inflate(decompressor, prefix, on_data, user_data)) {
+                return AWS_OP_ERR;
+            }
+        }
+    }
+
+    return s_inflate(decompressor, input, on_data, user_data);
+}
+
+int aws_http_decompressor_finish(struct aws_http_decompressor *decompressor) {
+    AWS_PRECONDITION(decompressor);
+
+    if (!decompressor->is_stream_end) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_DECODER, "id=%p: Compressed data ended before end of compressed stream.", (void *)decompressor);
+        return aws_raise_error(AWS_ERROR_HTTP_COMPRESSION);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+struct compressing_stream {
+    struct aws_input_stream base;
+    struct aws_input_stream *source;
+    z_stream zstream;
+
+    /* Data read from source, which zlib hasn't consumed yet */
+    struct aws_byte_buf input_buf;
+
+    /* Whether source has reached end-of-stream */
+    bool is_source_done;
+
+    /* Whether zlib has input that hasn't come out as compressed data yet */
+    bool has_unflushed_input;
+
+    /* Whether zlib finished writing the compressed stream */
+    bool is_stream_end;
+};
+
+static int s_compressing_stream_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct compressing_stream *impl = stream->impl;
+    z_stream *zstream = &impl->zstream;
+
+    while (!impl->is_stream_end && dest->len < dest->capacity) {
+        int flush = Z_NO_FLUSH;
+
+        if (zstream->avail_in == 0 && !impl->is_source_done) {
+            impl->input_buf.len = 0;
+            if (aws_input_stream_read(impl->source, &impl->input_buf)) {
+                return AWS_OP_ERR;
+            }
+
+            struct aws_stream_status status;
+            if (aws_input_stream_get_status(impl->source, &status)) {
+                return AWS_OP_ERR;
+            }
+            impl->is_source_done = status.is_end_of_stream;
+
+            zstream->next_in = impl->input_buf.buffer;
+            zstream->avail_in = (uInt)impl->input_buf.len;
+
+            if (impl->input_buf.len == 0 && !impl->is_source_done) {
+                /* Source has nothing for us right now. Rather than let its data sit in zlib indefinitely,
+                 * flush what we have so far, at a slight cost to compression ratio. */
+                if (!impl->has_unflushed_input) {
+                    break;
+                }
+                flush = Z_SYNC_FLUSH;
+            }
+        }
+
+        if (impl->is_source_done) {
+            flush = Z_FINISH;
+        }
+
+        zstream->next_out = dest->buffer + dest->len;
+        zstream->avail_out = (uInt)aws_min_size(dest->capacity - dest->len, UINT32_MAX);
+        uInt avail_out_before = zstream->avail_out;
+
+        int zerr = deflate(zstream, flush);
+        if (zerr != Z_OK && zerr != Z_STREAM_END && zerr != Z_BUF_ERROR) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_ENCODER,
+                "id=%p: Failed to compress data, zlib error %d (%s).",
+                (void *)stream,
+                zerr,
+                zstream->msg ? zstream->msg : "no message");
+            return aws_raise_error(AWS_ERROR_HTTP_COMPRESSION);
+        }
+
+        dest->len += avail_out_before - zstream->avail_out;
+
+        if (zerr == Z_STREAM_END) {
+            impl->is_stream_end = true;
+        } else if (flush == Z_SYNC_FLUSH && zstream->avail_out > 0) {
+            /* Everything's been flushed out */
+            impl->has_unflushed_input = false;
+            break;
+        } else if (flush == Z_NO_FLUSH) {
+            impl->has_unflushed_input = true;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_compressing_stream_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
+    struct compressing_stream *impl = stream->impl;
+
+    if (aws_input_stream_get_status(impl->source, status)) {
+        return AWS_OP_ERR;
+    }
+
+    status->is_end_of_stream = impl->is_stream_end;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_compressing_stream_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    (void)stream;
+    (void)out_length;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+static int s_compressing_stream_seek(
+    struct aws_input_stream *stream,
+    aws_off_t offset,
+    enum aws_stream_seek_basis basis) {
+
+    struct compressing_stream *impl = stream->impl;
+
+    /* Compressed data can only be regenerated from the start */
+    if (offset != 0 || basis != AWS_SSB_BEGIN) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    if (aws_input_stream_seek(impl->source, 0, AWS_SSB_BEGIN)) {
+        return AWS_OP_ERR;
+    }
+
+    deflateReset(&impl->zstream);
+    impl->zstream.avail_in = 0;
+    impl->is_source_done = false;
+    impl->has_unflushed_input = false;
+    impl->is_stream_end = false;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_compressing_stream_destroy(struct aws_input_stream *stream) {
+    struct compressing_stream *impl = stream->impl;
+
+    deflateEnd(&impl->zstream);
+    aws_byte_buf_clean_up(&impl->input_buf);
+    aws_mem_release(stream->allocator, impl);
+}
+
+static struct aws_input_stream_vtable s_compressing_stream_vtable = {
+    .seek = s_compressing_stream_seek,
+    .read = s_compressing_stream_read,
+    .get_status = s_compressing_stream_get_status,
+    .get_length = s_compressing_stream_get_length,
+    .destroy = s_compressing_stream_destroy,
+};
+
+struct aws_input_stream *aws_http_compressing_stream_new(
+    struct aws_allocator *allocator,
+    struct aws_input_stream *source,
+    enum aws_http_content_coding coding) {
+
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(source);
+
+    if (coding != AWS_HTTP_CONTENT_CODING_GZIP && coding != AWS_HTTP_CONTENT_CODING_DEFLATE) {
+        AWS_LOGF_ERROR(AWS_LS_HTTP_ENCODER, "Cannot create compressor for unsupported coding %d.", (int)coding);
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct compressing_stream *impl = aws_mem_calloc(allocator, 1, sizeof(struct compressing_stream));
+    if (!impl) {
+        return NULL;
+    }
+
+    impl->base.allocator = allocator;
+    impl->base.impl = impl;
+    impl->base.vtable = &s_compressing_stream_vtable;
+    impl->source = source;
+
+    if (aws_byte_buf_init(&impl->input_buf, allocator, AWS_HTTP_COMPRESSOR_INPUT_CHUNK_SIZE)) {
+        goto error;
+    }
+
+    impl->zstream.zalloc = s_zlib_alloc;
+    impl->zstream.zfree = s_zlib_free;
+    impl->zstream.opaque = allocator;
+
+    /* Adding 16 to windowBits tells zlib to write the gzip wrapper, rather than the zlib wrapper */
+    int window_bits = (coding == AWS_HTTP_CONTENT_CODING_GZIP) ? (MAX_WBITS + 16) : MAX_WBITS;
+    if (deflateInit2(&impl->zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_ENCODER,
+            "id=%p: Failed to initialize zlib: %s",
+            (void *)&impl->base,
+            impl->zstream.msg ? impl->zstream.msg : "unknown error");
+        aws_raise_error(AWS_ERROR_HTTP_COMPRESSION);
+        goto error;
+    }
+
+    return &impl->base;
+
+error:
+    aws_byte_buf_clean_up(&impl->input_buf);
+    aws_mem_release(allocator, impl);
+    return NULL;
+}
+
+#else /* !AWS_HTTP_HAS_ZLIB */
+
+struct aws_http_decompressor *aws_http_decompressor_new(
+    struct aws_allocator *allocator,
+    enum aws_http_content_coding coding) {
+
+    (void)allocator;
+    (void)coding;
+    AWS_LOGF_ERROR(AWS_LS_HTTP_DECODER, "Cannot decompress data, aws-c-http was built without zlib.");
+    aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    return NULL;
+}
+
+void aws_http_decompressor_destroy(struct aws_http_decompressor *decompressor) {
+    AWS_ASSERT(!decompressor);
+    (void)decompressor;
+}
+
+int aws_http_decompressor_process(
+    struct aws_http_decompressor *decompressor,
+    struct aws_byte_cursor input,
+    aws_http_decompressor_on_data_fn *on_data,
+    void *user_data) {
+
+    (void)decompressor;
+    (void)input;
+    (void)on_data;
+    (void)user_data;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_http_decompressor_finish(struct aws_http_decompressor *decompressor) {
+    (void)decompressor;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+struct aws_input_stream *aws_http_compressing_stream_new(
+    struct aws_allocator *allocator,
+    struct aws_input_stream *source,
+    enum aws_http_content_coding coding) {
+
+    (void)allocator;
+    (void)source;
+    (void)coding;
+    AWS_LOGF_ERROR(AWS_LS_HTTP_ENCODER, "Cannot compress data, aws-c-http was built without zlib.");
+    aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    return NULL;
+}
+
+#endif /* AWS_HTTP_HAS_ZLIB */
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/http/private/file_body.h>
+
+#include <aws/io/logging.h>
+#include <aws/io/stream.h>
+
+#ifndef _WIN32
+
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <inttypes.h>
+#    include <unistd.h>
+
+struct file_body_stream {
+    struct aws_input_stream base;
+    int fd;
+    uint64_t offset;
+    uint64_t length;
+
+    /* Bytes read so far, relative to `offset` */
+    uint64_t position;
+
+    /* Whether the file ended before `length` bytes were read */
+    bool is_truncated;
+};
+
+static int s_file_body_stream_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct file_body_stream *impl = stream->impl;
+
+    uint64_t remaining = impl->length - impl->position;
+    size_t reading = (size_t)aws_min_u64(remaining, dest->capacity - dest->len);
+    if (reading == 0 || impl->is_truncated) {
+        return AWS_OP_SUCCESS;
+    }
+
+    ssize_t num_read;
+    do {
+        num_read = pread(impl->fd, dest->buffer + dest->len, reading, (off_t)(impl->offset + impl->position));
+    } while (num_read < 0 && errno == EINTR);
+
+    if (num_read < 0) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_ENCODER,
+            "id=%p: Failed to read body from file descriptor %d, errno %d.",
+            (void *)stream,
+            impl->fd,
+            errno);
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+    if (num_read == 0) {
+        /* End the stream. Whoever's sending it will notice it's shorter than the Content-Length */
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_ENCODER,
+            "id=%p: File ended %" PRIu64 " bytes short of expected body length.",
+            (void *)stream,
+            remaining);
+        impl->is_truncated = true;
+        return AWS_OP_SUCCESS;
+    }
+
+    dest->len += (size_t)num_read;
+    impl->position += (uint64_t)num_read;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_file_body_stream_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
+    struct file_body_stream *impl = stream->impl;
+
+    status->is_end_of_stream = impl->position == impl->length || impl->is_truncated;
+    status->is_valid = true;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_file_body_stream_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    struct file_body_stream *impl = stream->impl;
+
+    *out_length = (int64_t)impl->length;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_file_body_stream_seek(
+    struct aws_input_stream *stream,
+    aws_off_t offset,
+    enum aws_stream_seek_basis basis) {
+
+    struct file_body_stream *impl = stream->impl;
+
+    int64_t position = offset;
+    if (basis == AWS_SSB_END) {
+        position += (int64_t)impl->length;
+    }
+
+    if (position < 0 || (uint64_t)position > impl->length) {
+        return aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
+    }
+
+    impl->position = (uint64_t)position;
+    impl->is_truncated = false;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_file_body_stream_destroy(struct aws_input_stream *stream) {
+    struct file_body_stream *impl = stream->impl;
+    aws_mem_release(stream->allocator, impl);
+}
+
+static struct aws_input_stream_vtable s_file_body_stream_vtable = {
+    .seek = s_file_body_stream_seek,
+    .read = s_file_body_stream_read,
+    .get_status = s_file_body_stream_get_status,
+    .get_length = s_file_body_stream_get_length,
+    .destroy = s_file_body_stream_destroy,
+};
+
+struct aws_input_stream *aws_http_file_body_stream_new(
+    struct aws_allocator *allocator,
+    int fd,
+    uint64_t offset,
+    uint64_t length) {
+
+    AWS_PRECONDITION(allocator);
+
+    /* Every byte must be addressable with an off_t */
+    uint64_t end = 0;
+    if (fd < 0 || aws_add_u64_checked(offset, length, &end) || end > INT64_MAX) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct file_body_stream *impl = aws_mem_calloc(allocator, 1, sizeof(struct file_body_stream));
+    if (!impl) {
+        return NULL;
+    }
+
+    impl->base.allocator = allocator;
+    impl->base.impl = impl;
+    impl->base.vtable = &s_file_body_stream_vtable;
+    impl->fd = fd;
+    impl->offset = offset;
+    impl->length = length;
+
+#    if defined(POSIX_FADV_SEQUENTIAL)
+    /* Only a hint, so that the kernel reads ahead aggressively. Failure is harmless */
+    (void)posix_fadvise(fd, (off_t)offset, (off_t)length, POSIX_FADV_SEQUENTIAL);
+#    endif
+
+    return &impl->base;
+}
+
+#else /* _WIN32 */
+
+struct aws_input_stream *aws_http_file_body_stream_new(
+    struct aws_allocator *allocator,
+    int fd,
+    uint64_t offset,
+    uint64_t length) {
+
+    (void)allocator;
+    (void)fd;
+    (void)offset;
+    (void)length;
+    AWS_LOGF_ERROR(AWS_LS_HTTP_ENCODER, "Sending a body from a file descriptor is not supported on this platform.");
+    aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    return NULL;
+}
+
+#endif /* _WIN32 */
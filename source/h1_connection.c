@@ -13,6 +13,7 @@
  * permissions and limitations under the License.
  */
 #include <aws/common/clock.h>
+#include <aws/common/date_time.h>
 #include <aws/common/math.h>
 #include <aws/common/mutex.h>
 #include <aws/common/string.h>
@@ -23,14 +24,22 @@
 #include <aws/http/private/request_response_impl.h>
 #include <aws/http/statistics.h>
 #include <aws/http/status_code.h>
+#include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
 
+#include <inttypes.h>
+#include <string.h>
+
 #if _MSC_VER
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
 #endif
 
 enum {
     DECODER_INITIAL_SCRATCH_SIZE = 256,
+
+    /* Largest slice of caller-owned body data to put in a single aws_io_message.
+     * Big enough that the socket does the work, small enough that a TLS handler isn't flooded. */
+    MAX_LENT_BODY_SLICE_SIZE = 1024 * 1024,
 };
 
 static int s_handler_process_read_message(
@@ -79,6 +88,8 @@ static int s_decoder_on_body(const struct aws_byte_cursor *data, bool finished,
 static int s_decoder_on_done(void *user_data);
 static void s_reset_statistics(struct aws_channel_handler *handler);
 static void s_gather_statistics(struct aws_channel_handler *handler, struct aws_array_list *stats);
+static void s_start_expect_continue_timer(struct h1_connection *connection, struct aws_h1_stream *stream);
+static void s_end_expect_continue_wait(struct h1_connection *connection, bool send_body);
 
 static struct aws_http_connection_vtable s_h1_connection_vtable = {
     .channel_handler_vtable =
@@ -115,12 +126,19 @@ struct h1_connection {
 
     size_t initial_window_size;
 
+    /* Client-only. Max number of requests that may be in flight (sent, but awaiting a complete response).
+     * 0 means no limit. */
+    size_t max_pipelined_requests;
+
     /* Single task used repeatedly for sending data from streams. */
     struct aws_channel_task outgoing_stream_task;
 
     /* Single task used for issuing window updates from off-thread */
     struct aws_channel_task window_update_task;
 
+    /* Client-only. Single task used to stop waiting for "100 Continue" once a request's timeout expires */
+    struct aws_channel_task expect_continue_timeout_task;
+
     /* Only the event-loop thread may touch this data */
     struct {
         /* List of streams being worked on. */
@@ -129,7 +147,8 @@ struct h1_connection {
         /* Points to the stream whose data is currently being sent.
          * This stream is ALWAYS in the `stream_list`.
          * HTTP pipelining is supported, so once the stream is completely written
-         * we'll start working on the next stream in the list */
+         * we'll start working on the next stream in the list,
+         * unless `max_pipelined_requests` are already awaiting their responses. */
         struct aws_h1_stream *outgoing_stream;
 
         /* Points to the stream being decoded.
@@ -164,6 +183,10 @@ struct h1_connection {
         uint64_t outgoing_stream_timestamp_ns;
         uint64_t incoming_stream_timestamp_ns;
 
+        /* If non-zero, the outgoing stream is holding back its body until "100 Continue" or this time */
+        uint64_t expect_continue_deadline_ns;
+        bool is_expect_continue_timeout_task_scheduled;
+
     } thread_data;
 
     /* Any thread may touch this data, but the lock must be held */
@@ -301,7 +324,13 @@ static int s_stream_send_response(struct aws_http_stream *stream, struct aws_htt
      * The encoder_message object will be moved into the stream later while holding the lock */
     struct aws_h1_encoder_message encoder_message;
     bool body_headers_ignored = h1_stream->base.request_method == AWS_HTTP_METHOD_HEAD;
-    err = aws_h1_encoder_message_init_from_response(&encoder_message, stream->alloc, response, body_headers_ignored);
+    err = aws_h1_encoder_message_init_from_response(
+        &encoder_message,
+        stream->alloc,
+        response,
+        body_headers_ignored,
+        connection->base.server_data->add_date_header,
+        &h1_stream->pending_chunk_list);
     if (err) {
         send_err = aws_last_error();
         goto response_error;
@@ -466,6 +495,148 @@ int aws_h1_stream_activate(struct aws_http_stream *stream) {
     return AWS_OP_SUCCESS;
 }
 
+int aws_h1_stream_resume_outgoing_body(struct aws_http_stream *stream) {
+    AWS_PRECONDITION(stream);
+
+    struct aws_h1_stream *h1_stream = AWS_CONTAINER_OF(stream, struct aws_h1_stream, base);
+    struct h1_connection *connection = AWS_CONTAINER_OF(stream->owning_connection, struct h1_connection, base);
+
+    int error_code = AWS_ERROR_SUCCESS;
+    bool should_schedule_task = false;
+
+    { /* BEGIN CRITICAL SECTION */
+        s_h1_connection_lock_synced_data(connection);
+
+        if (h1_stream->synced_data.is_complete) {
+            AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=%p: Cannot resume body, stream has completed.", (void *)stream);
+            error_code = AWS_ERROR_HTTP_STREAM_HAS_COMPLETED;
+
+        } else if (!connection->synced_data.is_outgoing_stream_task_active) {
+            /* Task went inactive, presumably because this body ran dry. Wake it up. */
+            connection->synced_data.is_outgoing_stream_task_active = true;
+            should_schedule_task = true;
+
+        } else {
+            /* Task is busy. Leave a note, in case it's about to find the body empty and pause. */
+            h1_stream->synced_data.has_pending_body_resume = true;
+        }
+
+        s_h1_connection_unlock_synced_data(connection);
+    } /* END CRITICAL SECTION */
+
+    if (error_code) {
+        return aws_raise_error(error_code);
+    }
+
+    AWS_LOGF_TRACE(AWS_LS_HTTP_STREAM, "id=%p: Outgoing body resumed.", (void *)stream);
+
+    if (should_schedule_task) {
+        AWS_LOGF_TRACE(AWS_LS_HTTP_CONNECTION, "id=%p: Scheduling outgoing stream task.", (void *)&connection->base);
+        aws_channel_schedule_task_now(connection->base.channel_slot->channel, &connection->outgoing_stream_task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_h1_stream_write_chunk(struct aws_http_stream *stream, const struct aws_http1_chunk_options *options) {
+    AWS_PRECONDITION(stream);
+    AWS_PRECONDITION(options);
+
+    struct aws_h1_stream *h1_stream = AWS_CONTAINER_OF(stream, struct aws_h1_stream, base);
+    struct h1_connection *connection = AWS_CONTAINER_OF(stream->owning_connection, struct h1_connection, base);
+
+    if (options->chunk_data_size > 0 && !options->chunk_data) {
+        AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=%p: Chunk with non-zero size must have data", (void *)stream);
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* Not from the stream's allocator, which may be an arena that wouldn't reclaim chunks until the stream ends */
+    struct aws_h1_chunk *chunk = aws_h1_chunk_new(connection->base.alloc, options);
+    if (!chunk) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: Failed to initialize streamed chunk, error %d (%s).",
+            (void *)stream,
+            aws_last_error(),
+            aws_error_name(aws_last_error()));
+        return AWS_OP_ERR;
+    }
+
+    int error_code = AWS_ERROR_SUCCESS;
+    bool should_schedule_task = false;
+
+    { /* BEGIN CRITICAL SECTION */
+        s_h1_connection_lock_synced_data(connection);
+
+        if (stream->client_data && stream->id == 0) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM, "id=%p: Cannot write chunks before stream is activated.", (void *)stream);
+            error_code = AWS_ERROR_INVALID_STATE;
+
+        } else if (stream->server_data && !h1_stream->synced_data.has_outgoing_response) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM, "id=%p: Cannot write chunks before response is sent.", (void *)stream);
+            error_code = AWS_ERROR_INVALID_STATE;
+
+        } else if (!h1_stream->encoder_message.has_chunked_encoding_header) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM,
+                "id=%p: Cannot write chunks without 'transfer-encoding: chunked' header.",
+                (void *)stream);
+            error_code = AWS_ERROR_INVALID_STATE;
+
+        } else if (h1_stream->encoder_message.body) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM,
+                "id=%p: Cannot write chunks, the message's body stream is already being sent as chunks.",
+                (void *)stream);
+            error_code = AWS_ERROR_INVALID_STATE;
+
+        } else if (h1_stream->synced_data.is_complete) {
+            AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=%p: Cannot write chunks, stream has completed.", (void *)stream);
+            error_code = AWS_ERROR_HTTP_STREAM_HAS_COMPLETED;
+
+        } else if (h1_stream->synced_data.has_final_chunk) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM, "id=%p: Cannot write chunks after the final chunk.", (void *)stream);
+            error_code = AWS_ERROR_INVALID_STATE;
+
+        } else {
+            if (chunk->data_size == 0) {
+                h1_stream->synced_data.has_final_chunk = true;
+            }
+
+            aws_linked_list_push_back(&h1_stream->synced_data.pending_chunk_list, &chunk->node);
+
+            /* The outgoing stream task goes inactive while it waits for chunks, so wake it up */
+            if (!connection->synced_data.is_outgoing_stream_task_active) {
+                connection->synced_data.is_outgoing_stream_task_active = true;
+                should_schedule_task = true;
+            }
+        }
+
+        s_h1_connection_unlock_synced_data(connection);
+    } /* END CRITICAL SECTION */
+
+    if (error_code) {
+        aws_h1_chunk_destroy(chunk);
+        return aws_raise_error(error_code);
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_HTTP_STREAM,
+        "id=%p: Adding chunk with size %" PRIu64 " to stream",
+        (void *)stream,
+        options->chunk_data_size);
+
+    if (should_schedule_task) {
+        AWS_LOGF_TRACE(AWS_LS_HTTP_CONNECTION, "id=%p: Scheduling outgoing stream task.", (void *)&connection->base);
+        aws_channel_schedule_task_now(connection->base.channel_slot->channel, &connection->outgoing_stream_task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 struct aws_http_stream *s_make_request(
     struct aws_http_connection *client_connection,
     const struct aws_http_make_request_options *options) {
@@ -507,8 +678,13 @@ struct aws_http_stream *s_make_request(
     }
 
     /* Success! */
+    /* When a template is used, the method comes from the template rather than the request */
     struct aws_byte_cursor method;
-    aws_http_message_get_request_method(options->request, &method);
+    if (options->request_template) {
+        method = aws_h1_request_template_get_method(options->request_template);
+    } else {
+        aws_http_message_get_request_method(options->request, &method);
+    }
     stream->base.request_method = aws_http_str_to_method(method);
     struct aws_byte_cursor path;
     aws_http_message_get_request_path(options->request, &path);
@@ -554,12 +730,64 @@ static void s_update_window_task(struct aws_channel_task *channel_task, void *ar
     s_update_window_action(connection, window_update_size);
 }
 
+/* Move chunks from the stream's synced_data to its thread-only list. Lock must be held. */
+static void s_move_pending_chunks(struct aws_h1_stream *stream) {
+    while (!aws_linked_list_empty(&stream->synced_data.pending_chunk_list)) {
+        aws_linked_list_push_back(
+            &stream->pending_chunk_list, aws_linked_list_pop_front(&stream->synced_data.pending_chunk_list));
+    }
+}
+
+/* Returns the body buffer being filled, or NULL if the user hasn't recycled it since it was last finished */
+static struct aws_byte_buf *s_get_incoming_body_buffer(struct aws_h1_stream *incoming_stream) {
+    size_t recycled = aws_atomic_load_int(&incoming_stream->incoming_body_buffers_recycled);
+    if (incoming_stream->incoming_body_buffer_index - recycled >= incoming_stream->num_incoming_body_buffers) {
+        return NULL;
+    }
+
+    size_t index = incoming_stream->incoming_body_buffer_index % incoming_stream->num_incoming_body_buffers;
+    return &incoming_stream->incoming_body_buffers[index];
+}
+
+/* Hand the body buffer being filled over to the user, and move on to the next */
+static void s_finish_incoming_body_buffer(struct aws_h1_stream *incoming_stream) {
+    incoming_stream->incoming_body_buffer_index++;
+    aws_atomic_store_int(&incoming_stream->incoming_body_buffers_finished, incoming_stream->incoming_body_buffer_index);
+}
+
 static void s_stream_complete(struct aws_h1_stream *stream, int error_code) {
     struct h1_connection *connection = AWS_CONTAINER_OF(stream->base.owning_connection, struct h1_connection, base);
 
     /* Remove stream from list. */
     aws_linked_list_remove(&stream->node);
 
+    /* No more body data is coming, so a partly filled body buffer is finished too */
+    if (stream->num_incoming_body_buffers > 0) {
+        struct aws_byte_buf *dst = s_get_incoming_body_buffer(stream);
+        if (dst) {
+            size_t index = dst - stream->incoming_body_buffers;
+            if (dst->len > 0 || stream->incoming_body_buffer_window_sizes[index] > 0) {
+                s_finish_incoming_body_buffer(stream);
+            }
+        }
+    }
+
+    /* No more chunks may be submitted. Grab any that arrived which the encoder never got to. */
+    { /* BEGIN CRITICAL SECTION */
+        s_h1_connection_lock_synced_data(connection);
+        stream->synced_data.is_complete = true;
+        s_move_pending_chunks(stream);
+        s_h1_connection_unlock_synced_data(connection);
+    } /* END CRITICAL SECTION */
+
+    /* Complete any leftover chunks. This only happens if the stream ended before sending its whole body. */
+    while (!aws_linked_list_empty(&stream->pending_chunk_list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&stream->pending_chunk_list);
+        struct aws_h1_chunk *chunk = AWS_CONTAINER_OF(node, struct aws_h1_chunk, node);
+        aws_h1_chunk_complete_and_destroy(
+            chunk, &stream->base, error_code ? error_code : AWS_ERROR_HTTP_STREAM_HAS_COMPLETED);
+    }
+
     /* Nice logging */
     if (error_code) {
         AWS_LOGF_DEBUG(
@@ -675,14 +903,108 @@ static void s_client_update_incoming_stream_ptr(struct h1_connection *connection
     s_set_incoming_stream_ptr(connection, desired);
 }
 
+/**
+ * Value for the "Date" header, shared by every server connection on an event-loop.
+ * Stored as an event-loop local object, so it's only ever touched from that event-loop's thread.
+ */
+struct date_cache {
+    /* Wall-clock second that `value` was formatted for */
+    uint64_t timestamp_secs;
+    uint8_t value[AWS_H1_DATE_VALUE_LEN];
+};
+
+/* Address is the key for the date_cache event-loop local object */
+static const int s_date_cache_key = 0;
+
+static void s_date_cache_on_removed(struct aws_event_loop_local_object *local_object) {
+    aws_mem_release(aws_default_allocator(), local_object->object);
+}
+
+/* Reformat the cached value if the second has changed. Returns false if the value couldn't be produced */
+static bool s_date_cache_refresh(struct date_cache *cache) {
+    uint64_t now_ns;
+    if (aws_sys_clock_get_ticks(&now_ns)) {
+        return false;
+    }
+
+    uint64_t now_secs = aws_timestamp_convert(now_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL);
+    if (now_secs == cache->timestamp_secs) {
+        return true;
+    }
+
+    struct aws_date_time date_time;
+    aws_date_time_init_epoch_secs(&date_time, (double)now_secs);
+
+    /* AWS_DATE_FORMAT_RFC822 renders the RFC-1123 form required by HTTP, ex: "Sun, 06 Nov 1994 08:49:37 GMT" */
+    uint8_t storage[AWS_DATE_TIME_STR_MAX_LEN];
+    struct aws_byte_buf str = aws_byte_buf_from_empty_array(storage, sizeof(storage));
+    if (aws_date_time_to_utc_time_str(&date_time, AWS_DATE_FORMAT_RFC822, &str) || str.len != AWS_H1_DATE_VALUE_LEN) {
+        return false;
+    }
+
+    memcpy(cache->value, str.buffer, AWS_H1_DATE_VALUE_LEN);
+    cache->timestamp_secs = now_secs;
+    return true;
+}
+
+/* Fill in the "Date" header of an outgoing response, if one was reserved. Called from event-loop thread. */
+static void s_write_date_header(struct h1_connection *connection, struct aws_h1_encoder_message *message) {
+    if (message->date_value_offset == 0) {
+        return;
+    }
+
+    struct aws_event_loop *event_loop = aws_channel_get_event_loop(connection->base.channel_slot->channel);
+    struct aws_event_loop_local_object local_object;
+    struct date_cache *cache = NULL;
+    if (aws_event_loop_fetch_local_object(event_loop, (void *)&s_date_cache_key, &local_object) == AWS_OP_SUCCESS) {
+        cache = local_object.object;
+    } else {
+        /* The cache lives as long as the event-loop, so it mustn't come from this connection's allocator */
+        cache = aws_mem_calloc(aws_default_allocator(), 1, sizeof(struct date_cache));
+        if (cache) {
+            cache->timestamp_secs = UINT64_MAX;
+
+            local_object.key = &s_date_cache_key;
+            local_object.object = cache;
+            local_object.on_object_removed = s_date_cache_on_removed;
+            if (aws_event_loop_put_local_object(event_loop, &local_object)) {
+                aws_mem_release(aws_default_allocator(), cache);
+                cache = NULL;
+            }
+        }
+    }
+
+    /* If the shared cache is unavailable, format a one-off value */
+    struct date_cache one_off = {.timestamp_secs = UINT64_MAX};
+    if (!cache) {
+        cache = &one_off;
+    }
+
+    if (!s_date_cache_refresh(cache)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_CONNECTION,
+            "id=%p: Failed to format Date header, sending response without one.",
+            (void *)&connection->base);
+        aws_h1_encoder_message_omit_date(message);
+        return;
+    }
+
+    aws_h1_encoder_message_set_date(message, aws_byte_cursor_from_array(cache->value, AWS_H1_DATE_VALUE_LEN));
+}
+
 /**
  * If necessary, update `outgoing_stream` so it is pointing at a stream
  * with data to send, or NULL if all streams are done sending data.
  *
+ * If there's no more work and `mark_task_inactive_if_idle` is true, the outgoing stream task is marked inactive.
+ * Pass false if the task will run again anyway (ex: it has a message in flight whose completion reschedules it).
+ *
  * Called from event-loop thread.
  * This function has lots of side effects.
  */
-static struct aws_h1_stream *s_update_outgoing_stream_ptr(struct h1_connection *connection) {
+static struct aws_h1_stream *s_update_outgoing_stream_ptr(
+    struct h1_connection *connection,
+    bool mark_task_inactive_if_idle) {
     struct aws_h1_stream *current = connection->thread_data.outgoing_stream;
     bool current_changed = false;
     int err;
@@ -735,6 +1057,7 @@ static struct aws_h1_stream *s_update_outgoing_stream_ptr(struct h1_connection *
         }
 
         /* Look for next stream we can work on. */
+        size_t num_in_flight = 0;
         for (struct aws_linked_list_node *node = aws_linked_list_begin(&connection->thread_data.stream_list);
              node != aws_linked_list_end(&connection->thread_data.stream_list);
              node = aws_linked_list_next(node)) {
@@ -743,9 +1066,21 @@ static struct aws_h1_stream *s_update_outgoing_stream_ptr(struct h1_connection *
 
             /* If we already sent this stream's data, keep looking... */
             if (stream->is_outgoing_message_done) {
+                ++num_in_flight;
                 continue;
             }
 
+            /* STOP if we're a client, and too many requests are already awaiting responses.
+             * s_decoder_on_done() wakes the task again when a response completes. */
+            if (connection->max_pipelined_requests && num_in_flight >= connection->max_pipelined_requests) {
+                AWS_LOGF_TRACE(
+                    AWS_LS_HTTP_CONNECTION,
+                    "id=%p: Pipelining depth of %zu reached, waiting for a response before sending more requests.",
+                    (void *)&connection->base,
+                    connection->max_pipelined_requests);
+                break;
+            }
+
             /* STOP if we're a server, and this stream's response isn't ready to send.
              * It's not like we can skip this and start on the next stream because responses must be sent in order.
              * Don't need a check like this for clients because their streams always start with data to send. */
@@ -759,7 +1094,7 @@ static struct aws_h1_stream *s_update_outgoing_stream_ptr(struct h1_connection *
             break;
         }
 
-        if (!current) {
+        if (!current && mark_task_inactive_if_idle) {
             /* If no more work to do. Set this false while we're holding the lock. */
             connection->synced_data.is_outgoing_stream_task_active = false;
         }
@@ -779,6 +1114,7 @@ static struct aws_h1_stream *s_update_outgoing_stream_ptr(struct h1_connection *
         s_set_outgoing_stream_ptr(connection, current);
 
         if (current) {
+            s_write_date_header(connection, &current->encoder_message);
             err = aws_h1_encoder_start_message(
                 &connection->thread_data.encoder, &current->encoder_message, &current->base);
             (void)err;
@@ -835,6 +1171,64 @@ static void s_on_channel_write_complete(
     aws_channel_schedule_task_now(channel, &connection->outgoing_stream_task);
 }
 
+/**
+ * User data for an aws_io_message whose data is a slice of caller-owned body memory, rather than its own buffer.
+ * Holds a reference to the aws_http_message that owns the memory until the write completes.
+ */
+struct lent_body_write {
+    struct h1_connection *connection;
+    struct aws_http_message *body_owner;
+};
+
+static void s_lent_body_write_destroy(struct lent_body_write *write) {
+    aws_http_message_release(write->body_owner);
+    aws_mem_release(write->connection->base.alloc, write);
+}
+
+static void s_on_lent_body_write_complete(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+
+    struct lent_body_write *write = user_data;
+    struct h1_connection *connection = write->connection;
+    s_lent_body_write_destroy(write);
+
+    s_on_channel_write_complete(channel, message, err_code, connection);
+}
+
+/* Returns an aws_io_message whose data points at `slice`. It's freed through its allocator, like any other */
+static struct aws_io_message *s_new_lent_body_io_message(
+    struct h1_connection *connection,
+    struct aws_byte_cursor slice,
+    struct aws_http_message *body_owner) {
+
+    /* Not from the channel's message pool, which can't hold a buffer it didn't allocate */
+    struct aws_io_message *msg = aws_mem_calloc(connection->base.alloc, 1, sizeof(struct aws_io_message));
+    if (!msg) {
+        return NULL;
+    }
+
+    struct lent_body_write *write = aws_mem_calloc(connection->base.alloc, 1, sizeof(struct lent_body_write));
+    if (!write) {
+        aws_mem_release(connection->base.alloc, msg);
+        return NULL;
+    }
+
+    write->connection = connection;
+    write->body_owner = body_owner;
+    aws_http_message_acquire(body_owner);
+
+    msg->allocator = connection->base.alloc;
+    msg->message_type = AWS_IO_MESSAGE_APPLICATION_DATA;
+    msg->message_data = aws_byte_buf_from_array(slice.ptr, slice.len);
+    msg->owning_channel = connection->base.channel_slot->channel;
+    msg->on_completion = s_on_lent_body_write_complete;
+    msg->user_data = write;
+    return msg;
+}
+
 static void s_outgoing_stream_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
     if (status != AWS_TASK_STATUS_RUN_READY) {
         return;
@@ -851,7 +1245,7 @@ static void s_outgoing_stream_task(struct aws_channel_task *task, void *arg, enu
 
     AWS_LOGF_TRACE(AWS_LS_HTTP_CONNECTION, "id=%p: Outgoing stream task is running.", (void *)&connection->base);
 
-    struct aws_h1_stream *outgoing_stream = s_update_outgoing_stream_ptr(connection);
+    struct aws_h1_stream *outgoing_stream = s_update_outgoing_stream_ptr(connection, true);
     if (!outgoing_stream) {
         /* Note: outgoing_stream_task_active is set false by s_update_outgoing_stream_ptr()
          * if there are no streams are ready to write. We do it there while holding the lock. */
@@ -859,6 +1253,57 @@ static void s_outgoing_stream_task(struct aws_channel_task *task, void *arg, enu
         return;
     }
 
+    /* Move any chunks that were submitted from other threads over to the encoder */
+    { /* BEGIN CRITICAL SECTION */
+        s_h1_connection_lock_synced_data(connection);
+        s_move_pending_chunks(outgoing_stream);
+        s_h1_connection_unlock_synced_data(connection);
+    } /* END CRITICAL SECTION */
+
+    /* If the body is in caller-owned memory and didn't fit in the last message, send it from there without copying */
+    struct aws_byte_cursor lent_body;
+    struct aws_http_message *lent_body_owner = NULL;
+    if (aws_h1_encoder_lend_body_data(
+            &connection->thread_data.encoder, MAX_LENT_BODY_SLICE_SIZE, &lent_body, &lent_body_owner)) {
+
+        msg = s_new_lent_body_io_message(connection, lent_body, lent_body_owner);
+        if (!msg) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_CONNECTION,
+                "id=%p: Failed to create message for body data, error %d (%s). Closing connection.",
+                (void *)&connection->base,
+                aws_last_error(),
+                aws_error_name(aws_last_error()));
+            goto error;
+        }
+
+        AWS_LOGF_TRACE(
+            AWS_LS_HTTP_CONNECTION,
+            "id=%p: Outgoing stream task is sending %zu bytes of body data without copying.",
+            (void *)&connection->base,
+            lent_body.len);
+
+        connection->thread_data.stats.num_outgoing_writes++;
+        if (!aws_h1_encoder_is_message_in_progress(&connection->thread_data.encoder)) {
+            connection->thread_data.stats.num_outgoing_messages++;
+        }
+
+        if (aws_channel_slot_send_message(connection->base.channel_slot, msg, AWS_CHANNEL_DIR_WRITE)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_CONNECTION,
+                "id=%p: Failed to send message down channel, error %d (%s). Closing connection.",
+                (void *)&connection->base,
+                aws_last_error(),
+                aws_error_name(aws_last_error()));
+
+            /* Message wasn't taken, so its completion will never run */
+            s_lent_body_write_destroy(msg->user_data);
+            goto error;
+        }
+
+        return;
+    }
+
     msg = aws_channel_slot_acquire_max_message_for_write(connection->base.channel_slot);
     if (!msg) {
         AWS_LOGF_ERROR(
@@ -877,18 +1322,58 @@ static void s_outgoing_stream_task(struct aws_channel_task *task, void *arg, enu
     /**
      * Fill message data from the outgoing stream.
      * Note that we might be resuming work on a stream from a previous run of this task.
+     *
+     * If the stream finishes and there's still room, keep filling the same aws_io_message from the next stream.
+     * This way, many small messages (ex: pipelined requests or responses) go out in a single write.
      */
-    if (aws_h1_encoder_process(&connection->thread_data.encoder, &msg->message_data)) {
-        /* Error sending data, abandon ship */
-        goto error;
+    size_t num_messages_finished = 0;
+    while (true) {
+        if (aws_h1_encoder_process(&connection->thread_data.encoder, &msg->message_data)) {
+            /* Error sending data, abandon ship */
+            goto error;
+        }
+
+        if (aws_h1_encoder_is_message_in_progress(&connection->thread_data.encoder)) {
+            /* Out of space, or stream's data isn't ready yet */
+            break;
+        }
+
+        ++num_messages_finished;
+
+        /* Don't look past the final stream, the connection shuts down once it's done */
+        if (msg->message_data.len == msg->message_data.capacity || outgoing_stream->is_final_stream) {
+            break;
+        }
+
+        /* This message's completion reschedules the task, so don't let it go inactive here */
+        struct aws_h1_stream *next_stream = s_update_outgoing_stream_ptr(connection, false);
+        if (!next_stream) {
+            break;
+        }
+
+        outgoing_stream = next_stream;
+
+        { /* BEGIN CRITICAL SECTION */
+            s_h1_connection_lock_synced_data(connection);
+            s_move_pending_chunks(outgoing_stream);
+            s_h1_connection_unlock_synced_data(connection);
+        } /* END CRITICAL SECTION */
+    }
+
+    if (aws_h1_encoder_is_waiting_for_continue(&connection->thread_data.encoder)) {
+        s_start_expect_continue_timer(connection, outgoing_stream);
     }
 
     if (msg->message_data.len > 0) {
         AWS_LOGF_TRACE(
             AWS_LS_HTTP_CONNECTION,
-            "id=%p: Outgoing stream task is sending message of size %zu.",
+            "id=%p: Outgoing stream task is sending message of size %zu, containing the end of %zu HTTP messages.",
             (void *)&connection->base,
-            msg->message_data.len);
+            msg->message_data.len,
+            num_messages_finished);
+
+        connection->thread_data.stats.num_outgoing_writes++;
+        connection->thread_data.stats.num_outgoing_messages += num_messages_finished;
 
         if (aws_channel_slot_send_message(connection->base.channel_slot, msg, AWS_CHANNEL_DIR_WRITE)) {
             AWS_LOGF_ERROR(
@@ -901,11 +1386,82 @@ static void s_outgoing_stream_task(struct aws_channel_task *task, void *arg, enu
             goto error;
         }
 
+    } else if (aws_h1_encoder_is_waiting_for_chunks(&connection->thread_data.encoder)) {
+        /* Encoder has nothing to do until the user submits more chunks.
+         * Let the task go inactive, aws_http1_stream_write_chunk() will wake it up again. */
+        aws_mem_release(msg->allocator, msg);
+
+        bool chunks_arrived = false;
+        { /* BEGIN CRITICAL SECTION */
+            s_h1_connection_lock_synced_data(connection);
+            if (aws_linked_list_empty(&outgoing_stream->synced_data.pending_chunk_list)) {
+                connection->synced_data.is_outgoing_stream_task_active = false;
+            } else {
+                chunks_arrived = true;
+            }
+            s_h1_connection_unlock_synced_data(connection);
+        } /* END CRITICAL SECTION */
+
+        if (chunks_arrived) {
+            aws_channel_schedule_task_now(channel, task);
+        } else {
+            AWS_LOGF_TRACE(
+                AWS_LS_HTTP_CONNECTION,
+                "id=%p: Outgoing stream task stopped, waiting for stream %p to write more chunks.",
+                (void *)&connection->base,
+                (void *)&outgoing_stream->base);
+        }
+
+    } else if (aws_h1_encoder_is_waiting_for_continue(&connection->thread_data.encoder)) {
+        /* Request head is sent, and its body is held back.
+         * Let the task go inactive, it's woken when "100 Continue" arrives, a final response arrives,
+         * or the timeout expires. All of those happen on this thread, so it's safe to go inactive unconditionally. */
+        aws_mem_release(msg->allocator, msg);
+
+        { /* BEGIN CRITICAL SECTION */
+            s_h1_connection_lock_synced_data(connection);
+            connection->synced_data.is_outgoing_stream_task_active = false;
+            s_h1_connection_unlock_synced_data(connection);
+        } /* END CRITICAL SECTION */
+
+        AWS_LOGF_TRACE(
+            AWS_LS_HTTP_CONNECTION,
+            "id=%p: Outgoing stream task stopped, stream %p is waiting for 100-continue before sending its body.",
+            (void *)&connection->base,
+            (void *)&outgoing_stream->base);
+
+    } else if (outgoing_stream && outgoing_stream->pause_outgoing_body_when_empty) {
+        /* Body has no data available and user asked us not to poll it.
+         * Let the task go inactive, aws_http_stream_resume_outgoing_body() will wake it up again. */
+        aws_mem_release(msg->allocator, msg);
+
+        bool resume_arrived = false;
+        { /* BEGIN CRITICAL SECTION */
+            s_h1_connection_lock_synced_data(connection);
+            if (outgoing_stream->synced_data.has_pending_body_resume) {
+                outgoing_stream->synced_data.has_pending_body_resume = false;
+                resume_arrived = true;
+            } else {
+                connection->synced_data.is_outgoing_stream_task_active = false;
+            }
+            s_h1_connection_unlock_synced_data(connection);
+        } /* END CRITICAL SECTION */
+
+        if (resume_arrived) {
+            aws_channel_schedule_task_now(channel, task);
+        } else {
+            AWS_LOGF_TRACE(
+                AWS_LS_HTTP_CONNECTION,
+                "id=%p: Outgoing stream task paused, waiting for stream %p to resume its body.",
+                (void *)&connection->base,
+                (void *)&outgoing_stream->base);
+        }
+
     } else {
         /* If message is empty, warn that no work is being done
          * and reschedule the task to try again next tick.
          * It's likely that body isn't ready, so body streaming function has no data to write yet.
-         * If this scenario turns out to be common we should implement a "pause" feature. */
+         * Streams that set pause_outgoing_body_when_empty avoid this polling. */
         AWS_LOGF_WARN(
             AWS_LS_HTTP_CONNECTION,
             "id=%p: Current outgoing stream %p sent no data, will try again next tick.",
@@ -1036,12 +1592,30 @@ static int s_decoder_on_header(const struct aws_h1_decoded_header *header, void
         }
     }
 
-    if (incoming_stream->base.on_incoming_headers) {
-        struct aws_http_header deliver = {
-            .name = header->name_data,
-            .value = header->value_data,
-        };
+    if (header->name == AWS_HTTP_HEADER_CONTENT_ENCODING && incoming_stream->decompress_incoming_body &&
+        header_block == AWS_HTTP_HEADER_BLOCK_MAIN) {
 
+        /* Multiple Content-Encoding headers form a list of codings, which we don't attempt to undo */
+        if (incoming_stream->incoming_content_coding != AWS_HTTP_CONTENT_CODING_IDENTITY) {
+            incoming_stream->incoming_content_coding = AWS_HTTP_CONTENT_CODING_UNSUPPORTED;
+        } else {
+            incoming_stream->incoming_content_coding = aws_http_str_to_content_coding(header->value_data);
+        }
+    }
+
+    struct aws_http_header deliver = {
+        .name = header->name_data,
+        .value = header->value_data,
+    };
+
+    /* Header data isn't stable, so copy it until the whole block can be delivered */
+    if (incoming_stream->base.on_incoming_header_block) {
+        if (aws_http_header_block_buffer_add(&incoming_stream->base.incoming_header_block, &deliver, header->name)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    if (incoming_stream->base.on_incoming_headers) {
         int err = incoming_stream->base.on_incoming_headers(
             &incoming_stream->base, header_block, &deliver, 1, incoming_stream->base.user_data);
 
@@ -1060,6 +1634,48 @@ static int s_decoder_on_header(const struct aws_h1_decoded_header *header, void
     return AWS_OP_SUCCESS;
 }
 
+/* Decide which coding, if any, to undo on the incoming body. Transfer-Encoding codings take precedence. */
+static int s_choose_incoming_body_coding(struct h1_connection *connection, struct aws_h1_stream *incoming_stream) {
+    if (!incoming_stream->decompress_incoming_body) {
+        return AWS_OP_SUCCESS;
+    }
+
+    int encoding_flags = aws_h1_decoder_get_encoding_flags(connection->thread_data.incoming_stream_decoder);
+    switch (encoding_flags & (AWS_HTTP_TRANSFER_ENCODING_GZIP | AWS_HTTP_TRANSFER_ENCODING_DEFLATE)) {
+        case 0:
+            incoming_stream->incoming_body_coding = incoming_stream->incoming_content_coding;
+            break;
+        case AWS_HTTP_TRANSFER_ENCODING_GZIP:
+            incoming_stream->incoming_body_coding = AWS_HTTP_CONTENT_CODING_GZIP;
+            break;
+        case AWS_HTTP_TRANSFER_ENCODING_DEFLATE:
+            incoming_stream->incoming_body_coding = AWS_HTTP_CONTENT_CODING_DEFLATE;
+            break;
+        default:
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM,
+                "id=%p: Cannot decompress body with multiple Transfer-Encoding codings.",
+                (void *)&incoming_stream->base);
+            return aws_raise_error(AWS_ERROR_HTTP_COMPRESSION);
+    }
+
+    if (incoming_stream->incoming_body_coding == AWS_HTTP_CONTENT_CODING_UNSUPPORTED) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: Content-Encoding is not supported for decompression, body will be delivered as-is.",
+            (void *)&incoming_stream->base);
+        incoming_stream->incoming_body_coding = AWS_HTTP_CONTENT_CODING_IDENTITY;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Whether this stream's request head is sent, and its body is being held back until "100 Continue" */
+static bool s_is_waiting_for_continue(struct h1_connection *connection, struct aws_h1_stream *stream) {
+    return connection->thread_data.outgoing_stream == stream &&
+           aws_h1_encoder_is_waiting_for_continue(&connection->thread_data.encoder);
+}
+
 static int s_mark_head_done(struct aws_h1_stream *incoming_stream) {
     /* Bail out if we've already done this */
     if (incoming_stream->is_incoming_head_done) {
@@ -1076,11 +1692,38 @@ static int s_mark_head_done(struct aws_h1_stream *incoming_stream) {
         AWS_LOGF_TRACE(AWS_LS_HTTP_STREAM, "id=%p: Main header block done.", (void *)&incoming_stream->base);
         incoming_stream->is_incoming_head_done = true;
 
+        if (s_choose_incoming_body_coding(connection, incoming_stream)) {
+            return AWS_OP_ERR;
+        }
+
+        /* RFC-7231 5.1.1: The server responded without waiting for the body, so don't send it.
+         * The request is incomplete on the wire, so this must be the final stream on the connection. */
+        if (s_is_waiting_for_continue(connection, incoming_stream)) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_HTTP_STREAM,
+                "id=%p: Final response received while waiting for 100-continue, body will not be sent."
+                " This will be the final stream on this connection.",
+                (void *)&incoming_stream->base);
+
+            incoming_stream->is_final_stream = true;
+            s_end_expect_continue_wait(connection, false /*send_body*/);
+        }
+
     } else if (header_block == AWS_HTTP_HEADER_BLOCK_INFORMATIONAL) {
         AWS_LOGF_TRACE(AWS_LS_HTTP_STREAM, "id=%p: Informational header block done.", (void *)&incoming_stream->base);
 
         /* Only clients can receive informational headers.
-         * Check whether we're switching protocols */
+         * Check whether the server wants the body that's being held back */
+        if (incoming_stream->base.client_data->response_status == AWS_HTTP_STATUS_CODE_100_CONTINUE &&
+            s_is_waiting_for_continue(connection, incoming_stream)) {
+
+            AWS_LOGF_TRACE(
+                AWS_LS_HTTP_STREAM, "id=%p: Received 100-continue, sending body.", (void *)&incoming_stream->base);
+
+            s_end_expect_continue_wait(connection, true /*send_body*/);
+        }
+
+        /* Check whether we're switching protocols */
         if (incoming_stream->base.client_data->response_status == AWS_HTTP_STATUS_CODE_101_SWITCHING_PROTOCOLS) {
 
             /* Switching protocols while there are multiple streams is too complex to deal with.
@@ -1111,7 +1754,11 @@ static int s_mark_head_done(struct aws_h1_stream *incoming_stream) {
         }
     }
 
-    /* Invoke user cb */
+    /* Invoke user cbs */
+    if (aws_http_stream_deliver_incoming_header_block(&incoming_stream->base, header_block)) {
+        return AWS_OP_ERR;
+    }
+
     if (incoming_stream->base.on_incoming_header_block_done) {
         int err = incoming_stream->base.on_incoming_header_block_done(
             &incoming_stream->base, header_block, incoming_stream->base.user_data);
@@ -1127,6 +1774,93 @@ static int s_mark_head_done(struct aws_h1_stream *incoming_stream) {
         }
     }
 
+    aws_http_header_block_buffer_reset(&incoming_stream->base.incoming_header_block);
+    return AWS_OP_SUCCESS;
+}
+
+/* Copy incoming body data into the stream's body buffers, filling them in order */
+static int s_write_incoming_body_to_buffers(struct aws_h1_stream *incoming_stream, struct aws_byte_cursor data) {
+    while (data.len > 0) {
+        struct aws_byte_buf *dst = s_get_incoming_body_buffer(incoming_stream);
+        if (!dst) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM,
+                "id=%p: Response body buffers are full, %zu bytes did not fit.",
+                (void *)&incoming_stream->base,
+                data.len);
+            return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+        }
+
+        size_t space_available = dst->capacity - dst->len;
+        if (space_available == 0) {
+            s_finish_incoming_body_buffer(incoming_stream);
+            continue;
+        }
+
+        struct aws_byte_cursor segment = aws_byte_cursor_advance(&data, aws_min_size(space_available, data.len));
+        struct aws_byte_cursor written = {
+            .ptr = dst->buffer + dst->len,
+            .len = segment.len,
+        };
+        aws_byte_buf_write_from_whole_cursor(dst, segment);
+
+        /* Full buffers are finished right away, so the user can have them before the next data arrives */
+        if (dst->len == dst->capacity) {
+            s_finish_incoming_body_buffer(incoming_stream);
+        }
+
+        /* Let user know where the data went */
+        if (incoming_stream->base.on_incoming_body) {
+            if (incoming_stream->base.on_incoming_body(
+                    &incoming_stream->base, &written, incoming_stream->base.user_data)) {
+                AWS_LOGF_TRACE(
+                    AWS_LS_HTTP_STREAM,
+                    "id=%p: Incoming body callback raised error %d (%s).",
+                    (void *)&incoming_stream->base,
+                    aws_last_error(),
+                    aws_error_name(aws_last_error()));
+
+                return AWS_OP_ERR;
+            }
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Pass incoming body data to the user. Also used as the aws_http_decompressor_on_data_fn for decompressed data. */
+static int s_deliver_incoming_body(struct aws_byte_cursor data, void *user_data) {
+    struct aws_h1_stream *incoming_stream = user_data;
+
+    if (incoming_stream->num_incoming_body_buffers > 0) {
+        return s_write_incoming_body_to_buffers(incoming_stream, data);
+    }
+
+    /* The window shrinks by the size of the data on the wire, once some of it is delivered.
+     * If decompression splits it across several deliveries, it all counts against the first. */
+    incoming_stream->base.incoming_body_wire_bytes = incoming_stream->undelivered_incoming_body_wire_bytes;
+    incoming_stream->undelivered_incoming_body_wire_bytes = 0;
+    if (incoming_stream->base.manual_window_management) {
+        struct h1_connection *connection =
+            AWS_CONTAINER_OF(incoming_stream->base.owning_connection, struct h1_connection, base);
+        connection->thread_data.incoming_message_window_shrink_size += incoming_stream->base.incoming_body_wire_bytes;
+    }
+
+    if (incoming_stream->base.on_incoming_body) {
+        int err =
+            incoming_stream->base.on_incoming_body(&incoming_stream->base, &data, incoming_stream->base.user_data);
+        if (err) {
+            AWS_LOGF_TRACE(
+                AWS_LS_HTTP_STREAM,
+                "id=%p: Incoming body callback raised error %d (%s).",
+                (void *)&incoming_stream->base,
+                aws_last_error(),
+                aws_error_name(aws_last_error()));
+
+            return AWS_OP_ERR;
+        }
+    }
+
     return AWS_OP_SUCCESS;
 }
 
@@ -1150,26 +1884,145 @@ static int s_decoder_on_body(const struct aws_byte_cursor *data, bool finished,
     AWS_LOGF_TRACE(
         AWS_LS_HTTP_STREAM, "id=%p: Incoming body: %zu bytes received.", (void *)&incoming_stream->base, data->len);
 
-    /* If the user wishes to manually increment windows, by default shrink the window by the amount of data read. */
-    if (incoming_stream->base.manual_window_management) {
-        connection->thread_data.incoming_message_window_shrink_size += data->len;
-    }
-
-    if (incoming_stream->base.on_incoming_body) {
-        err = incoming_stream->base.on_incoming_body(&incoming_stream->base, data, incoming_stream->base.user_data);
-        if (err) {
-            AWS_LOGF_TRACE(
+    /* If the user wishes to manually increment windows, by default shrink the window by the amount of data read.
+     * If user gave us buffers, the window re-opens as they're recycled, so note which buffer the data went to.
+     * Decompressed data may not land in a buffer until later, so it's noted against the buffer being filled now.
+     * Otherwise, the window shrinks once the data is delivered, see s_deliver_incoming_body(). */
+    if (incoming_stream->num_incoming_body_buffers > 0) {
+        struct aws_byte_buf *dst = s_get_incoming_body_buffer(incoming_stream);
+        if (!dst) {
+            AWS_LOGF_ERROR(
                 AWS_LS_HTTP_STREAM,
-                "id=%p: Incoming body callback raised error %d (%s).",
+                "id=%p: Response body buffers are full, %zu bytes did not fit.",
                 (void *)&incoming_stream->base,
-                aws_last_error(),
-                aws_error_name(aws_last_error()));
+                data->len);
+            return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+        }
 
-            return AWS_OP_ERR;
+        if (incoming_stream->base.manual_window_management) {
+            size_t index = dst - incoming_stream->incoming_body_buffers;
+            incoming_stream->incoming_body_buffer_window_sizes[index] += data->len;
+            connection->thread_data.incoming_message_window_shrink_size += data->len;
         }
+    } else {
+        incoming_stream->undelivered_incoming_body_wire_bytes = data->len;
     }
 
-    return AWS_OP_SUCCESS;
+    if (incoming_stream->incoming_body_coding != AWS_HTTP_CONTENT_CODING_IDENTITY) {
+        if (!incoming_stream->incoming_body_decompressor) {
+            incoming_stream->incoming_body_decompressor =
+                aws_http_decompressor_new(incoming_stream->base.alloc, incoming_stream->incoming_body_coding);
+            if (!incoming_stream->incoming_body_decompressor) {
+                return AWS_OP_ERR;
+            }
+        }
+
+        err = aws_http_decompressor_process(
+            incoming_stream->incoming_body_decompressor, *data, s_deliver_incoming_body, incoming_stream);
+
+        /* Data that decompressed to nothing yet never reaches the user, so it doesn't shrink the window */
+        incoming_stream->undelivered_incoming_body_wire_bytes = 0;
+        return err;
+    }
+
+    return s_deliver_incoming_body(*data, incoming_stream);
+}
+
+/* Schedule the outgoing stream task, if it's not already active */
+static void s_wake_outgoing_stream_task(struct h1_connection *connection) {
+    if (connection->thread_data.is_writing_stopped) {
+        return;
+    }
+
+    bool should_schedule_task = false;
+    { /* BEGIN CRITICAL SECTION */
+        s_h1_connection_lock_synced_data(connection);
+        if (!connection->synced_data.is_outgoing_stream_task_active) {
+            connection->synced_data.is_outgoing_stream_task_active = true;
+            should_schedule_task = true;
+        }
+        s_h1_connection_unlock_synced_data(connection);
+    } /* END CRITICAL SECTION */
+
+    if (should_schedule_task) {
+        AWS_LOGF_TRACE(AWS_LS_HTTP_CONNECTION, "id=%p: Scheduling outgoing stream task.", (void *)&connection->base);
+        aws_channel_schedule_task_now(connection->base.channel_slot->channel, &connection->outgoing_stream_task);
+    }
+}
+
+static void s_start_expect_continue_timer(struct h1_connection *connection, struct aws_h1_stream *stream) {
+    if (connection->thread_data.expect_continue_deadline_ns != 0) {
+        /* Already waiting */
+        return;
+    }
+
+    uint64_t now_ns = 0;
+    aws_channel_current_clock_time(connection->base.channel_slot->channel, &now_ns);
+    uint64_t timeout_ns =
+        aws_timestamp_convert(stream->expect_continue_timeout_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    connection->thread_data.expect_continue_deadline_ns = aws_add_u64_saturating(now_ns, timeout_ns);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_HTTP_STREAM,
+        "id=%p: Waiting up to %" PRIu64 "ms for 100-continue before sending body.",
+        (void *)&stream->base,
+        stream->expect_continue_timeout_ms);
+
+    /* If the task is still scheduled from a previous wait, it reschedules itself for the new deadline when it runs.
+     * Channel tasks can't be canceled, so a later wait with a shorter timeout may wait a bit longer than asked. */
+    if (!connection->thread_data.is_expect_continue_timeout_task_scheduled) {
+        connection->thread_data.is_expect_continue_timeout_task_scheduled = true;
+        aws_channel_schedule_task_future(
+            connection->base.channel_slot->channel,
+            &connection->expect_continue_timeout_task,
+            connection->thread_data.expect_continue_deadline_ns);
+    }
+}
+
+/* Stop holding back the outgoing stream's body, and either send it or skip it */
+static void s_end_expect_continue_wait(struct h1_connection *connection, bool send_body) {
+    connection->thread_data.expect_continue_deadline_ns = 0;
+
+    if (send_body) {
+        aws_h1_encoder_continue_body(&connection->thread_data.encoder);
+    } else {
+        aws_h1_encoder_skip_body(&connection->thread_data.encoder);
+    }
+
+    s_wake_outgoing_stream_task(connection);
+}
+
+static void s_expect_continue_timeout_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct h1_connection *connection = arg;
+    connection->thread_data.is_expect_continue_timeout_task_scheduled = false;
+
+    /* Bail out if the wait already ended */
+    if (connection->thread_data.expect_continue_deadline_ns == 0 || connection->thread_data.is_writing_stopped ||
+        !aws_h1_encoder_is_waiting_for_continue(&connection->thread_data.encoder)) {
+        connection->thread_data.expect_continue_deadline_ns = 0;
+        return;
+    }
+
+    /* A new wait started since this task was scheduled, run again at its deadline */
+    uint64_t now_ns = 0;
+    aws_channel_current_clock_time(connection->base.channel_slot->channel, &now_ns);
+    if (now_ns < connection->thread_data.expect_continue_deadline_ns) {
+        connection->thread_data.is_expect_continue_timeout_task_scheduled = true;
+        aws_channel_schedule_task_future(
+            connection->base.channel_slot->channel, task, connection->thread_data.expect_continue_deadline_ns);
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_HTTP_STREAM,
+        "id=%p: No 100-continue received before timeout, sending body anyway.",
+        (void *)&connection->thread_data.outgoing_stream->base);
+
+    s_end_expect_continue_wait(connection, true /*send_body*/);
 }
 
 static int s_decoder_on_done(void *user_data) {
@@ -1189,6 +2042,24 @@ static int s_decoder_on_done(void *user_data) {
         return AWS_OP_SUCCESS;
     }
 
+    /* Any headers buffered since the main header block are trailing headers, which have no header-block-done */
+    if (incoming_stream->base.on_incoming_header_block &&
+        aws_array_list_length(&incoming_stream->base.incoming_header_block.headers) > 0) {
+        err = aws_http_stream_deliver_incoming_header_block(&incoming_stream->base, AWS_HTTP_HEADER_BLOCK_TRAILING);
+        aws_http_header_block_buffer_reset(&incoming_stream->base.incoming_header_block);
+        if (err) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    /* Ensure the compressed body wasn't cut short */
+    if (incoming_stream->incoming_body_decompressor) {
+        err = aws_http_decompressor_finish(incoming_stream->incoming_body_decompressor);
+        if (err) {
+            return AWS_OP_ERR;
+        }
+    }
+
     /* Otherwise the incoming stream is finished decoding and we will update it if needed */
     incoming_stream->is_incoming_message_done = true;
 
@@ -1232,6 +2103,11 @@ static int s_decoder_on_done(void *user_data) {
         s_stream_complete(incoming_stream, AWS_ERROR_SUCCESS);
 
         s_client_update_incoming_stream_ptr(connection);
+
+        /* If the outgoing stream task stopped because the pipelining depth was reached, it can resume now */
+        if (connection->max_pipelined_requests) {
+            s_wake_outgoing_stream_task(connection);
+        }
     }
 
     /* Report success even if user's on_complete() callback shuts down on the connection.
@@ -1274,6 +2150,11 @@ static struct h1_connection *s_connection_new(
     aws_channel_task_init(
         &connection->outgoing_stream_task, s_outgoing_stream_task, connection, "http1_outgoing_stream");
     aws_channel_task_init(&connection->window_update_task, s_update_window_task, connection, "http1_update_window");
+    aws_channel_task_init(
+        &connection->expect_continue_timeout_task,
+        s_expect_continue_timeout_task,
+        connection,
+        "http1_expect_continue_timeout");
     aws_linked_list_init(&connection->thread_data.stream_list);
     aws_linked_list_init(&connection->thread_data.midchannel_read_messages);
     aws_crt_statistics_http1_channel_init(&connection->thread_data.stats);
@@ -1338,7 +2219,8 @@ struct aws_http_connection *aws_http_connection_new_http1_1_server(
 struct aws_http_connection *aws_http_connection_new_http1_1_client(
     struct aws_allocator *allocator,
     bool manual_window_management,
-    size_t initial_window_size) {
+    size_t initial_window_size,
+    size_t max_pipelined_requests) {
 
     struct h1_connection *connection =
         s_connection_new(allocator, manual_window_management, initial_window_size, false);
@@ -1347,6 +2229,7 @@ struct aws_http_connection *aws_http_connection_new_http1_1_client(
     }
 
     connection->base.client_data = &connection->base.client_or_server_data.client;
+    connection->max_pipelined_requests = max_pipelined_requests;
 
     return &connection->base;
 }
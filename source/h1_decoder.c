@@ -37,7 +37,12 @@ typedef int(linestate_fn)(struct aws_h1_decoder *decoder, struct aws_byte_cursor
 struct aws_h1_decoder {
     /* Implementation data. */
     struct aws_allocator *alloc;
+    /* Holds a line that spans multiple calls to aws_h1_decode(). Never grows beyond max_line_size. */
     struct aws_byte_buf scratch_space;
+    size_t max_line_size;
+    /* Index of first ':' in the line being scanned, or SIZE_MAX if none found yet.
+     * Recorded while scanning for CRLF, so header lines needn't be scanned again to split name from value. */
+    size_t line_colon_index;
     state_fn *run_state;
     linestate_fn *process_line;
     int transfer_encoding;
@@ -66,15 +71,25 @@ static int s_linestate_chunk_size(struct aws_h1_decoder *decoder, struct aws_byt
 static bool s_scan_for_crlf(struct aws_h1_decoder *decoder, struct aws_byte_cursor input, size_t *bytes_processed) {
     AWS_ASSERT(input.len > 0);
 
-    /* In a loop, scan for "\n", then look one char back for "\r" */
-    uint8_t *ptr = input.ptr;
-    uint8_t *end = input.ptr + input.len;
-    while (ptr != end) {
-        uint8_t *newline = (uint8_t *)memchr(ptr, '\n', end - ptr);
-        if (!newline) {
+    /* Any previous data for this line is in scratch_space, so line indices begin after it */
+    const size_t line_offset = decoder->scratch_space.len;
+
+    /* In a loop, scan for "\n", then look one char back for "\r".
+     * The scan also notes the first ':' it passes, for use by s_linestate_header() */
+    struct aws_byte_cursor remaining = input;
+    while (remaining.len > 0) {
+        size_t colon_index;
+        size_t newline_index = aws_strutil_scan_for_newline(remaining, &colon_index);
+
+        if (colon_index != SIZE_MAX && decoder->line_colon_index == SIZE_MAX) {
+            decoder->line_colon_index = line_offset + (size_t)(remaining.ptr - input.ptr) + colon_index;
+        }
+
+        if (newline_index == remaining.len) {
             break;
         }
 
+        const uint8_t *newline = remaining.ptr + newline_index;
         uint8_t prev_char;
         if (newline == input.ptr) {
             /* If "\n" is first character check scratch_space for previous character */
@@ -92,7 +107,7 @@ static bool s_scan_for_crlf(struct aws_h1_decoder *decoder, struct aws_byte_curs
             return true;
         }
 
-        ptr = newline + 1;
+        aws_byte_cursor_advance(&remaining, newline_index + 1);
     }
 
     *bytes_processed = input.len;
@@ -101,21 +116,25 @@ static bool s_scan_for_crlf(struct aws_h1_decoder *decoder, struct aws_byte_curs
 
 static int s_cat(struct aws_h1_decoder *decoder, struct aws_byte_cursor to_append) {
     struct aws_byte_buf *buffer = &decoder->scratch_space;
-    int op = AWS_OP_ERR;
-    if (buffer->buffer != NULL) {
-        if ((aws_byte_buf_append(buffer, &to_append) == AWS_OP_SUCCESS)) {
-            op = AWS_OP_SUCCESS;
-        }
+
+    if (to_append.len > decoder->max_line_size - buffer->len) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: Incoming line exceeds limit of %zu bytes.",
+            decoder->logging_id,
+            decoder->max_line_size);
+        return aws_raise_error(AWS_ERROR_HTTP_PROTOCOL_ERROR);
     }
 
-    if (op != AWS_OP_SUCCESS) {
+    if (to_append.len > buffer->capacity - buffer->len) {
+        /* Double capacity until there's room, but never exceed the max */
         size_t new_size = buffer->capacity ? buffer->capacity : 128;
-        do {
-            new_size <<= 1;      /* new_size *= 2 */
-            if (new_size == 0) { /* check for overflow */
-                return aws_raise_error(AWS_ERROR_OOM);
-            }
-        } while (new_size < (buffer->len + to_append.len));
+        while (new_size < buffer->len + to_append.len) {
+            new_size <<= 1; /* new_size *= 2 */
+        }
+        if (new_size > decoder->max_line_size) {
+            new_size = decoder->max_line_size;
+        }
 
         uint8_t *new_data = aws_mem_acquire(buffer->allocator, new_size);
         if (!new_data) {
@@ -129,17 +148,16 @@ static int s_cat(struct aws_h1_decoder *decoder, struct aws_byte_cursor to_appen
         aws_mem_release(buffer->allocator, buffer->buffer);
         buffer->capacity = new_size;
         buffer->buffer = new_data;
-
-        return aws_byte_buf_append(buffer, &to_append);
     }
 
-    return op;
+    return aws_byte_buf_append(buffer, &to_append);
 }
 
 /* This state consumes an entire line, then calls a linestate_fn to process the line. */
 static int s_state_getline(struct aws_h1_decoder *decoder, struct aws_byte_cursor *input) {
     /* If preceding runs of this state failed to find CRLF, their data is stored in the scratch_space
-     * and new data needs to be combined with the old data for processing. */
+     * and new data needs to be combined with the old data for processing.
+     * Otherwise, the line is passed along as a cursor into the input, without copying. */
     bool has_prev_data = decoder->scratch_space.len;
 
     size_t line_length = 0;
@@ -163,6 +181,15 @@ static int s_state_getline(struct aws_h1_decoder *decoder, struct aws_byte_curso
         }
         /* Line is actually the entire scratch buffer now */
         line = aws_byte_cursor_from_buf(&decoder->scratch_space);
+
+    } else if (AWS_UNLIKELY(line.len > decoder->max_line_size)) {
+        /* Enforce the same limit on lines that arrived whole, so it doesn't depend on how the data was split up */
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: Incoming line exceeds limit of %zu bytes.",
+            decoder->logging_id,
+            decoder->max_line_size);
+        return aws_raise_error(AWS_ERROR_HTTP_PROTOCOL_ERROR);
     }
 
     if (AWS_LIKELY(found_crlf)) {
@@ -229,6 +256,7 @@ static int s_cursor_split_exactly_n_times(
 
 static void s_set_state(struct aws_h1_decoder *decoder, state_fn *state) {
     decoder->scratch_space.len = 0;
+    decoder->line_colon_index = SIZE_MAX;
     decoder->run_state = state;
     decoder->process_line = NULL;
 }
@@ -425,17 +453,18 @@ static int s_linestate_header(struct aws_h1_decoder *decoder, struct aws_byte_cu
 
     /* Each header field consists of a case-insensitive field name followed by a colon (":"),
      * optional leading whitespace, the field value, and optional trailing whitespace.
-     * RFC-7230 3.2 */
-    struct aws_byte_cursor splits[2];
-    err = s_cursor_split_first_n_times(input, ':', splits, 2); /* value may contain more colons */
-    if (err) {
+     * RFC-7230 3.2
+     * The first colon was already found while scanning for CRLF. Value may contain more colons. */
+    if (decoder->line_colon_index >= input.len) {
         AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=%p: Invalid incoming header, missing colon.", decoder->logging_id);
         AWS_LOGF_DEBUG(
             AWS_LS_HTTP_STREAM, "id=%p: Bad header is: '" PRInSTR "'", decoder->logging_id, AWS_BYTE_CURSOR_PRI(input));
         return aws_raise_error(AWS_ERROR_HTTP_PROTOCOL_ERROR);
     }
 
-    struct aws_byte_cursor name = splits[0];
+    struct aws_byte_cursor input_remaining = input;
+    struct aws_byte_cursor name = aws_byte_cursor_advance(&input_remaining, decoder->line_colon_index);
+    aws_byte_cursor_advance(&input_remaining, 1); /* skip colon */
     if (name.len == 0 || !aws_strutil_is_http_token(name)) {
         AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=%p: Invalid incoming header, bad name.", decoder->logging_id);
         AWS_LOGF_DEBUG(
@@ -443,7 +472,7 @@ static int s_linestate_header(struct aws_h1_decoder *decoder, struct aws_byte_cu
         return aws_raise_error(AWS_ERROR_HTTP_PROTOCOL_ERROR);
     }
 
-    struct aws_byte_cursor value = aws_strutil_trim_http_whitespace(splits[1]);
+    struct aws_byte_cursor value = aws_strutil_trim_http_whitespace(input_remaining);
 
     struct aws_h1_decoded_header header;
     header.name = aws_http_str_to_header_name(name);
@@ -716,7 +745,16 @@ struct aws_h1_decoder *aws_h1_decoder_new(struct aws_h1_decoder_params *params)
     decoder->vtable = params->vtable;
     decoder->is_decoding_requests = params->is_decoding_requests;
 
-    aws_byte_buf_init(&decoder->scratch_space, params->alloc, params->scratch_space_initial_size);
+    decoder->max_line_size = params->max_line_size ? params->max_line_size : AWS_H1_DECODER_DEFAULT_MAX_LINE_SIZE;
+
+    size_t scratch_initial_size = params->scratch_space_initial_size;
+    if (scratch_initial_size > decoder->max_line_size) {
+        scratch_initial_size = decoder->max_line_size;
+    }
+    if (aws_byte_buf_init(&decoder->scratch_space, params->alloc, scratch_initial_size)) {
+        aws_mem_release(params->alloc, decoder);
+        return NULL;
+    }
 
     s_reset_state(decoder);
 
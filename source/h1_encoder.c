@@ -19,24 +19,137 @@
 #include <aws/io/stream.h>
 
 #include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
 
 #define ENCODER_LOGF(level, encoder, text, ...)                                                                        \
     AWS_LOGF_##level(AWS_LS_HTTP_STREAM, "id=%p: " text, encoder->logging_id, __VA_ARGS__)
 #define ENCODER_LOG(level, encoder, text) ENCODER_LOGF(level, encoder, "%s", text)
 
+static const struct aws_byte_cursor s_date_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Date");
+
 /**
- * Scan headers to detect errors and determine anything we'll need to know later (ex: total length).
+ * Response-lines, "HTTP/1.1 {status} {status_text}\r\n", rendered once for every status code with known text.
+ * Indexed by (status code - 100). Entries are empty for codes without known text, those are rendered per-response.
+ * Written once by aws_h1_status_lines_init(), read-only afterwards.
  */
-static int s_scan_outgoing_headers(
+enum {
+    STATUS_LINE_MIN_CODE = 100,
+    STATUS_LINE_MAX_CODE = 599,
+};
+static struct aws_byte_cursor s_status_lines[STATUS_LINE_MAX_CODE - STATUS_LINE_MIN_CODE + 1];
+static struct aws_byte_buf s_status_lines_storage;
+
+void aws_h1_status_lines_init(struct aws_allocator *allocator) {
+    struct aws_byte_cursor version = aws_http_version_to_str(AWS_HTTP_VERSION_1_1);
+
+    /* First pass measures, second pass writes. Cursors can't be taken until the storage stops moving. */
+    size_t total_len = 0;
+    for (int code = STATUS_LINE_MIN_CODE; code <= STATUS_LINE_MAX_CODE; ++code) {
+        size_t text_len = aws_byte_cursor_from_c_str(aws_http_status_text(code)).len;
+        if (text_len > 0) {
+            total_len += version.len + 5 /* " {3 digits} " */ + text_len + 2 /* "\r\n" */;
+        }
+    }
+
+    int result = aws_byte_buf_init(&s_status_lines_storage, allocator, total_len);
+    AWS_FATAL_ASSERT(AWS_OP_SUCCESS == result);
+
+    for (int code = STATUS_LINE_MIN_CODE; code <= STATUS_LINE_MAX_CODE; ++code) {
+        struct aws_byte_cursor text = aws_byte_cursor_from_c_str(aws_http_status_text(code));
+        if (text.len == 0) {
+            continue;
+        }
+
+        char code_str[4] = "XXX";
+        snprintf(code_str, sizeof(code_str), "%03d", code);
+
+        uint8_t *line_start = s_status_lines_storage.buffer + s_status_lines_storage.len;
+        bool wrote_all = true;
+        wrote_all &= aws_byte_buf_write_from_whole_cursor(&s_status_lines_storage, version);
+        wrote_all &= aws_byte_buf_write_u8(&s_status_lines_storage, ' ');
+        wrote_all &= aws_byte_buf_write(&s_status_lines_storage, (const uint8_t *)code_str, 3);
+        wrote_all &= aws_byte_buf_write_u8(&s_status_lines_storage, ' ');
+        wrote_all &= aws_byte_buf_write_from_whole_cursor(&s_status_lines_storage, text);
+        wrote_all &= aws_byte_buf_write_u8(&s_status_lines_storage, '\r');
+        wrote_all &= aws_byte_buf_write_u8(&s_status_lines_storage, '\n');
+        AWS_FATAL_ASSERT(wrote_all);
+
+        s_status_lines[code - STATUS_LINE_MIN_CODE] = aws_byte_cursor_from_array(
+            line_start, (size_t)(s_status_lines_storage.buffer + s_status_lines_storage.len - line_start));
+    }
+}
+
+void aws_h1_status_lines_clean_up(void) {
+    aws_byte_buf_clean_up(&s_status_lines_storage);
+    AWS_ZERO_ARRAY(s_status_lines);
+}
+
+/* Returns the pre-rendered response-line for this status code, or an empty cursor if there isn't one */
+static struct aws_byte_cursor s_get_status_line(int status_code) {
+    if (status_code < STATUS_LINE_MIN_CODE || status_code > STATUS_LINE_MAX_CODE) {
+        struct aws_byte_cursor empty;
+        AWS_ZERO_STRUCT(empty);
+        return empty;
+    }
+    return s_status_lines[status_code - STATUS_LINE_MIN_CODE];
+}
+
+/**
+ * Scan a Transfer-Encoding header value.
+ * The only coding we support sending is "chunked", and it must be the final coding.
+ */
+static int s_scan_outgoing_transfer_encoding(
+    struct aws_h1_encoder_message *encoder_message,
+    struct aws_byte_cursor header_value) {
+
+    struct aws_byte_cursor split;
+    AWS_ZERO_STRUCT(split);
+    while (aws_byte_cursor_next_split(&header_value, ',', &split)) {
+        struct aws_byte_cursor coding = aws_strutil_trim_http_whitespace(split);
+        if (coding.len == 0) {
+            continue;
+        }
+
+        /* RFC-7230 3.3.1: If any transfer coding other than chunked is applied to a request payload body,
+         * the sender MUST apply chunked as the final transfer coding */
+        if (encoder_message->has_chunked_encoding_header) {
+            AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=static: Transfer-Encoding lists a coding after 'chunked'");
+            return aws_raise_error(AWS_ERROR_HTTP_INVALID_HEADER_VALUE);
+        }
+
+        if (aws_byte_cursor_eq_c_str_ignore_case(&coding, "chunked")) {
+            encoder_message->has_chunked_encoding_header = true;
+        } else {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM,
+                "id=static: Sending Transfer-Encoding '" PRInSTR "' is not supported",
+                AWS_BYTE_CURSOR_PRI(coding));
+            return aws_raise_error(AWS_ERROR_UNIMPLEMENTED);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Results of scanning one or more lists of outgoing headers */
+struct outgoing_header_scan {
+    size_t header_lines_len;
+    bool has_content_length_header;
+    bool has_transfer_encoding_header;
+    bool has_body_headers;
+};
+
+/**
+ * Scan a message's headers to detect errors and determine anything we'll need to know later (ex: total length).
+ * Results are accumulated into `encoder_message` and `scan`, so multiple header lists may be scanned in sequence.
+ */
+static int s_scan_outgoing_header_list(
     struct aws_h1_encoder_message *encoder_message,
     const struct aws_http_message *message,
-    size_t *out_header_lines_len,
-    bool body_headers_ignored,
-    bool body_headers_forbidden) {
+    struct outgoing_header_scan *scan) {
 
-    size_t total = 0;
-    bool has_body_stream = aws_http_message_get_body_stream(message);
-    bool has_body_headers = false;
+    size_t total = scan->header_lines_len;
 
     const size_t num_headers = aws_http_message_get_header_count(message);
     for (size_t i = 0; i < num_headers; ++i) {
@@ -52,18 +165,34 @@ static int s_scan_outgoing_headers(
                 }
             } break;
             case AWS_HTTP_HEADER_CONTENT_LENGTH: {
+                scan->has_content_length_header = true;
                 struct aws_byte_cursor trimmed_value = aws_strutil_trim_http_whitespace(header.value);
                 if (aws_strutil_read_unsigned_num(trimmed_value, &encoder_message->content_length)) {
                     AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=static: Invalid Content-Length");
                     return aws_raise_error(AWS_ERROR_HTTP_INVALID_HEADER_VALUE);
                 }
                 if (encoder_message->content_length > 0) {
-                    has_body_headers = true;
+                    scan->has_body_headers = true;
                 }
             } break;
             case AWS_HTTP_HEADER_TRANSFER_ENCODING:
-                AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=static: Sending of chunked messages not yet implemented");
-                return aws_raise_error(AWS_ERROR_UNIMPLEMENTED);
+                scan->has_transfer_encoding_header = true;
+                if (s_scan_outgoing_transfer_encoding(encoder_message, header.value)) {
+                    return AWS_OP_ERR;
+                }
+                if (encoder_message->has_chunked_encoding_header) {
+                    scan->has_body_headers = true;
+                }
+                break;
+            case AWS_HTTP_HEADER_EXPECT: {
+                struct aws_byte_cursor trimmed_value = aws_strutil_trim_http_whitespace(header.value);
+                if (aws_byte_cursor_eq_c_str_ignore_case(&trimmed_value, "100-continue")) {
+                    encoder_message->has_expect_continue_header = true;
+                }
+            } break;
+            case AWS_HTTP_HEADER_DATE:
+                encoder_message->has_date_header = true;
+                break;
             default:
                 break;
         }
@@ -77,21 +206,72 @@ static int s_scan_outgoing_headers(
             return AWS_OP_ERR;
         }
     }
-    if (body_headers_forbidden && has_body_headers) {
+
+    scan->header_lines_len = total;
+    return AWS_OP_SUCCESS;
+}
+
+/**
+ * Once all header lists are scanned, check that the headers make sense as a whole.
+ */
+static int s_finish_outgoing_header_scan(
+    struct aws_h1_encoder_message *encoder_message,
+    struct outgoing_header_scan *scan,
+    bool has_body_stream,
+    bool body_headers_ignored,
+    bool body_headers_forbidden) {
+
+    /* RFC-7230 3.3.2: A sender MUST NOT send a Content-Length header field in any message that contains
+     * a Transfer-Encoding header field. */
+    if (scan->has_content_length_header && scan->has_transfer_encoding_header) {
+        AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=static: Both Content-Length and Transfer-Encoding are set");
+        return aws_raise_error(AWS_ERROR_HTTP_INVALID_HEADER_FIELD);
+    }
+
+    if (body_headers_forbidden && scan->has_body_headers) {
         return aws_raise_error(AWS_ERROR_HTTP_INVALID_HEADER_FIELD);
     }
 
     if (body_headers_ignored) {
         /* Don't send body, no matter what the headers are */
-        has_body_headers = false;
+        scan->has_body_headers = false;
         encoder_message->content_length = 0;
+        encoder_message->has_chunked_encoding_header = false;
     }
 
-    if (has_body_headers && !has_body_stream) {
+    /* Body data for chunked messages comes from aws_http1_stream_write_chunk(),
+     * unless there's a body stream, whose data is sent as a series of chunks */
+    if (!encoder_message->has_chunked_encoding_header && scan->has_body_headers && !has_body_stream) {
         return aws_raise_error(AWS_ERROR_HTTP_MISSING_BODY_STREAM);
     }
 
-    *out_header_lines_len = total;
+    return AWS_OP_SUCCESS;
+}
+
+/**
+ * Scan headers to detect errors and determine anything we'll need to know later (ex: total length).
+ */
+static int s_scan_outgoing_headers(
+    struct aws_h1_encoder_message *encoder_message,
+    const struct aws_http_message *message,
+    size_t *out_header_lines_len,
+    bool body_headers_ignored,
+    bool body_headers_forbidden) {
+
+    struct outgoing_header_scan scan;
+    AWS_ZERO_STRUCT(scan);
+
+    if (s_scan_outgoing_header_list(encoder_message, message, &scan)) {
+        return AWS_OP_ERR;
+    }
+
+    bool has_body_stream = aws_http_message_get_body_stream(message);
+    if (s_finish_outgoing_header_scan(
+            encoder_message, &scan, has_body_stream, body_headers_ignored, body_headers_forbidden)) {
+        return AWS_OP_ERR;
+    }
+
+    *out_header_lines_len = scan.header_lines_len;
     return AWS_OP_SUCCESS;
 }
 
@@ -115,14 +295,61 @@ static void s_write_headers(struct aws_byte_buf *dst, const struct aws_http_mess
     AWS_ASSERT(wrote_all);
 }
 
+/**
+ * If the message's body is in caller-owned memory, remember it so the body can be sent without copying.
+ * Must be called after headers are scanned.
+ */
+static int s_init_body_data(struct aws_h1_encoder_message *encoder_message, const struct aws_http_message *message) {
+    struct aws_byte_cursor body_data;
+    if (!aws_http_message_get_body_data(message, &body_data) || encoder_message->content_length == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (body_data.len != encoder_message->content_length) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=static: Body data length %zu does not match Content-Length: %" PRIu64,
+            body_data.len,
+            encoder_message->content_length);
+        return aws_raise_error(AWS_ERROR_HTTP_OUTGOING_STREAM_LENGTH_INCORRECT);
+    }
+
+    encoder_message->body_data = body_data;
+    /* Only the message's atomic refcount is ever modified through this pointer */
+    encoder_message->body_data_owner = (struct aws_http_message *)message;
+    return AWS_OP_SUCCESS;
+}
+
+/* request-line: "{method} {uri} {version}\r\n" */
+static bool s_write_request_line(
+    struct aws_byte_buf *dst,
+    struct aws_byte_cursor method,
+    struct aws_byte_cursor uri,
+    struct aws_byte_cursor version) {
+
+    bool wrote_all = true;
+    wrote_all &= aws_byte_buf_write_from_whole_cursor(dst, method);
+    wrote_all &= aws_byte_buf_write_u8(dst, ' ');
+    wrote_all &= aws_byte_buf_write_from_whole_cursor(dst, uri);
+    wrote_all &= aws_byte_buf_write_u8(dst, ' ');
+    wrote_all &= aws_byte_buf_write_from_whole_cursor(dst, version);
+    wrote_all &= aws_byte_buf_write_u8(dst, '\r');
+    wrote_all &= aws_byte_buf_write_u8(dst, '\n');
+    return wrote_all;
+}
+
 int aws_h1_encoder_message_init_from_request(
     struct aws_h1_encoder_message *message,
     struct aws_allocator *allocator,
-    const struct aws_http_message *request) {
+    const struct aws_http_message *request,
+    struct aws_linked_list *pending_chunk_list) {
+
+    AWS_PRECONDITION(aws_linked_list_is_valid(pending_chunk_list));
 
     AWS_ZERO_STRUCT(*message);
 
     message->body = aws_http_message_get_body_stream(request);
+    message->pending_chunk_list = pending_chunk_list;
 
     struct aws_byte_cursor method;
     int err = aws_http_message_get_request_method(request, &method);
@@ -151,6 +378,11 @@ int aws_h1_encoder_message_init_from_request(
         goto error;
     }
 
+    err = s_init_body_data(message, request);
+    if (err) {
+        goto error;
+    }
+
     /* request-line: "{method} {uri} {version}\r\n" */
     size_t request_line_len = 4; /* 2 spaces + "\r\n" */
     err |= aws_add_size_checked(method.len, request_line_len, &request_line_len);
@@ -172,16 +404,194 @@ int aws_h1_encoder_message_init_from_request(
         goto error;
     }
 
-    bool wrote_all = true;
+    bool wrote_all = s_write_request_line(&message->outgoing_head_buf, method, uri, version);
+
+    s_write_headers(&message->outgoing_head_buf, request);
 
-    wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, method);
-    wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, ' ');
-    wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, uri);
-    wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, ' ');
-    wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, version);
     wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, '\r');
     wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, '\n');
+    (void)wrote_all;
+    AWS_ASSERT(wrote_all);
+
+    return AWS_OP_SUCCESS;
+error:
+    aws_h1_encoder_message_clean_up(message);
+    return AWS_OP_ERR;
+}
+
+/**
+ * The invariant parts of a request head, validated and serialized once.
+ */
+struct aws_http1_request_template {
+    struct aws_allocator *allocator;
+
+    /* Holds the method, followed by the pre-encoded header lines */
+    struct aws_byte_buf storage;
+    struct aws_byte_cursor method;
+    struct aws_byte_cursor header_lines;
+
+    /* Results from scanning the template's headers, used to seed the scan of each request's headers */
+    struct outgoing_header_scan scan;
+    uint64_t content_length;
+    bool has_connection_close_header;
+    bool has_chunked_encoding_header;
+    bool has_expect_continue_header;
+};
+
+struct aws_http1_request_template *aws_http1_request_template_new(
+    struct aws_allocator *allocator,
+    const struct aws_http_message *prototype) {
+
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(prototype);
+
+    if (!aws_http_message_is_request(prototype)) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_byte_cursor method;
+    if (aws_http_message_get_request_method(prototype, &method)) {
+        aws_raise_error(AWS_ERROR_HTTP_INVALID_METHOD);
+        return NULL;
+    }
+
+    struct aws_http1_request_template *request_template =
+        aws_mem_calloc(allocator, 1, sizeof(struct aws_http1_request_template));
+    if (!request_template) {
+        return NULL;
+    }
+
+    request_template->allocator = allocator;
+
+    /* Scan headers once, so each request only needs to scan its own headers */
+    struct aws_h1_encoder_message scan_message;
+    AWS_ZERO_STRUCT(scan_message);
+    if (s_scan_outgoing_header_list(&scan_message, prototype, &request_template->scan)) {
+        goto error;
+    }
+
+    request_template->content_length = scan_message.content_length;
+    request_template->has_connection_close_header = scan_message.has_connection_close_header;
+    request_template->has_chunked_encoding_header = scan_message.has_chunked_encoding_header;
+    request_template->has_expect_continue_header = scan_message.has_expect_continue_header;
+
+    size_t storage_size = 0;
+    if (aws_add_size_checked(method.len, request_template->scan.header_lines_len, &storage_size)) {
+        goto error;
+    }
+
+    if (aws_byte_buf_init(&request_template->storage, allocator, storage_size)) {
+        goto error;
+    }
+
+    aws_byte_buf_write_from_whole_cursor(&request_template->storage, method);
+    s_write_headers(&request_template->storage, prototype);
+    AWS_ASSERT(request_template->storage.len == storage_size);
+
+    struct aws_byte_cursor storage_cursor = aws_byte_cursor_from_buf(&request_template->storage);
+    request_template->method = aws_byte_cursor_advance(&storage_cursor, method.len);
+    request_template->header_lines = storage_cursor;
+
+    return request_template;
+
+error:
+    aws_http1_request_template_destroy(request_template);
+    return NULL;
+}
+
+void aws_http1_request_template_destroy(struct aws_http1_request_template *request_template) {
+    if (!request_template) {
+        return;
+    }
 
+    aws_byte_buf_clean_up(&request_template->storage);
+    aws_mem_release(request_template->allocator, request_template);
+}
+
+struct aws_byte_cursor aws_h1_request_template_get_method(const struct aws_http1_request_template *request_template) {
+    AWS_PRECONDITION(request_template);
+    return request_template->method;
+}
+
+int aws_h1_encoder_message_init_from_template(
+    struct aws_h1_encoder_message *message,
+    struct aws_allocator *allocator,
+    const struct aws_http1_request_template *request_template,
+    const struct aws_http_message *request,
+    struct aws_linked_list *pending_chunk_list) {
+
+    AWS_PRECONDITION(aws_linked_list_is_valid(pending_chunk_list));
+
+    AWS_ZERO_STRUCT(*message);
+
+    message->body = aws_http_message_get_body_stream(request);
+    message->pending_chunk_list = pending_chunk_list;
+
+    /* Start from what was learned scanning the template's headers */
+    message->content_length = request_template->content_length;
+    message->has_connection_close_header = request_template->has_connection_close_header;
+    message->has_chunked_encoding_header = request_template->has_chunked_encoding_header;
+    message->has_expect_continue_header = request_template->has_expect_continue_header;
+
+    /* The method comes from the template. The request needn't have one, but it mustn't contradict the template */
+    struct aws_byte_cursor request_method;
+    if (aws_http_message_get_request_method(request, &request_method) == AWS_OP_SUCCESS &&
+        !aws_byte_cursor_eq(&request_method, &request_template->method)) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        goto error;
+    }
+
+    struct aws_byte_cursor uri;
+    int err = aws_http_message_get_request_path(request, &uri);
+    if (err) {
+        aws_raise_error(AWS_ERROR_HTTP_INVALID_PATH);
+        goto error;
+    }
+
+    struct aws_byte_cursor version = aws_http_version_to_str(AWS_HTTP_VERSION_1_1);
+
+    /* Only the request's own headers need scanning */
+    struct outgoing_header_scan scan = request_template->scan;
+    err = s_scan_outgoing_header_list(message, request, &scan);
+    if (err) {
+        goto error;
+    }
+
+    err = s_finish_outgoing_header_scan(
+        message,
+        &scan,
+        message->body != NULL,
+        false /*body_headers_ignored*/,
+        false /*body_headers_forbidden*/);
+    if (err) {
+        goto error;
+    }
+
+    err = s_init_body_data(message, request);
+    if (err) {
+        goto error;
+    }
+
+    /* request-line + header-lines + head-end */
+    size_t head_total_len = 4 + 2; /* 2 spaces + "\r\n" + "\r\n" */
+    err |= aws_add_size_checked(request_template->method.len, head_total_len, &head_total_len);
+    err |= aws_add_size_checked(uri.len, head_total_len, &head_total_len);
+    err |= aws_add_size_checked(version.len, head_total_len, &head_total_len);
+    err |= aws_add_size_checked(scan.header_lines_len, head_total_len, &head_total_len);
+    if (err) {
+        goto error;
+    }
+
+    err = aws_byte_buf_init(&message->outgoing_head_buf, allocator, head_total_len);
+    if (err) {
+        goto error;
+    }
+
+    bool wrote_all = s_write_request_line(&message->outgoing_head_buf, request_template->method, uri, version);
+
+    /* Invariant header lines are copied as-is, then the request's own headers follow */
+    wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, request_template->header_lines);
     s_write_headers(&message->outgoing_head_buf, request);
 
     wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, '\r');
@@ -199,13 +609,16 @@ int aws_h1_encoder_message_init_from_response(
     struct aws_h1_encoder_message *message,
     struct aws_allocator *allocator,
     const struct aws_http_message *response,
-    bool body_headers_ignored) {
+    bool body_headers_ignored,
+    bool add_date_header,
+    struct aws_linked_list *pending_chunk_list) {
+
+    AWS_PRECONDITION(aws_linked_list_is_valid(pending_chunk_list));
 
     AWS_ZERO_STRUCT(*message);
 
     message->body = aws_http_message_get_body_stream(response);
-
-    struct aws_byte_cursor version = aws_http_version_to_str(AWS_HTTP_VERSION_1_1);
+    message->pending_chunk_list = pending_chunk_list;
 
     int status_int;
     int err = aws_http_message_get_response_status(response, &status_int);
@@ -215,11 +628,22 @@ int aws_h1_encoder_message_init_from_response(
 
     /* Status code must fit in 3 digits */
     AWS_ASSERT(status_int >= 0 && status_int <= 999); /* aws_http_message should have already checked this */
-    char status_code_str[4] = "XXX";
-    snprintf(status_code_str, sizeof(status_code_str), "%03d", status_int);
-    struct aws_byte_cursor status_code = aws_byte_cursor_from_c_str(status_code_str);
 
-    struct aws_byte_cursor status_text = aws_byte_cursor_from_c_str(aws_http_status_text(status_int));
+    /* response-line: "{version} {status} {status_text}\r\n"
+     * Usually pre-rendered, only status codes without known text are rendered here */
+    struct aws_byte_cursor response_line = s_get_status_line(status_int);
+    char response_line_storage[64];
+    if (response_line.len == 0) {
+        int printed = snprintf(
+            response_line_storage,
+            sizeof(response_line_storage),
+            "HTTP/1.1 %03d %s\r\n",
+            status_int,
+            aws_http_status_text(status_int));
+        AWS_ASSERT(printed > 0 && (size_t)printed < sizeof(response_line_storage));
+        (void)printed;
+        response_line = aws_byte_cursor_from_c_str(response_line_storage);
+    }
 
     /**
      * Calculate total size needed for outgoing_head_buffer, then write to buffer.
@@ -237,16 +661,24 @@ int aws_h1_encoder_message_init_from_response(
         goto error;
     }
 
-    /* valid status must be three digital code, change it into byte_cursor */
-    /* response-line: "{version} {status} {status_text}\r\n" */
-    size_t response_line_len = 4; /* 2 spaces + "\r\n" */
-    err |= aws_add_size_checked(version.len, response_line_len, &response_line_len);
-    err |= aws_add_size_checked(status_code.len, response_line_len, &response_line_len);
-    err |= aws_add_size_checked(status_text.len, response_line_len, &response_line_len);
+    /* Expect is a request header, a server never waits before sending its body */
+    message->has_expect_continue_header = false;
+
+    err = s_init_body_data(message, response);
+    if (err) {
+        goto error;
+    }
+
+    /* date-line: "Date: {date}\r\n", value filled in later by aws_h1_encoder_message_set_date() */
+    add_date_header &= !message->has_date_header;
+    if (add_date_header) {
+        size_t date_line_len = s_date_header_name.len + AWS_H1_DATE_VALUE_LEN + 4; /* ": " + "\r\n" */
+        err |= aws_add_size_checked(date_line_len, header_lines_len, &header_lines_len);
+    }
 
     /* head-end: "\r\n" */
     size_t head_end_len = 2;
-    size_t head_total_len = response_line_len;
+    size_t head_total_len = response_line.len;
     err |= aws_add_size_checked(header_lines_len, head_total_len, &head_total_len);
     err |= aws_add_size_checked(head_end_len, head_total_len, &head_total_len);
     if (err) {
@@ -260,13 +692,19 @@ int aws_h1_encoder_message_init_from_response(
 
     bool wrote_all = true;
 
-    wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, version);
-    wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, ' ');
-    wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, status_code);
-    wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, ' ');
-    wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, status_text);
-    wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, '\r');
-    wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, '\n');
+    wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, response_line);
+
+    if (add_date_header) {
+        wrote_all &= aws_byte_buf_write_from_whole_cursor(&message->outgoing_head_buf, s_date_header_name);
+        wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, ':');
+        wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, ' ');
+        message->date_value_offset = message->outgoing_head_buf.len;
+        for (size_t i = 0; i < AWS_H1_DATE_VALUE_LEN; ++i) {
+            wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, ' ');
+        }
+        wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, '\r');
+        wrote_all &= aws_byte_buf_write_u8(&message->outgoing_head_buf, '\n');
+    }
 
     s_write_headers(&message->outgoing_head_buf, response);
 
@@ -283,11 +721,88 @@ error:
     return AWS_OP_ERR;
 }
 
+void aws_h1_encoder_message_set_date(struct aws_h1_encoder_message *message, struct aws_byte_cursor date) {
+    if (message->date_value_offset == 0) {
+        return;
+    }
+
+    AWS_ASSERT(date.len == AWS_H1_DATE_VALUE_LEN);
+    AWS_ASSERT(message->date_value_offset + AWS_H1_DATE_VALUE_LEN <= message->outgoing_head_buf.len);
+    memcpy(message->outgoing_head_buf.buffer + message->date_value_offset, date.ptr, AWS_H1_DATE_VALUE_LEN);
+}
+
+void aws_h1_encoder_message_omit_date(struct aws_h1_encoder_message *message) {
+    if (message->date_value_offset == 0) {
+        return;
+    }
+
+    /* Cut the whole reserved date-line out of the head: "Date: {date}\r\n" */
+    size_t line_start = message->date_value_offset - (s_date_header_name.len + 2);
+    size_t line_end = message->date_value_offset + AWS_H1_DATE_VALUE_LEN + 2;
+    AWS_ASSERT(line_end <= message->outgoing_head_buf.len);
+    memmove(
+        message->outgoing_head_buf.buffer + line_start,
+        message->outgoing_head_buf.buffer + line_end,
+        message->outgoing_head_buf.len - line_end);
+    message->outgoing_head_buf.len -= line_end - line_start;
+    message->date_value_offset = 0;
+}
+
 void aws_h1_encoder_message_clean_up(struct aws_h1_encoder_message *message) {
     aws_byte_buf_clean_up(&message->outgoing_head_buf);
     AWS_ZERO_STRUCT(*message);
 }
 
+struct aws_h1_chunk *aws_h1_chunk_new(struct aws_allocator *allocator, const struct aws_http1_chunk_options *options) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(options);
+
+    struct aws_h1_chunk *chunk = aws_mem_calloc(allocator, 1, sizeof(struct aws_h1_chunk));
+    if (!chunk) {
+        return NULL;
+    }
+
+    chunk->allocator = allocator;
+    chunk->data = options->chunk_data;
+    chunk->data_size = options->chunk_data_size;
+    chunk->on_complete = options->on_complete;
+    chunk->user_data = options->user_data;
+
+    /* chunk-line: "{hex size}\r\n" */
+    chunk->chunk_line = aws_byte_buf_from_empty_array(chunk->chunk_line_storage, sizeof(chunk->chunk_line_storage));
+    char size_str[AWS_H1_ENCODER_CHUNK_LINE_MAX_SIZE + 1];
+    int size_str_len = snprintf(size_str, sizeof(size_str), "%" PRIX64 "\r\n", chunk->data_size);
+    AWS_ASSERT(size_str_len > 0 && (size_t)size_str_len <= chunk->chunk_line.capacity);
+    bool wrote = aws_byte_buf_write(&chunk->chunk_line, (const uint8_t *)size_str, (size_t)size_str_len);
+    (void)wrote;
+    AWS_ASSERT(wrote);
+
+    return chunk;
+}
+
+void aws_h1_chunk_destroy(struct aws_h1_chunk *chunk) {
+    AWS_PRECONDITION(chunk);
+    aws_mem_release(chunk->allocator, chunk);
+}
+
+void aws_h1_chunk_complete_and_destroy(
+    struct aws_h1_chunk *chunk,
+    struct aws_http_stream *http_stream,
+    int error_code) {
+
+    AWS_PRECONDITION(chunk);
+
+    aws_http1_stream_write_chunk_complete_fn *on_complete = chunk->on_complete;
+    void *user_data = chunk->user_data;
+
+    /* Clean up before firing callback */
+    aws_h1_chunk_destroy(chunk);
+
+    if (on_complete) {
+        on_complete(http_stream, error_code, user_data);
+    }
+}
+
 void aws_h1_encoder_init(struct aws_h1_encoder *encoder, struct aws_allocator *allocator) {
     AWS_ZERO_STRUCT(*encoder);
     encoder->allocator = allocator;
@@ -300,7 +815,7 @@ void aws_h1_encoder_clean_up(struct aws_h1_encoder *encoder) {
 int aws_h1_encoder_start_message(
     struct aws_h1_encoder *encoder,
     struct aws_h1_encoder_message *message,
-    void *log_as_stream) {
+    struct aws_http_stream *stream) {
 
     AWS_PRECONDITION(encoder);
     AWS_PRECONDITION(message);
@@ -311,155 +826,543 @@ int aws_h1_encoder_start_message(
     }
 
     /* Can start writing head next */
-    encoder->logging_id = log_as_stream;
+    encoder->current_stream = stream;
+    encoder->logging_id = stream;
     encoder->message = message;
     encoder->state = AWS_H1_ENCODER_STATE_HEAD;
     encoder->progress_bytes = 0;
+    encoder->current_chunk = NULL;
 
     return AWS_OP_SUCCESS;
 }
 
-int aws_h1_encoder_process(struct aws_h1_encoder *encoder, struct aws_byte_buf *out_buf) {
-    AWS_PRECONDITION(encoder);
-    AWS_PRECONDITION(out_buf);
+/* Copy as much of `src` to `dst` as possible, using encoder->progress_bytes to track how much was already written.
+ * Returns true once all of `src` has been written. */
+static bool s_write_src_with_progress(
+    struct aws_h1_encoder *encoder,
+    struct aws_byte_cursor src,
+    struct aws_byte_buf *dst) {
 
-    if (!encoder->message) {
-        ENCODER_LOG(ERROR, encoder, "No message is currently set for encoding.");
-        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    AWS_ASSERT(encoder->progress_bytes <= src.len);
+    aws_byte_cursor_advance(&src, (size_t)encoder->progress_bytes);
+
+    size_t dst_available = dst->capacity - dst->len;
+    size_t transferring = src.len < dst_available ? src.len : dst_available;
+
+    bool success = aws_byte_buf_write(dst, src.ptr, transferring);
+    (void)success;
+    AWS_ASSERT(success);
+
+    encoder->progress_bytes += transferring;
+    return transferring == src.len;
+}
+
+/* Each state function writes as much as it can, and changes the state if it's done.
+ * If the state is unchanged when the function returns, no further progress can be made with this `dst` */
+typedef int encoder_state_fn(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst);
+
+static void s_switch_state(struct aws_h1_encoder *encoder, enum aws_h1_encoder_state state) {
+    encoder->state = state;
+    encoder->progress_bytes = 0;
+}
+
+static int s_state_fn_init(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    (void)dst;
+    ENCODER_LOG(ERROR, encoder, "Encoder is processing, but no message has been started.");
+    return aws_raise_error(AWS_ERROR_INVALID_STATE);
+}
+
+static bool s_has_body(const struct aws_h1_encoder_message *message) {
+    return message->has_chunked_encoding_header || (message->body && message->content_length);
+}
+
+static void s_switch_to_body_state(struct aws_h1_encoder *encoder) {
+    AWS_ASSERT(s_has_body(encoder->message));
+
+    if (encoder->message->has_chunked_encoding_header && encoder->message->body) {
+        s_switch_state(encoder, AWS_H1_ENCODER_STATE_CHUNKED_BODY_STREAM);
+    } else if (encoder->message->has_chunked_encoding_header) {
+        s_switch_state(encoder, AWS_H1_ENCODER_STATE_CHUNK_NEXT);
+    } else {
+        s_switch_state(encoder, AWS_H1_ENCODER_STATE_UNCHUNKED_BODY);
     }
+}
 
-    struct aws_byte_buf *dst = out_buf;
+static int s_state_fn_head(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    struct aws_byte_buf *src = &encoder->message->outgoing_head_buf;
+    bool done = s_write_src_with_progress(encoder, aws_byte_cursor_from_buf(src), dst);
+
+    ENCODER_LOGF(
+        TRACE,
+        encoder,
+        "Writing to message, outgoing head progress %" PRIu64 "/%zu.",
+        encoder->progress_bytes,
+        encoder->message->outgoing_head_buf.len);
+
+    if (!done) {
+        /* Can't write anymore */
+        ENCODER_LOG(TRACE, encoder, "Cannot fit any more head data in this message.");
+        return AWS_OP_SUCCESS;
+    }
 
-    if (encoder->state == AWS_H1_ENCODER_STATE_HEAD) {
-        size_t dst_available = dst->capacity - dst->len;
-        if (dst_available == 0) {
+    /* Don't NEED to free this buffer now, but we don't need it anymore, so why not */
+    aws_byte_buf_clean_up(&encoder->message->outgoing_head_buf);
+
+    if (!s_has_body(encoder->message)) {
+        ENCODER_LOG(TRACE, encoder, "Skipping body");
+        s_switch_state(encoder, AWS_H1_ENCODER_STATE_DONE);
+    } else if (encoder->message->has_expect_continue_header) {
+        ENCODER_LOG(TRACE, encoder, "Holding body until server sends 100-continue.");
+        s_switch_state(encoder, AWS_H1_ENCODER_STATE_AWAIT_CONTINUE);
+    } else {
+        s_switch_to_body_state(encoder);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Nothing is written until aws_h1_encoder_continue_body() or aws_h1_encoder_skip_body() is called */
+static int s_state_fn_await_continue(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    (void)encoder;
+    (void)dst;
+    return AWS_OP_SUCCESS;
+}
+
+/* Return the part of the body data that hasn't been sent yet */
+static struct aws_byte_cursor s_get_unsent_body_data(const struct aws_h1_encoder *encoder) {
+    struct aws_byte_cursor unsent = encoder->message->body_data;
+    aws_byte_cursor_advance(&unsent, (size_t)encoder->progress_bytes);
+    return unsent;
+}
+
+/**
+ * Body in caller-owned memory. If it all fits, copy it, since that's cheaper than another write.
+ * Otherwise, leave it for aws_h1_encoder_lend_body_data() to send without copying.
+ */
+static int s_state_fn_unchunked_body_data(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    struct aws_byte_cursor unsent = s_get_unsent_body_data(encoder);
+    if (unsent.len > dst->capacity - dst->len) {
+        ENCODER_LOG(TRACE, encoder, "Body data doesn't fit in this message, it will be lent out instead.");
+        return AWS_OP_SUCCESS;
+    }
+
+    aws_byte_buf_write_from_whole_cursor(dst, unsent);
+    encoder->progress_bytes += unsent.len;
+
+    ENCODER_LOGF(TRACE, encoder, "Writing %zu body bytes to message", unsent.len);
+    ENCODER_LOG(TRACE, encoder, "Done sending body.");
+    s_switch_state(encoder, AWS_H1_ENCODER_STATE_DONE);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_state_fn_unchunked_body(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    if (encoder->message->body_data_owner) {
+        return s_state_fn_unchunked_body_data(encoder, dst);
+    }
+
+    while (true) {
+        if (dst->capacity == dst->len) {
             /* Can't write anymore */
-            ENCODER_LOG(TRACE, encoder, "Cannot fit any more head data in this message.");
+            ENCODER_LOG(TRACE, encoder, "Cannot fit any more body data in this message");
+
+            /* Return success because we want to try again later */
             return AWS_OP_SUCCESS;
         }
 
-        /* Copy data from outgoing_head_buf */
-        struct aws_byte_buf *src = &encoder->message->outgoing_head_buf;
-        size_t src_progress = (size_t)encoder->progress_bytes;
-        size_t src_remaining = src->len - src_progress;
-        size_t transferring = src_remaining < dst_available ? src_remaining : dst_available;
+        const size_t prev_len = dst->len;
+        int err = aws_input_stream_read(encoder->message->body, dst);
+        const size_t amount_read = dst->len - prev_len;
+
+        if (err) {
+            ENCODER_LOGF(
+                ERROR,
+                encoder,
+                "Failed to read body stream, error %d (%s)",
+                aws_last_error(),
+                aws_error_name(aws_last_error()));
+
+            return AWS_OP_ERR;
+        }
+
+        if ((amount_read > encoder->message->content_length) ||
+            (encoder->progress_bytes > encoder->message->content_length - amount_read)) {
+            ENCODER_LOGF(
+                ERROR, encoder, "Body stream has exceeded Content-Length: %" PRIu64, encoder->message->content_length);
+            return aws_raise_error(AWS_ERROR_HTTP_OUTGOING_STREAM_LENGTH_INCORRECT);
+        }
 
-        bool success = aws_byte_buf_write(dst, src->buffer + src_progress, transferring);
-        (void)success;
-        AWS_ASSERT(success);
+        encoder->progress_bytes += amount_read;
 
-        encoder->progress_bytes += transferring;
+        ENCODER_LOGF(TRACE, encoder, "Writing %zu body bytes to message", amount_read);
 
-        ENCODER_LOGF(
-            TRACE,
-            encoder,
-            "Writing to message, outgoing head progress %" PRIu64 "/%zu.",
-            encoder->progress_bytes,
-            encoder->message->outgoing_head_buf.len);
+        if (encoder->progress_bytes == encoder->message->content_length) {
+            ENCODER_LOG(TRACE, encoder, "Done sending body.");
+            s_switch_state(encoder, AWS_H1_ENCODER_STATE_DONE);
+            return AWS_OP_SUCCESS;
+        }
 
-        if (encoder->progress_bytes == src->len) {
-            /* Don't NEED to free this buffer now, but we don't need it anymore, so why not */
-            aws_byte_buf_clean_up(&encoder->message->outgoing_head_buf);
+        /* Return if user failed to write anything. Maybe their data isn't ready yet. */
+        if (amount_read == 0) {
+            /* Ensure we're not at end-of-stream too early */
+            struct aws_stream_status status;
+            err = aws_input_stream_get_status(encoder->message->body, &status);
+            if (err) {
+                ENCODER_LOGF(
+                    TRACE,
+                    encoder,
+                    "Failed to query body stream status, error %d (%s)",
+                    aws_last_error(),
+                    aws_error_name(aws_last_error()));
+
+                return AWS_OP_ERR;
+            }
+            if (status.is_end_of_stream) {
+                ENCODER_LOGF(
+                    ERROR,
+                    encoder,
+                    "Reached end of body stream before Content-Length: %" PRIu64 " sent",
+                    encoder->message->content_length);
+                return aws_raise_error(AWS_ERROR_HTTP_OUTGOING_STREAM_LENGTH_INCORRECT);
+            }
 
-            encoder->progress_bytes = 0;
-            encoder->state++;
+            ENCODER_LOG(
+                TRACE,
+                encoder,
+                "No body data written, concluding this message. "
+                "Will try to write body data again in the next message.");
+            return AWS_OP_SUCCESS;
         }
+
+        /* Stay in this state, there's still space in dst to try and fill */
     }
+}
 
-    if (encoder->state == AWS_H1_ENCODER_STATE_BODY) {
-        if (!encoder->message->body || !encoder->message->content_length) {
-            ENCODER_LOG(TRACE, encoder, "Skipping body")
-            encoder->state++;
-        } else {
-            while (true) {
-                if (dst->capacity == dst->len) {
-                    /* Can't write anymore */
-                    ENCODER_LOG(TRACE, encoder, "Cannot fit any more body data in this message");
+/**
+ * Body stream of a chunked message. Whatever each read from the stream produces is sent as one chunk,
+ * and the final chunk is sent once the stream reaches its end.
+ */
+static int s_state_fn_chunked_body_stream(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    while (true) {
+        /* Only start a chunk if its chunk-size line, at least 1 byte of data, and the CRLF after it will all fit */
+        size_t dst_available = dst->capacity - dst->len;
+        if (dst_available < AWS_H1_ENCODER_CHUNK_LINE_MAX_SIZE + 3) {
+            ENCODER_LOG(TRACE, encoder, "Cannot fit any more chunk data in this message.");
+            return AWS_OP_SUCCESS;
+        }
 
-                    /* Return success because we want to try again later */
-                    return AWS_OP_SUCCESS;
-                }
+        /* The chunk-size is written with a fixed number of hex digits, padded with leading zeros (allowed by
+         * RFC-7230 4.1), so data can be read straight into place before its size is known */
+        size_t data_max = dst_available - AWS_H1_ENCODER_CHUNK_LINE_MAX_SIZE - 2;
+        size_t num_hex_digits = 1;
+        while ((data_max >> (4 * num_hex_digits)) > 0 && num_hex_digits < 16) {
+            ++num_hex_digits;
+        }
+        size_t chunk_line_len = num_hex_digits + 2;
+
+        struct aws_byte_buf data_view =
+            aws_byte_buf_from_empty_array(dst->buffer + dst->len + chunk_line_len, data_max);
+        if (aws_input_stream_read(encoder->message->body, &data_view)) {
+            ENCODER_LOGF(
+                ERROR,
+                encoder,
+                "Failed to read body stream, error %d (%s)",
+                aws_last_error(),
+                aws_error_name(aws_last_error()));
+            return AWS_OP_ERR;
+        }
 
-                const size_t prev_len = dst->len;
-                int err = aws_input_stream_read(encoder->message->body, dst);
-                const size_t amount_read = dst->len - prev_len;
+        if (data_view.len > 0) {
+            ENCODER_LOGF(TRACE, encoder, "Writing %zu body bytes to message as a chunk", data_view.len);
+
+            /* chunk-line: "{hex size}\r\n" */
+            char chunk_line[AWS_H1_ENCODER_CHUNK_LINE_MAX_SIZE + 1];
+            int written = snprintf(
+                chunk_line, sizeof(chunk_line), "%0*" PRIX64 "\r\n", (int)num_hex_digits, (uint64_t)data_view.len);
+            AWS_ASSERT((size_t)written == chunk_line_len);
+            (void)written;
+            memcpy(dst->buffer + dst->len, chunk_line, chunk_line_len);
+            dst->len += chunk_line_len + data_view.len;
+            aws_byte_buf_write_from_whole_cursor(dst, aws_byte_cursor_from_c_str("\r\n"));
+        }
 
-                if (err) {
-                    ENCODER_LOGF(
-                        ERROR,
-                        encoder,
-                        "Failed to read body stream, error %d (%s)",
-                        aws_last_error(),
-                        aws_error_name(aws_last_error()));
+        struct aws_stream_status status;
+        if (aws_input_stream_get_status(encoder->message->body, &status)) {
+            ENCODER_LOGF(
+                ERROR,
+                encoder,
+                "Failed to query body stream status, error %d (%s)",
+                aws_last_error(),
+                aws_error_name(aws_last_error()));
+            return AWS_OP_ERR;
+        }
 
-                    return AWS_OP_ERR;
-                }
+        if (status.is_end_of_stream) {
+            /* last-chunk: "0\r\n" */
+            struct aws_byte_cursor last_chunk = aws_byte_cursor_from_c_str("0\r\n");
+            if (dst->capacity - dst->len < last_chunk.len) {
+                ENCODER_LOG(TRACE, encoder, "Cannot fit final chunk in this message.");
+                return AWS_OP_SUCCESS;
+            }
 
-                if ((amount_read > encoder->message->content_length) ||
-                    (encoder->progress_bytes > encoder->message->content_length - amount_read)) {
-                    ENCODER_LOGF(
-                        ERROR,
-                        encoder,
-                        "Body stream has exceeded Content-Length: %" PRIu64,
-                        encoder->message->content_length);
-                    return aws_raise_error(AWS_ERROR_HTTP_OUTGOING_STREAM_LENGTH_INCORRECT);
-                }
+            ENCODER_LOG(TRACE, encoder, "Body stream complete, sending final chunk.");
+            aws_byte_buf_write_from_whole_cursor(dst, last_chunk);
+            s_switch_state(encoder, AWS_H1_ENCODER_STATE_CHUNK_TRAILER);
+            return AWS_OP_SUCCESS;
+        }
 
-                encoder->progress_bytes += amount_read;
+        if (data_view.len == 0) {
+            ENCODER_LOG(
+                TRACE,
+                encoder,
+                "No body data written, concluding this message. "
+                "Will try to write body data again in the next message.");
+            return AWS_OP_SUCCESS;
+        }
+    }
+}
 
-                ENCODER_LOGF(TRACE, encoder, "Writing %zu body bytes to message", amount_read);
+static int s_state_fn_chunk_next(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    (void)dst;
 
-                if (encoder->progress_bytes == encoder->message->content_length) {
-                    ENCODER_LOG(TRACE, encoder, "Done sending body.");
-                    encoder->progress_bytes = 0;
-                    encoder->state++;
-                    break;
-                }
+    if (aws_linked_list_empty(encoder->message->pending_chunk_list)) {
+        ENCODER_LOG(TRACE, encoder, "No chunks ready to send, waiting for more...");
+        return AWS_OP_SUCCESS;
+    }
 
-                /* Return if user failed to write anything. Maybe their data isn't ready yet. */
-                if (amount_read == 0) {
-                    /* Ensure we're not at end-of-stream too early */
-                    struct aws_stream_status status;
-                    err = aws_input_stream_get_status(encoder->message->body, &status);
-                    if (err) {
-                        ENCODER_LOGF(
-                            TRACE,
-                            encoder,
-                            "Failed to query body stream status, error %d (%s)",
-                            aws_last_error(),
-                            aws_error_name(aws_last_error()));
-
-                        return AWS_OP_ERR;
-                    }
-                    if (status.is_end_of_stream) {
-                        ENCODER_LOGF(
-                            ERROR,
-                            encoder,
-                            "Reached end of body stream before Content-Length: %" PRIu64 " sent",
-                            encoder->message->content_length);
-                        return aws_raise_error(AWS_ERROR_HTTP_OUTGOING_STREAM_LENGTH_INCORRECT);
-                    }
-
-                    ENCODER_LOG(
-                        TRACE,
-                        encoder,
-                        "No body data written, concluding this message. "
-                        "Will try to write body data again in the next message.");
-                    return AWS_OP_SUCCESS;
-                }
+    /* Chunk stays in the list until it's done sending, so it's cleaned up if the stream ends early */
+    struct aws_linked_list_node *node = aws_linked_list_front(encoder->message->pending_chunk_list);
+    encoder->current_chunk = AWS_CONTAINER_OF(node, struct aws_h1_chunk, node);
+
+    ENCODER_LOGF(
+        TRACE,
+        encoder,
+        "Begin sending chunk %p with size %" PRIu64,
+        (void *)encoder->current_chunk,
+        encoder->current_chunk->data_size);
+
+    s_switch_state(encoder, AWS_H1_ENCODER_STATE_CHUNK_LINE);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_state_fn_chunk_line(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    bool done = s_write_src_with_progress(encoder, aws_byte_cursor_from_buf(&encoder->current_chunk->chunk_line), dst);
+    if (!done) {
+        ENCODER_LOG(TRACE, encoder, "Cannot fit any more chunk data in this message.");
+        return AWS_OP_SUCCESS;
+    }
+
+    if (encoder->current_chunk->data_size == 0) {
+        /* The final chunk has no body and no CRLF after it, just the trailer */
+        ENCODER_LOG(TRACE, encoder, "Final chunk complete");
+
+        aws_linked_list_remove(&encoder->current_chunk->node);
+        aws_h1_chunk_complete_and_destroy(encoder->current_chunk, encoder->current_stream, AWS_ERROR_SUCCESS);
+        encoder->current_chunk = NULL;
+
+        s_switch_state(encoder, AWS_H1_ENCODER_STATE_CHUNK_TRAILER);
+    } else {
+        s_switch_state(encoder, AWS_H1_ENCODER_STATE_CHUNK_BODY);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_state_fn_chunk_body(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    struct aws_h1_chunk *chunk = encoder->current_chunk;
+
+    while (encoder->progress_bytes < chunk->data_size) {
+        size_t dst_available = dst->capacity - dst->len;
+        if (dst_available == 0) {
+            ENCODER_LOG(TRACE, encoder, "Cannot fit any more chunk data in this message.");
+            return AWS_OP_SUCCESS;
+        }
+
+        /* Don't let the stream write past the end of this chunk */
+        uint64_t chunk_remaining = chunk->data_size - encoder->progress_bytes;
+        size_t read_max = chunk_remaining < dst_available ? (size_t)chunk_remaining : dst_available;
+        struct aws_byte_buf dst_view = aws_byte_buf_from_empty_array(dst->buffer + dst->len, read_max);
+
+        if (aws_input_stream_read(chunk->data, &dst_view)) {
+            ENCODER_LOGF(
+                ERROR,
+                encoder,
+                "Failed to read chunk data, error %d (%s)",
+                aws_last_error(),
+                aws_error_name(aws_last_error()));
+            return AWS_OP_ERR;
+        }
+
+        dst->len += dst_view.len;
+        encoder->progress_bytes += dst_view.len;
+
+        ENCODER_LOGF(TRACE, encoder, "Writing %zu chunk bytes to message", dst_view.len);
+
+        if (dst_view.len == 0) {
+            /* Ensure we're not at end-of-stream too early */
+            struct aws_stream_status status;
+            if (aws_input_stream_get_status(chunk->data, &status)) {
+                ENCODER_LOGF(
+                    ERROR,
+                    encoder,
+                    "Failed to query chunk data status, error %d (%s)",
+                    aws_last_error(),
+                    aws_error_name(aws_last_error()));
+                return AWS_OP_ERR;
             }
+
+            if (status.is_end_of_stream) {
+                ENCODER_LOGF(
+                    ERROR,
+                    encoder,
+                    "Reached end of chunk data before chunk size %" PRIu64 " sent",
+                    chunk->data_size);
+                return aws_raise_error(AWS_ERROR_HTTP_OUTGOING_STREAM_LENGTH_INCORRECT);
+            }
+
+            ENCODER_LOG(
+                TRACE,
+                encoder,
+                "No chunk data written, concluding this message. "
+                "Will try to write chunk data again in the next message.");
+            return AWS_OP_SUCCESS;
         }
     }
 
-    if (encoder->state == AWS_H1_ENCODER_STATE_DONE) {
-        ENCODER_LOG(TRACE, encoder, "Done sending data.");
+    s_switch_state(encoder, AWS_H1_ENCODER_STATE_CHUNK_END);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_state_fn_chunk_end(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    /* chunk-end: "\r\n" */
+    bool done = s_write_src_with_progress(encoder, aws_byte_cursor_from_c_str("\r\n"), dst);
+    if (!done) {
+        ENCODER_LOG(TRACE, encoder, "Cannot fit any more chunk data in this message.");
+        return AWS_OP_SUCCESS;
+    }
+
+    ENCODER_LOGF(TRACE, encoder, "Chunk %p complete", (void *)encoder->current_chunk);
+
+    aws_linked_list_remove(&encoder->current_chunk->node);
+    aws_h1_chunk_complete_and_destroy(encoder->current_chunk, encoder->current_stream, AWS_ERROR_SUCCESS);
+    encoder->current_chunk = NULL;
+
+    s_switch_state(encoder, AWS_H1_ENCODER_STATE_CHUNK_NEXT);
+    return AWS_OP_SUCCESS;
+}
 
-        encoder->message = NULL;
+static int s_state_fn_chunk_trailer(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    /* We don't send trailing headers, so the trailer is just the final: "\r\n" */
+    bool done = s_write_src_with_progress(encoder, aws_byte_cursor_from_c_str("\r\n"), dst);
+    if (!done) {
+        ENCODER_LOG(TRACE, encoder, "Cannot fit any more chunk data in this message.");
+        return AWS_OP_SUCCESS;
     }
 
+    s_switch_state(encoder, AWS_H1_ENCODER_STATE_DONE);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_state_fn_done(struct aws_h1_encoder *encoder, struct aws_byte_buf *dst) {
+    (void)dst;
+
+    ENCODER_LOG(TRACE, encoder, "Done sending data.");
+    encoder->message = NULL;
+    encoder->current_stream = NULL;
+    s_switch_state(encoder, AWS_H1_ENCODER_STATE_INIT);
+    return AWS_OP_SUCCESS;
+}
+
+static encoder_state_fn *s_encoder_state_fns[] = {
+    [AWS_H1_ENCODER_STATE_INIT] = s_state_fn_init,
+    [AWS_H1_ENCODER_STATE_HEAD] = s_state_fn_head,
+    [AWS_H1_ENCODER_STATE_AWAIT_CONTINUE] = s_state_fn_await_continue,
+    [AWS_H1_ENCODER_STATE_UNCHUNKED_BODY] = s_state_fn_unchunked_body,
+    [AWS_H1_ENCODER_STATE_CHUNKED_BODY_STREAM] = s_state_fn_chunked_body_stream,
+    [AWS_H1_ENCODER_STATE_CHUNK_NEXT] = s_state_fn_chunk_next,
+    [AWS_H1_ENCODER_STATE_CHUNK_LINE] = s_state_fn_chunk_line,
+    [AWS_H1_ENCODER_STATE_CHUNK_BODY] = s_state_fn_chunk_body,
+    [AWS_H1_ENCODER_STATE_CHUNK_END] = s_state_fn_chunk_end,
+    [AWS_H1_ENCODER_STATE_CHUNK_TRAILER] = s_state_fn_chunk_trailer,
+    [AWS_H1_ENCODER_STATE_DONE] = s_state_fn_done,
+};
+
+int aws_h1_encoder_process(struct aws_h1_encoder *encoder, struct aws_byte_buf *out_buf) {
+    AWS_PRECONDITION(encoder);
+    AWS_PRECONDITION(out_buf);
+
+    if (!encoder->message) {
+        ENCODER_LOG(ERROR, encoder, "No message is currently set for encoding.");
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    /* Run state machine until states stop changing. (due to out_buf running out of space, input_stream stalling, or
+     * waiting for more chunks, or message being done) */
+    enum aws_h1_encoder_state prev_state;
+    do {
+        prev_state = encoder->state;
+        if (s_encoder_state_fns[encoder->state](encoder, out_buf)) {
+            return AWS_OP_ERR;
+        }
+    } while (encoder->message && encoder->state != prev_state);
+
     return AWS_OP_SUCCESS;
 }
 
 bool aws_h1_encoder_is_message_in_progress(const struct aws_h1_encoder *encoder) {
     return encoder->message;
 }
+
+bool aws_h1_encoder_lend_body_data(
+    struct aws_h1_encoder *encoder,
+    size_t max_size,
+    struct aws_byte_cursor *out_slice,
+    struct aws_http_message **out_owner) {
+
+    AWS_PRECONDITION(encoder);
+    AWS_PRECONDITION(out_slice);
+    AWS_PRECONDITION(out_owner);
+
+    if (!encoder->message || encoder->state != AWS_H1_ENCODER_STATE_UNCHUNKED_BODY ||
+        !encoder->message->body_data_owner || max_size == 0) {
+        return false;
+    }
+
+    struct aws_byte_cursor unsent = s_get_unsent_body_data(encoder);
+    *out_slice = aws_byte_cursor_advance(&unsent, unsent.len < max_size ? unsent.len : max_size);
+    *out_owner = encoder->message->body_data_owner;
+    encoder->progress_bytes += out_slice->len;
+
+    ENCODER_LOGF(TRACE, encoder, "Lending %zu body bytes, without copying", out_slice->len);
+
+    if (unsent.len == 0) {
+        ENCODER_LOG(TRACE, encoder, "Done sending body.");
+        s_switch_state(encoder, AWS_H1_ENCODER_STATE_DONE);
+        s_state_fn_done(encoder, NULL);
+    }
+
+    return true;
+}
+
+bool aws_h1_encoder_is_waiting_for_chunks(const struct aws_h1_encoder *encoder) {
+    return encoder->message && encoder->state == AWS_H1_ENCODER_STATE_CHUNK_NEXT &&
+           aws_linked_list_empty(encoder->message->pending_chunk_list);
+}
+
+bool aws_h1_encoder_is_waiting_for_continue(const struct aws_h1_encoder *encoder) {
+    return encoder->message && encoder->state == AWS_H1_ENCODER_STATE_AWAIT_CONTINUE;
+}
+
+void aws_h1_encoder_continue_body(struct aws_h1_encoder *encoder) {
+    AWS_PRECONDITION(aws_h1_encoder_is_waiting_for_continue(encoder));
+
+    ENCODER_LOG(TRACE, encoder, "Done waiting, sending body.");
+    s_switch_to_body_state(encoder);
+}
+
+void aws_h1_encoder_skip_body(struct aws_h1_encoder *encoder) {
+    AWS_PRECONDITION(aws_h1_encoder_is_waiting_for_continue(encoder));
+
+    ENCODER_LOG(TRACE, encoder, "Skipping body, server responded before it was sent.");
+    s_switch_state(encoder, AWS_H1_ENCODER_STATE_DONE);
+    s_state_fn_done(encoder, NULL);
+}
@@ -17,25 +17,74 @@
 #include <aws/http/private/connection_impl.h>
 #include <aws/http/private/h1_connection.h>
 
+#include <aws/http/arena.h>
+
 #include <aws/http/status_code.h>
 #include <aws/io/logging.h>
 
 static void s_stream_destroy(struct aws_http_stream *stream_base) {
     struct aws_h1_stream *stream = AWS_CONTAINER_OF(stream_base, struct aws_h1_stream, base);
 
+    /* Connection completes all outstanding chunks before the stream can be destroyed */
+    AWS_ASSERT(aws_linked_list_empty(&stream->pending_chunk_list));
+    AWS_ASSERT(aws_linked_list_empty(&stream->synced_data.pending_chunk_list));
+
     aws_h1_encoder_message_clean_up(&stream->encoder_message);
     aws_byte_buf_clean_up(&stream->incoming_storage_buf);
+    aws_http_decompressor_destroy(stream->incoming_body_decompressor);
+    aws_http_header_block_buffer_clean_up(&stream->base.incoming_header_block);
+    if (stream->incoming_body_buffer_window_sizes) {
+        aws_mem_release(stream->base.alloc, stream->incoming_body_buffer_window_sizes);
+    }
+
+    struct aws_allocator *arena = stream->arena;
     aws_mem_release(stream->base.alloc, stream);
+    aws_http_arena_allocator_destroy(arena);
 }
 
 static void s_stream_update_window(struct aws_http_stream *stream, size_t increment_size) {
     aws_http_connection_update_window(stream->owning_connection, increment_size);
 }
 
+static int s_stream_recycle_response_body_buffer(struct aws_http_stream *stream_base) {
+    struct aws_h1_stream *stream = AWS_CONTAINER_OF(stream_base, struct aws_h1_stream, base);
+
+    if (stream->num_incoming_body_buffers == 0) {
+        AWS_LOGF_ERROR(AWS_LS_HTTP_STREAM, "id=%p: Cannot recycle body buffer, stream has none.", (void *)stream_base);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    size_t recycled = aws_atomic_load_int(&stream->incoming_body_buffers_recycled);
+    size_t finished = aws_atomic_load_int(&stream->incoming_body_buffers_finished);
+    if (recycled == finished) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: Cannot recycle body buffer, the connection hasn't finished filling one.",
+            (void *)stream_base);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    /* The buffer is ours until the store below hands it back to the connection */
+    size_t index = recycled % stream->num_incoming_body_buffers;
+    size_t window_size = stream->incoming_body_buffer_window_sizes[index];
+    stream->incoming_body_buffers[index].len = 0;
+    stream->incoming_body_buffer_window_sizes[index] = 0;
+    aws_atomic_store_int(&stream->incoming_body_buffers_recycled, recycled + 1);
+
+    if (window_size > 0) {
+        aws_http_stream_update_window(stream_base, window_size);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static const struct aws_http_stream_vtable s_stream_vtable = {
     .destroy = s_stream_destroy,
     .update_window = s_stream_update_window,
     .activate = aws_h1_stream_activate,
+    .http1_write_chunk = aws_h1_stream_write_chunk,
+    .resume_outgoing_body = aws_h1_stream_resume_outgoing_body,
+    .http1_recycle_response_body_buffer = s_stream_recycle_response_body_buffer,
 };
 
 static struct aws_h1_stream *s_stream_new_common(
@@ -44,24 +93,52 @@ static struct aws_h1_stream *s_stream_new_common(
     void *user_data,
     aws_http_on_incoming_headers_fn *on_incoming_headers,
     aws_http_on_incoming_header_block_done_fn *on_incoming_header_block_done,
+    aws_http_on_incoming_header_block_fn *on_incoming_header_block,
     aws_http_on_incoming_body_fn *on_incoming_body,
-    aws_http_on_stream_complete_fn on_complete) {
+    aws_http_on_stream_complete_fn on_complete,
+    size_t arena_block_size) {
+
+    struct aws_allocator *alloc = owning_connection->alloc;
+    struct aws_allocator *arena = NULL;
+    if (arena_block_size) {
+        arena = aws_http_arena_allocator_new(owning_connection->alloc, arena_block_size);
+        if (!arena) {
+            return NULL;
+        }
+        alloc = arena;
+    }
 
-    struct aws_h1_stream *stream = aws_mem_calloc(owning_connection->alloc, 1, sizeof(struct aws_h1_stream));
+    struct aws_h1_stream *stream = aws_mem_calloc(alloc, 1, sizeof(struct aws_h1_stream));
     if (!stream) {
+        aws_http_arena_allocator_destroy(arena);
         return NULL;
     }
 
+    stream->arena = arena;
     stream->base.vtable = &s_stream_vtable;
-    stream->base.alloc = owning_connection->alloc;
+    stream->base.alloc = alloc;
     stream->base.owning_connection = owning_connection;
     stream->base.manual_window_management = manual_window_management;
     stream->base.user_data = user_data;
     stream->base.on_incoming_headers = on_incoming_headers;
     stream->base.on_incoming_header_block_done = on_incoming_header_block_done;
+    stream->base.on_incoming_header_block = on_incoming_header_block;
     stream->base.on_incoming_body = on_incoming_body;
     stream->base.on_complete = on_complete;
 
+    if (on_incoming_header_block) {
+        if (aws_http_header_block_buffer_init(&stream->base.incoming_header_block, alloc)) {
+            aws_mem_release(alloc, stream);
+            aws_http_arena_allocator_destroy(arena);
+            return NULL;
+        }
+    }
+
+    aws_linked_list_init(&stream->pending_chunk_list);
+    aws_linked_list_init(&stream->synced_data.pending_chunk_list);
+    aws_atomic_init_int(&stream->incoming_body_buffers_finished, 0);
+    aws_atomic_init_int(&stream->incoming_body_buffers_recycled, 0);
+
     /* Stream refcount starts at 1 for user and is incremented upon activation for the connection */
     aws_atomic_init_int(&stream->base.refcount, 1);
 
@@ -78,8 +155,10 @@ struct aws_h1_stream *aws_h1_stream_new_request(
         options->user_data,
         options->on_response_headers,
         options->on_response_header_block_done,
+        options->on_response_header_block,
         options->on_response_body,
-        options->on_complete);
+        options->on_complete,
+        options->arena_block_size);
     if (!stream) {
         return NULL;
     }
@@ -91,12 +170,37 @@ struct aws_h1_stream *aws_h1_stream_new_request(
         }
     }
 
+    stream->pause_outgoing_body_when_empty = options->pause_outgoing_body_when_empty;
+    stream->incoming_body_buffers = options->response_body_buffers;
+    stream->num_incoming_body_buffers = options->response_body_buffers ? options->num_response_body_buffers : 0;
+    if (stream->num_incoming_body_buffers > 0) {
+        stream->incoming_body_buffer_window_sizes =
+            aws_mem_calloc(stream->base.alloc, stream->num_incoming_body_buffers, sizeof(size_t));
+        if (!stream->incoming_body_buffer_window_sizes) {
+            goto error;
+        }
+    }
+    stream->decompress_incoming_body = options->decompress_response_body;
+    stream->expect_continue_timeout_ms = options->expect_continue_timeout_ms
+                                             ? options->expect_continue_timeout_ms
+                                             : AWS_H1_DEFAULT_EXPECT_CONTINUE_TIMEOUT_MS;
+
     stream->base.client_data = &stream->base.client_or_server_data.client;
     stream->base.client_data->response_status = AWS_HTTP_STATUS_CODE_UNKNOWN;
 
     /* Validate request and cache info that the encoder will eventually need */
-    int err =
-        aws_h1_encoder_message_init_from_request(&stream->encoder_message, client_connection->alloc, options->request);
+    int err;
+    if (options->request_template) {
+        err = aws_h1_encoder_message_init_from_template(
+            &stream->encoder_message,
+            stream->base.alloc,
+            options->request_template,
+            options->request,
+            &stream->pending_chunk_list);
+    } else {
+        err = aws_h1_encoder_message_init_from_request(
+            &stream->encoder_message, stream->base.alloc, options->request, &stream->pending_chunk_list);
+    }
     if (err) {
         goto error;
     }
@@ -121,8 +225,10 @@ struct aws_h1_stream *aws_h1_stream_new_request_handler(const struct aws_http_re
         options->user_data,
         options->on_request_headers,
         options->on_request_header_block_done,
+        options->on_request_header_block,
         options->on_request_body,
-        options->on_complete);
+        options->on_complete,
+        options->arena_block_size);
     if (!stream) {
         return NULL;
     }
@@ -133,6 +239,7 @@ struct aws_h1_stream *aws_h1_stream_new_request_handler(const struct aws_http_re
 
     stream->base.server_data = &stream->base.client_or_server_data.server;
     stream->base.server_data->on_request_done = options->on_request_done;
+    stream->pause_outgoing_body_when_empty = options->pause_outgoing_body_when_empty;
     aws_atomic_fetch_add(&stream->base.refcount, 1);
 
     return stream;
@@ -17,7 +17,9 @@
 
 #include <aws/http/private/h2_decoder.h>
 #include <aws/http/private/h2_stream.h>
+#include <aws/http/private/h2_stream_scheduler.h>
 
+#include <aws/common/clock.h>
 #include <aws/common/logging.h>
 
 #if _MSC_VER
@@ -28,6 +30,10 @@
     AWS_LOGF_##level(AWS_LS_HTTP_CONNECTION, "id=%p: " text, (void *)(connection), __VA_ARGS__)
 #define CONNECTION_LOG(level, connection, text) CONNECTION_LOGF(level, connection, "%s", text)
 
+/* While auto-tuned windows aren't growing, the PINGs that measure them are sent less and less often */
+static const uint64_t s_window_autotune_ping_backoff_min_ms = 100;
+static const uint64_t s_window_autotune_ping_backoff_max_ms = 10000;
+
 static int s_handler_process_read_message(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -53,6 +59,8 @@ static int s_handler_shutdown(
 static size_t s_handler_initial_window_size(struct aws_channel_handler *handler);
 static size_t s_handler_message_overhead(struct aws_channel_handler *handler);
 static void s_handler_destroy(struct aws_channel_handler *handler);
+static void s_reset_statistics(struct aws_channel_handler *handler);
+static void s_gather_statistics(struct aws_channel_handler *handler, struct aws_array_list *stats);
 static void s_handler_installed(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
 static struct aws_http_stream *s_connection_make_request(
     struct aws_http_connection *client_connection,
@@ -60,6 +68,7 @@ static struct aws_http_stream *s_connection_make_request(
 static bool s_connection_is_open(const struct aws_http_connection *connection_base);
 
 static void s_cross_thread_work_task(struct aws_channel_task *task, void *arg, enum aws_task_status status);
+static void s_activate_waiting_streams(struct aws_h2_connection *connection);
 static void s_outgoing_frames_task(struct aws_channel_task *task, void *arg, enum aws_task_status status);
 
 static int s_decoder_on_headers_begin(uint32_t stream_id, void *userdata);
@@ -74,14 +83,22 @@ static int s_decoder_on_headers_end(
     bool malformed,
     enum aws_http_header_block block_type,
     void *userdata);
+static int s_decoder_on_data_begin(
+    uint32_t stream_id,
+    uint32_t payload_len,
+    uint32_t total_padding_bytes,
+    bool end_stream,
+    void *userdata);
 static int s_decoder_on_data(uint32_t stream_id, struct aws_byte_cursor data, void *userdata);
 static int s_decoder_on_end_stream(uint32_t stream_id, void *userdata);
+static int s_decoder_on_ping_ack(uint8_t opaque_data[AWS_H2_PING_DATA_SIZE], void *userdata);
 static int s_decoder_on_ping(uint8_t opaque_data[AWS_H2_PING_DATA_SIZE], void *userdata);
 static int s_decoder_on_settings(
     const struct aws_h2_frame_setting *settings_array,
     size_t num_settings,
     void *userdata);
 static int s_decoder_on_settings_ack(void *userdata);
+static int s_decoder_on_window_update(uint32_t stream_id, uint32_t window_size_increment, void *userdata);
 
 static struct aws_http_connection_vtable s_h2_connection_vtable = {
     .channel_handler_vtable =
@@ -93,6 +110,8 @@ static struct aws_http_connection_vtable s_h2_connection_vtable = {
             .initial_window_size = s_handler_initial_window_size,
             .message_overhead = s_handler_message_overhead,
             .destroy = s_handler_destroy,
+            .reset_statistics = s_reset_statistics,
+            .gather_statistics = s_gather_statistics,
         },
 
     .on_channel_handler_installed = s_handler_installed,
@@ -108,11 +127,14 @@ static const struct aws_h2_decoder_vtable s_h2_decoder_vtable = {
     .on_headers_begin = s_decoder_on_headers_begin,
     .on_headers_i = s_decoder_on_headers_i,
     .on_headers_end = s_decoder_on_headers_end,
+    .on_data_begin = s_decoder_on_data_begin,
     .on_data = s_decoder_on_data,
     .on_end_stream = s_decoder_on_end_stream,
+    .on_ping_ack = s_decoder_on_ping_ack,
     .on_ping = s_decoder_on_ping,
     .on_settings = s_decoder_on_settings,
     .on_settings_ack = s_decoder_on_settings_ack,
+    .on_window_update = s_decoder_on_window_update,
 };
 
 static void s_lock_synced_data(struct aws_h2_connection *connection) {
@@ -186,10 +208,17 @@ static struct aws_h2_connection *s_connection_new(
     struct aws_allocator *alloc,
     bool manual_window_management,
     size_t initial_window_size,
+    size_t max_window_size,
+    enum aws_http2_stream_scheduler stream_scheduler,
     bool server) {
 
     (void)server;
-    (void)initial_window_size; /* #TODO use this for our initial settings */
+
+    const struct aws_h2_stream_scheduler_vtable *stream_scheduler_vtable =
+        aws_h2_stream_scheduler_get(stream_scheduler);
+    if (!stream_scheduler_vtable) {
+        return NULL;
+    }
 
     struct aws_h2_connection *connection = aws_mem_calloc(alloc, 1, sizeof(struct aws_h2_connection));
     if (!connection) {
@@ -218,8 +247,17 @@ static struct aws_h2_connection *s_connection_new(
     aws_atomic_init_int(&connection->synced_data.is_open, 1);
     aws_atomic_init_int(&connection->synced_data.new_stream_error_code, 0);
     aws_linked_list_init(&connection->synced_data.pending_stream_list);
+    aws_atomic_init_int(&connection->synced_data.pending_stream_count, 0);
+    aws_atomic_init_int(
+        &connection->synced_data.max_concurrent_streams_peer,
+        aws_h2_settings_initial[AWS_H2_SETTINGS_MAX_CONCURRENT_STREAMS]);
+    aws_linked_list_init(&connection->synced_data.window_update_stream_list);
 
+    aws_linked_list_init(&connection->thread_data.waiting_streams_list);
     aws_linked_list_init(&connection->thread_data.outgoing_streams_list);
+    connection->thread_data.stream_scheduler = stream_scheduler_vtable;
+    aws_linked_list_init(&connection->thread_data.stream_scheduler_data.root_active_children);
+    aws_linked_list_init(&connection->thread_data.stalled_window_streams_list);
     aws_linked_list_init(&connection->thread_data.outgoing_frames_queue);
 
     if (aws_mutex_init(&connection->synced_data.lock)) {
@@ -254,6 +292,31 @@ static struct aws_h2_connection *s_connection_new(
     memcpy(connection->thread_data.settings_peer, aws_h2_settings_initial, sizeof(aws_h2_settings_initial));
     memcpy(connection->thread_data.settings_self, aws_h2_settings_initial, sizeof(aws_h2_settings_initial));
 
+    /* Windows replenished automatically are bounded, to limit the memory used by DATA in flight */
+    size_t window_size_limit = AWS_H2_WINDOW_UPDATE_MAX;
+    if (!manual_window_management) {
+        window_size_limit =
+            aws_min_size(window_size_limit, max_window_size ? max_window_size : AWS_HTTP2_DEFAULT_MAX_WINDOW_SIZE);
+    }
+
+    /* Our streams' initial window is sent to peer in the connection preface SETTINGS */
+    connection->thread_data.settings_self[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE] =
+        (uint32_t)aws_min_size(initial_window_size, window_size_limit);
+
+    /* Connection-level windows always start at 65535, SETTINGS don't affect them (RFC-7540 6.9.2) */
+    connection->thread_data.window_size_peer = aws_h2_settings_initial[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE];
+    connection->thread_data.window_size_self = aws_h2_settings_initial[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE];
+
+    /* Connection's window has room for at least 1 stream's full window */
+    connection->thread_data.window_autotune.max_window_size = window_size_limit;
+    connection->thread_data.window_autotune.stream_window_size =
+        connection->thread_data.settings_self[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE];
+    connection->thread_data.window_autotune.connection_window_size = aws_max_size(
+        aws_h2_settings_initial[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE],
+        connection->thread_data.settings_self[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE]);
+
+    aws_crt_statistics_http2_channel_init(&connection->thread_data.stats);
+
     /* Create a new decoder */
     struct aws_h2_decoder_params params = {
         .alloc = alloc,
@@ -286,10 +349,12 @@ error:
 struct aws_http_connection *aws_http_connection_new_http2_server(
     struct aws_allocator *allocator,
     bool manual_window_management,
-    size_t initial_window_size) {
+    size_t initial_window_size,
+    size_t max_window_size,
+    enum aws_http2_stream_scheduler stream_scheduler) {
 
-    struct aws_h2_connection *connection =
-        s_connection_new(allocator, manual_window_management, initial_window_size, true);
+    struct aws_h2_connection *connection = s_connection_new(
+        allocator, manual_window_management, initial_window_size, max_window_size, stream_scheduler, true);
     if (!connection) {
         return NULL;
     }
@@ -302,10 +367,12 @@ struct aws_http_connection *aws_http_connection_new_http2_server(
 struct aws_http_connection *aws_http_connection_new_http2_client(
     struct aws_allocator *allocator,
     bool manual_window_management,
-    size_t initial_window_size) {
+    size_t initial_window_size,
+    size_t max_window_size,
+    enum aws_http2_stream_scheduler stream_scheduler) {
 
-    struct aws_h2_connection *connection =
-        s_connection_new(allocator, manual_window_management, initial_window_size, false);
+    struct aws_h2_connection *connection = s_connection_new(
+        allocator, manual_window_management, initial_window_size, max_window_size, stream_scheduler, false);
     if (!connection) {
         return NULL;
     }
@@ -327,7 +394,10 @@ static void s_handler_destroy(struct aws_channel_handler *handler) {
         aws_hash_table_get_entry_count(&connection->thread_data.active_streams_map) == 0);
 
     AWS_ASSERT(aws_linked_list_empty(&connection->thread_data.outgoing_streams_list));
+    AWS_ASSERT(aws_linked_list_empty(&connection->thread_data.stalled_window_streams_list));
     AWS_ASSERT(aws_linked_list_empty(&connection->synced_data.pending_stream_list));
+    AWS_ASSERT(aws_linked_list_empty(&connection->thread_data.waiting_streams_list));
+    AWS_ASSERT(aws_linked_list_empty(&connection->synced_data.window_update_stream_list));
 
     /* Clean up any unsent frames */
     struct aws_linked_list *outgoing_frames_queue = &connection->thread_data.outgoing_frames_queue;
@@ -345,6 +415,14 @@ static void s_handler_destroy(struct aws_channel_handler *handler) {
     aws_mem_release(connection->base.alloc, connection);
 }
 
+size_t aws_h2_connection_get_pending_stream_count(const struct aws_h2_connection *connection) {
+    return aws_atomic_load_int(&connection->synced_data.pending_stream_count);
+}
+
+uint32_t aws_h2_connection_get_max_concurrent_streams(const struct aws_h2_connection *connection) {
+    return (uint32_t)aws_atomic_load_int(&connection->synced_data.max_concurrent_streams_peer);
+}
+
 void aws_h2_connection_enqueue_outgoing_frame(struct aws_h2_connection *connection, struct aws_h2_frame *frame) {
     AWS_PRECONDITION(frame->type != AWS_H2_FRAME_T_DATA);
     AWS_PRECONDITION(aws_channel_thread_is_callers_thread(connection->base.channel_slot->channel));
@@ -396,6 +474,98 @@ static void s_on_channel_write_complete(
     aws_channel_schedule_task_now(channel, &connection->outgoing_frames_task);
 }
 
+/**
+ * Write as many DATA frames from outgoing_streams_list as possible.
+ * The connection's stream scheduler chooses which stream sends each frame,
+ * and no frame carries more than 1 scheduling quantum, so the scheduler gets to choose again often.
+ *
+ * Streams whose flow-control window is exhausted are parked in stalled_window_streams_list.
+ */
+static int s_encode_data_from_outgoing_streams(
+    struct aws_h2_connection *connection,
+    struct aws_byte_buf *output,
+    size_t *num_frames_encoded) {
+
+    struct aws_linked_list *outgoing_streams_list = &connection->thread_data.outgoing_streams_list;
+    const struct aws_h2_stream_scheduler_vtable *scheduler = connection->thread_data.stream_scheduler;
+
+    /* Streams that couldn't send anything this time (out of space, or bodies have nothing yet) are moved here,
+     * so the scheduler doesn't keep choosing them */
+    struct aws_linked_list idle_streams;
+    aws_linked_list_init(&idle_streams);
+    int result = AWS_OP_SUCCESS;
+
+    while (connection->thread_data.window_size_peer > 0 && !aws_linked_list_empty(outgoing_streams_list)) {
+        struct aws_h2_stream *stream = scheduler->choose_stream(connection);
+        struct aws_linked_list_node *node = &stream->node;
+        aws_linked_list_remove(node);
+
+        if (stream->thread_data.window_size_peer <= 0) {
+            AWS_H2_STREAM_LOG(TRACE, stream, "Flow-control window exhausted, waiting for WINDOW_UPDATE");
+            stream->thread_data.is_waiting_for_window_update = true;
+            scheduler->on_stream_unready(connection, stream);
+            aws_linked_list_push_back(&connection->thread_data.stalled_window_streams_list, node);
+            continue;
+        }
+
+        /* Limit the frame to 1 quantum by only offering that much of the connection's window */
+        const size_t quantum = aws_min_size(connection->thread_data.window_size_peer, AWS_H2_STREAM_SCHEDULER_QUANTUM);
+        size_t quantum_remaining = quantum;
+
+        struct aws_input_stream *body_stream = aws_http_message_get_body_stream(stream->thread_data.outgoing_message);
+        const size_t prev_len = output->len;
+        bool body_complete = false;
+        if (aws_h2_encode_data_frame(
+                &connection->thread_data.encoder,
+                stream->base.id,
+                body_stream,
+                true /*body_ends_stream*/,
+                0 /*pad_length*/,
+                &stream->thread_data.window_size_peer,
+                &quantum_remaining,
+                output,
+                &body_complete)) {
+
+            AWS_H2_STREAM_LOGF(ERROR, stream, "Error encoding DATA frame, %s", aws_error_name(aws_last_error()));
+            scheduler->on_stream_unready(connection, stream);
+            aws_linked_list_push_back(&idle_streams, node);
+            result = AWS_OP_ERR;
+            break;
+        }
+
+        const size_t payload_len = quantum - quantum_remaining;
+        connection->thread_data.window_size_peer -= payload_len;
+
+        if (output->len > prev_len) {
+            *num_frames_encoded += 1;
+            scheduler->on_data_sent(connection, stream, payload_len);
+        }
+
+        if (body_complete) {
+            /* Stream is done sending, it may be done entirely if it's also done receiving */
+            scheduler->on_stream_unready(connection, stream);
+            if (aws_h2_stream_on_end_stream_sent(stream)) {
+                result = AWS_OP_ERR;
+                break;
+            }
+        } else if (output->len > prev_len) {
+            aws_linked_list_push_back(outgoing_streams_list, node);
+        } else {
+            scheduler->on_stream_unready(connection, stream);
+            aws_linked_list_push_back(&idle_streams, node);
+        }
+    }
+
+    /* Idle streams go to the back of the line */
+    while (!aws_linked_list_empty(&idle_streams)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&idle_streams);
+        aws_linked_list_push_back(outgoing_streams_list, node);
+        scheduler->on_stream_ready(connection, AWS_CONTAINER_OF(node, struct aws_h2_stream, node));
+    }
+
+    return result;
+}
+
 static void s_outgoing_frames_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
     if (status != AWS_TASK_STATUS_RUN_READY) {
         return;
@@ -409,8 +579,15 @@ static void s_outgoing_frames_task(struct aws_channel_task *task, void *arg, enu
     AWS_PRECONDITION(aws_channel_thread_is_callers_thread(channel_slot->channel));
     AWS_PRECONDITION(connection->thread_data.is_outgoing_frames_task_active);
 
-    /* If there is nothing to send, then end the task immediately */
-    if (aws_linked_list_empty(outgoing_frames_queue) && aws_linked_list_empty(outgoing_streams_list)) {
+    /* Streams may have closed, or peer may have raised SETTINGS_MAX_CONCURRENT_STREAMS, since the last time.
+     * Streams are opened here, so their HEADERS are always sent before any of their DATA */
+    s_activate_waiting_streams(connection);
+
+    /* If there is nothing to send, then end the task immediately.
+     * DATA can't be sent while the connection's flow-control window is exhausted,
+     * the task is restarted when peer's WINDOW_UPDATE arrives. */
+    bool can_send_data = !aws_linked_list_empty(outgoing_streams_list) && connection->thread_data.window_size_peer > 0;
+    if (aws_linked_list_empty(outgoing_frames_queue) && !can_send_data) {
         CONNECTION_LOG(TRACE, connection, "Outgoing frames task stopped, nothing to send at this time");
         connection->thread_data.is_outgoing_frames_task_active = false;
         return;
@@ -478,32 +655,8 @@ static void s_outgoing_frames_task(struct aws_channel_task *task, void *arg, enu
         num_frames_encoded++;
     }
 
-    /* Write as many DATA frames from outgoing_streams_list as possible.
-     * We simply round-robin through available streams, instead of using stream priority.
-     *
-     * Respecting priority is not required (RFC-7540 5.3), so we're ignoring it for now. This also keeps use safe
-     * from priority DOS attacks: https://cve.mitre.org/cgi-bin/cvename.cgi?name=CVE-2019-9513
-     */
-    while (!aws_linked_list_empty(outgoing_streams_list)) {
-        num_frames_encoded++;
-
-        /* #TODO actually encode DATA frames.
-         * It will go something like:
-         * If there's not enough room in msg to bother encoding anything: goto done_encoding.
-         * Encode a DATA frame
-         * - It will write as much data as will fit in msg, and as much data as body_stream will give us
-         * - Encoder will go back and edit frame length to fit what we actually encoded.
-         * - Encoder will go back and edit END_STREAM flag if we reached the end of the body_stream.
-         *
-         * If stream has sent all data:
-         * - Remove stream from outgoing_streams_list
-         * - Stream is complete if it is also done receiving (weird edge case, but theoretically possible)
-         * Else stream has not sent all data:
-         * - Move stream to back of outgoing_streams_list ("round-robin" DATA frames from available streams)
-         * - Beware getting into a loop, don't read from the same stream twice
-         */
-        CONNECTION_LOG(ERROR, connection, "DATA frames not supported yet");
-        aws_raise_error(AWS_ERROR_UNIMPLEMENTED);
+    /* Write as many DATA frames from outgoing_streams_list as possible. */
+    if (s_encode_data_from_outgoing_streams(connection, &msg->message_data, &num_frames_encoded)) {
         goto error;
     }
 
@@ -715,10 +868,181 @@ int s_decoder_on_headers_end(
     return AWS_OP_SUCCESS;
 }
 
-int s_decoder_on_data(uint32_t stream_id, struct aws_byte_cursor data, void *userdata) {
+static int s_replenish_connection_window_self(struct aws_h2_connection *connection) {
+    /* Window is topped up once half of it is used */
+    const size_t target = connection->thread_data.window_autotune.connection_window_size;
+    if (connection->thread_data.window_size_self > target / 2) {
+        return AWS_OP_SUCCESS;
+    }
+
+    const size_t increment = target - connection->thread_data.window_size_self;
+    struct aws_h2_frame *window_update_frame =
+        aws_h2_frame_new_window_update(connection->base.alloc, 0 /*stream_id*/, (uint32_t)increment);
+    if (!window_update_frame) {
+        CONNECTION_LOGF(ERROR, connection, "Error creating WINDOW_UPDATE frame, %s", aws_error_name(aws_last_error()));
+        return AWS_OP_ERR;
+    }
+
+    aws_h2_connection_enqueue_outgoing_frame(connection, window_update_frame);
+    connection->thread_data.window_size_self = target;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_window_autotune_ping_data(uint64_t ping_count, uint8_t opaque_data[AWS_H2_PING_DATA_SIZE]) {
+    struct aws_byte_buf buf = aws_byte_buf_from_empty_array(opaque_data, AWS_H2_PING_DATA_SIZE);
+    aws_byte_buf_write_be64(&buf, ping_count);
+}
+
+static void s_window_autotune_on_rtt(struct aws_h2_connection *connection, uint64_t rtt_ns) {
+    /* Smooth it out, like TCP does (RFC-6298) */
+    uint64_t *smoothed_rtt_ns = &connection->thread_data.window_autotune.rtt_ns;
+    *smoothed_rtt_ns = *smoothed_rtt_ns ? (*smoothed_rtt_ns * 7 + rtt_ns) / 8 : rtt_ns;
+}
+
+/* DATA is arriving, send a PING to measure how much more arrives in one round-trip */
+static int s_window_autotune_on_data(struct aws_h2_connection *connection, uint32_t payload_len) {
+    if (connection->base.manual_window_management) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (connection->thread_data.window_autotune.is_ping_in_flight) {
+        connection->thread_data.window_autotune.bytes_received_since_ping += payload_len;
+        return AWS_OP_SUCCESS;
+    }
+
+    /* Nothing left to learn once windows are as big as they're allowed to get */
+    if (connection->thread_data.window_autotune.stream_window_size >=
+        connection->thread_data.window_autotune.max_window_size) {
+        return AWS_OP_SUCCESS;
+    }
+
+    uint64_t now_ns = 0;
+    if (aws_channel_current_clock_time(connection->base.channel_slot->channel, &now_ns)) {
+        return AWS_OP_ERR;
+    }
+
+    if (now_ns < connection->thread_data.window_autotune.next_ping_timestamp_ns) {
+        return AWS_OP_SUCCESS;
+    }
+
+    uint8_t opaque_data[AWS_H2_PING_DATA_SIZE];
+    s_window_autotune_ping_data(connection->thread_data.window_autotune.ping_count + 1, opaque_data);
+    struct aws_h2_frame *ping_frame = aws_h2_frame_new_ping(connection->base.alloc, false /*ack*/, opaque_data);
+    if (!ping_frame) {
+        CONNECTION_LOGF(ERROR, connection, "Error creating PING frame, %s", aws_error_name(aws_last_error()));
+        return AWS_OP_ERR;
+    }
+
+    aws_h2_connection_enqueue_outgoing_frame(connection, ping_frame);
+
+    connection->thread_data.window_autotune.is_ping_in_flight = true;
+    connection->thread_data.window_autotune.ping_count++;
+    connection->thread_data.window_autotune.ping_timestamp_ns = now_ns;
+    connection->thread_data.window_autotune.bytes_received_since_ping = 0;
+    return AWS_OP_SUCCESS;
+}
+
+/* PING is ACKed, grow windows if DATA received during the round-trip nearly filled them.
+ * This is the same estimator gRPC uses. */
+static void s_window_autotune_on_ping_ack(struct aws_h2_connection *connection, uint64_t now_ns) {
+    connection->thread_data.window_autotune.is_ping_in_flight = false;
+
+    const uint64_t rtt_ns = aws_max_u64(now_ns - connection->thread_data.window_autotune.ping_timestamp_ns, 1);
+    s_window_autotune_on_rtt(connection, rtt_ns);
+
+    const size_t bytes = connection->thread_data.window_autotune.bytes_received_since_ping;
+    const uint64_t bandwidth = aws_mul_u64_saturating(bytes, AWS_TIMESTAMP_NANOS) / rtt_ns;
+    const size_t window_size = connection->thread_data.window_autotune.stream_window_size;
+
+    /* Don't grow just because the RTT got longer, the bandwidth must be better than ever too */
+    bool grew = false;
+    if (bytes >= window_size / 3 * 2 &&
+        bandwidth > connection->thread_data.window_autotune.max_bandwidth_bytes_per_sec) {
+
+        connection->thread_data.window_autotune.max_bandwidth_bytes_per_sec = bandwidth;
+
+        const size_t new_window_size = aws_min_size(
+            aws_max_size(bytes, aws_mul_size_saturating(window_size, 2)),
+            connection->thread_data.window_autotune.max_window_size);
+
+        if (new_window_size > window_size) {
+            CONNECTION_LOGF(
+                DEBUG,
+                connection,
+                "Growing receive windows from %zu to %zu, measured %zu bytes per %" PRIu64 "ns round-trip",
+                window_size,
+                new_window_size,
+                bytes,
+                rtt_ns);
+
+            connection->thread_data.window_autotune.stream_window_size = (uint32_t)new_window_size;
+            connection->thread_data.window_autotune.connection_window_size =
+                aws_max_size(connection->thread_data.window_autotune.connection_window_size, new_window_size);
+            grew = true;
+        }
+    }
+
+    uint64_t *ping_backoff_ns = &connection->thread_data.window_autotune.ping_backoff_ns;
+    if (grew) {
+        *ping_backoff_ns = 0;
+    } else if (*ping_backoff_ns == 0) {
+        *ping_backoff_ns = aws_timestamp_convert(
+            s_window_autotune_ping_backoff_min_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    } else {
+        *ping_backoff_ns = aws_min_u64(
+            *ping_backoff_ns * 2,
+            aws_timestamp_convert(
+                s_window_autotune_ping_backoff_max_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    }
+    connection->thread_data.window_autotune.next_ping_timestamp_ns = aws_add_u64_saturating(now_ns, *ping_backoff_ns);
+}
+
+int s_decoder_on_data_begin(
+    uint32_t stream_id,
+    uint32_t payload_len,
+    uint32_t total_padding_bytes,
+    bool end_stream,
+    void *userdata) {
+
     struct aws_h2_connection *connection = userdata;
 
-    /* #TODO Update connection's flow-control window */
+    /* DATA counts against the connection's window, even if its stream is closed.
+     * Exceeding the connection window is a connection error (RFC-7540 6.9.1) */
+    if (payload_len > connection->thread_data.window_size_self) {
+        CONNECTION_LOGF(
+            ERROR,
+            connection,
+            "DATA frame with %" PRIu32 " byte payload exceeds connection flow-control window of %zu",
+            payload_len,
+            connection->thread_data.window_size_self);
+        return aws_raise_error(AWS_ERROR_HTTP_FLOW_CONTROL_ERROR);
+    }
+    connection->thread_data.window_size_self -= payload_len;
+
+    if (s_window_autotune_on_data(connection, payload_len)) {
+        return AWS_OP_ERR;
+    }
+
+    if (s_replenish_connection_window_self(connection)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_h2_stream *stream;
+    if (s_get_active_stream_for_incoming_frame(connection, stream_id, AWS_H2_FRAME_T_DATA, &stream)) {
+        return AWS_OP_ERR;
+    }
+
+    if (stream) {
+        if (aws_h2_stream_on_decoder_data_begin(stream, payload_len, total_padding_bytes, end_stream)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int s_decoder_on_data(uint32_t stream_id, struct aws_byte_cursor data, void *userdata) {
+    struct aws_h2_connection *connection = userdata;
 
     /* Pass data to stream */
     struct aws_h2_stream *stream;
@@ -754,6 +1078,27 @@ int s_decoder_on_end_stream(uint32_t stream_id, void *userdata) {
     return AWS_OP_SUCCESS;
 }
 
+static int s_decoder_on_ping_ack(uint8_t opaque_data[AWS_H2_PING_DATA_SIZE], void *userdata) {
+    struct aws_h2_connection *connection = userdata;
+
+    /* The only PINGs we send are for auto-tuning windows */
+    uint8_t expected_opaque_data[AWS_H2_PING_DATA_SIZE];
+    s_window_autotune_ping_data(connection->thread_data.window_autotune.ping_count, expected_opaque_data);
+    if (!connection->thread_data.window_autotune.is_ping_in_flight ||
+        memcmp(opaque_data, expected_opaque_data, AWS_H2_PING_DATA_SIZE) != 0) {
+        CONNECTION_LOG(TRACE, connection, "Ignoring PING ACK that doesn't match any PING in flight");
+        return AWS_OP_SUCCESS;
+    }
+
+    uint64_t now_ns = 0;
+    if (aws_channel_current_clock_time(connection->base.channel_slot->channel, &now_ns)) {
+        return AWS_OP_ERR;
+    }
+
+    s_window_autotune_on_ping_ack(connection, now_ns);
+    return AWS_OP_SUCCESS;
+}
+
 static int s_decoder_on_ping(uint8_t opaque_data[AWS_H2_PING_DATA_SIZE], void *userdata) {
     struct aws_h2_connection *connection = userdata;
 
@@ -778,6 +1123,43 @@ static void s_aws_h2_decoder_change_settings(struct aws_h2_connection *connectio
     aws_h2_decoder_set_setting_max_frame_size(decoder, settings_self[AWS_H2_SETTINGS_MAX_FRAME_SIZE]);
 }
 
+/* Move stream back to outgoing_streams_list, now that its flow-control window is open again */
+static void s_resume_stalled_stream(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    if (!stream->thread_data.is_waiting_for_window_update) {
+        return;
+    }
+
+    AWS_H2_STREAM_LOG(TRACE, stream, "Flow-control window opened, resuming DATA");
+    stream->thread_data.is_waiting_for_window_update = false;
+    aws_linked_list_remove(&stream->node);
+    aws_linked_list_push_back(&connection->thread_data.outgoing_streams_list, &stream->node);
+    connection->thread_data.stream_scheduler->on_stream_ready(connection, stream);
+}
+
+/* A change to SETTINGS_INITIAL_WINDOW_SIZE adjusts the window of every active stream by the difference,
+ * possibly making windows negative (RFC-7540 6.9.2) */
+static int s_apply_peer_initial_window_size(struct aws_h2_connection *connection, uint32_t new_value) {
+    const int64_t delta =
+        (int64_t)new_value - (int64_t)connection->thread_data.settings_peer[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE];
+
+    struct aws_hash_iter stream_iter = aws_hash_iter_begin(&connection->thread_data.active_streams_map);
+    for (; !aws_hash_iter_done(&stream_iter); aws_hash_iter_next(&stream_iter)) {
+        struct aws_h2_stream *stream = stream_iter.element.value;
+        const int64_t new_window = stream->thread_data.window_size_peer + delta;
+        if (new_window > AWS_H2_WINDOW_UPDATE_MAX) {
+            AWS_H2_STREAM_LOG(ERROR, stream, "SETTINGS_INITIAL_WINDOW_SIZE change overflows flow-control window");
+            return aws_raise_error(AWS_ERROR_HTTP_FLOW_CONTROL_ERROR);
+        }
+
+        stream->thread_data.window_size_peer = (int32_t)new_window;
+        if (new_window > 0) {
+            s_resume_stalled_stream(connection, stream);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static int s_decoder_on_settings(
     const struct aws_h2_frame_setting *settings_array,
     size_t num_settings,
@@ -804,9 +1186,17 @@ static int s_decoder_on_settings(
             case AWS_H2_SETTINGS_HEADER_TABLE_SIZE:
                 aws_h2_frame_encoder_set_setting_header_table_size(encoder, settings_array[i].value);
                 break;
+            case AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE:
+                if (s_apply_peer_initial_window_size(connection, settings_array[i].value)) {
+                    goto error;
+                }
+                break;
             case AWS_H2_SETTINGS_MAX_FRAME_SIZE:
                 aws_h2_frame_encoder_set_setting_max_frame_size(encoder, settings_array[i].value);
                 break;
+            case AWS_H2_SETTINGS_MAX_CONCURRENT_STREAMS:
+                aws_atomic_store_int(&connection->synced_data.max_concurrent_streams_peer, settings_array[i].value);
+                break;
         }
         connection->thread_data.settings_peer[settings_array[i].id] = settings_array[i].value;
     }
@@ -821,11 +1211,68 @@ static int s_decoder_on_settings_ack(void *userdata) {
     struct aws_h2_connection *connection = userdata;
     /* #TODO track which SETTINGS frames is ACKed by this */
 
+    /* Only the connection preface SETTINGS is ever sent, so this ACK completes its round-trip */
+    if (connection->thread_data.window_autotune.settings_timestamp_ns) {
+        uint64_t now_ns = 0;
+        if (aws_channel_current_clock_time(connection->base.channel_slot->channel, &now_ns)) {
+            return AWS_OP_ERR;
+        }
+
+        s_window_autotune_on_rtt(
+            connection, aws_max_u64(now_ns - connection->thread_data.window_autotune.settings_timestamp_ns, 1));
+        connection->thread_data.window_autotune.settings_timestamp_ns = 0;
+    }
+
     /* inform decoder about the settings */
     s_aws_h2_decoder_change_settings(connection);
     return AWS_OP_SUCCESS;
 }
 
+static int s_decoder_on_window_update(uint32_t stream_id, uint32_t window_size_increment, void *userdata) {
+    struct aws_h2_connection *connection = userdata;
+
+    if (stream_id == 0) {
+        /* Connection-level window */
+        if (window_size_increment == 0) {
+            /* Errors on the connection flow-control window MUST be treated as a connection error (RFC-7540 6.9) */
+            CONNECTION_LOG(ERROR, connection, "Received connection WINDOW_UPDATE with 0 increment");
+            return aws_raise_error(AWS_ERROR_HTTP_PROTOCOL_ERROR);
+        }
+
+        if (connection->thread_data.window_size_peer + window_size_increment > AWS_H2_WINDOW_UPDATE_MAX) {
+            CONNECTION_LOGF(
+                ERROR,
+                connection,
+                "WINDOW_UPDATE increment of %" PRIu32 " would overflow connection flow-control window of %zu",
+                window_size_increment,
+                connection->thread_data.window_size_peer);
+            return aws_raise_error(AWS_ERROR_HTTP_FLOW_CONTROL_ERROR);
+        }
+
+        /* Outgoing frames task resumes DATA for all streams after the message is processed */
+        connection->thread_data.window_size_peer += window_size_increment;
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_h2_stream *stream;
+    if (s_get_active_stream_for_incoming_frame(connection, stream_id, AWS_H2_FRAME_T_WINDOW_UPDATE, &stream)) {
+        return AWS_OP_ERR;
+    }
+
+    if (stream) {
+        bool window_resumed = false;
+        if (aws_h2_stream_on_decoder_window_update(stream, window_size_increment, &window_resumed)) {
+            return AWS_OP_ERR;
+        }
+
+        if (window_resumed) {
+            s_resume_stalled_stream(connection, stream);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 /* End decoder callbacks */
 
 static int s_send_connection_preface_client_string(struct aws_h2_connection *connection) {
@@ -857,18 +1304,36 @@ error:
     return AWS_OP_ERR;
 }
 
-/* #TODO actually fill with initial settings */
 /* #TODO track which SETTINGS frames have been ACK'd */
 static int s_enqueue_settings_frame(struct aws_h2_connection *connection) {
     struct aws_allocator *alloc = connection->base.alloc;
 
-    struct aws_h2_frame *settings_frame = aws_h2_frame_new_settings(alloc, NULL, 0, false /*ack*/);
+    /* Only send settings that differ from the initial values */
+    struct aws_h2_frame_setting settings[AWS_H2_SETTINGS_END_RANGE];
+    size_t num_settings = 0;
+    for (uint16_t id = AWS_H2_SETTINGS_BEGIN_RANGE; id < AWS_H2_SETTINGS_END_RANGE; ++id) {
+        if (connection->thread_data.settings_self[id] != aws_h2_settings_initial[id]) {
+            settings[num_settings].id = id;
+            settings[num_settings].value = connection->thread_data.settings_self[id];
+            num_settings++;
+        }
+    }
+
+    struct aws_h2_frame *settings_frame = aws_h2_frame_new_settings(alloc, settings, num_settings, false /*ack*/);
     if (!settings_frame) {
         return AWS_OP_ERR;
     }
 
     aws_h2_connection_enqueue_outgoing_frame(connection, settings_frame);
-    return AWS_OP_SUCCESS;
+
+    if (aws_channel_current_clock_time(
+            connection->base.channel_slot->channel, &connection->thread_data.window_autotune.settings_timestamp_ns)) {
+        return AWS_OP_ERR;
+    }
+
+    /* Connection-level window always starts at 65535, but our streams' windows may be larger.
+     * Open the connection window right away so it doesn't hold up the first stream. */
+    return s_replenish_connection_window_self(connection);
 }
 
 static void s_handler_installed(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
@@ -927,6 +1392,7 @@ static void s_stream_complete(struct aws_h2_connection *connection, struct aws_h
     }
 
     /* Remove stream from active_streams_map and outgoing_stream_list (if it was in them at all) */
+    connection->thread_data.stream_scheduler->on_stream_complete(connection, stream);
     aws_hash_table_remove(&connection->thread_data.active_streams_map, (void *)(size_t)stream->base.id, NULL, NULL);
     if (stream->node.next) {
         aws_linked_list_remove(&stream->node);
@@ -982,18 +1448,14 @@ int aws_h2_connection_on_stream_closed(
 static void s_activate_stream(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
     AWS_PRECONDITION(aws_channel_thread_is_callers_thread(connection->base.channel_slot->channel));
 
-    uint32_t max_concurrent_streams = connection->thread_data.settings_peer[AWS_H2_SETTINGS_MAX_CONCURRENT_STREAMS];
-    if (aws_hash_table_get_entry_count(&connection->thread_data.active_streams_map) >= max_concurrent_streams) {
-        AWS_H2_STREAM_LOG(ERROR, stream, "Failed activating stream, max concurrent streams are reached");
-        goto error;
-    }
-
     if (aws_hash_table_put(
             &connection->thread_data.active_streams_map, (void *)(size_t)stream->base.id, stream, NULL)) {
         AWS_H2_STREAM_LOG(ERROR, stream, "Failed inserting stream into map");
         goto error;
     }
 
+    connection->thread_data.stream_scheduler->on_stream_activated(connection, stream);
+
     bool has_outgoing_data = false;
     if (aws_h2_stream_on_activated(stream, &has_outgoing_data)) {
         goto error;
@@ -1003,6 +1465,7 @@ static void s_activate_stream(struct aws_h2_connection *connection, struct aws_h
 
     if (has_outgoing_data) {
         aws_linked_list_push_back(&connection->thread_data.outgoing_streams_list, &stream->node);
+        connection->thread_data.stream_scheduler->on_stream_ready(connection, stream);
     }
 
     return;
@@ -1011,6 +1474,33 @@ error:
     s_stream_complete(connection, stream, aws_last_error());
 }
 
+/* Open streams from waiting_streams_list, in the order they were activated, until peer's limit is reached */
+static void s_activate_waiting_streams(struct aws_h2_connection *connection) {
+    AWS_PRECONDITION(aws_channel_thread_is_callers_thread(connection->base.channel_slot->channel));
+
+    struct aws_linked_list *waiting_streams_list = &connection->thread_data.waiting_streams_list;
+    const uint32_t max_concurrent_streams =
+        connection->thread_data.settings_peer[AWS_H2_SETTINGS_MAX_CONCURRENT_STREAMS];
+
+    while (!aws_linked_list_empty(waiting_streams_list) &&
+           aws_hash_table_get_entry_count(&connection->thread_data.active_streams_map) < max_concurrent_streams) {
+
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(waiting_streams_list);
+        struct aws_h2_stream *stream = AWS_CONTAINER_OF(node, struct aws_h2_stream, node);
+        aws_atomic_fetch_sub(&connection->synced_data.pending_stream_count, 1);
+        s_activate_stream(connection, stream);
+    }
+
+    if (!aws_linked_list_empty(waiting_streams_list)) {
+        CONNECTION_LOGF(
+            TRACE,
+            connection,
+            "Max concurrent streams reached (%" PRIu32 "), %zu streams waiting to be opened",
+            max_concurrent_streams,
+            aws_h2_connection_get_pending_stream_count(connection));
+    }
+}
+
 /* Perform on-thread work that is triggered by calls to the connection/stream API */
 static void s_cross_thread_work_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
     (void)task;
@@ -1023,23 +1513,55 @@ static void s_cross_thread_work_task(struct aws_channel_task *task, void *arg, e
     struct aws_linked_list pending_streams;
     aws_linked_list_init(&pending_streams);
 
+    struct aws_linked_list window_update_streams;
+    aws_linked_list_init(&window_update_streams);
+
     { /* BEGIN CRITICAL SECTION */
         s_lock_synced_data(connection);
         connection->synced_data.is_cross_thread_work_task_scheduled = false;
 
         aws_linked_list_swap_contents(&connection->synced_data.pending_stream_list, &pending_streams);
+        aws_linked_list_swap_contents(&connection->synced_data.window_update_stream_list, &window_update_streams);
 
         s_unlock_synced_data(connection);
     } /* END CRITICAL SECTION */
 
-    /* Process new pending_streams */
+    /* New pending_streams wait their turn behind any streams already waiting.
+     * They're opened by the outgoing frames task, once peer's SETTINGS_MAX_CONCURRENT_STREAMS allows */
     while (!aws_linked_list_empty(&pending_streams)) {
-        struct aws_linked_list_node *node = aws_linked_list_pop_front(&pending_streams);
-        struct aws_h2_stream *stream = AWS_CONTAINER_OF(node, struct aws_h2_stream, node);
-        s_activate_stream(connection, stream);
+        aws_linked_list_push_back(
+            &connection->thread_data.waiting_streams_list, aws_linked_list_pop_front(&pending_streams));
+    }
+
+    /* Apply window updates from aws_http_stream_update_window().
+     * Updates for streams that haven't been opened yet are applied once they are. */
+    int window_update_error_code = AWS_ERROR_SUCCESS;
+    while (!aws_linked_list_empty(&window_update_streams)) {
+        struct aws_h2_stream *stream;
+        size_t increment_size;
+        { /* BEGIN CRITICAL SECTION */
+            s_lock_synced_data(connection);
+            /* Other threads check whether the node is in a list, so only touch it while holding the lock */
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&window_update_streams);
+            stream = AWS_CONTAINER_OF(node, struct aws_h2_stream, synced_data.window_update_node);
+            increment_size = stream->synced_data.pending_window_update_size;
+            stream->synced_data.pending_window_update_size = 0;
+            s_unlock_synced_data(connection);
+        } /* END CRITICAL SECTION */
+
+        if (aws_h2_stream_apply_window_update(stream, increment_size)) {
+            CONNECTION_LOGF(ERROR, connection, "Failed to update stream window, %s", aws_error_name(aws_last_error()));
+            window_update_error_code = aws_last_error();
+        }
+
+        /* Release the hold taken by aws_h2_stream_update_window() */
+        aws_http_stream_release(&stream->base);
     }
 
-    /* #TODO: process stuff from other API calls (ex: window-updates) */
+    if (window_update_error_code) {
+        s_shutdown_due_to_write_err(connection, window_update_error_code);
+        return;
+    }
 
     /* It's likely that frames were queued while processing cross-thread work.
      * If so, try writing them now */
@@ -1069,6 +1591,7 @@ int aws_h2_stream_activate(struct aws_http_stream *stream) {
             connection->synced_data.is_cross_thread_work_task_scheduled = true;
 
             aws_linked_list_push_back(&connection->synced_data.pending_stream_list, &h2_stream->node);
+            aws_atomic_fetch_add(&connection->synced_data.pending_stream_count, 1);
         }
         s_unlock_synced_data(connection);
     } /* END CRITICAL SECTION */
@@ -1086,6 +1609,55 @@ int aws_h2_stream_activate(struct aws_http_stream *stream) {
     return AWS_OP_SUCCESS;
 }
 
+void aws_h2_stream_update_window(struct aws_http_stream *stream, size_t increment_size) {
+    struct aws_h2_stream *h2_stream = AWS_CONTAINER_OF(stream, struct aws_h2_stream, base);
+
+    struct aws_http_connection *base_connection = stream->owning_connection;
+    struct aws_h2_connection *connection = AWS_CONTAINER_OF(base_connection, struct aws_h2_connection, base);
+
+    if (increment_size == 0) {
+        return;
+    }
+
+    bool was_cross_thread_work_scheduled = false;
+    bool is_open = true;
+    { /* BEGIN CRITICAL SECTION */
+        s_lock_synced_data(connection);
+
+        /* Once the connection is shutting down, nothing will ever process the list */
+        is_open = aws_atomic_load_int(&connection->synced_data.is_open);
+        if (is_open) {
+            h2_stream->synced_data.pending_window_update_size =
+                aws_add_size_saturating(h2_stream->synced_data.pending_window_update_size, increment_size);
+
+            /* Stream may already be in the list, waiting for cross-thread work task */
+            if (!h2_stream->synced_data.window_update_node.next) {
+                /* Keep stream alive until the update is applied */
+                aws_atomic_fetch_add(&stream->refcount, 1);
+                aws_linked_list_push_back(
+                    &connection->synced_data.window_update_stream_list, &h2_stream->synced_data.window_update_node);
+
+                was_cross_thread_work_scheduled = connection->synced_data.is_cross_thread_work_task_scheduled;
+                connection->synced_data.is_cross_thread_work_task_scheduled = true;
+            } else {
+                was_cross_thread_work_scheduled = true;
+            }
+        }
+
+        s_unlock_synced_data(connection);
+    } /* END CRITICAL SECTION */
+
+    if (!is_open) {
+        CONNECTION_LOG(DEBUG, connection, "Ignoring stream window update, connection is closed");
+        return;
+    }
+
+    if (!was_cross_thread_work_scheduled) {
+        CONNECTION_LOG(TRACE, connection, "Scheduling cross-thread work task");
+        aws_channel_schedule_task_now(connection->base.channel_slot->channel, &connection->cross_thread_work_task);
+    }
+}
+
 static struct aws_http_stream *s_connection_make_request(
     struct aws_http_connection *client_connection,
     const struct aws_http_make_request_options *options) {
@@ -1251,8 +1823,34 @@ static int s_handler_shutdown(
         while (!aws_linked_list_empty(&connection->synced_data.pending_stream_list)) {
             struct aws_linked_list_node *node = aws_linked_list_pop_front(&connection->synced_data.pending_stream_list);
             struct aws_h2_stream *stream = AWS_CONTAINER_OF(node, struct aws_h2_stream, node);
+            aws_atomic_fetch_sub(&connection->synced_data.pending_stream_count, 1);
+            s_stream_complete(connection, stream, AWS_ERROR_HTTP_CONNECTION_CLOSED);
+        }
+
+        struct aws_linked_list *waiting_streams_list = &connection->thread_data.waiting_streams_list;
+        while (!aws_linked_list_empty(waiting_streams_list)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(waiting_streams_list);
+            struct aws_h2_stream *stream = AWS_CONTAINER_OF(node, struct aws_h2_stream, node);
+            aws_atomic_fetch_sub(&connection->synced_data.pending_stream_count, 1);
             s_stream_complete(connection, stream, AWS_ERROR_HTTP_CONNECTION_CLOSED);
         }
+
+        /* Release the holds on any streams whose window updates will never be applied.
+         * It's OK to touch the nodes outside the lock because aws_h2_stream_update_window()
+         * won't touch them after s_stop() has been invoked. */
+        struct aws_linked_list window_update_streams;
+        aws_linked_list_init(&window_update_streams);
+        { /* BEGIN CRITICAL SECTION */
+            s_lock_synced_data(connection);
+            aws_linked_list_swap_contents(&connection->synced_data.window_update_stream_list, &window_update_streams);
+            s_unlock_synced_data(connection);
+        } /* END CRITICAL SECTION */
+
+        while (!aws_linked_list_empty(&window_update_streams)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&window_update_streams);
+            struct aws_h2_stream *stream = AWS_CONTAINER_OF(node, struct aws_h2_stream, synced_data.window_update_node);
+            aws_http_stream_release(&stream->base);
+        }
     }
 
     aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
@@ -1273,3 +1871,24 @@ static size_t s_handler_message_overhead(struct aws_channel_handler *handler) {
     /* "All frames begin with a fixed 9-octet header followed by a variable-length payload" (RFC-7540 4.1) */
     return 9;
 }
+
+static void s_reset_statistics(struct aws_channel_handler *handler) {
+    struct aws_h2_connection *connection = handler->impl;
+
+    aws_crt_statistics_http2_channel_reset(&connection->thread_data.stats);
+}
+
+static void s_gather_statistics(struct aws_channel_handler *handler, struct aws_array_list *stats) {
+    struct aws_h2_connection *connection = handler->impl;
+
+    connection->thread_data.stats.stream_window_size = connection->thread_data.window_autotune.stream_window_size;
+    connection->thread_data.stats.connection_window_size =
+        connection->thread_data.window_autotune.connection_window_size;
+    connection->thread_data.stats.rtt_ms = aws_timestamp_convert(
+        connection->thread_data.window_autotune.rtt_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
+    connection->thread_data.stats.max_bandwidth_bytes_per_sec =
+        connection->thread_data.window_autotune.max_bandwidth_bytes_per_sec;
+
+    void *stats_base = &connection->thread_data.stats;
+    aws_array_list_push_back(stats, &stats_base);
+}
@@ -216,6 +216,7 @@ struct aws_h2_decoder {
             bool end_stream;
             bool end_headers;
             bool priority;
+            bool padded;
         } flags;
     } frame_in_progress;
 
@@ -461,6 +462,18 @@ static int s_decoder_switch_state(struct aws_h2_decoder *decoder, const struct d
 
 static int s_decoder_switch_to_frame_state(struct aws_h2_decoder *decoder) {
     AWS_ASSERT(decoder->frame_in_progress.type < AWS_H2_FRAME_TYPE_COUNT);
+
+    if (decoder->frame_in_progress.type == AWS_H2_FRAME_T_DATA) {
+        /* Padding length is known by now, so report the whole frame, which counts against flow-control windows */
+        uint32_t total_padding_bytes = 0;
+        if (decoder->frame_in_progress.flags.padded) {
+            total_padding_bytes = s_state_padding_len_requires_1_bytes + decoder->frame_in_progress.padding_len;
+        }
+        uint32_t payload_len = decoder->frame_in_progress.payload_len + total_padding_bytes;
+        DECODER_CALL_VTABLE_STREAM_ARGS(
+            decoder, on_data_begin, payload_len, total_padding_bytes, decoder->frame_in_progress.flags.end_stream);
+    }
+
     return s_decoder_switch_state(decoder, s_state_frames[decoder->frame_in_progress.type]);
 }
 
@@ -580,6 +593,7 @@ static int s_state_fn_prefix(struct aws_h2_decoder *decoder, struct aws_byte_cur
     const uint8_t flags = raw_flags & s_acceptable_flags_for_frame[decoder->frame_in_progress.type];
 
     bool is_padded = flags & AWS_H2_FRAME_F_PADDED;
+    decoder->frame_in_progress.flags.padded = is_padded;
     decoder->frame_in_progress.flags.ack = flags & AWS_H2_FRAME_F_ACK;
     decoder->frame_in_progress.flags.end_stream = flags & AWS_H2_FRAME_F_END_STREAM;
     decoder->frame_in_progress.flags.end_headers = flags & AWS_H2_FRAME_F_END_HEADERS;
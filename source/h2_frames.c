@@ -152,6 +152,8 @@ enum aws_h2_error_code aws_error_to_h2_error_code(int aws_error_code) {
             return AWS_H2_ERR_FRAME_SIZE_ERROR;
         case AWS_ERROR_HTTP_COMPRESSION:
             return AWS_H2_ERR_COMPRESSION_ERROR;
+        case AWS_ERROR_HTTP_FLOW_CONTROL_ERROR:
+            return AWS_H2_ERR_FLOW_CONTROL_ERROR;
         default:
             return AWS_H2_ERR_INTERNAL_ERROR;
     }
@@ -316,11 +318,15 @@ int aws_h2_encode_data_frame(
     struct aws_input_stream *body_stream,
     bool body_ends_stream,
     uint8_t pad_length,
+    int32_t *stream_window_size_peer,
+    size_t *connection_window_size_peer,
     struct aws_byte_buf *output,
     bool *body_complete) {
 
     AWS_PRECONDITION(encoder);
     AWS_PRECONDITION(body_stream);
+    AWS_PRECONDITION(stream_window_size_peer);
+    AWS_PRECONDITION(connection_window_size_peer);
     AWS_PRECONDITION(output);
     AWS_PRECONDITION(body_complete);
 
@@ -355,6 +361,15 @@ int aws_h2_encode_data_frame(
         goto handle_waiting_for_more_space;
     }
 
+    /* Flow-control windows limit the whole payload, padding included (RFC-7540 6.9.1) */
+    if (*stream_window_size_peer <= 0 || *connection_window_size_peer == 0) {
+        goto handle_waiting_for_window;
+    }
+    size_t max_payload_given_windows = aws_min_size((size_t)*stream_window_size_peer, *connection_window_size_peer);
+    if (max_payload > max_payload_given_windows) {
+        max_payload = max_payload_given_windows;
+    }
+
     /* Max amount of body we can fit in the payload*/
     size_t max_body;
     if (aws_sub_size_checked(max_payload, payload_overhead, &max_body) || max_body == 0) {
@@ -420,12 +435,21 @@ int aws_h2_encode_data_frame(
     }
 
     AWS_ASSERT(writes_ok);
+
+    /* Consume flow-control windows */
+    *stream_window_size_peer -= (int32_t)payload_len;
+    *connection_window_size_peer -= payload_len;
+
     return AWS_OP_SUCCESS;
 
 handle_waiting_for_more_space:
     ENCODER_LOGF(TRACE, encoder, "Insufficient space to encode DATA for stream %" PRIu32 " right now", stream_id);
     return AWS_OP_SUCCESS;
 
+handle_waiting_for_window:
+    ENCODER_LOGF(TRACE, encoder, "Flow-control window exhausted, can't send DATA for stream %" PRIu32, stream_id);
+    return AWS_OP_SUCCESS;
+
 handle_nothing_to_send_right_now:
     ENCODER_LOGF(INFO, encoder, "Stream %" PRIu32 " produced 0 bytes of body data", stream_id);
     return AWS_OP_SUCCESS;
@@ -16,6 +16,7 @@
 #include <aws/http/private/h2_stream.h>
 
 #include <aws/http/private/h2_connection.h>
+#include <aws/http/private/h2_stream_scheduler.h>
 #include <aws/http/private/strutil.h>
 #include <aws/http/status_code.h>
 #include <aws/io/channel.h>
@@ -25,8 +26,11 @@ static void s_stream_destroy(struct aws_http_stream *stream_base);
 
 struct aws_http_stream_vtable s_h2_stream_vtable = {
     .destroy = s_stream_destroy,
-    .update_window = NULL,
+    .update_window = aws_h2_stream_update_window,
     .activate = aws_h2_stream_activate,
+    .http1_write_chunk = NULL,
+    .resume_outgoing_body = NULL,
+    .http1_recycle_response_body_buffer = NULL,
 };
 
 const char *aws_h2_stream_state_to_str(enum aws_h2_stream_state state) {
@@ -183,6 +187,29 @@ struct aws_h2_stream *aws_h2_stream_new_request(
     AWS_PRECONDITION(client_connection);
     AWS_PRECONDITION(options);
 
+    if (options->request_template || options->response_body_buffers || options->decompress_response_body) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: Request templates, response body buffers, and response body decompression are not supported on "
+            "HTTP/2 connections yet.",
+            (void *)client_connection);
+        aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+        return NULL;
+    }
+
+    struct aws_http2_stream_priority priority = AWS_HTTP2_STREAM_PRIORITY_INIT;
+    if (options->http2_priority) {
+        priority = *options->http2_priority;
+        if (priority.weight < 1 || priority.weight > 256 || priority.urgency > 7) {
+            AWS_LOGF_ERROR(
+                AWS_LS_HTTP_STREAM,
+                "id=%p: Invalid HTTP/2 stream priority, weight must be 1-256 and urgency must be 0-7.",
+                (void *)client_connection);
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            return NULL;
+        }
+    }
+
     struct aws_h2_stream *stream = aws_mem_calloc(client_connection->alloc, 1, sizeof(struct aws_h2_stream));
     if (!stream) {
         return NULL;
@@ -195,11 +222,19 @@ struct aws_h2_stream *aws_h2_stream_new_request(
     stream->base.user_data = options->user_data;
     stream->base.on_incoming_headers = options->on_response_headers;
     stream->base.on_incoming_header_block_done = options->on_response_header_block_done;
+    stream->base.on_incoming_header_block = options->on_response_header_block;
     stream->base.on_incoming_body = options->on_response_body;
     stream->base.on_complete = options->on_complete;
     stream->base.client_data = &stream->base.client_or_server_data.client;
     stream->base.client_data->response_status = AWS_HTTP_STATUS_CODE_UNKNOWN;
 
+    if (stream->base.on_incoming_header_block) {
+        if (aws_http_header_block_buffer_init(&stream->base.incoming_header_block, client_connection->alloc)) {
+            aws_mem_release(client_connection->alloc, stream);
+            return NULL;
+        }
+    }
+
     /* Stream refcount starts at 1, and gets incremented again for the connection upon a call to activate() */
     aws_atomic_init_int(&stream->base.refcount, 1);
 
@@ -207,6 +242,8 @@ struct aws_h2_stream *aws_h2_stream_new_request(
     stream->thread_data.state = AWS_H2_STREAM_STATE_IDLE;
     stream->thread_data.outgoing_message = options->request;
     aws_http_message_acquire(stream->thread_data.outgoing_message);
+    stream->thread_data.priority = priority;
+    aws_linked_list_init(&stream->thread_data.scheduler.active_children);
 
     return stream;
 }
@@ -218,6 +255,7 @@ static void s_stream_destroy(struct aws_http_stream *stream_base) {
     AWS_H2_STREAM_LOG(DEBUG, stream, "Destroying stream");
 
     aws_http_message_release(stream->thread_data.outgoing_message);
+    aws_http_header_block_buffer_clean_up(&stream->base.incoming_header_block);
 
     aws_mem_release(stream->base.alloc, stream);
 }
@@ -271,19 +309,35 @@ int aws_h2_stream_on_activated(struct aws_h2_stream *stream, bool *out_has_outgo
     /* Create HEADERS frame */
     const struct aws_http_message *msg = stream->thread_data.outgoing_message;
     bool has_body_stream = aws_http_message_get_body_stream(msg) != NULL;
+
+    /* Only tell peer about dependency and weight if they're what this side schedules by.
+     * Weight is sent as 0-255, meaning 1-256 (RFC-7540 6.3) */
+    struct aws_h2_frame_priority_settings priority_settings = {
+        .stream_dependency = stream->thread_data.priority.dependency_stream_id,
+        .stream_dependency_exclusive = stream->thread_data.priority.exclusive,
+        .weight = (uint8_t)(stream->thread_data.priority.weight - 1),
+    };
+    const bool sends_priority = connection->thread_data.stream_scheduler->sends_priority;
+
     struct aws_h2_frame *headers_frame = aws_h2_frame_new_headers(
         stream->base.alloc,
         stream->base.id,
         aws_http_message_get_const_headers(msg),
         !has_body_stream /* end_stream */,
         0 /* padding - not currently configurable via public API */,
-        NULL /* priority - not currently configurable via public API */);
+        sends_priority ? &priority_settings : NULL);
 
     if (!headers_frame) {
         AWS_H2_STREAM_LOGF(ERROR, stream, "Failed to create HEADERS frame: %s", aws_error_name(aws_last_error()));
         goto error;
     }
 
+    /* Initial flow-control windows come from each side's SETTINGS_INITIAL_WINDOW_SIZE (RFC-7540 6.9.2) */
+    stream->thread_data.window_size_peer =
+        (int32_t)connection->thread_data.settings_peer[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE];
+    stream->thread_data.window_size_self =
+        (int32_t)connection->thread_data.settings_self[AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE];
+
     if (has_body_stream) {
         /* If stream has DATA to send, put it in the outgoing_streams_list, and we'll send data later */
         stream->thread_data.state = AWS_H2_STREAM_STATE_OPEN;
@@ -299,6 +353,15 @@ int aws_h2_stream_on_activated(struct aws_h2_stream *stream, bool *out_has_outgo
     }
 
     aws_h2_connection_enqueue_outgoing_frame(connection, headers_frame);
+
+    if (stream->thread_data.window_update_before_open) {
+        const size_t increment_size = stream->thread_data.window_update_before_open;
+        stream->thread_data.window_update_before_open = 0;
+        if (aws_h2_stream_apply_window_update(stream, increment_size)) {
+            goto error;
+        }
+    }
+
     return AWS_OP_SUCCESS;
 
 error:
@@ -372,6 +435,14 @@ int aws_h2_stream_on_decoder_headers_i(
         }
     }
 
+    /* Decoder's header data isn't stable, so copy it until the whole block can be delivered */
+    if (stream->base.on_incoming_header_block) {
+        if (aws_http_header_block_buffer_add(&stream->base.incoming_header_block, header, name_enum)) {
+            AWS_H2_STREAM_LOGF(ERROR, stream, "Failed to buffer incoming header, %s", aws_error_name(aws_last_error()));
+            return AWS_OP_ERR;
+        }
+    }
+
     if (stream->base.on_incoming_headers) {
         if (stream->base.on_incoming_headers(&stream->base, block_type, header, 1, stream->base.user_data)) {
             AWS_H2_STREAM_LOGF(
@@ -416,6 +487,10 @@ int aws_h2_stream_on_decoder_headers_end(
             AWS_ASSERT(0);
     }
 
+    if (aws_http_stream_deliver_incoming_header_block(&stream->base, block_type)) {
+        return AWS_OP_ERR;
+    }
+
     if (stream->base.on_incoming_header_block_done) {
         if (stream->base.on_incoming_header_block_done(&stream->base, block_type, stream->base.user_data)) {
             AWS_H2_STREAM_LOGF(
@@ -427,10 +502,30 @@ int aws_h2_stream_on_decoder_headers_end(
         }
     }
 
+    aws_http_header_block_buffer_reset(&stream->base.incoming_header_block);
     return AWS_OP_SUCCESS;
 }
 
-int aws_h2_stream_on_decoder_data(struct aws_h2_stream *stream, struct aws_byte_cursor data) {
+/* Open our flow-control window, letting peer send more DATA */
+static int s_send_window_update(struct aws_h2_stream *stream, uint32_t window_size_increment) {
+    struct aws_h2_frame *window_update_frame =
+        aws_h2_frame_new_window_update(stream->base.alloc, stream->base.id, window_size_increment);
+    if (!window_update_frame) {
+        AWS_H2_STREAM_LOGF(ERROR, stream, "Error creating WINDOW_UPDATE frame, %s", aws_error_name(aws_last_error()));
+        return AWS_OP_ERR;
+    }
+    aws_h2_connection_enqueue_outgoing_frame(s_get_h2_connection(stream), window_update_frame);
+
+    stream->thread_data.window_size_self += (int32_t)window_size_increment;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_h2_stream_on_decoder_data_begin(
+    struct aws_h2_stream *stream,
+    uint32_t payload_len,
+    uint32_t total_padding_bytes,
+    bool end_stream) {
+
     AWS_PRECONDITION_ON_CHANNEL_THREAD(stream);
 
     if (s_check_state_allows_frame_type(stream, AWS_H2_FRAME_T_DATA)) {
@@ -443,7 +538,50 @@ int aws_h2_stream_on_decoder_data(struct aws_h2_stream *stream, struct aws_byte_
         return s_send_rst_and_close_stream(stream, AWS_ERROR_HTTP_PROTOCOL_ERROR);
     }
 
-    /* #TODO Update stream's flow-control window */
+    /* Peer must not send more than our flow-control window allows (RFC-7540 6.9.1) */
+    if ((int64_t)payload_len > stream->thread_data.window_size_self) {
+        AWS_H2_STREAM_LOGF(
+            ERROR,
+            stream,
+            "DATA frame with %" PRIu32 " byte payload exceeds flow-control window of %" PRId32,
+            payload_len,
+            stream->thread_data.window_size_self);
+        return s_send_rst_and_close_stream(stream, AWS_ERROR_HTTP_FLOW_CONTROL_ERROR);
+    }
+    stream->thread_data.window_size_self -= (int32_t)payload_len;
+
+    /* No more DATA can follow END_STREAM, so there's no point opening the window again */
+    if (end_stream) {
+        return AWS_OP_SUCCESS;
+    }
+
+    uint32_t auto_window_update_size = 0;
+    if (stream->base.owning_connection->manual_window_management) {
+        /* User only sees the body, and updates the window accordingly. Padding is given back right away. */
+        auto_window_update_size = total_padding_bytes;
+    } else {
+        /* Top the window back up once half of it is used, rather than sending WINDOW_UPDATE for every frame.
+         * The connection may have grown the target size beyond the initial window, to keep up with its BDP. */
+        const uint32_t target_window_size = s_get_h2_connection(stream)->thread_data.window_autotune.stream_window_size;
+        if (stream->thread_data.window_size_self <= (int32_t)(target_window_size / 2)) {
+            auto_window_update_size = target_window_size - (uint32_t)stream->thread_data.window_size_self;
+        }
+    }
+
+    if (auto_window_update_size > 0) {
+        return s_send_window_update(stream, auto_window_update_size);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_h2_stream_on_decoder_data(struct aws_h2_stream *stream, struct aws_byte_cursor data) {
+    AWS_PRECONDITION_ON_CHANNEL_THREAD(stream);
+
+    /* Not calling s_check_state_allows_frame_type() here because we already checked
+     * at start of DATA frame in aws_h2_stream_on_decoder_data_begin() */
+
+    stream->base.incoming_body_wire_bytes = data.len;
 
     if (stream->base.on_incoming_body) {
         if (stream->base.on_incoming_body(&stream->base, &data, stream->base.user_data)) {
@@ -485,3 +623,91 @@ int aws_h2_stream_on_decoder_end_stream(struct aws_h2_stream *stream) {
 
     return AWS_OP_SUCCESS;
 }
+
+int aws_h2_stream_on_decoder_window_update(
+    struct aws_h2_stream *stream,
+    uint32_t window_size_increment,
+    bool *out_window_resumed) {
+
+    AWS_PRECONDITION_ON_CHANNEL_THREAD(stream);
+    *out_window_resumed = false;
+
+    if (s_check_state_allows_frame_type(stream, AWS_H2_FRAME_T_WINDOW_UPDATE)) {
+        return s_send_rst_and_close_stream(stream, aws_last_error());
+    }
+
+    if (window_size_increment == 0) {
+        /* RFC-7540 6.9: A receiver MUST treat the receipt of a WINDOW_UPDATE frame with a
+         * flow-control window increment of 0 as a stream error of type PROTOCOL_ERROR */
+        AWS_H2_STREAM_LOG(ERROR, stream, "Received WINDOW_UPDATE with 0 increment");
+        return s_send_rst_and_close_stream(stream, AWS_ERROR_HTTP_PROTOCOL_ERROR);
+    }
+
+    if ((int64_t)stream->thread_data.window_size_peer + window_size_increment > AWS_H2_WINDOW_UPDATE_MAX) {
+        /* RFC-7540 6.9.1: flow-control window must not exceed 2^31-1 */
+        AWS_H2_STREAM_LOGF(
+            ERROR,
+            stream,
+            "WINDOW_UPDATE increment of %" PRIu32 " would overflow flow-control window of %" PRId32,
+            window_size_increment,
+            stream->thread_data.window_size_peer);
+        return s_send_rst_and_close_stream(stream, AWS_ERROR_HTTP_FLOW_CONTROL_ERROR);
+    }
+
+    bool was_exhausted = stream->thread_data.window_size_peer <= 0;
+    stream->thread_data.window_size_peer += (int32_t)window_size_increment;
+    *out_window_resumed = was_exhausted && stream->thread_data.window_size_peer > 0;
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_h2_stream_on_end_stream_sent(struct aws_h2_stream *stream) {
+    AWS_PRECONDITION_ON_CHANNEL_THREAD(stream);
+
+    if (stream->thread_data.state == AWS_H2_STREAM_STATE_HALF_CLOSED_REMOTE) {
+        /* Both sides have sent END_STREAM */
+        stream->thread_data.state = AWS_H2_STREAM_STATE_CLOSED;
+        AWS_H2_STREAM_LOG(TRACE, stream, "Sent END_STREAM. State -> CLOSED");
+
+        /* Tell connection that stream is now closed */
+        return aws_h2_connection_on_stream_closed(
+            s_get_h2_connection(stream), stream, AWS_H2_STREAM_CLOSED_WHEN_BOTH_SIDES_END_STREAM, AWS_ERROR_SUCCESS);
+    }
+
+    AWS_ASSERT(stream->thread_data.state == AWS_H2_STREAM_STATE_OPEN);
+    stream->thread_data.state = AWS_H2_STREAM_STATE_HALF_CLOSED_LOCAL;
+    AWS_H2_STREAM_LOG(TRACE, stream, "Sent END_STREAM. State -> HALF_CLOSED_LOCAL");
+    return AWS_OP_SUCCESS;
+}
+
+int aws_h2_stream_apply_window_update(struct aws_h2_stream *stream, size_t increment_size) {
+    AWS_PRECONDITION_ON_CHANNEL_THREAD(stream);
+
+    /* Stream might be waiting for the connection to have room for it. Apply the update once it's opened */
+    const enum aws_h2_stream_state state = stream->thread_data.state;
+    if (state == AWS_H2_STREAM_STATE_IDLE) {
+        stream->thread_data.window_update_before_open =
+            aws_add_size_saturating(stream->thread_data.window_update_before_open, increment_size);
+        return AWS_OP_SUCCESS;
+    }
+
+    /* Peer only sends DATA in these states. Otherwise the stream is done receiving. */
+    if (state != AWS_H2_STREAM_STATE_OPEN && state != AWS_H2_STREAM_STATE_HALF_CLOSED_LOCAL) {
+        AWS_H2_STREAM_LOGF(TRACE, stream, "Ignoring window update of %zu, peer can't send DATA now", increment_size);
+        return AWS_OP_SUCCESS;
+    }
+
+    /* Window must not exceed 2^31-1, or peer would treat it as a FLOW_CONTROL_ERROR (RFC-7540 6.9.1) */
+    const size_t max_increment = (size_t)(AWS_H2_WINDOW_UPDATE_MAX - stream->thread_data.window_size_self);
+    if (increment_size > max_increment) {
+        AWS_H2_STREAM_LOGF(
+            DEBUG, stream, "Window update of %zu reduced to %zu, the max window size", increment_size, max_increment);
+        increment_size = max_increment;
+    }
+
+    if (increment_size == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    return s_send_window_update(stream, (uint32_t)increment_size);
+}
@@ -0,0 +1,376 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/http/private/h2_stream_scheduler.h>
+
+#include <aws/http/private/h2_connection.h>
+#include <aws/http/private/h2_stream.h>
+
+#define FOREACH_OUTGOING_STREAM(CONNECTION, STREAM)                                                                    \
+    for (struct aws_linked_list_node *STREAM##_node =                                                                  \
+             aws_linked_list_begin(&(CONNECTION)->thread_data.outgoing_streams_list);                                  \
+         STREAM##_node != aws_linked_list_end(&(CONNECTION)->thread_data.outgoing_streams_list) &&                     \
+         ((STREAM) = AWS_CONTAINER_OF(STREAM##_node, struct aws_h2_stream, node));                                     \
+         STREAM##_node = aws_linked_list_next(STREAM##_node))
+
+/* For schedulers that have no use for an event */
+static void s_ignore_stream_event(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    (void)connection;
+    (void)stream;
+}
+
+/*****************************************************************************
+ * Common to fair-queueing schedulers.
+ *
+ * Each stream has a virtual time, which advances by the bytes it sends divided by its share of bandwidth.
+ * The stream furthest behind goes next, so over time each stream gets its share.
+ * A stream that had nothing to send doesn't get to "save up" bandwidth,
+ * it's brought up to the current virtual time when it becomes ready again.
+ ****************************************************************************/
+
+static void s_fair_queue_on_stream_activated(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    stream->thread_data.scheduler.virtual_time = connection->thread_data.stream_scheduler_data.virtual_time;
+    stream->thread_data.scheduler.share = 1.0;
+}
+
+static void s_fair_queue_on_data_sent(
+    struct aws_h2_connection *connection,
+    struct aws_h2_stream *stream,
+    size_t payload_len) {
+
+    (void)connection;
+    AWS_ASSERT(stream->thread_data.scheduler.share > 0.0);
+    stream->thread_data.scheduler.virtual_time += (double)payload_len / stream->thread_data.scheduler.share;
+}
+
+/* Of the candidates, choose the one furthest behind. Ties go to whoever's first in the list. */
+static struct aws_h2_stream *s_fair_queue_choose(
+    struct aws_h2_connection *connection,
+    bool (*is_candidate)(struct aws_h2_connection *connection, struct aws_h2_stream *stream)) {
+
+    const double now = connection->thread_data.stream_scheduler_data.virtual_time;
+    struct aws_h2_stream *chosen = NULL;
+    struct aws_h2_stream *stream = NULL;
+    FOREACH_OUTGOING_STREAM(connection, stream) {
+        if (!is_candidate(connection, stream)) {
+            continue;
+        }
+
+        if (stream->thread_data.scheduler.virtual_time < now) {
+            stream->thread_data.scheduler.virtual_time = now;
+        }
+
+        if (!chosen || stream->thread_data.scheduler.virtual_time < chosen->thread_data.scheduler.virtual_time) {
+            chosen = stream;
+        }
+    }
+
+    AWS_ASSERT(chosen);
+    connection->thread_data.stream_scheduler_data.virtual_time = chosen->thread_data.scheduler.virtual_time;
+    return chosen;
+}
+
+/*****************************************************************************
+ * Round-robin: streams take turns sending 1 frame each.
+ * The connection moves a stream to the back of the list after it sends a frame,
+ * so the stream at the front is the one whose turn it is.
+ ****************************************************************************/
+
+static struct aws_h2_stream *s_round_robin_choose_stream(struct aws_h2_connection *connection) {
+    struct aws_linked_list_node *node = aws_linked_list_front(&connection->thread_data.outgoing_streams_list);
+    return AWS_CONTAINER_OF(node, struct aws_h2_stream, node);
+}
+
+static void s_round_robin_on_data_sent(
+    struct aws_h2_connection *connection,
+    struct aws_h2_stream *stream,
+    size_t payload_len) {
+
+    (void)connection;
+    (void)stream;
+    (void)payload_len;
+}
+
+static const struct aws_h2_stream_scheduler_vtable s_round_robin_vtable = {
+    .on_stream_activated = s_ignore_stream_event,
+    .on_stream_ready = s_ignore_stream_event,
+    .on_stream_unready = s_ignore_stream_event,
+    .on_stream_complete = s_ignore_stream_event,
+    .choose_stream = s_round_robin_choose_stream,
+    .on_data_sent = s_round_robin_on_data_sent,
+    .sends_priority = false,
+};
+
+/*****************************************************************************
+ * Dependency: RFC-7540 5.3.
+ * A stream only gets bandwidth if none of its ancestors have DATA ready.
+ * Bandwidth is split among siblings in proportion to their weights,
+ * counting only siblings with DATA ready somewhere in their subtree.
+ *
+ * Each stream counts the ready streams in its subtree, and while that's non-zero the stream is linked into
+ * its parent's list of active children. Readiness changes cost O(depth), and choosing a stream only looks at
+ * active children on the way down from the root, so sending DATA doesn't rescan every stream.
+ * Siblings are fair-queued. A stream's virtual time advances by the bytes sent from its subtree,
+ * divided by its weight.
+ *
+ * When a stream closes, its dependents should move up to its parent (RFC-7540 5.3.4),
+ * but closed streams are forgotten, so their dependents move up to the root instead.
+ ****************************************************************************/
+
+static struct aws_h2_stream *s_get_active_stream(struct aws_h2_connection *connection, uint32_t stream_id) {
+    if (stream_id == 0) {
+        return NULL;
+    }
+
+    struct aws_hash_element *found = NULL;
+    aws_hash_table_find(&connection->thread_data.active_streams_map, (void *)(size_t)stream_id, &found);
+    return found ? found->value : NULL;
+}
+
+static struct aws_h2_stream *s_get_parent(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    return s_get_active_stream(connection, stream->thread_data.priority.dependency_stream_id);
+}
+
+static void s_link_active_child(
+    struct aws_h2_connection *connection,
+    struct aws_h2_stream *parent,
+    struct aws_h2_stream *child) {
+
+    struct aws_linked_list *active_children = &connection->thread_data.stream_scheduler_data.root_active_children;
+    double *children_virtual_time = &connection->thread_data.stream_scheduler_data.virtual_time;
+    if (parent) {
+        active_children = &parent->thread_data.scheduler.active_children;
+        children_virtual_time = &parent->thread_data.scheduler.children_virtual_time;
+    }
+
+    /* A child that had nothing to send doesn't get to "save up" bandwidth */
+    if (child->thread_data.scheduler.virtual_time < *children_virtual_time) {
+        child->thread_data.scheduler.virtual_time = *children_virtual_time;
+    } else if (aws_linked_list_empty(active_children)) {
+        *children_virtual_time = child->thread_data.scheduler.virtual_time;
+    }
+
+    aws_linked_list_push_back(active_children, &child->thread_data.scheduler.active_sibling_node);
+}
+
+/* Add delta to the ready count of the stream and all its ancestors,
+ * linking or unlinking each one from its parent's active children as its count becomes non-zero or zero */
+static void s_add_ready_count(struct aws_h2_connection *connection, struct aws_h2_stream *stream, int64_t delta) {
+    struct aws_h2_stream *node = stream;
+    while (node) {
+        struct aws_h2_stream *parent = s_get_parent(connection, node);
+        const uint32_t prev_count = node->thread_data.scheduler.ready_count;
+        AWS_ASSERT((int64_t)prev_count + delta >= 0);
+        node->thread_data.scheduler.ready_count = (uint32_t)((int64_t)prev_count + delta);
+
+        if (prev_count == 0 && node->thread_data.scheduler.ready_count > 0) {
+            s_link_active_child(connection, parent, node);
+        } else if (prev_count > 0 && node->thread_data.scheduler.ready_count == 0) {
+            aws_linked_list_remove(&node->thread_data.scheduler.active_sibling_node);
+        }
+
+        node = parent;
+    }
+}
+
+/* Move the stream, and its subtree's ready count, under a new parent */
+static void s_set_parent(struct aws_h2_connection *connection, struct aws_h2_stream *stream, uint32_t parent_id) {
+    const uint32_t ready_count = stream->thread_data.scheduler.ready_count;
+    if (ready_count > 0) {
+        aws_linked_list_remove(&stream->thread_data.scheduler.active_sibling_node);
+        s_add_ready_count(connection, s_get_parent(connection, stream), -(int64_t)ready_count);
+    }
+
+    stream->thread_data.priority.dependency_stream_id = parent_id;
+
+    if (ready_count > 0) {
+        struct aws_h2_stream *parent = s_get_parent(connection, stream);
+        s_link_active_child(connection, parent, stream);
+        s_add_ready_count(connection, parent, ready_count);
+    }
+}
+
+static void s_dependency_on_stream_activated(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    /* Only depend on older streams that are still around, this guarantees there are no cycles */
+    struct aws_http2_stream_priority *priority = &stream->thread_data.priority;
+    if (priority->dependency_stream_id >= stream->base.id ||
+        !s_get_active_stream(connection, priority->dependency_stream_id)) {
+
+        priority->dependency_stream_id = 0;
+    }
+
+    /* Adopt the parent's other dependents (RFC-7540 5.3.3) */
+    if (priority->exclusive) {
+        struct aws_hash_iter iter = aws_hash_iter_begin(&connection->thread_data.active_streams_map);
+        for (; !aws_hash_iter_done(&iter); aws_hash_iter_next(&iter)) {
+            struct aws_h2_stream *sibling = iter.element.value;
+            if (sibling != stream &&
+                sibling->thread_data.priority.dependency_stream_id == priority->dependency_stream_id) {
+
+                s_set_parent(connection, sibling, stream->base.id);
+            }
+        }
+    }
+}
+
+static void s_dependency_on_stream_ready(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    AWS_ASSERT(!stream->thread_data.scheduler.is_ready);
+    stream->thread_data.scheduler.is_ready = true;
+    s_add_ready_count(connection, stream, 1);
+}
+
+static void s_dependency_on_stream_unready(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    AWS_ASSERT(stream->thread_data.scheduler.is_ready);
+    stream->thread_data.scheduler.is_ready = false;
+    s_add_ready_count(connection, stream, -1);
+}
+
+static void s_dependency_on_stream_complete(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    if (stream->thread_data.scheduler.is_ready) {
+        s_dependency_on_stream_unready(connection, stream);
+    }
+
+    /* Active dependents move up to the root */
+    struct aws_linked_list *active_children = &stream->thread_data.scheduler.active_children;
+    while (!aws_linked_list_empty(active_children)) {
+        struct aws_linked_list_node *node = aws_linked_list_front(active_children);
+        s_set_parent(
+            connection, AWS_CONTAINER_OF(node, struct aws_h2_stream, thread_data.scheduler.active_sibling_node), 0);
+    }
+
+    /* The count can be stale if the stream was already forgotten while the connection shuts down */
+    if (stream->thread_data.scheduler.active_sibling_node.next) {
+        aws_linked_list_remove(&stream->thread_data.scheduler.active_sibling_node);
+    }
+    stream->thread_data.scheduler.ready_count = 0;
+}
+
+/* From the root down, choose the active child that's furthest behind, until reaching a ready stream */
+static struct aws_h2_stream *s_dependency_choose_stream(struct aws_h2_connection *connection) {
+    struct aws_linked_list *active_children = &connection->thread_data.stream_scheduler_data.root_active_children;
+    double *children_virtual_time = &connection->thread_data.stream_scheduler_data.virtual_time;
+
+    while (true) {
+        AWS_ASSERT(!aws_linked_list_empty(active_children));
+
+        /* Ties go to whoever's first in the list */
+        struct aws_h2_stream *chosen = NULL;
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(active_children);
+             node != aws_linked_list_end(active_children);
+             node = aws_linked_list_next(node)) {
+
+            struct aws_h2_stream *child =
+                AWS_CONTAINER_OF(node, struct aws_h2_stream, thread_data.scheduler.active_sibling_node);
+            if (!chosen || child->thread_data.scheduler.virtual_time < chosen->thread_data.scheduler.virtual_time) {
+                chosen = child;
+            }
+        }
+
+        *children_virtual_time = chosen->thread_data.scheduler.virtual_time;
+        if (chosen->thread_data.scheduler.is_ready) {
+            return chosen;
+        }
+
+        active_children = &chosen->thread_data.scheduler.active_children;
+        children_virtual_time = &chosen->thread_data.scheduler.children_virtual_time;
+    }
+}
+
+static void s_dependency_on_data_sent(
+    struct aws_h2_connection *connection,
+    struct aws_h2_stream *stream,
+    size_t payload_len) {
+
+    for (struct aws_h2_stream *node = stream; node; node = s_get_parent(connection, node)) {
+        node->thread_data.scheduler.virtual_time += (double)payload_len / (double)node->thread_data.priority.weight;
+    }
+}
+
+static const struct aws_h2_stream_scheduler_vtable s_dependency_vtable = {
+    .on_stream_activated = s_dependency_on_stream_activated,
+    .on_stream_ready = s_dependency_on_stream_ready,
+    .on_stream_unready = s_dependency_on_stream_unready,
+    .on_stream_complete = s_dependency_on_stream_complete,
+    .choose_stream = s_dependency_choose_stream,
+    .on_data_sent = s_dependency_on_data_sent,
+    .sends_priority = true,
+};
+
+/*****************************************************************************
+ * Urgency: modeled on RFC-9218.
+ * Only streams of the most urgent level get bandwidth.
+ * Non-incremental streams go one at a time, oldest first. Then incremental streams share bandwidth equally.
+ ****************************************************************************/
+
+static bool s_urgency_is_candidate(struct aws_h2_connection *connection, struct aws_h2_stream *stream) {
+    return stream->thread_data.scheduler.active_pass == connection->thread_data.stream_scheduler_data.pass;
+}
+
+static struct aws_h2_stream *s_urgency_choose_stream(struct aws_h2_connection *connection) {
+    struct aws_h2_stream *stream = NULL;
+
+    uint8_t most_urgent = UINT8_MAX;
+    FOREACH_OUTGOING_STREAM(connection, stream) {
+        if (stream->thread_data.priority.urgency < most_urgent) {
+            most_urgent = stream->thread_data.priority.urgency;
+        }
+    }
+
+    struct aws_h2_stream *oldest_non_incremental = NULL;
+    FOREACH_OUTGOING_STREAM(connection, stream) {
+        if (stream->thread_data.priority.urgency == most_urgent && !stream->thread_data.priority.incremental) {
+            if (!oldest_non_incremental || stream->base.id < oldest_non_incremental->base.id) {
+                oldest_non_incremental = stream;
+            }
+        }
+    }
+
+    if (oldest_non_incremental) {
+        return oldest_non_incremental;
+    }
+
+    const uint64_t pass = ++connection->thread_data.stream_scheduler_data.pass;
+    FOREACH_OUTGOING_STREAM(connection, stream) {
+        if (stream->thread_data.priority.urgency == most_urgent) {
+            stream->thread_data.scheduler.active_pass = pass;
+        }
+    }
+
+    return s_fair_queue_choose(connection, s_urgency_is_candidate);
+}
+
+static const struct aws_h2_stream_scheduler_vtable s_urgency_vtable = {
+    .on_stream_activated = s_fair_queue_on_stream_activated,
+    .on_stream_ready = s_ignore_stream_event,
+    .on_stream_unready = s_ignore_stream_event,
+    .on_stream_complete = s_ignore_stream_event,
+    .choose_stream = s_urgency_choose_stream,
+    .on_data_sent = s_fair_queue_on_data_sent,
+    .sends_priority = false,
+};
+
+const struct aws_h2_stream_scheduler_vtable *aws_h2_stream_scheduler_get(enum aws_http2_stream_scheduler type) {
+    switch (type) {
+        case AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN:
+            return &s_round_robin_vtable;
+        case AWS_HTTP2_STREAM_SCHEDULER_DEPENDENCY:
+            return &s_dependency_vtable;
+        case AWS_HTTP2_STREAM_SCHEDULER_URGENCY:
+            return &s_urgency_vtable;
+        default:
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            return NULL;
+    }
+}
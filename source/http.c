@@ -13,20 +13,15 @@
  * permissions and limitations under the License.
  */
 
-#include <aws/common/hash_table.h>
 #include <aws/compression/compression.h>
+#include <aws/http/private/h1_encoder.h>
 #include <aws/http/private/hpack.h>
 #include <aws/http/private/http_impl.h>
 #include <aws/http/status_code.h>
 #include <aws/io/logging.h>
 
 #include <ctype.h>
-
-#ifdef _MSC_VER
-#    pragma warning(disable : 4311) /* 'type cast': pointer truncation from 'void *' to 'int' */
-#else
-#    pragma GCC diagnostic ignored "-Wpointer-to-int-cast"
-#endif
+#include <string.h>
 
 #define AWS_DEFINE_ERROR_INFO_HTTP(CODE, STR) [(CODE)-0x0800] = AWS_DEFINE_ERROR_INFO(CODE, STR, "aws-c-http")
 
@@ -122,6 +117,15 @@ static struct aws_error_info s_errors[] = {
     AWS_DEFINE_ERROR_INFO_HTTP(
         AWS_ERROR_HTTP_INVALID_FRAME_SIZE,
         "Received frame with an illegal frame size"),
+    AWS_DEFINE_ERROR_INFO_HTTP(
+        AWS_ERROR_HTTP_COMPRESSION,
+        "Error compressing or decompressing HPACK headers or message body"),
+    AWS_DEFINE_ERROR_INFO_HTTP(
+        AWS_ERROR_HTTP_STREAM_HAS_COMPLETED,
+        "Action not allowed because the stream has completed."),
+    AWS_DEFINE_ERROR_INFO_HTTP(
+        AWS_ERROR_HTTP_FLOW_CONTROL_ERROR,
+        "Peer violated flow-control limits"),
 };
 /* clang-format on */
 
@@ -148,76 +152,74 @@ static struct aws_log_subject_info_list s_log_subject_list = {
 };
 
 /**
- * Given array of aws_byte_cursors, init hashtable where...
- * Key is aws_byte_cursor* (pointing into cursor from array) and comparisons are case-insensitive.
- * Value is the array index cast to a void*.
+ * -- String To Enum Notes --
+ * Strings are classified by switching on their length, then comparing against the few candidates of that length.
+ * Case-insensitive comparisons fold 8 bytes at a time to lowercase (SWAR), rather than a byte at a time.
+ * No tables are built at runtime.
  */
-static void s_init_str_to_enum_hash_table(
-    struct aws_hash_table *table,
-    struct aws_allocator *alloc,
-    struct aws_byte_cursor *str_array,
-    int start_index,
-    int end_index,
-    bool ignore_case) {
-
-    int err = aws_hash_table_init(
-        table,
-        alloc,
-        end_index - start_index,
-        ignore_case ? aws_hash_byte_cursor_ptr_ignore_case : aws_hash_byte_cursor_ptr,
-        (aws_hash_callback_eq_fn *)(ignore_case ? aws_byte_cursor_eq_ignore_case : aws_byte_cursor_eq),
-        NULL,
-        NULL);
-    AWS_FATAL_ASSERT(!err);
-
-    for (size_t i = start_index; i < (size_t)end_index; ++i) {
-        int was_created;
-        AWS_FATAL_ASSERT(str_array[i].ptr && "Missing enum string");
-        err = aws_hash_table_put(table, &str_array[i], (void *)i, &was_created);
-        AWS_FATAL_ASSERT(!err && was_created);
-    }
-}
 
-/**
- * Given key, get value from table initialized by s_init_str_to_enum_hash_table().
- * Returns -1 if key not found.
- */
-static int s_find_in_str_to_enum_hash_table(const struct aws_hash_table *table, struct aws_byte_cursor *key) {
-    struct aws_hash_element *elem;
-    aws_hash_table_find(table, key, &elem);
-    if (elem) {
-        return (int)elem->value;
-    }
-    return -1;
+/* Fold any ASCII uppercase letters among these 8 bytes to lowercase */
+static uint64_t s_fold_u64_to_lower(uint64_t word) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t heptets = word & (0x7F * ones);
+    const uint64_t is_gt_upper_z = heptets + ((0x7F - 'Z') * ones); /* high bit set if byte > 'Z' */
+    const uint64_t is_ge_upper_a = heptets + ((0x80 - 'A') * ones); /* high bit set if byte >= 'A' */
+    const uint64_t is_ascii = ~word & (0x80 * ones);
+    const uint64_t is_upper = is_ascii & (is_ge_upper_a ^ is_gt_upper_z);
+    return word | (is_upper >> 2); /* high bit becomes 0x20 bit */
 }
 
-/* METHODS */
-static struct aws_hash_table s_method_str_to_enum;                         /* for string -> enum lookup */
-static struct aws_byte_cursor s_method_enum_to_str[AWS_HTTP_METHOD_COUNT]; /* for enum -> string lookup */
-
-static void s_methods_init(struct aws_allocator *alloc) {
-    s_method_enum_to_str[AWS_HTTP_METHOD_GET] = aws_http_method_get;
-    s_method_enum_to_str[AWS_HTTP_METHOD_HEAD] = aws_http_method_head;
-    s_method_enum_to_str[AWS_HTTP_METHOD_CONNECT] = aws_http_method_connect;
-
-    s_init_str_to_enum_hash_table(
-        &s_method_str_to_enum,
-        alloc,
-        s_method_enum_to_str,
-        AWS_HTTP_METHOD_UNKNOWN + 1,
-        AWS_HTTP_METHOD_COUNT,
-        false /* DO NOT ignore case of method */);
-}
+/* Compare cursor to a lowercase string literal, which must be the same length as the cursor */
+static bool s_eq_lowercase_literal(struct aws_byte_cursor cursor, const char *lowercase, bool ignore_case) {
+    AWS_ASSERT(cursor.len == strlen(lowercase));
+
+    const uint8_t *lhs = cursor.ptr;
+    const uint8_t *rhs = (const uint8_t *)lowercase;
+    size_t remaining = cursor.len;
+    while (remaining > 0) {
+        const size_t n = remaining < sizeof(uint64_t) ? remaining : sizeof(uint64_t);
+        uint64_t lhs_word = 0;
+        uint64_t rhs_word = 0;
+        memcpy(&lhs_word, lhs, n);
+        memcpy(&rhs_word, rhs, n);
+        if (ignore_case) {
+            lhs_word = s_fold_u64_to_lower(lhs_word);
+        }
+        if (lhs_word != rhs_word) {
+            return false;
+        }
+
+        lhs += n;
+        rhs += n;
+        remaining -= n;
+    }
 
-static void s_methods_clean_up(void) {
-    aws_hash_table_clean_up(&s_method_str_to_enum);
+    return true;
 }
 
+/* METHODS */
 enum aws_http_method aws_http_str_to_method(struct aws_byte_cursor cursor) {
-    int method = s_find_in_str_to_enum_hash_table(&s_method_str_to_enum, &cursor);
-    if (method >= 0) {
-        return (enum aws_http_method)method;
+    /* Methods are case-sensitive */
+    switch (cursor.len) {
+        case 3:
+            if (aws_byte_cursor_eq(&cursor, &aws_http_method_get)) {
+                return AWS_HTTP_METHOD_GET;
+            }
+            break;
+        case 4:
+            if (aws_byte_cursor_eq(&cursor, &aws_http_method_head)) {
+                return AWS_HTTP_METHOD_HEAD;
+            }
+            break;
+        case 7:
+            if (aws_byte_cursor_eq(&cursor, &aws_http_method_connect)) {
+                return AWS_HTTP_METHOD_CONNECT;
+            }
+            break;
+        default:
+            break;
     }
+
     return AWS_HTTP_METHOD_UNKNOWN;
 }
 
@@ -243,58 +245,73 @@ struct aws_byte_cursor aws_http_version_to_str(enum aws_http_version version) {
 }
 
 /* HEADERS */
-static struct aws_hash_table s_header_str_to_enum;           /* for case-insensitive string -> enum lookup */
-static struct aws_hash_table s_lowercase_header_str_to_enum; /* for case-sensitive string -> enum lookup */
-static struct aws_byte_cursor s_header_enum_to_str[AWS_HTTP_HEADER_COUNT]; /* for enum -> string lookup */
-
-static void s_headers_init(struct aws_allocator *alloc) {
-    s_header_enum_to_str[AWS_HTTP_HEADER_METHOD] = aws_byte_cursor_from_c_str(":method");
-    s_header_enum_to_str[AWS_HTTP_HEADER_SCHEME] = aws_byte_cursor_from_c_str(":scheme");
-    s_header_enum_to_str[AWS_HTTP_HEADER_AUTHORITY] = aws_byte_cursor_from_c_str(":authority");
-    s_header_enum_to_str[AWS_HTTP_HEADER_PATH] = aws_byte_cursor_from_c_str(":path");
-    s_header_enum_to_str[AWS_HTTP_HEADER_STATUS] = aws_byte_cursor_from_c_str(":status");
-    s_header_enum_to_str[AWS_HTTP_HEADER_COOKIE] = aws_byte_cursor_from_c_str("cookie");
-    s_header_enum_to_str[AWS_HTTP_HEADER_CONNECTION] = aws_byte_cursor_from_c_str("connection");
-    s_header_enum_to_str[AWS_HTTP_HEADER_CONTENT_LENGTH] = aws_byte_cursor_from_c_str("content-length");
-    s_header_enum_to_str[AWS_HTTP_HEADER_EXPECT] = aws_byte_cursor_from_c_str("expect");
-    s_header_enum_to_str[AWS_HTTP_HEADER_TRANSFER_ENCODING] = aws_byte_cursor_from_c_str("transfer-encoding");
-
-    s_init_str_to_enum_hash_table(
-        &s_header_str_to_enum,
-        alloc,
-        s_header_enum_to_str,
-        AWS_HTTP_HEADER_UNKNOWN + 1,
-        AWS_HTTP_HEADER_COUNT,
-        true /* ignore case */);
-
-    s_init_str_to_enum_hash_table(
-        &s_lowercase_header_str_to_enum,
-        alloc,
-        s_header_enum_to_str,
-        AWS_HTTP_HEADER_UNKNOWN + 1,
-        AWS_HTTP_HEADER_COUNT,
-        false /* ignore case */);
-}
+static enum aws_http_header_name s_str_to_header_name(struct aws_byte_cursor cursor, bool ignore_case) {
+    switch (cursor.len) {
+        case 4:
+            if (s_eq_lowercase_literal(cursor, "date", ignore_case)) {
+                return AWS_HTTP_HEADER_DATE;
+            }
+            break;
+        case 5:
+            if (s_eq_lowercase_literal(cursor, ":path", ignore_case)) {
+                return AWS_HTTP_HEADER_PATH;
+            }
+            break;
+        case 6:
+            if (s_eq_lowercase_literal(cursor, "cookie", ignore_case)) {
+                return AWS_HTTP_HEADER_COOKIE;
+            }
+            if (s_eq_lowercase_literal(cursor, "expect", ignore_case)) {
+                return AWS_HTTP_HEADER_EXPECT;
+            }
+            break;
+        case 7:
+            if (s_eq_lowercase_literal(cursor, ":method", ignore_case)) {
+                return AWS_HTTP_HEADER_METHOD;
+            }
+            if (s_eq_lowercase_literal(cursor, ":scheme", ignore_case)) {
+                return AWS_HTTP_HEADER_SCHEME;
+            }
+            if (s_eq_lowercase_literal(cursor, ":status", ignore_case)) {
+                return AWS_HTTP_HEADER_STATUS;
+            }
+            break;
+        case 10:
+            if (s_eq_lowercase_literal(cursor, "connection", ignore_case)) {
+                return AWS_HTTP_HEADER_CONNECTION;
+            }
+            if (s_eq_lowercase_literal(cursor, ":authority", ignore_case)) {
+                return AWS_HTTP_HEADER_AUTHORITY;
+            }
+            break;
+        case 14:
+            if (s_eq_lowercase_literal(cursor, "content-length", ignore_case)) {
+                return AWS_HTTP_HEADER_CONTENT_LENGTH;
+            }
+            break;
+        case 16:
+            if (s_eq_lowercase_literal(cursor, "content-encoding", ignore_case)) {
+                return AWS_HTTP_HEADER_CONTENT_ENCODING;
+            }
+            break;
+        case 17:
+            if (s_eq_lowercase_literal(cursor, "transfer-encoding", ignore_case)) {
+                return AWS_HTTP_HEADER_TRANSFER_ENCODING;
+            }
+            break;
+        default:
+            break;
+    }
 
-static void s_headers_clean_up(void) {
-    aws_hash_table_clean_up(&s_header_str_to_enum);
-    aws_hash_table_clean_up(&s_lowercase_header_str_to_enum);
+    return AWS_HTTP_HEADER_UNKNOWN;
 }
 
 enum aws_http_header_name aws_http_str_to_header_name(struct aws_byte_cursor cursor) {
-    int header = s_find_in_str_to_enum_hash_table(&s_header_str_to_enum, &cursor);
-    if (header >= 0) {
-        return (enum aws_http_header_name)header;
-    }
-    return AWS_HTTP_HEADER_UNKNOWN;
+    return s_str_to_header_name(cursor, true /*ignore_case*/);
 }
 
 enum aws_http_header_name aws_http_lowercase_str_to_header_name(struct aws_byte_cursor cursor) {
-    int header = s_find_in_str_to_enum_hash_table(&s_lowercase_header_str_to_enum, &cursor);
-    if (header >= 0) {
-        return (enum aws_http_header_name)header;
-    }
-    return AWS_HTTP_HEADER_UNKNOWN;
+    return s_str_to_header_name(cursor, false /*ignore_case*/);
 }
 
 /* STATUS */
@@ -442,9 +459,8 @@ void aws_http_library_init(struct aws_allocator *alloc) {
     aws_compression_library_init(alloc);
     aws_register_error_info(&s_error_list);
     aws_register_log_subject_info_list(&s_log_subject_list);
-    s_methods_init(alloc);
-    s_headers_init(alloc);
     s_versions_init(alloc);
+    aws_h1_status_lines_init(alloc);
     aws_hpack_static_table_init(alloc);
 }
 
@@ -456,8 +472,7 @@ void aws_http_library_clean_up(void) {
 
     aws_unregister_error_info(&s_error_list);
     aws_unregister_log_subject_info_list(&s_log_subject_list);
-    s_methods_clean_up();
-    s_headers_clean_up();
+    aws_h1_status_lines_clean_up();
     s_versions_clean_up();
     aws_hpack_static_table_clean_up();
     aws_compression_library_clean_up();
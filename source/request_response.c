@@ -14,13 +14,21 @@
  */
 
 #include <aws/common/array_list.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/mutex.h>
 #include <aws/common/string.h>
 #include <aws/http/private/connection_impl.h>
+#include <aws/http/private/content_coding.h>
+#include <aws/http/private/file_body.h>
 #include <aws/http/private/request_response_impl.h>
 #include <aws/http/private/strutil.h>
 #include <aws/http/server.h>
 #include <aws/http/status_code.h>
 #include <aws/io/logging.h>
+#include <aws/io/stream.h>
+
+#include <inttypes.h>
+#include <stdio.h>
 
 #if _MSC_VER
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
@@ -29,6 +37,12 @@
 enum {
     /* Initial capacity for the aws_http_message.headers array_list. */
     AWS_HTTP_REQUEST_NUM_RESERVED_HEADERS = 16,
+
+    /* Size of each chunk in the aws_http_headers string pool. A longer string gets a chunk of its own. */
+    AWS_HTTP_HEADERS_STRING_CHUNK_SIZE = 1024,
+
+    /* aws_http_headers builds a hash index of names once it holds this many headers. */
+    AWS_HTTP_HEADERS_INDEX_MIN_COUNT = 16,
 };
 
 bool aws_http_header_name_eq(struct aws_byte_cursor name_a, struct aws_byte_cursor name_b) {
@@ -40,18 +54,287 @@ bool aws_http_header_name_eq(struct aws_byte_cursor name_a, struct aws_byte_curs
  * Headers are stored in a linear array, rather than a hash-table of arrays.
  * The linear array was simpler to implement and may be faster due to having fewer allocations.
  * The API has been designed so we can swap out the implementation later if desired.
+ * Once there are enough headers that a linear search gets expensive, a hash index of names is built on the side.
+ * The index maps a case-insensitive hash of each name to the header's position in the array.
+ * Adding a header adds it to the index. Erasing shifts positions, so the index is rebuilt after an erase.
+ * The index is only touched by functions that modify the headers, so lookups remain read-only.
  *
  * -- String Storage Notes --
- * We use a single allocation to hold the name and value of each aws_http_header.
- * We could optimize storage by using something like a string pool. If we do this, be sure to maintain
- * the address of existing strings when adding new strings (a dynamic aws_byte_buf would not suffice).
+ * Names and values are copied into a string pool: a list of fixed-size chunks that are filled in order.
+ * A header's name and value are stored back-to-back. Chunks are never moved or resized, so existing strings
+ * keep their address when new strings are added (aws_http_headers_set() relies on this).
+ * Strings can't be freed individually. Erasing the most recently added header gives its storage back,
+ * otherwise its storage is counted as wasted. Once enough is wasted (more than the live strings take up),
+ * erasing compacts the pool: live strings are copied into one fresh chunk and the old chunks are freed.
+ * That copying is paid for by the erasures that caused the waste, so memory stays proportional to the live strings.
+ * Compaction moves strings, so it only happens when headers are erased, never when they're added.
+ * aws_http_headers_clear() forgets all strings at once, keeping the chunks for reuse.
  */
+struct aws_http_headers_string_chunk {
+    struct aws_http_headers_string_chunk *next;
+    size_t capacity;
+    size_t used;
+    /* Chunk's data immediately follows this struct */
+};
+
+struct aws_http_headers_index_entry {
+    uint32_t name_hash;
+    uint32_t header_index_plus_one; /* 0 means the slot is empty */
+};
+
 struct aws_http_headers {
     struct aws_allocator *alloc;
     struct aws_array_list array_list; /* Contains aws_http_header */
     struct aws_atomic_var refcount;
+
+    /* Open-addressing hash table with linear probing. Only exists once there are enough headers. */
+    struct {
+        struct aws_http_headers_index_entry *entries;
+        size_t capacity; /* Power of 2, or 0 if there is no index */
+    } index;
+
+    struct {
+        struct aws_http_headers_string_chunk *first;
+        struct aws_http_headers_string_chunk *last;
+        struct aws_http_headers_string_chunk *current; /* Chunk being filled */
+        size_t live_len;                               /* Bytes used by strings of current headers */
+        size_t wasted_len;                             /* Bytes used by erased strings, which can't be reused */
+    } string_pool;
 };
 
+static uint8_t *s_string_chunk_data(struct aws_http_headers_string_chunk *chunk) {
+    return (uint8_t *)(chunk + 1);
+}
+
+/* Get `len` bytes of storage from the string pool */
+static uint8_t *s_string_pool_acquire(struct aws_http_headers *headers, size_t len) {
+    /* Look for room in the current chunk, or in chunks after it that were kept from before a clear */
+    struct aws_http_headers_string_chunk *chunk = headers->string_pool.current;
+    while (chunk && (chunk->capacity - chunk->used < len)) {
+        chunk = chunk->next;
+    }
+
+    if (!chunk) {
+        size_t capacity = len > AWS_HTTP_HEADERS_STRING_CHUNK_SIZE ? len : AWS_HTTP_HEADERS_STRING_CHUNK_SIZE;
+        size_t alloc_size;
+        if (aws_add_size_checked(sizeof(struct aws_http_headers_string_chunk), capacity, &alloc_size)) {
+            return NULL;
+        }
+
+        chunk = aws_mem_acquire(headers->alloc, alloc_size);
+        if (!chunk) {
+            return NULL;
+        }
+
+        chunk->next = NULL;
+        chunk->capacity = capacity;
+        chunk->used = 0;
+
+        if (headers->string_pool.last) {
+            headers->string_pool.last->next = chunk;
+        } else {
+            headers->string_pool.first = chunk;
+        }
+        headers->string_pool.last = chunk;
+    }
+
+    /* A string too long for a normal chunk doesn't make us abandon the current chunk */
+    if (len <= AWS_HTTP_HEADERS_STRING_CHUNK_SIZE || !headers->string_pool.current) {
+        headers->string_pool.current = chunk;
+    }
+
+    uint8_t *mem = s_string_chunk_data(chunk) + chunk->used;
+    chunk->used += len;
+    headers->string_pool.live_len += len;
+    return mem;
+}
+
+/* Give storage back to the string pool.
+ * Only the most recently acquired storage can be reused, anything else is wasted until the pool is compacted. */
+static void s_string_pool_release(struct aws_http_headers *headers, const uint8_t *mem, size_t len) {
+    headers->string_pool.live_len -= len;
+
+    struct aws_http_headers_string_chunk *chunk = headers->string_pool.current;
+    if (chunk && chunk->used >= len && (mem == s_string_chunk_data(chunk) + chunk->used - len)) {
+        chunk->used -= len;
+    } else {
+        headers->string_pool.wasted_len += len;
+    }
+}
+
+/* Forget all strings, but keep the chunks for reuse */
+static void s_string_pool_reset(struct aws_http_headers *headers) {
+    for (struct aws_http_headers_string_chunk *chunk = headers->string_pool.first; chunk; chunk = chunk->next) {
+        chunk->used = 0;
+    }
+    headers->string_pool.current = headers->string_pool.first;
+    headers->string_pool.live_len = 0;
+    headers->string_pool.wasted_len = 0;
+}
+
+/* FNV-1a hash of the lowercase name */
+static uint32_t s_header_name_hash(struct aws_byte_cursor name) {
+    const uint8_t *to_lower = aws_lookup_table_to_lower_get();
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < name.len; ++i) {
+        hash ^= to_lower[name.ptr[i]];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void s_index_clean_up(struct aws_http_headers *headers) {
+    aws_mem_release(headers->alloc, headers->index.entries);
+    AWS_ZERO_STRUCT(headers->index);
+}
+
+static void s_index_insert(struct aws_http_headers *headers, uint32_t name_hash, size_t header_index) {
+    const size_t mask = headers->index.capacity - 1;
+    size_t slot = name_hash & mask;
+    while (headers->index.entries[slot].header_index_plus_one != 0) {
+        slot = (slot + 1) & mask;
+    }
+
+    headers->index.entries[slot].name_hash = name_hash;
+    headers->index.entries[slot].header_index_plus_one = (uint32_t)(header_index + 1);
+}
+
+/* (Re)build the index from scratch, or get rid of it if there aren't enough headers to need one.
+ * The index is just an optimization, so if this fails we carry on without one. */
+static void s_index_rebuild(struct aws_http_headers *headers) {
+    const size_t count = aws_http_headers_count(headers);
+    if (count < AWS_HTTP_HEADERS_INDEX_MIN_COUNT || count > UINT32_MAX / 2) {
+        s_index_clean_up(headers);
+        return;
+    }
+
+    /* Keep load factor at or below 1/2 */
+    size_t capacity = AWS_HTTP_HEADERS_INDEX_MIN_COUNT * 2;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+
+    if (capacity == headers->index.capacity) {
+        memset(headers->index.entries, 0, capacity * sizeof(struct aws_http_headers_index_entry));
+    } else {
+        s_index_clean_up(headers);
+        headers->index.entries = aws_mem_calloc(headers->alloc, capacity, sizeof(struct aws_http_headers_index_entry));
+        if (!headers->index.entries) {
+            return;
+        }
+        headers->index.capacity = capacity;
+    }
+
+    struct aws_http_header *header = NULL;
+    for (size_t i = 0; i < count; ++i) {
+        aws_array_list_get_at_ptr(&headers->array_list, (void **)&header, i);
+        AWS_ASSUME(header);
+        s_index_insert(headers, s_header_name_hash(header->name), i);
+    }
+}
+
+/* Update the index after a header was added to the end of the array */
+static void s_index_on_header_added(struct aws_http_headers *headers, struct aws_byte_cursor name) {
+    const size_t count = aws_http_headers_count(headers);
+    if (headers->index.capacity == 0 || count * 2 > headers->index.capacity) {
+        if (count >= AWS_HTTP_HEADERS_INDEX_MIN_COUNT) {
+            s_index_rebuild(headers);
+        }
+        return;
+    }
+
+    s_index_insert(headers, s_header_name_hash(name), count - 1);
+}
+
+/* Use the index to find the position of the first header with this name. Returns false if there is none. */
+static bool s_index_find_first(
+    const struct aws_http_headers *headers,
+    struct aws_byte_cursor name,
+    size_t *out_index) {
+
+    const uint32_t name_hash = s_header_name_hash(name);
+    const size_t mask = headers->index.capacity - 1;
+    bool found = false;
+    size_t first_index = SIZE_MAX;
+
+    /* Entries for the same name aren't necessarily stored in array order, so check every candidate */
+    for (size_t slot = name_hash & mask; headers->index.entries[slot].header_index_plus_one != 0;
+         slot = (slot + 1) & mask) {
+
+        const struct aws_http_headers_index_entry *entry = &headers->index.entries[slot];
+        const size_t header_index = entry->header_index_plus_one - 1;
+        if (entry->name_hash != name_hash || header_index > first_index) {
+            continue;
+        }
+
+        struct aws_http_header *header = NULL;
+        aws_array_list_get_at_ptr(&headers->array_list, (void **)&header, header_index);
+        AWS_ASSUME(header);
+        if (aws_http_header_name_eq(header->name, name)) {
+            found = true;
+            first_index = header_index;
+        }
+    }
+
+    *out_index = first_index;
+    return found;
+}
+
+static void s_string_pool_clean_up(struct aws_http_headers *headers) {
+    struct aws_http_headers_string_chunk *chunk = headers->string_pool.first;
+    while (chunk) {
+        struct aws_http_headers_string_chunk *next = chunk->next;
+        aws_mem_release(headers->alloc, chunk);
+        chunk = next;
+    }
+    AWS_ZERO_STRUCT(headers->string_pool);
+}
+
+/* If erased strings are wasting more memory than the live ones use, copy the live ones into a fresh chunk.
+ * Call this after erasing. It's just an optimization, so if memory can't be had, the pool is left as is. */
+static void s_string_pool_compact_if_wasteful(struct aws_http_headers *headers) {
+    if (headers->string_pool.wasted_len < AWS_HTTP_HEADERS_STRING_CHUNK_SIZE ||
+        headers->string_pool.wasted_len <= headers->string_pool.live_len) {
+        return;
+    }
+
+    const size_t live_len = headers->string_pool.live_len;
+    const size_t capacity = aws_max_size(live_len, AWS_HTTP_HEADERS_STRING_CHUNK_SIZE);
+    struct aws_http_headers_string_chunk *chunk =
+        aws_mem_acquire(headers->alloc, sizeof(struct aws_http_headers_string_chunk) + capacity);
+    if (!chunk) {
+        return;
+    }
+
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+
+    /* Storage for each header's name & value is contiguous */
+    struct aws_http_header *header = NULL;
+    const size_t count = aws_http_headers_count(headers);
+    for (size_t i = 0; i < count; ++i) {
+        aws_array_list_get_at_ptr(&headers->array_list, (void **)&header, i);
+        AWS_ASSUME(header);
+
+        uint8_t *mem = s_string_chunk_data(chunk) + chunk->used;
+        const size_t len = header->name.len + header->value.len;
+        if (len > 0) {
+            memcpy(mem, header->name.ptr, len);
+        }
+        header->name.ptr = mem;
+        header->value.ptr = mem + header->name.len;
+        chunk->used += len;
+    }
+    AWS_ASSERT(chunk->used == live_len);
+
+    s_string_pool_clean_up(headers);
+    headers->string_pool.first = chunk;
+    headers->string_pool.last = chunk;
+    headers->string_pool.current = chunk;
+    headers->string_pool.live_len = live_len;
+}
+
 struct aws_http_headers *aws_http_headers_new(struct aws_allocator *allocator) {
     AWS_PRECONDITION(allocator);
 
@@ -86,6 +369,8 @@ void aws_http_headers_release(struct aws_http_headers *headers) {
     if (prev_refcount == 1) {
         aws_http_headers_clear(headers);
         aws_array_list_clean_up(&headers->array_list);
+        s_index_clean_up(headers);
+        s_string_pool_clean_up(headers);
         aws_mem_release(headers->alloc, headers);
     } else {
         AWS_ASSERT(prev_refcount != 0);
@@ -113,8 +398,8 @@ int aws_http_headers_add_header(struct aws_http_headers *headers, const struct a
 
     struct aws_http_header header_copy = *header;
     /* Store our own copy of the strings.
-     * We put the name and value into the same allocation. */
-    uint8_t *strmem = aws_mem_acquire(headers->alloc, total_len);
+     * We put the name and value next to each other in the string pool. */
+    uint8_t *strmem = s_string_pool_acquire(headers, total_len);
     if (!strmem) {
         return AWS_OP_ERR;
     }
@@ -127,10 +412,11 @@ int aws_http_headers_add_header(struct aws_http_headers *headers, const struct a
         goto error;
     }
 
+    s_index_on_header_added(headers, header_copy.name);
     return AWS_OP_SUCCESS;
 
 error:
-    aws_mem_release(headers->alloc, strmem);
+    s_string_pool_release(headers, strmem, total_len);
     return AWS_OP_ERR;
 }
 
@@ -142,27 +428,23 @@ int aws_http_headers_add(struct aws_http_headers *headers, struct aws_byte_curso
 void aws_http_headers_clear(struct aws_http_headers *headers) {
     AWS_PRECONDITION(headers);
 
-    struct aws_http_header *header = NULL;
-    const size_t count = aws_http_headers_count(headers);
-    for (size_t i = 0; i < count; ++i) {
-        aws_array_list_get_at_ptr(&headers->array_list, (void **)&header, i);
-        AWS_ASSUME(header);
+    aws_array_list_clear(&headers->array_list);
+    s_string_pool_reset(headers);
 
-        /* Storage for name & value is in the same allocation */
-        aws_mem_release(headers->alloc, header->name.ptr);
+    /* Keep the index's memory too, it's likely to be refilled by a similar number of headers */
+    if (headers->index.capacity) {
+        memset(headers->index.entries, 0, headers->index.capacity * sizeof(struct aws_http_headers_index_entry));
     }
-
-    aws_array_list_clear(&headers->array_list);
 }
 
-/* Does not check index */
+/* Does not check index. Positions shift, so caller must call s_index_rebuild() when done erasing */
 static void s_http_headers_erase_index(struct aws_http_headers *headers, size_t index) {
     struct aws_http_header *header = NULL;
     aws_array_list_get_at_ptr(&headers->array_list, (void **)&header, index);
     AWS_ASSUME(header);
 
-    /* Storage for name & value is in the same allocation */
-    aws_mem_release(headers->alloc, header->name.ptr);
+    /* Storage for name & value is contiguous */
+    s_string_pool_release(headers, header->name.ptr, header->name.len + header->value.len);
 
     aws_array_list_erase(&headers->array_list, index);
 }
@@ -175,6 +457,8 @@ int aws_http_headers_erase_index(struct aws_http_headers *headers, size_t index)
     }
 
     s_http_headers_erase_index(headers, index);
+    s_index_rebuild(headers);
+    s_string_pool_compact_if_wasteful(headers);
     return AWS_OP_SUCCESS;
 }
 
@@ -183,6 +467,14 @@ static int s_http_headers_erase(struct aws_http_headers *headers, struct aws_byt
     bool erased_any = false;
     struct aws_http_header *header = NULL;
 
+    /* With an index, we can skip searching for names that aren't present */
+    if (headers->index.capacity) {
+        size_t first_index;
+        if (!s_index_find_first(headers, name, &first_index) || first_index >= end_index) {
+            return aws_raise_error(AWS_ERROR_HTTP_HEADER_NOT_FOUND);
+        }
+    }
+
     /* Iterating in reverse is simpler */
     for (size_t n = end_index; n > 0; --n) {
         const size_t i = n - 1;
@@ -200,6 +492,8 @@ static int s_http_headers_erase(struct aws_http_headers *headers, struct aws_byt
         return aws_raise_error(AWS_ERROR_HTTP_HEADER_NOT_FOUND);
     }
 
+    s_index_rebuild(headers);
+    s_string_pool_compact_if_wasteful(headers);
     return AWS_OP_SUCCESS;
 }
 
@@ -226,6 +520,8 @@ int aws_http_headers_erase_value(
 
         if (aws_http_header_name_eq(header->name, name) && aws_byte_cursor_eq(&header->value, &value)) {
             s_http_headers_erase_index(headers, i);
+            s_index_rebuild(headers);
+            s_string_pool_compact_if_wasteful(headers);
             return AWS_OP_SUCCESS;
         }
     }
@@ -252,6 +548,7 @@ error:
     for (size_t new_count = aws_http_headers_count(headers); new_count > orig_count; --new_count) {
         s_http_headers_erase_index(headers, new_count - 1);
     }
+    s_index_rebuild(headers);
 
     return AWS_OP_ERR;
 }
@@ -297,6 +594,19 @@ int aws_http_headers_get(
     AWS_PRECONDITION(aws_byte_cursor_is_valid(&name));
 
     struct aws_http_header *header = NULL;
+
+    if (headers->index.capacity) {
+        size_t first_index;
+        if (!s_index_find_first(headers, name, &first_index)) {
+            return aws_raise_error(AWS_ERROR_HTTP_HEADER_NOT_FOUND);
+        }
+
+        aws_array_list_get_at_ptr(&headers->array_list, (void **)&header, first_index);
+        AWS_ASSUME(header);
+        *out_value = header->value;
+        return AWS_OP_SUCCESS;
+    }
+
     const size_t count = aws_http_headers_count(headers);
     for (size_t i = 0; i < count; ++i) {
         aws_array_list_get_at_ptr(&headers->array_list, (void **)&header, i);
@@ -326,6 +636,18 @@ struct aws_http_message {
     struct aws_input_stream *body_stream;
     struct aws_atomic_var refcount;
 
+    /* Set by aws_http_message_set_body_data(). The message owns body_data_stream, but not the memory itself */
+    struct {
+        struct aws_byte_cursor data;
+        struct aws_input_stream *stream;
+        aws_http_message_body_data_release_fn *on_release;
+        void *user_data;
+    } body_data;
+
+    /* Set by aws_http_message_set_compressed_body_stream() or aws_http_message_set_body_from_fd().
+     * The message owns this stream, but not whatever it reads from */
+    struct aws_input_stream *owned_body_stream;
+
     /* Data specific to the request or response subclasses */
     union {
         struct aws_http_message_request_data {
@@ -339,8 +661,15 @@ struct aws_http_message {
 
     struct aws_http_message_request_data *request_data;
     struct aws_http_message_response_data *response_data;
+
+    /* Set if the message came from an aws_http_message_pool, which it returns to when released */
+    struct aws_http_message_pool *pool;
+    struct aws_linked_list_node pool_node;
 };
 
+static void s_message_clean_up_body(struct aws_http_message *message);
+static void s_message_pool_recycle(struct aws_http_message *message);
+
 static int s_set_string_from_cursor(
     struct aws_string **dst,
     struct aws_byte_cursor cursor,
@@ -434,6 +763,19 @@ void aws_http_message_destroy(struct aws_http_message *message) {
     aws_http_message_release(message);
 }
 
+static void s_message_destroy(struct aws_http_message *message) {
+    if (message->request_data) {
+        aws_string_destroy(message->request_data->method);
+        aws_string_destroy(message->request_data->path);
+    }
+
+    aws_http_headers_release(message->headers);
+
+    s_message_clean_up_body(message);
+
+    aws_mem_release(message->allocator, message);
+}
+
 void aws_http_message_release(struct aws_http_message *message) {
     /* Note that release() may also be used by new() functions to clean up if something goes wrong */
     AWS_PRECONDITION(!message || message->allocator);
@@ -443,14 +785,11 @@ void aws_http_message_release(struct aws_http_message *message) {
 
     size_t prev_refcount = aws_atomic_fetch_sub(&message->refcount, 1);
     if (prev_refcount == 1) {
-        if (message->request_data) {
-            aws_string_destroy(message->request_data->method);
-            aws_string_destroy(message->request_data->path);
+        if (message->pool) {
+            s_message_pool_recycle(message);
+        } else {
+            s_message_destroy(message);
         }
-
-        aws_http_headers_release(message->headers);
-
-        aws_mem_release(message->allocator, message);
     } else {
         AWS_ASSERT(prev_refcount != 0);
     }
@@ -461,6 +800,185 @@ void aws_http_message_acquire(struct aws_http_message *message) {
     aws_atomic_fetch_add(&message->refcount, 1);
 }
 
+struct aws_http_message_pool {
+    struct aws_allocator *allocator;
+    size_t max_pooled_messages;
+
+    /* One hold for the user, plus one for each message on loan */
+    struct aws_atomic_var refcount;
+
+    /* Any thread may touch this data, but the lock must be held */
+    struct aws_mutex lock;
+    struct {
+        struct aws_linked_list idle_requests;
+        struct aws_linked_list idle_responses;
+        size_t num_idle_requests;
+        size_t num_idle_responses;
+    } synced_data;
+};
+
+struct aws_http_message_pool *aws_http_message_pool_new(struct aws_allocator *allocator, size_t max_pooled_messages) {
+    AWS_PRECONDITION(allocator);
+
+    struct aws_http_message_pool *pool = aws_mem_calloc(allocator, 1, sizeof(struct aws_http_message_pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    if (aws_mutex_init(&pool->lock)) {
+        aws_mem_release(allocator, pool);
+        return NULL;
+    }
+
+    pool->allocator = allocator;
+    pool->max_pooled_messages = max_pooled_messages;
+    aws_atomic_init_int(&pool->refcount, 1);
+    aws_linked_list_init(&pool->synced_data.idle_requests);
+    aws_linked_list_init(&pool->synced_data.idle_responses);
+    return pool;
+}
+
+static void s_message_pool_destroy(struct aws_http_message_pool *pool) {
+    /* No other thread can be using the pool now, so no need for the lock */
+    struct aws_linked_list *idle_lists[] = {&pool->synced_data.idle_requests, &pool->synced_data.idle_responses};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(idle_lists); ++i) {
+        while (!aws_linked_list_empty(idle_lists[i])) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(idle_lists[i]);
+            s_message_destroy(AWS_CONTAINER_OF(node, struct aws_http_message, pool_node));
+        }
+    }
+
+    aws_mutex_clean_up(&pool->lock);
+    aws_mem_release(pool->allocator, pool);
+}
+
+void aws_http_message_pool_release(struct aws_http_message_pool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    size_t prev_refcount = aws_atomic_fetch_sub(&pool->refcount, 1);
+    if (prev_refcount == 1) {
+        s_message_pool_destroy(pool);
+    } else {
+        AWS_ASSERT(prev_refcount != 0);
+    }
+}
+
+static struct aws_http_message *s_message_pool_acquire(struct aws_http_message_pool *pool, bool is_request) {
+    struct aws_http_message *message = NULL;
+
+    { /* BEGIN CRITICAL SECTION */
+        aws_mutex_lock(&pool->lock);
+
+        struct aws_linked_list *idle_list =
+            is_request ? &pool->synced_data.idle_requests : &pool->synced_data.idle_responses;
+        if (!aws_linked_list_empty(idle_list)) {
+            message = AWS_CONTAINER_OF(aws_linked_list_pop_front(idle_list), struct aws_http_message, pool_node);
+            if (is_request) {
+                --pool->synced_data.num_idle_requests;
+            } else {
+                --pool->synced_data.num_idle_responses;
+            }
+        }
+
+        aws_mutex_unlock(&pool->lock);
+    } /* END CRITICAL SECTION */
+
+    if (message) {
+        aws_atomic_store_int(&message->refcount, 1);
+
+        /* Headers were let go if someone else still held them when the message was recycled */
+        if (!message->headers) {
+            message->headers = aws_http_headers_new(pool->allocator);
+            if (!message->headers) {
+                s_message_destroy(message);
+                return NULL;
+            }
+        }
+    } else {
+        message = is_request ? aws_http_message_new_request(pool->allocator)
+                             : aws_http_message_new_response(pool->allocator);
+        if (!message) {
+            return NULL;
+        }
+    }
+
+    message->pool = pool;
+    aws_atomic_fetch_add(&pool->refcount, 1);
+    return message;
+}
+
+struct aws_http_message *aws_http_message_pool_acquire_request(struct aws_http_message_pool *pool) {
+    AWS_PRECONDITION(pool);
+    return s_message_pool_acquire(pool, true /*is_request*/);
+}
+
+struct aws_http_message *aws_http_message_pool_acquire_response(struct aws_http_message_pool *pool) {
+    AWS_PRECONDITION(pool);
+    return s_message_pool_acquire(pool, false /*is_request*/);
+}
+
+/* Called when the last hold on a pooled message is released. Reset it, and return it to the pool if there's room */
+static void s_message_pool_recycle(struct aws_http_message *message) {
+    struct aws_http_message_pool *pool = message->pool;
+
+    /* Do this outside the lock, it may invoke the body data's release callback */
+    s_message_clean_up_body(message);
+    message->body_stream = NULL;
+
+    if (message->request_data) {
+        aws_string_destroy(message->request_data->method);
+        message->request_data->method = NULL;
+        aws_string_destroy(message->request_data->path);
+        message->request_data->path = NULL;
+    } else {
+        message->response_data->status = AWS_HTTP_STATUS_CODE_UNKNOWN;
+    }
+
+    /* Keep the headers' storage, unless someone else acquired the headers and is still using them.
+     * Only the message's hold may remain, so claim the headers by swapping the refcount from 1 to 0.
+     * Checking and clearing aren't separate steps, so no other hold can appear in between.
+     * Nobody can legitimately acquire headers with a refcount of 0, and it's put back once they're cleared. */
+    size_t expected_refcount = 1;
+    if (aws_atomic_compare_exchange_int(&message->headers->refcount, &expected_refcount, 0)) {
+        aws_http_headers_clear(message->headers);
+        aws_atomic_store_int(&message->headers->refcount, 1);
+    } else {
+        aws_http_headers_release(message->headers);
+        message->headers = NULL;
+    }
+
+    bool is_pooled = false;
+
+    { /* BEGIN CRITICAL SECTION */
+        aws_mutex_lock(&pool->lock);
+
+        if (message->request_data) {
+            if (pool->synced_data.num_idle_requests < pool->max_pooled_messages) {
+                aws_linked_list_push_back(&pool->synced_data.idle_requests, &message->pool_node);
+                ++pool->synced_data.num_idle_requests;
+                is_pooled = true;
+            }
+        } else {
+            if (pool->synced_data.num_idle_responses < pool->max_pooled_messages) {
+                aws_linked_list_push_back(&pool->synced_data.idle_responses, &message->pool_node);
+                ++pool->synced_data.num_idle_responses;
+                is_pooled = true;
+            }
+        }
+
+        aws_mutex_unlock(&pool->lock);
+    } /* END CRITICAL SECTION */
+
+    if (!is_pooled) {
+        s_message_destroy(message);
+    }
+
+    /* Release the hold this message had on the pool */
+    aws_http_message_pool_release(pool);
+}
+
 bool aws_http_message_is_request(const struct aws_http_message *message) {
     AWS_PRECONDITION(message);
     return message->request_data;
@@ -561,11 +1079,193 @@ int aws_http_message_set_response_status(struct aws_http_message *response_messa
     return aws_raise_error(AWS_ERROR_INVALID_STATE);
 }
 
+/* Forget body data, invoking its release callback */
+static void s_message_clean_up_body_data(struct aws_http_message *message) {
+    if (!message->body_data.stream) {
+        return;
+    }
+
+    if (message->body_stream == message->body_data.stream) {
+        message->body_stream = NULL;
+    }
+
+    aws_input_stream_destroy(message->body_data.stream);
+
+    aws_http_message_body_data_release_fn *on_release = message->body_data.on_release;
+    void *user_data = message->body_data.user_data;
+    AWS_ZERO_STRUCT(message->body_data);
+
+    if (on_release) {
+        on_release(user_data);
+    }
+}
+
+/* Forget any body stream the message created itself */
+static void s_message_clean_up_body(struct aws_http_message *message) {
+    s_message_clean_up_body_data(message);
+
+    if (message->owned_body_stream) {
+        if (message->body_stream == message->owned_body_stream) {
+            message->body_stream = NULL;
+        }
+        aws_input_stream_destroy(message->owned_body_stream);
+        message->owned_body_stream = NULL;
+    }
+}
+
 void aws_http_message_set_body_stream(struct aws_http_message *message, struct aws_input_stream *body_stream) {
     AWS_PRECONDITION(message);
+    s_message_clean_up_body(message);
     message->body_stream = body_stream;
 }
 
+int aws_http_message_set_body_data(
+    struct aws_http_message *message,
+    struct aws_byte_cursor data,
+    aws_http_message_body_data_release_fn *on_release,
+    void *user_data) {
+
+    AWS_PRECONDITION(message);
+    AWS_PRECONDITION(aws_byte_cursor_is_valid(&data));
+
+    struct aws_input_stream *stream = aws_input_stream_new_from_cursor(message->allocator, &data);
+    if (!stream) {
+        return AWS_OP_ERR;
+    }
+
+    s_message_clean_up_body(message);
+
+    message->body_data.data = data;
+    message->body_data.stream = stream;
+    message->body_data.on_release = on_release;
+    message->body_data.user_data = user_data;
+    message->body_stream = stream;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_http_message_set_compressed_body_stream(
+    struct aws_http_message *message,
+    struct aws_input_stream *body_stream,
+    enum aws_http_body_compression compression) {
+
+    AWS_PRECONDITION(message);
+    AWS_PRECONDITION(body_stream);
+
+    enum aws_http_content_coding coding;
+    struct aws_byte_cursor coding_name;
+    switch (compression) {
+        case AWS_HTTP_BODY_COMPRESSION_GZIP:
+            coding = AWS_HTTP_CONTENT_CODING_GZIP;
+            coding_name = aws_byte_cursor_from_c_str("gzip");
+            break;
+        case AWS_HTTP_BODY_COMPRESSION_DEFLATE:
+            coding = AWS_HTTP_CONTENT_CODING_DEFLATE;
+            coding_name = aws_byte_cursor_from_c_str("deflate");
+            break;
+        default:
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct aws_input_stream *compressed_body_stream =
+        aws_http_compressing_stream_new(message->allocator, body_stream, coding);
+    if (!compressed_body_stream) {
+        return AWS_OP_ERR;
+    }
+
+    /* If the body already has codings applied, the new one is listed after them (RFC-9110 8.4).
+     * They're gathered into a single Content-Encoding header, ex: "br, gzip" */
+    struct aws_byte_buf content_encoding;
+    if (aws_byte_buf_init(&content_encoding, message->allocator, 32)) {
+        aws_input_stream_destroy(compressed_body_stream);
+        return AWS_OP_ERR;
+    }
+
+    const struct aws_byte_cursor content_encoding_name = aws_byte_cursor_from_c_str("Content-Encoding");
+    const struct aws_byte_cursor separator = aws_byte_cursor_from_c_str(", ");
+    const size_t prev_count = aws_http_headers_count(message->headers);
+    for (size_t i = 0; i < prev_count; ++i) {
+        struct aws_http_header header;
+        aws_http_headers_get_index(message->headers, i, &header);
+        if (header.value.len == 0 || !aws_http_header_name_eq(header.name, content_encoding_name)) {
+            continue;
+        }
+
+        if (aws_byte_buf_append_dynamic(&content_encoding, &header.value) ||
+            aws_byte_buf_append_dynamic(&content_encoding, &separator)) {
+            goto error;
+        }
+    }
+
+    if (aws_byte_buf_append_dynamic(&content_encoding, &coding_name)) {
+        goto error;
+    }
+
+    const struct aws_http_header new_headers[] = {
+        {.name = content_encoding_name, .value = aws_byte_cursor_from_buf(&content_encoding)},
+        {.name = aws_byte_cursor_from_c_str("Transfer-Encoding"), .value = aws_byte_cursor_from_c_str("chunked")},
+    };
+
+    /* Adding the array is all-or-nothing, so the message is untouched if this fails */
+    if (aws_http_headers_add_array(message->headers, new_headers, AWS_ARRAY_SIZE(new_headers))) {
+        goto error;
+    }
+
+    aws_byte_buf_clean_up(&content_encoding);
+
+    /* Nothing can fail from here on. Erase the pre-existing headers, which the new ones replace.
+     * The compressed length isn't known until it's all been sent, so Content-Length goes too. */
+    s_http_headers_erase(message->headers, aws_byte_cursor_from_c_str("Content-Length"), prev_count);
+    s_http_headers_erase(message->headers, content_encoding_name, prev_count);
+    s_http_headers_erase(message->headers, aws_byte_cursor_from_c_str("Transfer-Encoding"), prev_count);
+
+    s_message_clean_up_body(message);
+    message->owned_body_stream = compressed_body_stream;
+    message->body_stream = compressed_body_stream;
+    return AWS_OP_SUCCESS;
+
+error:
+    aws_byte_buf_clean_up(&content_encoding);
+    aws_input_stream_destroy(compressed_body_stream);
+    return AWS_OP_ERR;
+}
+
+int aws_http_message_set_body_from_fd(struct aws_http_message *message, int fd, uint64_t offset, uint64_t length) {
+    AWS_PRECONDITION(message);
+
+    struct aws_input_stream *file_body_stream = aws_http_file_body_stream_new(message->allocator, fd, offset, length);
+    if (!file_body_stream) {
+        return AWS_OP_ERR;
+    }
+
+    char content_length_str[32];
+    snprintf(content_length_str, sizeof(content_length_str), "%" PRIu64, length);
+    if (aws_http_headers_set(
+            message->headers,
+            aws_byte_cursor_from_c_str("Content-Length"),
+            aws_byte_cursor_from_c_str(content_length_str))) {
+
+        aws_input_stream_destroy(file_body_stream);
+        return AWS_OP_ERR;
+    }
+
+    s_message_clean_up_body(message);
+    message->owned_body_stream = file_body_stream;
+    message->body_stream = file_body_stream;
+    return AWS_OP_SUCCESS;
+}
+
+bool aws_http_message_get_body_data(const struct aws_http_message *message, struct aws_byte_cursor *out_data) {
+    AWS_PRECONDITION(message);
+    AWS_PRECONDITION(out_data);
+
+    if (!message->body_data.stream) {
+        return false;
+    }
+
+    *out_data = message->body_data.data;
+    return true;
+}
+
 struct aws_input_stream *aws_http_message_get_body_stream(const struct aws_http_message *message) {
     AWS_PRECONDITION(message);
     return message->body_stream;
@@ -672,6 +1372,49 @@ int aws_http_stream_send_response(struct aws_http_stream *stream, struct aws_htt
     return stream->owning_connection->vtable->stream_send_response(stream, response);
 }
 
+int aws_http1_stream_write_chunk(struct aws_http_stream *http1_stream, const struct aws_http1_chunk_options *options) {
+    AWS_PRECONDITION(http1_stream);
+    AWS_PRECONDITION(http1_stream->vtable);
+    AWS_PRECONDITION(options);
+    if (!http1_stream->vtable->http1_write_chunk) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: HTTP/1 stream only function invoked on other stream, ignoring call.",
+            (void *)http1_stream);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    return http1_stream->vtable->http1_write_chunk(http1_stream, options);
+}
+
+int aws_http1_stream_recycle_response_body_buffer(struct aws_http_stream *http1_stream) {
+    AWS_PRECONDITION(http1_stream);
+    AWS_PRECONDITION(http1_stream->vtable);
+    if (!http1_stream->vtable->http1_recycle_response_body_buffer) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: HTTP/1 stream only function invoked on other stream, ignoring call.",
+            (void *)http1_stream);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    return http1_stream->vtable->http1_recycle_response_body_buffer(http1_stream);
+}
+
+int aws_http_stream_resume_outgoing_body(struct aws_http_stream *stream) {
+    AWS_PRECONDITION(stream);
+    AWS_PRECONDITION(stream->vtable);
+    if (!stream->vtable->resume_outgoing_body) {
+        AWS_LOGF_ERROR(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: Pausing and resuming the outgoing body is not supported on this stream.",
+            (void *)stream);
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    return stream->vtable->resume_outgoing_body(stream);
+}
+
 void aws_http_stream_release(struct aws_http_stream *stream) {
     if (!stream) {
         return;
@@ -740,6 +1483,150 @@ void aws_http_stream_update_window(struct aws_http_stream *stream, size_t increm
     stream->vtable->update_window(stream, increment_size);
 }
 
+size_t aws_http_stream_get_incoming_body_wire_bytes(const struct aws_http_stream *stream) {
+    AWS_PRECONDITION(stream);
+    return stream->incoming_body_wire_bytes;
+}
+
 uint32_t aws_http_stream_get_id(const struct aws_http_stream *stream) {
     return stream->id;
 }
+
+int aws_http_header_block_buffer_init(struct aws_http_header_block_buffer *buffer, struct aws_allocator *allocator) {
+    AWS_PRECONDITION(buffer);
+    AWS_PRECONDITION(allocator);
+
+    AWS_ZERO_STRUCT(*buffer);
+
+    /* Start small, the memory is reused for each header block */
+    if (aws_array_list_init_dynamic(&buffer->headers, allocator, 16, sizeof(struct aws_http_header))) {
+        goto error;
+    }
+
+    if (aws_array_list_init_dynamic(&buffer->name_ids, allocator, 16, sizeof(enum aws_http_header_name))) {
+        goto error;
+    }
+
+    if (aws_byte_buf_init(&buffer->storage, allocator, 512)) {
+        goto error;
+    }
+
+    return AWS_OP_SUCCESS;
+
+error:
+    aws_http_header_block_buffer_clean_up(buffer);
+    return AWS_OP_ERR;
+}
+
+void aws_http_header_block_buffer_clean_up(struct aws_http_header_block_buffer *buffer) {
+    AWS_PRECONDITION(buffer);
+
+    aws_array_list_clean_up(&buffer->headers);
+    aws_array_list_clean_up(&buffer->name_ids);
+    aws_byte_buf_clean_up(&buffer->storage);
+    AWS_ZERO_STRUCT(*buffer);
+}
+
+int aws_http_header_block_buffer_add(
+    struct aws_http_header_block_buffer *buffer,
+    const struct aws_http_header *header,
+    enum aws_http_header_name name_id) {
+
+    AWS_PRECONDITION(buffer);
+    AWS_PRECONDITION(header);
+
+    /* Only lengths are stored now, since `storage` may move as it grows */
+    struct aws_http_header buffered = {
+        .name = {.len = header->name.len},
+        .value = {.len = header->value.len},
+        .compression = header->compression,
+    };
+
+    size_t prev_storage_len = buffer->storage.len;
+    if (aws_byte_buf_append_dynamic(&buffer->storage, &header->name) ||
+        aws_byte_buf_append_dynamic(&buffer->storage, &header->value)) {
+        goto error;
+    }
+
+    if (aws_array_list_push_back(&buffer->headers, &buffered)) {
+        goto error;
+    }
+
+    if (aws_array_list_push_back(&buffer->name_ids, &name_id)) {
+        aws_array_list_pop_back(&buffer->headers);
+        goto error;
+    }
+
+    return AWS_OP_SUCCESS;
+
+error:
+    buffer->storage.len = prev_storage_len;
+    return AWS_OP_ERR;
+}
+
+void aws_http_header_block_buffer_get(
+    struct aws_http_header_block_buffer *buffer,
+    const struct aws_http_header **out_headers,
+    const enum aws_http_header_name **out_name_ids,
+    size_t *out_count) {
+
+    AWS_PRECONDITION(buffer);
+    AWS_PRECONDITION(out_headers);
+    AWS_PRECONDITION(out_name_ids);
+    AWS_PRECONDITION(out_count);
+
+    /* Point each header's cursors at its strings, which are stored in order */
+    struct aws_byte_cursor storage = aws_byte_cursor_from_buf(&buffer->storage);
+    struct aws_http_header *headers = buffer->headers.data;
+    const size_t count = aws_array_list_length(&buffer->headers);
+    for (size_t i = 0; i < count; ++i) {
+        headers[i].name = aws_byte_cursor_advance(&storage, headers[i].name.len);
+        headers[i].value = aws_byte_cursor_advance(&storage, headers[i].value.len);
+    }
+    AWS_ASSERT(storage.len == 0);
+
+    *out_headers = headers;
+    *out_name_ids = buffer->name_ids.data;
+    *out_count = count;
+}
+
+void aws_http_header_block_buffer_reset(struct aws_http_header_block_buffer *buffer) {
+    AWS_PRECONDITION(buffer);
+
+    /* Buffer is never initialized if stream has no `on_incoming_header_block` callback */
+    if (!buffer->storage.allocator) {
+        return;
+    }
+
+    aws_array_list_clear(&buffer->headers);
+    aws_array_list_clear(&buffer->name_ids);
+    aws_byte_buf_reset(&buffer->storage, false /*zero_contents*/);
+}
+
+int aws_http_stream_deliver_incoming_header_block(
+    struct aws_http_stream *stream,
+    enum aws_http_header_block header_block) {
+
+    AWS_PRECONDITION(stream);
+
+    if (!stream->on_incoming_header_block) {
+        return AWS_OP_SUCCESS;
+    }
+
+    const struct aws_http_header *headers;
+    const enum aws_http_header_name *name_ids;
+    size_t num_headers;
+    aws_http_header_block_buffer_get(&stream->incoming_header_block, &headers, &name_ids, &num_headers);
+
+    if (stream->on_incoming_header_block(stream, header_block, headers, name_ids, num_headers, stream->user_data)) {
+        AWS_LOGF_TRACE(
+            AWS_LS_HTTP_STREAM,
+            "id=%p: Incoming-header-block callback raised error %d (%s).",
+            (void *)stream,
+            aws_last_error(),
+            aws_error_name(aws_last_error()));
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
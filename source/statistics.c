@@ -31,4 +31,24 @@ void aws_crt_statistics_http1_channel_reset(struct aws_crt_statistics_http1_chan
     stats->pending_incoming_stream_ms = 0;
     stats->current_outgoing_stream_id = 0;
     stats->current_incoming_stream_id = 0;
+    stats->num_outgoing_writes = 0;
+    stats->num_outgoing_messages = 0;
+}
+
+int aws_crt_statistics_http2_channel_init(struct aws_crt_statistics_http2_channel *stats) {
+    AWS_ZERO_STRUCT(*stats);
+    stats->category = AWSCRT_STAT_CAT_HTTP2_CHANNEL;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_crt_statistics_http2_channel_cleanup(struct aws_crt_statistics_http2_channel *stats) {
+    (void)stats;
+}
+
+void aws_crt_statistics_http2_channel_reset(struct aws_crt_statistics_http2_channel *stats) {
+    stats->stream_window_size = 0;
+    stats->connection_window_size = 0;
+    stats->rtt_ms = 0;
+    stats->max_bandwidth_bytes_per_sec = 0;
 }
@@ -14,6 +14,18 @@
  */
 #include <aws/http/private/strutil.h>
 
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#    define AWS_HTTP_STRUTIL_SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define AWS_HTTP_STRUTIL_SCAN_SSE2
+#endif
+
+#if defined(_MSC_VER) && (defined(AWS_HTTP_STRUTIL_SCAN_AVX2) || defined(AWS_HTTP_STRUTIL_SCAN_SSE2))
+#    include <intrin.h>
+#endif
+
 /* Lookup from '0' -> 0, 'f' -> 0xf, 'F' -> 0xF, etc
  * invalid characters have value 255 */
 /* clang-format off */
@@ -173,3 +185,81 @@ bool aws_strutil_is_http_token(struct aws_byte_cursor token) {
 bool aws_strutil_is_lowercase_http_token(struct aws_byte_cursor token) {
     return s_is_token(token, s_http_lowercase_token_table);
 }
+
+#if defined(AWS_HTTP_STRUTIL_SCAN_AVX2)
+#    define AWS_HTTP_STRUTIL_SCAN_BLOCK_SIZE 32
+
+/* Set a bit in each mask for every '\n' and ':' in the next 32 bytes */
+static void s_scan_block(const uint8_t *ptr, uint32_t *newline_mask, uint32_t *colon_mask) {
+    const __m256i block = _mm256_loadu_si256((const __m256i *)ptr);
+    *newline_mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n')));
+    *colon_mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(':')));
+}
+
+#elif defined(AWS_HTTP_STRUTIL_SCAN_SSE2)
+#    define AWS_HTTP_STRUTIL_SCAN_BLOCK_SIZE 16
+
+/* Set a bit in each mask for every '\n' and ':' in the next 16 bytes */
+static void s_scan_block(const uint8_t *ptr, uint32_t *newline_mask, uint32_t *colon_mask) {
+    const __m128i block = _mm_loadu_si128((const __m128i *)ptr);
+    *newline_mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')));
+    *colon_mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(':')));
+}
+#endif
+
+#ifdef AWS_HTTP_STRUTIL_SCAN_BLOCK_SIZE
+/* Index of lowest set bit. mask must not be 0 */
+static size_t s_lowest_bit_index(uint32_t mask) {
+    AWS_ASSERT(mask != 0);
+#    if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#    else
+    return (size_t)__builtin_ctz(mask);
+#    endif
+}
+#endif
+
+size_t aws_strutil_scan_for_newline(struct aws_byte_cursor cursor, size_t *out_colon_index) {
+    size_t colon_index = SIZE_MAX;
+    size_t i = 0;
+
+#ifdef AWS_HTTP_STRUTIL_SCAN_BLOCK_SIZE
+    for (; i + AWS_HTTP_STRUTIL_SCAN_BLOCK_SIZE <= cursor.len; i += AWS_HTTP_STRUTIL_SCAN_BLOCK_SIZE) {
+        uint32_t newline_mask;
+        uint32_t colon_mask;
+        s_scan_block(cursor.ptr + i, &newline_mask, &colon_mask);
+
+        if (newline_mask) {
+            /* Only care about colons that come before the newline */
+            const size_t newline_offset = s_lowest_bit_index(newline_mask);
+            colon_mask &= (1u << newline_offset) - 1;
+            if (colon_mask && colon_index == SIZE_MAX) {
+                colon_index = i + s_lowest_bit_index(colon_mask);
+            }
+
+            *out_colon_index = colon_index;
+            return i + newline_offset;
+        }
+
+        if (colon_mask && colon_index == SIZE_MAX) {
+            colon_index = i + s_lowest_bit_index(colon_mask);
+        }
+    }
+#endif /* AWS_HTTP_STRUTIL_SCAN_BLOCK_SIZE */
+
+    /* Scalar fallback, and the tail of the vectorized scan */
+    for (; i < cursor.len; ++i) {
+        const uint8_t c = cursor.ptr[i];
+        if (c == '\n') {
+            break;
+        }
+        if (c == ':' && colon_index == SIZE_MAX) {
+            colon_index = i;
+        }
+    }
+
+    *out_colon_index = colon_index;
+    return i;
+}
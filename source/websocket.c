@@ -108,7 +108,9 @@ struct aws_websocket {
         bool is_waiting_for_write_completion;
 
         /* If, while writing out data from a payload stream, we experience "read would block",
-         * schedule a task to try again in the near-future. */
+         * schedule a task to try again in the near-future.
+         * If the frame was sent with pause_payload_when_empty, the task is scheduled by
+         * aws_websocket_resume_outgoing_payload() instead. */
         bool is_waiting_on_payload_stream_task;
 
         /* True if this websocket is being used as a dumb mid-channel handler.
@@ -134,6 +136,13 @@ struct aws_websocket {
 
         bool is_move_synced_data_to_thread_task_scheduled;
 
+        /* True when the payload stream ran dry, and aws_websocket_resume_outgoing_payload()
+         * should schedule the waiting_on_payload_stream_task */
+        bool is_payload_paused;
+
+        /* True if aws_websocket_resume_outgoing_payload() was called while the payload wasn't paused */
+        bool has_pending_payload_resume;
+
         /* Mirrors variable from thread_data */
         bool is_midchannel_handler;
 
@@ -723,9 +732,34 @@ static void s_try_write_outgoing_frames(struct aws_websocket *websocket) {
         if (!websocket->thread_data.is_waiting_on_payload_stream_task) {
             websocket->thread_data.is_waiting_on_payload_stream_task = true;
 
-            /* Future Optimization Idea: Minimize work while we wait. Use some kind of backoff for the retry timing,
-             * or have some way for stream to notify when more data is available. */
-            aws_channel_schedule_task_now(websocket->channel_slot->channel, &websocket->waiting_on_payload_stream_task);
+            bool should_schedule_task = true;
+            if (websocket->thread_data.current_outgoing_frame &&
+                websocket->thread_data.current_outgoing_frame->def.pause_payload_when_empty) {
+
+                /* Don't poll, wait for aws_websocket_resume_outgoing_payload() to schedule the task */
+                /* BEGIN CRITICAL SECTION */
+                s_lock_synced_data(websocket);
+
+                if (websocket->synced_data.has_pending_payload_resume) {
+                    websocket->synced_data.has_pending_payload_resume = false;
+                } else {
+                    websocket->synced_data.is_payload_paused = true;
+                    should_schedule_task = false;
+                }
+
+                s_unlock_synced_data(websocket);
+                /* END CRITICAL SECTION */
+            }
+
+            if (should_schedule_task) {
+                aws_channel_schedule_task_now(
+                    websocket->channel_slot->channel, &websocket->waiting_on_payload_stream_task);
+            } else {
+                AWS_LOGF_TRACE(
+                    AWS_LS_HTTP_WEBSOCKET,
+                    "id=%p: Payload stream paused, waiting for aws_websocket_resume_outgoing_payload().",
+                    (void *)websocket);
+            }
         }
 
         aws_mem_release(io_msg->allocator, io_msg);
@@ -1599,6 +1633,40 @@ void aws_websocket_increment_read_window(struct aws_websocket *websocket, size_t
     }
 }
 
+void aws_websocket_resume_outgoing_payload(struct aws_websocket *websocket) {
+    bool is_midchannel_handler = false;
+    bool should_schedule_task = false;
+
+    /* BEGIN CRITICAL SECTION */
+    s_lock_synced_data(websocket);
+
+    if (websocket->synced_data.is_midchannel_handler) {
+        is_midchannel_handler = true;
+    } else if (websocket->synced_data.is_payload_paused) {
+        websocket->synced_data.is_payload_paused = false;
+        should_schedule_task = true;
+    } else {
+        websocket->synced_data.has_pending_payload_resume = true;
+    }
+
+    s_unlock_synced_data(websocket);
+    /* END CRITICAL SECTION */
+
+    if (is_midchannel_handler) {
+        AWS_LOGF_TRACE(
+            AWS_LS_HTTP_WEBSOCKET,
+            "id=%p: Ignoring payload resume call, websocket has converted to midchannel handler.",
+            (void *)websocket);
+    } else if (should_schedule_task) {
+        AWS_LOGF_TRACE(
+            AWS_LS_HTTP_WEBSOCKET, "id=%p: Scheduling task to resume paused payload stream.", (void *)websocket);
+        aws_channel_schedule_task_now(websocket->channel_slot->channel, &websocket->waiting_on_payload_stream_task);
+    } else {
+        AWS_LOGF_TRACE(
+            AWS_LS_HTTP_WEBSOCKET, "id=%p: Payload stream not paused, noting resume for later.", (void *)websocket);
+    }
+}
+
 int aws_websocket_random_handshake_key(struct aws_byte_buf *dst) {
     /* RFC-6455 Section 4.1.
      * Derive random 16-byte value, base64-encoded, for the Sec-WebSocket-Key header */
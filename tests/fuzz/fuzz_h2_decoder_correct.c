@@ -243,11 +243,20 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
             /* Allow body to exceed available space. Data encoder should just write what it can fit */
             struct aws_input_stream *body = aws_input_stream_new_from_cursor(allocator, &input);
 
+            int32_t stream_window = AWS_H2_WINDOW_UPDATE_MAX;
+            size_t connection_window = AWS_H2_WINDOW_UPDATE_MAX;
             bool body_complete;
             AWS_FATAL_ASSERT(
                 aws_h2_encode_data_frame(
-                    &encoder, stream_id, body, (bool)body_ends_stream, pad_length, &frame_data, &body_complete) ==
-                AWS_OP_SUCCESS);
+                    &encoder,
+                    stream_id,
+                    body,
+                    (bool)body_ends_stream,
+                    pad_length,
+                    &stream_window,
+                    &connection_window,
+                    &frame_data,
+                    &body_complete) == AWS_OP_SUCCESS);
 
             struct aws_stream_status body_status;
             aws_input_stream_get_status(body, &body_status);
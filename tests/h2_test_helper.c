@@ -536,9 +536,20 @@ int h2_fake_peer_send_data_frame(
         peer->testing_channel->channel, AWS_IO_MESSAGE_APPLICATION_DATA, g_aws_channel_max_fragment_size);
     ASSERT_NOT_NULL(msg);
 
+    /* This helper doesn't enforce flow-control, tests can send as much as they like */
+    int32_t stream_window = AWS_H2_WINDOW_UPDATE_MAX;
+    size_t connection_window = AWS_H2_WINDOW_UPDATE_MAX;
     bool body_complete;
     ASSERT_SUCCESS(aws_h2_encode_data_frame(
-        &peer->encoder, stream_id, body_stream, end_stream, 0, &msg->message_data, &body_complete));
+        &peer->encoder,
+        stream_id,
+        body_stream,
+        end_stream,
+        0 /*pad_length*/,
+        &stream_window,
+        &connection_window,
+        &msg->message_data,
+        &body_complete));
 
     ASSERT_TRUE(body_complete);
     ASSERT_TRUE(msg->message_data.len != 0);
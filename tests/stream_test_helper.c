@@ -171,6 +171,7 @@ int client_stream_tester_init(
     struct aws_http_make_request_options request_options = {
         .self_size = sizeof(request_options),
         .request = options->request,
+        .request_template = options->request_template,
         .user_data = tester,
         .on_response_headers = s_on_headers,
         .on_response_header_block_done = s_on_header_block_done,
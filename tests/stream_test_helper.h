@@ -58,6 +58,8 @@ struct client_stream_tester {
 struct client_stream_tester_options {
     struct aws_http_message *request;
     struct aws_http_connection *connection;
+    /* Optional */
+    const struct aws_http1_request_template *request_template;
 };
 
 int client_stream_tester_init(
@@ -36,6 +36,8 @@ enum new_connection_result_type { AWS_NCRT_SUCCESS, AWS_NCRT_ERROR_VIA_CALLBACK,
 struct mock_connection {
     enum new_connection_result_type result;
     bool is_closed_on_release;
+    enum aws_http_version version;
+    uint32_t max_concurrent_streams;
 };
 
 struct cm_tester_options {
@@ -43,6 +45,14 @@ struct cm_tester_options {
     struct aws_http_connection_manager_system_vtable *mock_table;
     struct aws_http_proxy_options *proxy_options;
     size_t max_connections;
+    bool use_tls;
+};
+
+/* A connection attempt whose setup callback hasn't been invoked yet */
+struct deferred_setup {
+    aws_http_on_client_connection_setup_fn *on_setup;
+    void *user_data;
+    size_t connection_id;
 };
 
 struct cm_tester {
@@ -76,6 +86,9 @@ struct cm_tester {
     struct aws_atomic_var next_connection_id;
     struct aws_array_list mock_connections;
     aws_http_on_client_connection_shutdown_fn *release_connection_fn;
+
+    /* Contains struct deferred_setup */
+    struct aws_array_list deferred_setups;
 };
 
 static struct cm_tester s_tester;
@@ -155,7 +168,7 @@ int s_cm_tester_init(struct cm_tester_options *options) {
         .bootstrap = tester->client_bootstrap,
         .initial_window_size = SIZE_MAX,
         .socket_options = &socket_options,
-        .tls_connection_options = NULL,
+        .tls_connection_options = options->use_tls ? &tester->tls_connection_options : NULL,
         .proxy_options = tester->proxy_options,
         .host = aws_byte_cursor_from_c_str("www.google.com"),
         .port = 80,
@@ -178,6 +191,9 @@ int s_cm_tester_init(struct cm_tester_options *options) {
     ASSERT_SUCCESS(aws_array_list_init_dynamic(
         &tester->mock_connections, tester->allocator, 10, sizeof(struct mock_connection *)));
 
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(
+        &tester->deferred_setups, tester->allocator, 10, sizeof(struct deferred_setup)));
+
     return AWS_OP_SUCCESS;
 }
 
@@ -190,6 +206,23 @@ void s_add_mock_connections(size_t count, enum new_connection_result_type result
 
         mock->result = result;
         mock->is_closed_on_release = closed_on_release;
+        mock->version = AWS_HTTP_VERSION_1_1;
+        mock->max_concurrent_streams = 1;
+
+        aws_array_list_push_back(&tester->mock_connections, &mock);
+    }
+}
+
+void s_add_mock_http2_connections(size_t count, uint32_t max_concurrent_streams) {
+    struct cm_tester *tester = &s_tester;
+
+    for (size_t i = 0; i < count; ++i) {
+        struct mock_connection *mock = aws_mem_acquire(tester->allocator, sizeof(struct mock_connection));
+        AWS_ZERO_STRUCT(*mock);
+
+        mock->result = AWS_NCRT_SUCCESS;
+        mock->version = AWS_HTTP_VERSION_2;
+        mock->max_concurrent_streams = max_concurrent_streams;
 
         aws_array_list_push_back(&tester->mock_connections, &mock);
     }
@@ -369,6 +402,7 @@ int s_cm_tester_clean_up(void) {
         aws_mem_release(tester->allocator, mock);
     }
     aws_array_list_clean_up(&tester->mock_connections);
+    aws_array_list_clean_up(&tester->deferred_setups);
 
     aws_http_connection_manager_release(tester->connection_manager);
 
@@ -581,11 +615,29 @@ static bool s_aws_http_connection_manager_is_connection_open_sync_mock(const str
     return !proxy->is_closed_on_release;
 }
 
+static enum aws_http_version s_aws_http_connection_manager_get_version_sync_mock(
+    const struct aws_http_connection *connection) {
+
+    struct mock_connection *proxy = (struct mock_connection *)(void *)connection;
+
+    return proxy->version;
+}
+
+static uint32_t s_aws_http_connection_manager_get_max_concurrent_streams_sync_mock(
+    const struct aws_http_connection *connection) {
+
+    struct mock_connection *proxy = (struct mock_connection *)(void *)connection;
+
+    return proxy->max_concurrent_streams;
+}
+
 static struct aws_http_connection_manager_system_vtable s_synchronous_mocks = {
     .create_connection = s_aws_http_connection_manager_create_connection_sync_mock,
     .release_connection = s_aws_http_connection_manager_release_connection_sync_mock,
     .close_connection = s_aws_http_connection_manager_close_connection_sync_mock,
-    .is_connection_open = s_aws_http_connection_manager_is_connection_open_sync_mock};
+    .is_connection_open = s_aws_http_connection_manager_is_connection_open_sync_mock,
+    .get_version = s_aws_http_connection_manager_get_version_sync_mock,
+    .get_max_concurrent_streams = s_aws_http_connection_manager_get_max_concurrent_streams_sync_mock};
 
 static int s_test_connection_manager_acquire_release_mix_synchronous(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -702,6 +754,181 @@ AWS_TEST_CASE(
     test_connection_manager_success_then_cancel_pending_from_failure,
     s_test_connection_manager_success_then_cancel_pending_from_failure);
 
+static int s_aws_http_connection_manager_create_connection_deferred_mock(
+    const struct aws_http_client_connection_options *options) {
+    struct cm_tester *tester = &s_tester;
+
+    size_t next_connection_id = aws_atomic_fetch_add(&tester->next_connection_id, 1);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&tester->lock));
+    tester->release_connection_fn = options->on_shutdown;
+    ASSERT_SUCCESS(aws_mutex_unlock(&tester->lock));
+
+    struct deferred_setup setup = {
+        .on_setup = options->on_setup,
+        .user_data = options->user_data,
+        .connection_id = next_connection_id,
+    };
+    return aws_array_list_push_back(&tester->deferred_setups, &setup);
+}
+
+/* Invoke the setup callback of the oldest connection attempt, with its mock connection or its failure */
+static int s_complete_deferred_setup(void) {
+    struct cm_tester *tester = &s_tester;
+
+    struct deferred_setup setup;
+    ASSERT_SUCCESS(aws_array_list_front(&tester->deferred_setups, &setup));
+    aws_array_list_pop_front(&tester->deferred_setups);
+
+    struct mock_connection *connection = NULL;
+    ASSERT_SUCCESS(aws_array_list_get_at(&tester->mock_connections, &connection, setup.connection_id));
+    if (connection->result == AWS_NCRT_ERROR_VIA_CALLBACK) {
+        setup.on_setup(NULL, AWS_ERROR_HTTP_UNKNOWN, setup.user_data);
+    } else {
+        setup.on_setup((struct aws_http_connection *)connection, AWS_ERROR_SUCCESS, setup.user_data);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_http_connection_manager_system_vtable s_deferred_setup_mocks = {
+    .create_connection = s_aws_http_connection_manager_create_connection_deferred_mock,
+    .release_connection = s_aws_http_connection_manager_release_connection_sync_mock,
+    .close_connection = s_aws_http_connection_manager_close_connection_sync_mock,
+    .is_connection_open = s_aws_http_connection_manager_is_connection_open_sync_mock,
+    .get_version = s_aws_http_connection_manager_get_version_sync_mock,
+    .get_max_concurrent_streams = s_aws_http_connection_manager_get_max_concurrent_streams_sync_mock};
+
+static int s_test_connection_manager_http2_multiplexing(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct cm_tester_options options = {
+        .allocator = allocator, .max_connections = 5, .mock_table = &s_synchronous_mocks};
+
+    ASSERT_SUCCESS(s_cm_tester_init(&options));
+
+    s_add_mock_http2_connections(5, 3);
+
+    struct aws_http_connection *first_mock = NULL;
+    struct aws_http_connection *second_mock = NULL;
+    ASSERT_SUCCESS(aws_array_list_get_at(&s_tester.mock_connections, &first_mock, 0));
+    ASSERT_SUCCESS(aws_array_list_get_at(&s_tester.mock_connections, &second_mock, 1));
+
+    /* One connection serves as many acquisitions as the server allows streams */
+    s_acquire_connections(3);
+    ASSERT_SUCCESS(s_wait_on_connection_reply_count(3));
+    ASSERT_UINT_EQUALS(1, aws_atomic_load_int(&s_tester.next_connection_id));
+    for (size_t i = 0; i < 3; ++i) {
+        struct aws_http_connection *connection = NULL;
+        ASSERT_SUCCESS(aws_array_list_get_at(&s_tester.connections, &connection, i));
+        ASSERT_PTR_EQUALS(first_mock, connection);
+    }
+
+    /* Once it's full, a new connection is made */
+    s_acquire_connections(1);
+    ASSERT_SUCCESS(s_wait_on_connection_reply_count(4));
+    ASSERT_UINT_EQUALS(2, aws_atomic_load_int(&s_tester.next_connection_id));
+
+    /* Release the second connection's only lease, and one of the first connection's */
+    ASSERT_SUCCESS(s_release_connections(2, false));
+
+    /* New acquisitions go to the least-loaded connection, without connecting again */
+    s_acquire_connections(2);
+    ASSERT_SUCCESS(s_wait_on_connection_reply_count(6));
+    ASSERT_UINT_EQUALS(2, aws_atomic_load_int(&s_tester.next_connection_id));
+    for (size_t i = 2; i < 4; ++i) {
+        struct aws_http_connection *connection = NULL;
+        ASSERT_SUCCESS(aws_array_list_get_at(&s_tester.connections, &connection, i));
+        ASSERT_PTR_EQUALS(second_mock, connection);
+    }
+
+    ASSERT_TRUE(s_tester.connection_errors == 0);
+
+    ASSERT_SUCCESS(s_cm_tester_clean_up());
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(test_connection_manager_http2_multiplexing, s_test_connection_manager_http2_multiplexing);
+
+/* Until a TLS connection is established, it's unknown whether ALPN will pick HTTP/2,
+ * so a burst of acquisitions must not open a connection for each */
+static int s_test_connection_manager_http2_cold_start(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct cm_tester_options options = {
+        .allocator = allocator,
+        .max_connections = 5,
+        .mock_table = &s_deferred_setup_mocks,
+        .use_tls = true,
+    };
+
+    ASSERT_SUCCESS(s_cm_tester_init(&options));
+
+    s_add_mock_http2_connections(5, 3);
+
+    /* All acquisitions are queued before any connection is established, only one connection is attempted */
+    s_acquire_connections(4);
+    ASSERT_UINT_EQUALS(1, aws_atomic_load_int(&s_tester.next_connection_id));
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&s_tester.connections));
+
+    /* The first connection serves as many as it can, and one more connection is made for the rest */
+    ASSERT_SUCCESS(s_complete_deferred_setup());
+    ASSERT_SUCCESS(s_wait_on_connection_reply_count(3));
+    ASSERT_UINT_EQUALS(2, aws_atomic_load_int(&s_tester.next_connection_id));
+
+    ASSERT_SUCCESS(s_complete_deferred_setup());
+    ASSERT_SUCCESS(s_wait_on_connection_reply_count(4));
+    ASSERT_UINT_EQUALS(2, aws_atomic_load_int(&s_tester.next_connection_id));
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&s_tester.deferred_setups));
+
+    ASSERT_TRUE(s_tester.connection_errors == 0);
+
+    ASSERT_SUCCESS(s_cm_tester_clean_up());
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(test_connection_manager_http2_cold_start, s_test_connection_manager_http2_cold_start);
+
+/* A failed probe only fails the acquisition it was expected to satisfy, the rest wait for another probe */
+static int s_test_connection_manager_http2_cold_start_probe_failure(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct cm_tester_options options = {
+        .allocator = allocator,
+        .max_connections = 5,
+        .mock_table = &s_deferred_setup_mocks,
+        .use_tls = true,
+    };
+
+    ASSERT_SUCCESS(s_cm_tester_init(&options));
+
+    s_add_mock_connections(1, AWS_NCRT_ERROR_VIA_CALLBACK, false);
+    s_add_mock_http2_connections(4, 3);
+
+    s_acquire_connections(3);
+    ASSERT_UINT_EQUALS(1, aws_atomic_load_int(&s_tester.next_connection_id));
+
+    /* The first probe fails, failing one acquisition, and another probe is made */
+    ASSERT_SUCCESS(s_complete_deferred_setup());
+    ASSERT_SUCCESS(s_wait_on_connection_reply_count(1));
+    ASSERT_TRUE(s_tester.connection_errors == 1);
+    ASSERT_UINT_EQUALS(2, aws_atomic_load_int(&s_tester.next_connection_id));
+
+    /* The second probe succeeds, and serves the rest */
+    ASSERT_SUCCESS(s_complete_deferred_setup());
+    ASSERT_SUCCESS(s_wait_on_connection_reply_count(3));
+    ASSERT_TRUE(s_tester.connection_errors == 1);
+    ASSERT_UINT_EQUALS(2, aws_atomic_load_int(&s_tester.next_connection_id));
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&s_tester.deferred_setups));
+
+    ASSERT_SUCCESS(s_cm_tester_clean_up());
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(
+    test_connection_manager_http2_cold_start_probe_failure,
+    s_test_connection_manager_http2_cold_start_probe_failure);
+
 static int s_test_connection_manager_proxy_setup_shutdown(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
 
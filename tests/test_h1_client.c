@@ -14,8 +14,12 @@
  */
 
 #include "stream_test_helper.h"
+#include <aws/common/thread.h>
 #include <aws/common/uuid.h>
+#include <aws/http/arena.h>
+#include <aws/http/private/content_coding.h>
 #include <aws/http/private/h1_connection.h>
+#include <aws/http/private/strutil.h>
 #include <aws/http/request_response.h>
 #include <aws/http/status_code.h>
 #include <aws/io/logging.h>
@@ -56,7 +60,11 @@ struct tester {
     bool manual_window_management;
 };
 
-static int s_tester_init(struct tester *tester, struct aws_allocator *alloc) {
+static int s_tester_init_with_pipelining(
+    struct tester *tester,
+    struct aws_allocator *alloc,
+    size_t max_pipelined_requests) {
+
     aws_http_library_init(alloc);
 
     AWS_ZERO_STRUCT(*tester);
@@ -75,7 +83,7 @@ static int s_tester_init(struct tester *tester, struct aws_allocator *alloc) {
 
     /* Use small window so that we can observe it opening in tests.
      * Channel may wait until the window is small before issuing the increment command. */
-    tester->connection = aws_http_connection_new_http1_1_client(alloc, true, 256);
+    tester->connection = aws_http_connection_new_http1_1_client(alloc, true, 256, max_pipelined_requests);
     ASSERT_NOT_NULL(tester->connection);
 
     struct aws_channel_slot *slot = aws_channel_slot_new(tester->testing_channel.channel);
@@ -89,6 +97,10 @@ static int s_tester_init(struct tester *tester, struct aws_allocator *alloc) {
     return AWS_OP_SUCCESS;
 }
 
+static int s_tester_init(struct tester *tester, struct aws_allocator *alloc) {
+    return s_tester_init_with_pipelining(tester, alloc, 0 /*max_pipelined_requests*/);
+}
+
 static int s_tester_clean_up(struct tester *tester) {
     aws_http_connection_release(tester->connection);
     ASSERT_SUCCESS(testing_channel_clean_up(&tester->testing_channel));
@@ -290,6 +302,384 @@ H1_CLIENT_TEST_CASE(h1_client_request_content_length_0_ok) {
     return AWS_OP_SUCCESS;
 }
 
+static struct aws_http_message *s_new_default_chunked_put_request(struct aws_allocator *allocator) {
+    struct aws_http_header headers[] = {
+        {
+            .name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Transfer-Encoding"),
+            .value = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("chunked"),
+        },
+    };
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    AWS_FATAL_ASSERT(request);
+    AWS_FATAL_ASSERT(!aws_http_message_set_request_method(request, aws_byte_cursor_from_c_str("PUT")));
+    AWS_FATAL_ASSERT(!aws_http_message_set_request_path(request, aws_byte_cursor_from_c_str("/plan.txt")));
+    AWS_FATAL_ASSERT(!aws_http_message_add_header_array(request, headers, AWS_ARRAY_SIZE(headers)));
+    return request;
+}
+
+struct chunk_tester {
+    size_t on_complete_count;
+    int on_complete_error_code;
+};
+
+static void s_on_chunk_complete(struct aws_http_stream *stream, int error_code, void *user_data) {
+    (void)stream;
+    struct chunk_tester *chunk_tester = user_data;
+    chunk_tester->on_complete_count++;
+    if (error_code) {
+        chunk_tester->on_complete_error_code = error_code;
+    }
+}
+
+static int s_write_chunk_str(
+    struct aws_http_stream *stream,
+    struct aws_input_stream *data,
+    uint64_t data_size,
+    struct chunk_tester *chunk_tester) {
+
+    struct aws_http1_chunk_options options = {
+        .chunk_data = data,
+        .chunk_data_size = data_size,
+        .on_complete = s_on_chunk_complete,
+        .user_data = chunk_tester,
+    };
+    return aws_http1_stream_write_chunk(stream, &options);
+}
+
+H1_CLIENT_TEST_CASE(h1_client_request_send_chunked) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_http_message *request = s_new_default_chunked_put_request(allocator);
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+
+    /* write chunks */
+    static const struct aws_byte_cursor chunk1 = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("write more tests");
+    static const struct aws_byte_cursor chunk2 = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("ok");
+    struct aws_input_stream *chunk1_stream = aws_input_stream_new_from_cursor(allocator, &chunk1);
+    struct aws_input_stream *chunk2_stream = aws_input_stream_new_from_cursor(allocator, &chunk2);
+
+    struct chunk_tester chunk_tester = {0};
+    ASSERT_SUCCESS(s_write_chunk_str(stream, chunk1_stream, chunk1.len, &chunk_tester));
+    ASSERT_SUCCESS(s_write_chunk_str(stream, chunk2_stream, chunk2.len, &chunk_tester));
+    ASSERT_SUCCESS(s_write_chunk_str(stream, NULL, 0, &chunk_tester));
+
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* check result */
+    const char *expected = "PUT /plan.txt HTTP/1.1\r\n"
+                           "Transfer-Encoding: chunked\r\n"
+                           "\r\n"
+                           "10\r\n"
+                           "write more tests\r\n"
+                           "2\r\n"
+                           "ok\r\n"
+                           "0\r\n"
+                           "\r\n";
+    ASSERT_SUCCESS(testing_channel_check_written_message_str(&tester.testing_channel, expected));
+    ASSERT_UINT_EQUALS(3, chunk_tester.on_complete_count);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, chunk_tester.on_complete_error_code);
+
+    /* no more chunks allowed after the final chunk */
+    ASSERT_FAILS(s_write_chunk_str(stream, NULL, 0, &chunk_tester));
+
+    /* clean up */
+    aws_input_stream_destroy(chunk1_stream);
+    aws_input_stream_destroy(chunk2_stream);
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Drain everything written so far, check that it begins with `expected_head`, and decode the chunked body after it */
+static int s_drain_chunked_request(struct tester *tester, const char *expected_head, struct aws_byte_buf *out_body) {
+    struct aws_byte_buf written;
+    ASSERT_SUCCESS(aws_byte_buf_init(&written, tester->alloc, 1024));
+    ASSERT_SUCCESS(testing_channel_drain_written_messages(&tester->testing_channel, &written));
+
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&written);
+    size_t head_len = strlen(expected_head);
+    ASSERT_TRUE(cursor.len >= head_len);
+    ASSERT_BIN_ARRAYS_EQUALS(expected_head, head_len, cursor.ptr, head_len);
+    aws_byte_cursor_advance(&cursor, head_len);
+
+    uint64_t chunk_size;
+    do {
+        /* chunk-line: "{hex size}\r\n" */
+        size_t line_len = 0;
+        while (line_len < cursor.len && cursor.ptr[line_len] != '\r') {
+            ++line_len;
+        }
+        ASSERT_SUCCESS(aws_strutil_read_unsigned_hex(aws_byte_cursor_advance(&cursor, line_len), &chunk_size));
+        ASSERT_TRUE(cursor.len >= 2 && cursor.ptr[0] == '\r' && cursor.ptr[1] == '\n');
+        aws_byte_cursor_advance(&cursor, 2);
+
+        /* chunk-data, followed by "\r\n". The final chunk is followed by an empty trailer, so "\r\n" again */
+        ASSERT_TRUE(cursor.len >= chunk_size + 2);
+        struct aws_byte_cursor chunk_data = aws_byte_cursor_advance(&cursor, (size_t)chunk_size);
+        ASSERT_SUCCESS(aws_byte_buf_append_dynamic(out_body, &chunk_data));
+        ASSERT_TRUE(cursor.ptr[0] == '\r' && cursor.ptr[1] == '\n');
+        aws_byte_cursor_advance(&cursor, 2);
+    } while (chunk_size > 0);
+
+    ASSERT_UINT_EQUALS(0, cursor.len);
+    aws_byte_buf_clean_up(&written);
+    return AWS_OP_SUCCESS;
+}
+
+/* A chunked request with a body stream should send the stream's data as chunks */
+H1_CLIENT_TEST_CASE(h1_client_request_send_chunked_body_stream) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_http_message *request = s_new_default_chunked_put_request(allocator);
+    struct aws_byte_cursor body = aws_byte_cursor_from_c_str("write more tests");
+    struct aws_input_stream *body_stream = aws_input_stream_new_from_cursor(allocator, &body);
+    aws_http_message_set_body_stream(request, body_stream);
+
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* check result */
+    const char *expected_head = "PUT /plan.txt HTTP/1.1\r\n"
+                                "Transfer-Encoding: chunked\r\n"
+                                "\r\n";
+    struct aws_byte_buf sent_body;
+    ASSERT_SUCCESS(aws_byte_buf_init(&sent_body, allocator, 16));
+    ASSERT_SUCCESS(s_drain_chunked_request(&tester, expected_head, &sent_body));
+    ASSERT_BIN_ARRAYS_EQUALS(body.ptr, body.len, sent_body.buffer, sent_body.len);
+
+    /* chunks can't be written by hand when the body stream provides them */
+    struct chunk_tester chunk_tester = {0};
+    ASSERT_FAILS(s_write_chunk_str(stream, NULL, 0, &chunk_tester));
+
+    /* clean up */
+    aws_byte_buf_clean_up(&sent_body);
+    aws_http_message_destroy(request);
+    aws_input_stream_destroy(body_stream);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+#ifdef AWS_HTTP_HAS_ZLIB
+
+static int s_on_decompressed_data(struct aws_byte_cursor data, void *user_data) {
+    struct aws_byte_buf *dst = user_data;
+    return aws_byte_buf_append_dynamic(dst, &data);
+}
+
+/* A compressed body stream should set the right headers, and its data should decompress to the original */
+H1_CLIENT_TEST_CASE(h1_client_request_send_compressed_body) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    /* highly compressible body, big enough to span multiple aws_io_messages before compression */
+    struct aws_byte_buf body_buf;
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buf, allocator, 64 * 1024));
+    while (body_buf.len + 64 <= body_buf.capacity) {
+        char line[64];
+        snprintf(line, sizeof(line), "2020-01-01T00:00:00Z INFO request %06zu complete\n", body_buf.len);
+        ASSERT_TRUE(aws_byte_buf_write_from_whole_cursor(&body_buf, aws_byte_cursor_from_c_str(line)));
+    }
+    struct aws_byte_cursor body = aws_byte_cursor_from_buf(&body_buf);
+    struct aws_input_stream *body_stream = aws_input_stream_new_from_cursor(allocator, &body);
+
+    /* Content-Length should get replaced by chunked encoding */
+    char content_length[32];
+    snprintf(content_length, sizeof(content_length), "%zu", body.len);
+    struct aws_http_header headers[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("Content-Length"),
+            .value = aws_byte_cursor_from_c_str(content_length),
+        },
+    };
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    ASSERT_SUCCESS(aws_http_message_set_request_method(request, aws_byte_cursor_from_c_str("PUT")));
+    ASSERT_SUCCESS(aws_http_message_set_request_path(request, aws_byte_cursor_from_c_str("/plan.txt")));
+    ASSERT_SUCCESS(aws_http_message_add_header_array(request, headers, AWS_ARRAY_SIZE(headers)));
+    ASSERT_SUCCESS(aws_http_message_set_compressed_body_stream(request, body_stream, AWS_HTTP_BODY_COMPRESSION_GZIP));
+
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    const char *expected_head = "PUT /plan.txt HTTP/1.1\r\n"
+                                "Content-Encoding: gzip\r\n"
+                                "Transfer-Encoding: chunked\r\n"
+                                "\r\n";
+    struct aws_byte_buf sent_body;
+    ASSERT_SUCCESS(aws_byte_buf_init(&sent_body, allocator, 1024));
+    ASSERT_SUCCESS(s_drain_chunked_request(&tester, expected_head, &sent_body));
+    ASSERT_TRUE(sent_body.len < body.len / 4);
+
+    struct aws_byte_buf decompressed;
+    ASSERT_SUCCESS(aws_byte_buf_init(&decompressed, allocator, body.len));
+    struct aws_http_decompressor *decompressor = aws_http_decompressor_new(allocator, AWS_HTTP_CONTENT_CODING_GZIP);
+    ASSERT_NOT_NULL(decompressor);
+    ASSERT_SUCCESS(aws_http_decompressor_process(
+        decompressor, aws_byte_cursor_from_buf(&sent_body), s_on_decompressed_data, &decompressed));
+    ASSERT_SUCCESS(aws_http_decompressor_finish(decompressor));
+    ASSERT_BIN_ARRAYS_EQUALS(body.ptr, body.len, decompressed.buffer, decompressed.len);
+
+    /* clean up */
+    aws_http_decompressor_destroy(decompressor);
+    aws_byte_buf_clean_up(&decompressed);
+    aws_byte_buf_clean_up(&sent_body);
+    aws_http_message_destroy(request);
+    aws_input_stream_destroy(body_stream);
+    aws_byte_buf_clean_up(&body_buf);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+#endif /* AWS_HTTP_HAS_ZLIB */
+
+/* Outgoing stream task should stop while there are no chunks, and resume when one is written */
+H1_CLIENT_TEST_CASE(h1_client_request_waits_for_chunks) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_http_message *request = s_new_default_chunked_put_request(allocator);
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+
+    /* only the head can be sent. draining tasks must not spin forever */
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_SUCCESS(testing_channel_check_written_message_str(
+        &tester.testing_channel,
+        "PUT /plan.txt HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"));
+
+    /* write a chunk, task should wake up and send it */
+    static const struct aws_byte_cursor chunk = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("write more tests");
+    struct aws_input_stream *chunk_stream = aws_input_stream_new_from_cursor(allocator, &chunk);
+    struct chunk_tester chunk_tester = {0};
+    ASSERT_SUCCESS(s_write_chunk_str(stream, chunk_stream, chunk.len, &chunk_tester));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_SUCCESS(testing_channel_check_written_message_str(&tester.testing_channel, "10\r\nwrite more tests\r\n"));
+    ASSERT_UINT_EQUALS(1, chunk_tester.on_complete_count);
+
+    /* final chunk */
+    ASSERT_SUCCESS(s_write_chunk_str(stream, NULL, 0, &chunk_tester));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_SUCCESS(testing_channel_check_written_message_str(&tester.testing_channel, "0\r\n\r\n"));
+    ASSERT_UINT_EQUALS(2, chunk_tester.on_complete_count);
+
+    /* clean up */
+    aws_input_stream_destroy(chunk_stream);
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Chunks that never got sent must still have their completion callback invoked */
+H1_CLIENT_TEST_CASE(h1_client_request_unsent_chunks_complete_on_shutdown) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_http_message *request = s_new_default_chunked_put_request(allocator);
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+
+    /* send head, then outgoing stream task goes idle waiting for chunks */
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* begin shutdown, then write chunk. The shutdown task runs before the chunk can be sent */
+    aws_channel_shutdown(tester.testing_channel.channel, AWS_ERROR_SUCCESS);
+
+    static const struct aws_byte_cursor chunk = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("write more tests");
+    struct aws_input_stream *chunk_stream = aws_input_stream_new_from_cursor(allocator, &chunk);
+    struct chunk_tester chunk_tester = {0};
+    ASSERT_SUCCESS(s_write_chunk_str(stream, chunk_stream, chunk.len, &chunk_tester));
+
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    ASSERT_UINT_EQUALS(1, chunk_tester.on_complete_count);
+    ASSERT_TRUE(chunk_tester.on_complete_error_code != AWS_ERROR_SUCCESS);
+
+    /* can't write chunks after stream completes */
+    ASSERT_FAILS(s_write_chunk_str(stream, NULL, 0, &chunk_tester));
+    ASSERT_INT_EQUALS(AWS_ERROR_HTTP_STREAM_HAS_COMPLETED, aws_last_error());
+
+    /* clean up */
+    aws_input_stream_destroy(chunk_stream);
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+H1_CLIENT_TEST_CASE(h1_client_request_write_chunk_requires_chunked_header) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+
+    struct chunk_tester chunk_tester = {0};
+    ASSERT_FAILS(s_write_chunk_str(stream, NULL, 0, &chunk_tester));
+    ASSERT_UINT_EQUALS(0, chunk_tester.on_complete_count);
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
 /* Send a request whose body doesn't fit in a single aws_io_message */
 H1_CLIENT_TEST_CASE(h1_client_request_send_large_body) {
     (void)ctx;
@@ -466,42 +856,300 @@ H1_CLIENT_TEST_CASE(h1_client_request_send_multiple) {
     return AWS_OP_SUCCESS;
 }
 
-static int s_stream_tester_init(
-    struct client_stream_tester *tester,
-    struct tester *master_tester,
-    struct aws_http_message *request) {
-
-    struct client_stream_tester_options options = {
-        .request = request,
-        .connection = master_tester->connection,
-    };
-    return client_stream_tester_init(tester, master_tester->alloc, &options);
-}
-
-H1_CLIENT_TEST_CASE(h1_client_response_get_1liner) {
+/* Small requests that are ready at the same time should be coalesced into a single aws_io_message */
+H1_CLIENT_TEST_CASE(h1_client_request_send_multiple_in_1_io_message) {
     (void)ctx;
     struct tester tester;
     ASSERT_SUCCESS(s_tester_init(&tester, allocator));
 
-    /* send request */
-    struct aws_http_message *request = s_new_default_get_request(allocator);
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = s_new_default_get_request(allocator),
+    };
 
-    struct client_stream_tester stream_tester;
-    ASSERT_SUCCESS(s_stream_tester_init(&stream_tester, &tester, request));
+    struct aws_http_stream *streams[3];
+    size_t num_streams = AWS_ARRAY_SIZE(streams);
+    for (size_t i = 0; i < num_streams; ++i) {
+        streams[i] = aws_http_connection_make_request(tester.connection, &opt);
+        ASSERT_NOT_NULL(streams[i]);
+        ASSERT_SUCCESS(aws_http_stream_activate(streams[i]));
+    }
 
     testing_channel_drain_queued_tasks(&tester.testing_channel);
 
-    /* Ensure the request can be destroyed after request is sent */
-    aws_http_message_destroy(request);
+    /* check that everything went out in ONE message */
+    const char *expected = "GET / HTTP/1.1\r\n"
+                           "\r\n"
+                           "GET / HTTP/1.1\r\n"
+                           "\r\n"
+                           "GET / HTTP/1.1\r\n"
+                           "\r\n";
+    ASSERT_SUCCESS(testing_channel_check_written_message_str(&tester.testing_channel, expected));
 
-    /* send response */
-    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, "HTTP/1.1 204 No Content\r\n\r\n"));
+    /* clean up */
+    aws_http_message_destroy(opt.request);
+    for (size_t i = 0; i < num_streams; ++i) {
+        aws_http_stream_release(streams[i]);
+    }
 
-    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
 
-    /* check result */
-    ASSERT_TRUE(stream_tester.complete);
-    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, stream_tester.on_complete_error_code);
+static struct aws_http_message *s_new_template_request(
+    struct aws_allocator *allocator,
+    const char *path,
+    struct aws_http_header *headers,
+    size_t num_headers) {
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    AWS_FATAL_ASSERT(request);
+    AWS_FATAL_ASSERT(!aws_http_message_set_request_path(request, aws_byte_cursor_from_c_str(path)));
+    AWS_FATAL_ASSERT(!aws_http_message_add_header_array(request, headers, num_headers));
+    return request;
+}
+
+/* Requests made with a template should send the template's method and headers, followed by the request's own */
+H1_CLIENT_TEST_CASE(h1_client_request_send_with_template) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    /* create template, prototype can be destroyed right away */
+    struct aws_http_header template_headers[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("Host"),
+            .value = aws_byte_cursor_from_c_str("amazon.com"),
+        },
+        {
+            .name = aws_byte_cursor_from_c_str("User-Agent"),
+            .value = aws_byte_cursor_from_c_str("bench/1.0"),
+        },
+    };
+    struct aws_http_message *prototype = s_new_template_request(allocator, "/", template_headers, 2);
+    ASSERT_SUCCESS(aws_http_message_set_request_method(prototype, aws_byte_cursor_from_c_str("GET")));
+    struct aws_http1_request_template *request_template = aws_http1_request_template_new(allocator, prototype);
+    ASSERT_NOT_NULL(request_template);
+    aws_http_message_destroy(prototype);
+
+    /* requests supply only path and variable headers */
+    struct aws_http_header headers_a[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("x-request-id"),
+            .value = aws_byte_cursor_from_c_str("1"),
+        },
+    };
+    struct aws_http_message *request_a = s_new_template_request(allocator, "/a", headers_a, 1);
+    struct aws_http_message *request_b = s_new_template_request(allocator, "/b", NULL, 0);
+
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request_a,
+        .request_template = request_template,
+    };
+    struct aws_http_stream *stream_a = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream_a);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream_a));
+
+    opt.request = request_b;
+    struct aws_http_stream *stream_b = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream_b);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream_b));
+
+    /* streams copy what they need from the template, so it can be destroyed now */
+    aws_http1_request_template_destroy(request_template);
+
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    const char *expected = "GET /a HTTP/1.1\r\n"
+                           "Host: amazon.com\r\n"
+                           "User-Agent: bench/1.0\r\n"
+                           "x-request-id: 1\r\n"
+                           "\r\n"
+                           "GET /b HTTP/1.1\r\n"
+                           "Host: amazon.com\r\n"
+                           "User-Agent: bench/1.0\r\n"
+                           "\r\n";
+    ASSERT_SUCCESS(testing_channel_check_written_messages_str(&tester.testing_channel, allocator, expected));
+
+    /* clean up */
+    aws_http_message_destroy(request_a);
+    aws_http_message_destroy(request_b);
+    aws_http_stream_release(stream_a);
+    aws_http_stream_release(stream_b);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Headers from the template and the request are validated together */
+H1_CLIENT_TEST_CASE(h1_client_request_template_conflicting_headers_fails) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_http_header template_headers[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("Transfer-Encoding"),
+            .value = aws_byte_cursor_from_c_str("chunked"),
+        },
+    };
+    struct aws_http_message *prototype = s_new_template_request(allocator, "/", template_headers, 1);
+    ASSERT_SUCCESS(aws_http_message_set_request_method(prototype, aws_byte_cursor_from_c_str("PUT")));
+    struct aws_http1_request_template *request_template = aws_http1_request_template_new(allocator, prototype);
+    ASSERT_NOT_NULL(request_template);
+    aws_http_message_destroy(prototype);
+
+    /* Content-Length conflicts with the template's Transfer-Encoding */
+    struct aws_http_header headers[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("Content-Length"),
+            .value = aws_byte_cursor_from_c_str("0"),
+        },
+    };
+    struct aws_http_message *request = s_new_template_request(allocator, "/", headers, 1);
+
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .request_template = request_template,
+    };
+    ASSERT_NULL(aws_http_connection_make_request(tester.connection, &opt));
+    ASSERT_INT_EQUALS(AWS_ERROR_HTTP_INVALID_HEADER_FIELD, aws_last_error());
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http1_request_template_destroy(request_template);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* A request's own method must agree with its template's */
+H1_CLIENT_TEST_CASE(h1_client_request_template_conflicting_method_fails) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_http_message *prototype = s_new_template_request(allocator, "/", NULL, 0);
+    ASSERT_SUCCESS(aws_http_message_set_request_method(prototype, aws_http_method_get));
+    struct aws_http1_request_template *request_template = aws_http1_request_template_new(allocator, prototype);
+    ASSERT_NOT_NULL(request_template);
+    aws_http_message_destroy(prototype);
+
+    struct aws_http_message *request = s_new_template_request(allocator, "/", NULL, 0);
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .request_template = request_template,
+    };
+
+    /* same method is fine */
+    ASSERT_SUCCESS(aws_http_message_set_request_method(request, aws_http_method_get));
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    aws_http_stream_release(stream);
+
+    /* different method fails */
+    ASSERT_SUCCESS(aws_http_message_set_request_method(request, aws_http_method_post));
+    ASSERT_NULL(aws_http_connection_make_request(tester.connection, &opt));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http1_request_template_destroy(request_template);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* The method of a request made with a template comes from the template, so a HEAD response has no body */
+H1_CLIENT_TEST_CASE(h1_client_response_head_request_with_template) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_http_message *prototype = s_new_template_request(allocator, "/", NULL, 0);
+    ASSERT_SUCCESS(aws_http_message_set_request_method(prototype, aws_http_method_head));
+    struct aws_http1_request_template *request_template = aws_http1_request_template_new(allocator, prototype);
+    ASSERT_NOT_NULL(request_template);
+    aws_http_message_destroy(prototype);
+
+    /* send request */
+    struct aws_http_message *request = s_new_template_request(allocator, "/", NULL, 0);
+
+    struct client_stream_tester_options options = {
+        .request = request,
+        .connection = tester.connection,
+        .request_template = request_template,
+    };
+    struct client_stream_tester stream_tester;
+    ASSERT_SUCCESS(client_stream_tester_init(&stream_tester, allocator, &options));
+    aws_http1_request_template_destroy(request_template);
+
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_SUCCESS(testing_channel_check_written_messages_str(
+        &tester.testing_channel, allocator, "HEAD / HTTP/1.1\r\n\r\n"));
+
+    aws_http_message_destroy(request);
+
+    /* send response, its Content-Length describes the body a GET would have gotten */
+    ASSERT_SUCCESS(testing_channel_push_read_str(
+        &tester.testing_channel,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 9\r\n"
+        "\r\n"));
+
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* check result */
+    ASSERT_TRUE(stream_tester.complete);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, stream_tester.on_complete_error_code);
+    ASSERT_INT_EQUALS(200, stream_tester.response_status);
+    ASSERT_UINT_EQUALS(0, stream_tester.response_body.len);
+
+    /* clean up */
+    client_stream_tester_clean_up(&stream_tester);
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+static int s_stream_tester_init(
+    struct client_stream_tester *tester,
+    struct tester *master_tester,
+    struct aws_http_message *request) {
+
+    struct client_stream_tester_options options = {
+        .request = request,
+        .connection = master_tester->connection,
+    };
+    return client_stream_tester_init(tester, master_tester->alloc, &options);
+}
+
+H1_CLIENT_TEST_CASE(h1_client_response_get_1liner) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    /* send request */
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+
+    struct client_stream_tester stream_tester;
+    ASSERT_SUCCESS(s_stream_tester_init(&stream_tester, &tester, request));
+
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* Ensure the request can be destroyed after request is sent */
+    aws_http_message_destroy(request);
+
+    /* send response */
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, "HTTP/1.1 204 No Content\r\n\r\n"));
+
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* check result */
+    ASSERT_TRUE(stream_tester.complete);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, stream_tester.on_complete_error_code);
     ASSERT_INT_EQUALS(204, stream_tester.response_status);
     ASSERT_UINT_EQUALS(0, aws_http_headers_count(stream_tester.response_headers));
     ASSERT_UINT_EQUALS(0, stream_tester.response_body.len);
@@ -770,6 +1418,96 @@ H1_CLIENT_TEST_CASE(h1_client_response_get_1_from_multiple_io_messages) {
 }
 
 /* Check that multiple responses in a single aws_io_message all come through */
+/* With a max pipelining depth, requests beyond that depth wait until a response completes */
+H1_CLIENT_TEST_CASE(h1_client_request_pipelining_depth) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init_with_pipelining(&tester, allocator, 2 /*max_pipelined_requests*/));
+
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+
+    struct client_stream_tester stream_testers[3];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(stream_testers); ++i) {
+        ASSERT_SUCCESS(s_stream_tester_init(&stream_testers[i], &tester, request));
+    }
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* only 2 requests should be sent */
+    ASSERT_SUCCESS(testing_channel_check_written_messages_str(
+        &tester.testing_channel,
+        allocator,
+        "GET / HTTP/1.1\r\n"
+        "\r\n"
+        "GET / HTTP/1.1\r\n"
+        "\r\n"));
+
+    /* 1st response completes, now 3rd request can be sent */
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, "HTTP/1.1 204 No Content\r\n\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    ASSERT_TRUE(stream_testers[0].complete);
+    ASSERT_SUCCESS(testing_channel_check_written_messages_str(
+        &tester.testing_channel,
+        allocator,
+        "GET / HTTP/1.1\r\n"
+        "\r\n"));
+
+    /* remaining responses */
+    ASSERT_SUCCESS(testing_channel_push_read_str(
+        &tester.testing_channel,
+        "HTTP/1.1 204 No Content\r\n\r\n"
+        "HTTP/1.1 204 No Content\r\n\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(stream_testers); ++i) {
+        ASSERT_TRUE(stream_testers[i].complete);
+        ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, stream_testers[i].on_complete_error_code);
+        ASSERT_INT_EQUALS(204, stream_testers[i].response_status);
+
+        client_stream_tester_clean_up(&stream_testers[i]);
+    }
+
+    aws_http_message_destroy(request);
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Requests that are in flight, or waiting on the pipelining depth, fail when the connection closes */
+H1_CLIENT_TEST_CASE(h1_client_request_pipelining_cancelled_by_channel_shutdown) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init_with_pipelining(&tester, allocator, 1 /*max_pipelined_requests*/));
+
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+
+    struct client_stream_tester stream_testers[2];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(stream_testers); ++i) {
+        ASSERT_SUCCESS(s_stream_tester_init(&stream_testers[i], &tester, request));
+    }
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* pipelining disabled, so only 1st request is sent */
+    ASSERT_SUCCESS(testing_channel_check_written_messages_str(
+        &tester.testing_channel,
+        allocator,
+        "GET / HTTP/1.1\r\n"
+        "\r\n"));
+
+    aws_channel_shutdown(tester.testing_channel.channel, AWS_ERROR_SUCCESS);
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(stream_testers); ++i) {
+        ASSERT_TRUE(stream_testers[i].complete);
+        ASSERT_INT_EQUALS(AWS_ERROR_HTTP_CONNECTION_CLOSED, stream_testers[i].on_complete_error_code);
+
+        client_stream_tester_clean_up(&stream_testers[i]);
+    }
+
+    aws_http_message_destroy(request);
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
 H1_CLIENT_TEST_CASE(h1_client_response_get_multiple_from_1_io_message) {
     (void)ctx;
     struct tester tester;
@@ -1020,17 +1758,198 @@ H1_CLIENT_TEST_CASE(h1_client_response_arrives_before_request_done_sending_is_ok
     return AWS_OP_SUCCESS;
 }
 
-/* Response data arrives, but there was no outstanding request */
-H1_CLIENT_TEST_CASE(h1_client_response_without_request_shuts_down_connection) {
+/* If pause_outgoing_body_when_empty is set, the connection should stop polling an empty body
+ * until aws_http_stream_resume_outgoing_body() is called */
+H1_CLIENT_TEST_CASE(h1_client_request_send_body_pause_and_resume) {
     (void)ctx;
     struct tester tester;
     ASSERT_SUCCESS(s_tester_init(&tester, allocator));
 
-    ASSERT_SUCCESS(testing_channel_push_read_str_ignore_errors(&tester.testing_channel, "HTTP/1.1 200 OK\r\n\r\n"));
-    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    /* set up request whose body won't have data for a long time */
+    const size_t initial_delay_ticks = 1000;
+    struct slow_body_sender body_sender = {
+        .status =
+            {
+                .is_end_of_stream = false,
+                .is_valid = true,
+            },
+        .cursor = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("write more tests"),
+        .delay_ticks = initial_delay_ticks,
+    };
+    struct aws_input_stream body_stream = {
+        .allocator = allocator,
+        .impl = &body_sender,
+        .vtable = &s_slow_stream_vtable,
+    };
 
-    ASSERT_TRUE(testing_channel_is_shutdown_completed(&tester.testing_channel));
-    ASSERT_TRUE(testing_channel_get_shutdown_error_code(&tester.testing_channel) != AWS_ERROR_SUCCESS);
+    struct aws_http_header headers[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("Content-Length"),
+            .value = aws_byte_cursor_from_c_str("16"),
+        },
+    };
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    ASSERT_SUCCESS(aws_http_message_set_request_method(request, aws_byte_cursor_from_c_str("PUT")));
+    ASSERT_SUCCESS(aws_http_message_set_request_path(request, aws_byte_cursor_from_c_str("/plan.txt")));
+    ASSERT_SUCCESS(aws_http_message_add_header_array(request, headers, AWS_ARRAY_SIZE(headers)));
+    aws_http_message_set_body_stream(request, &body_stream);
+
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .pause_outgoing_body_when_empty = true,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+
+    /* head should be sent, then the connection should pause rather than poll the body every tick */
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_TRUE(body_sender.delay_ticks + 5 > initial_delay_ticks);
+    ASSERT_SUCCESS(testing_channel_check_written_messages_str(
+        &tester.testing_channel,
+        allocator,
+        "PUT /plan.txt HTTP/1.1\r\n"
+        "Content-Length: 16\r\n"
+        "\r\n"));
+
+    /* make data available and resume */
+    body_sender.delay_ticks = 0;
+    ASSERT_SUCCESS(aws_http_stream_resume_outgoing_body(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_SUCCESS(
+        testing_channel_check_written_messages_str(&tester.testing_channel, allocator, "write more tests"));
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+static void s_on_body_data_release(void *user_data) {
+    size_t *release_count = user_data;
+    *release_count += 1;
+}
+
+/* Body data in caller-owned memory that's too big for one message should be sent without copying,
+ * and the memory should stay in use until the writes referencing it have completed */
+H1_CLIENT_TEST_CASE(h1_client_request_send_body_data_without_copy) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    /* big enough to span several aws_io_messages */
+    const size_t body_len = 256 * 1024;
+    struct aws_byte_buf body_buf;
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buf, allocator, body_len));
+    for (size_t i = 0; i < body_len; ++i) {
+        aws_byte_buf_write_u8(&body_buf, (uint8_t)('a' + (i % 26)));
+    }
+
+    char content_length_str[32];
+    snprintf(content_length_str, sizeof(content_length_str), "%zu", body_len);
+    struct aws_http_header headers[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("Content-Length"),
+            .value = aws_byte_cursor_from_c_str(content_length_str),
+        },
+    };
+
+    size_t release_count = 0;
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    ASSERT_SUCCESS(aws_http_message_set_request_method(request, aws_byte_cursor_from_c_str("PUT")));
+    ASSERT_SUCCESS(aws_http_message_set_request_path(request, aws_byte_cursor_from_c_str("/plan.txt")));
+    ASSERT_SUCCESS(aws_http_message_add_header_array(request, headers, AWS_ARRAY_SIZE(headers)));
+    ASSERT_SUCCESS(aws_http_message_set_body_data(
+        request, aws_byte_cursor_from_buf(&body_buf), s_on_body_data_release, &release_count));
+
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+
+    /* Turn off instant write completion, so the test decides when each write is done */
+    testing_channel_complete_written_messages_immediately(&tester.testing_channel, false, AWS_OP_SUCCESS);
+
+    /* the user is done with the request, but the body data must stay in use until the last write completes */
+    aws_http_message_destroy(request);
+
+    /* gather up everything written, noting which messages point right into the body data */
+    struct aws_byte_buf written;
+    ASSERT_SUCCESS(aws_byte_buf_init(&written, allocator, body_len + 128));
+    size_t num_lent_bytes = 0;
+
+    struct aws_linked_list *msgs = testing_channel_get_written_message_queue(&tester.testing_channel);
+    while (true) {
+        testing_channel_drain_queued_tasks(&tester.testing_channel);
+        if (aws_linked_list_empty(msgs)) {
+            break;
+        }
+
+        ASSERT_UINT_EQUALS(0, release_count);
+
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(msgs);
+        struct aws_io_message *msg = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+
+        if (msg->message_data.buffer >= body_buf.buffer && msg->message_data.buffer < body_buf.buffer + body_len) {
+            num_lent_bytes += msg->message_data.len;
+        }
+
+        struct aws_byte_cursor msg_data = aws_byte_cursor_from_buf(&msg->message_data);
+        ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&written, &msg_data));
+
+        if (msg->on_completion) {
+            msg->on_completion(tester.testing_channel.channel, msg, AWS_ERROR_SUCCESS, msg->user_data);
+        }
+        aws_mem_release(msg->allocator, msg);
+    }
+
+    /* most of the body should have gone out without being copied */
+    ASSERT_TRUE(num_lent_bytes > body_len / 2);
+    ASSERT_UINT_EQUALS(1, release_count);
+
+    /* check that the bytes are right */
+    struct aws_byte_buf expected;
+    ASSERT_SUCCESS(aws_byte_buf_init(&expected, allocator, body_len + 128));
+    struct aws_byte_cursor head = aws_byte_cursor_from_c_str("PUT /plan.txt HTTP/1.1\r\nContent-Length: ");
+    ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&expected, &head));
+    struct aws_byte_cursor content_length_cursor = aws_byte_cursor_from_c_str(content_length_str);
+    ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&expected, &content_length_cursor));
+    struct aws_byte_cursor head_end = aws_byte_cursor_from_c_str("\r\n\r\n");
+    ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&expected, &head_end));
+    struct aws_byte_cursor body = aws_byte_cursor_from_buf(&body_buf);
+    ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&expected, &body));
+    ASSERT_BIN_ARRAYS_EQUALS(expected.buffer, expected.len, written.buffer, written.len);
+
+    /* clean up */
+    aws_byte_buf_clean_up(&expected);
+    aws_byte_buf_clean_up(&written);
+    aws_http_stream_release(stream);
+    aws_byte_buf_clean_up(&body_buf);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Response data arrives, but there was no outstanding request */
+H1_CLIENT_TEST_CASE(h1_client_response_without_request_shuts_down_connection) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    ASSERT_SUCCESS(testing_channel_push_read_str_ignore_errors(&tester.testing_channel, "HTTP/1.1 200 OK\r\n\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    ASSERT_TRUE(testing_channel_is_shutdown_completed(&tester.testing_channel));
+    ASSERT_TRUE(testing_channel_get_shutdown_error_code(&tester.testing_channel) != AWS_ERROR_SUCCESS);
 
     /* clean up */
     ASSERT_SUCCESS(s_tester_clean_up(&tester));
@@ -1396,6 +2315,792 @@ static void s_on_complete(struct aws_http_stream *stream, int error_code, void *
     *completion_error_code = error_code;
 }
 
+/* Response body should be written straight into the user's buffers, and the window re-opened as they're recycled */
+H1_CLIENT_TEST_CASE(h1_client_response_body_into_buffers) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_byte_buf body_buffers[2];
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buffers[0], allocator, 4));
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buffers[1], allocator, 16));
+
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+    int completion_error_code = -1;
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .on_complete = s_on_complete,
+        .user_data = &completion_error_code,
+        .response_body_buffers = body_buffers,
+        .num_response_body_buffers = AWS_ARRAY_SIZE(body_buffers),
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* send response */
+    const char *response_str = "HTTP/1.1 200 OK\r\n"
+                               "Content-Length: 16\r\n"
+                               "\r\n"
+                               "write more tests";
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, response_str));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* check result */
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, completion_error_code);
+    ASSERT_BIN_ARRAYS_EQUALS("writ", 4, body_buffers[0].buffer, body_buffers[0].len);
+    ASSERT_BIN_ARRAYS_EQUALS("e more tests", 12, body_buffers[1].buffer, body_buffers[1].len);
+
+    /* window shouldn't re-open for the body until the buffers are recycled */
+    size_t body_len = 16;
+    ASSERT_UINT_EQUALS(strlen(response_str) - body_len, testing_channel_last_window_update(&tester.testing_channel));
+
+    /* the window shrank for the whole body while the first buffer was being filled */
+    ASSERT_SUCCESS(aws_http1_stream_recycle_response_body_buffer(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_UINT_EQUALS(body_len, testing_channel_last_window_update(&tester.testing_channel));
+    ASSERT_UINT_EQUALS(0, body_buffers[0].len);
+
+    /* the second buffer was finished when the stream completed */
+    ASSERT_SUCCESS(aws_http1_stream_recycle_response_body_buffer(stream));
+    ASSERT_UINT_EQUALS(0, body_buffers[1].len);
+
+    /* nothing left to recycle */
+    ASSERT_FAILS(aws_http1_stream_recycle_response_body_buffer(stream));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+    aws_byte_buf_clean_up(&body_buffers[0]);
+    aws_byte_buf_clean_up(&body_buffers[1]);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Response body buffers should be filled again once they're recycled, wrapping around from the last to the first */
+H1_CLIENT_TEST_CASE(h1_client_response_body_into_recycled_buffers) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_byte_buf body_buffers[2];
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buffers[0], allocator, 4));
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buffers[1], allocator, 4));
+
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+    int completion_error_code = -1;
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .on_complete = s_on_complete,
+        .user_data = &completion_error_code,
+        .response_body_buffers = body_buffers,
+        .num_response_body_buffers = AWS_ARRAY_SIZE(body_buffers),
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* nothing is finished yet */
+    ASSERT_FAILS(aws_http1_stream_recycle_response_body_buffer(stream));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+
+    /* fill both buffers */
+    ASSERT_SUCCESS(testing_channel_push_read_str(
+        &tester.testing_channel,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 12\r\n"
+        "\r\n"
+        "writ"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, "e mo"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_BIN_ARRAYS_EQUALS("writ", 4, body_buffers[0].buffer, body_buffers[0].len);
+    ASSERT_BIN_ARRAYS_EQUALS("e mo", 4, body_buffers[1].buffer, body_buffers[1].len);
+
+    /* recycling the first buffer re-opens the window for its data, and lets it be filled again */
+    ASSERT_SUCCESS(aws_http1_stream_recycle_response_body_buffer(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_UINT_EQUALS(4, testing_channel_last_window_update(&tester.testing_channel));
+
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, "re t"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, completion_error_code);
+    ASSERT_BIN_ARRAYS_EQUALS("re t", 4, body_buffers[0].buffer, body_buffers[0].len);
+    ASSERT_BIN_ARRAYS_EQUALS("e mo", 4, body_buffers[1].buffer, body_buffers[1].len);
+
+    /* buffers are recycled in the order they were filled */
+    ASSERT_SUCCESS(aws_http1_stream_recycle_response_body_buffer(stream));
+    ASSERT_UINT_EQUALS(0, body_buffers[1].len);
+    ASSERT_UINT_EQUALS(4, body_buffers[0].len);
+    ASSERT_SUCCESS(aws_http1_stream_recycle_response_body_buffer(stream));
+    ASSERT_UINT_EQUALS(0, body_buffers[0].len);
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+    aws_byte_buf_clean_up(&body_buffers[0]);
+    aws_byte_buf_clean_up(&body_buffers[1]);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Stream should fail if the response body doesn't fit in the user's buffers */
+H1_CLIENT_TEST_CASE(h1_client_response_body_into_buffers_too_small_is_error) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_byte_buf body_buffer;
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buffer, allocator, 8));
+
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+    int completion_error_code = -1;
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .on_complete = s_on_complete,
+        .user_data = &completion_error_code,
+        .response_body_buffers = &body_buffer,
+        .num_response_body_buffers = 1,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    const char *response_str = "HTTP/1.1 200 OK\r\n"
+                               "Content-Length: 16\r\n"
+                               "\r\n"
+                               "write more tests";
+    ASSERT_SUCCESS(testing_channel_push_read_str_ignore_errors(&tester.testing_channel, response_str));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    ASSERT_INT_EQUALS(AWS_ERROR_SHORT_BUFFER, completion_error_code);
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+    aws_byte_buf_clean_up(&body_buffer);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+static const char *s_expect_continue_head = "PUT /plan.txt HTTP/1.1\r\n"
+                                            "Content-Length: 16\r\n"
+                                            "Expect: 100-continue\r\n"
+                                            "\r\n";
+
+static struct aws_http_message *s_new_expect_continue_request(
+    struct aws_allocator *allocator,
+    struct aws_input_stream *body_stream) {
+
+    struct aws_http_header headers[] = {
+        {
+            .name = aws_byte_cursor_from_c_str("Content-Length"),
+            .value = aws_byte_cursor_from_c_str("16"),
+        },
+        {
+            .name = aws_byte_cursor_from_c_str("Expect"),
+            .value = aws_byte_cursor_from_c_str("100-continue"),
+        },
+    };
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    AWS_FATAL_ASSERT(request);
+    AWS_FATAL_ASSERT(!aws_http_message_set_request_method(request, aws_byte_cursor_from_c_str("PUT")));
+    AWS_FATAL_ASSERT(!aws_http_message_set_request_path(request, aws_byte_cursor_from_c_str("/plan.txt")));
+    AWS_FATAL_ASSERT(!aws_http_message_add_header_array(request, headers, AWS_ARRAY_SIZE(headers)));
+    aws_http_message_set_body_stream(request, body_stream);
+    return request;
+}
+
+/* Body of an "Expect: 100-continue" request should be held back until "100 Continue" arrives */
+H1_CLIENT_TEST_CASE(h1_client_request_expect_continue_waits_for_100) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_byte_cursor body = aws_byte_cursor_from_c_str("write more tests");
+    struct aws_input_stream *body_stream = aws_input_stream_new_from_cursor(allocator, &body);
+    struct aws_http_message *request = s_new_expect_continue_request(allocator, body_stream);
+
+    int completion_error_code = -1;
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .on_complete = s_on_complete,
+        .user_data = &completion_error_code,
+        .expect_continue_timeout_ms = 60 * 1000, /* long enough that it won't expire during the test */
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* only the head should be sent */
+    ASSERT_SUCCESS(
+        testing_channel_check_written_messages_str(&tester.testing_channel, allocator, s_expect_continue_head));
+
+    /* body should be sent once the server says to continue */
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, "HTTP/1.1 100 Continue\r\n\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_SUCCESS(
+        testing_channel_check_written_messages_str(&tester.testing_channel, allocator, "write more tests"));
+
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, "HTTP/1.1 200 OK\r\n\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, completion_error_code);
+    ASSERT_TRUE(aws_http_connection_is_open(tester.connection));
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_input_stream_destroy(body_stream);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* If the server sends a final response instead of "100 Continue", the body should never be sent,
+ * and the connection should close, since the request is incomplete on the wire */
+H1_CLIENT_TEST_CASE(h1_client_request_expect_continue_skips_body_on_final_response) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_byte_cursor body = aws_byte_cursor_from_c_str("write more tests");
+    struct aws_input_stream *body_stream = aws_input_stream_new_from_cursor(allocator, &body);
+    struct aws_http_message *request = s_new_expect_continue_request(allocator, body_stream);
+
+    int completion_error_code = -1;
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .on_complete = s_on_complete,
+        .user_data = &completion_error_code,
+        .expect_continue_timeout_ms = 60 * 1000,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    ASSERT_SUCCESS(testing_channel_push_read_str(
+        &tester.testing_channel,
+        "HTTP/1.1 413 Payload Too Large\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* stream completes without the body ever being sent */
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, completion_error_code);
+    int status = 0;
+    ASSERT_SUCCESS(aws_http_stream_get_incoming_response_status(stream, &status));
+    ASSERT_INT_EQUALS(413, status);
+    ASSERT_SUCCESS(
+        testing_channel_check_written_messages_str(&tester.testing_channel, allocator, s_expect_continue_head));
+
+    ASSERT_TRUE(testing_channel_is_shutdown_completed(&tester.testing_channel));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, testing_channel_get_shutdown_error_code(&tester.testing_channel));
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_input_stream_destroy(body_stream);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* If "100 Continue" doesn't arrive before the timeout, the body should be sent anyway */
+H1_CLIENT_TEST_CASE(h1_client_request_expect_continue_timeout_sends_body) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_byte_cursor body = aws_byte_cursor_from_c_str("write more tests");
+    struct aws_input_stream *body_stream = aws_input_stream_new_from_cursor(allocator, &body);
+    struct aws_http_message *request = s_new_expect_continue_request(allocator, body_stream);
+
+    int completion_error_code = -1;
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .on_complete = s_on_complete,
+        .user_data = &completion_error_code,
+        .expect_continue_timeout_ms = 1,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+
+    /* keep running tasks until the timeout expires */
+    struct aws_byte_buf written;
+    ASSERT_SUCCESS(aws_byte_buf_init(&written, allocator, 128));
+    for (int i = 0; i < 1000 && written.len < strlen(s_expect_continue_head) + body.len; ++i) {
+        aws_thread_current_sleep(aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+        testing_channel_drain_queued_tasks(&tester.testing_channel);
+        ASSERT_SUCCESS(testing_channel_drain_written_messages(&tester.testing_channel, &written));
+    }
+
+    struct aws_byte_buf expected;
+    ASSERT_SUCCESS(
+        aws_byte_buf_init_copy_from_cursor(&expected, allocator, aws_byte_cursor_from_c_str(s_expect_continue_head)));
+    ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&expected, &body));
+    ASSERT_BIN_ARRAYS_EQUALS(expected.buffer, expected.len, written.buffer, written.len);
+
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, "HTTP/1.1 200 OK\r\n\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, completion_error_code);
+
+    /* clean up */
+    aws_byte_buf_clean_up(&expected);
+    aws_byte_buf_clean_up(&written);
+    aws_http_message_destroy(request);
+    aws_input_stream_destroy(body_stream);
+    aws_http_stream_release(stream);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+#ifdef AWS_HTTP_HAS_ZLIB
+
+/* "write more tests" x4, compressed with gzip */
+static const uint8_t s_gzip_body[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x2b, 0x2f, 0xca, 0x2c,
+    0x49, 0x55, 0xc8, 0xcd, 0x2f, 0x4a, 0x55, 0x28, 0x49, 0x2d, 0x2e, 0x29, 0x2e, 0x27,
+    0x91, 0x0f, 0x00, 0x6e, 0xe3, 0x90, 0xd0, 0x40, 0x00, 0x00, 0x00,
+};
+
+/* "write more tests" x4, compressed with zlib (the "deflate" coding) */
+static const uint8_t s_deflate_body[] = {
+    0x78, 0x9c, 0x2b, 0x2f, 0xca, 0x2c, 0x49, 0x55, 0xc8, 0xcd, 0x2f, 0x4a, 0x55, 0x28,
+    0x49, 0x2d, 0x2e, 0x29, 0x2e, 0x27, 0x91, 0x0f, 0x00, 0x35, 0x5d, 0x19, 0x45,
+};
+
+static const char *s_decompressed_body = "write more testswrite more testswrite more testswrite more tests";
+
+/* Send a request with decompress_response_body set, feed it the response, and check the outcome */
+static int s_test_decompress_response(
+    struct aws_allocator *allocator,
+    const char *response_head,
+    struct aws_byte_cursor response_body,
+    const char *response_tail,
+    int expected_error_code) {
+
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct aws_byte_buf body_buffer;
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buffer, allocator, 128));
+
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+    int completion_error_code = -1;
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .on_complete = s_on_complete,
+        .user_data = &completion_error_code,
+        .response_body_buffers = &body_buffer,
+        .num_response_body_buffers = 1,
+        .decompress_response_body = true,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* send response, splitting the compressed body so it's decompressed across multiple calls */
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, response_head));
+    while (response_body.len > 0) {
+        struct aws_byte_cursor piece = aws_byte_cursor_advance(&response_body, aws_min_size(response_body.len, 5));
+        ASSERT_SUCCESS(testing_channel_push_read_data(&tester.testing_channel, piece));
+    }
+    ASSERT_SUCCESS(testing_channel_push_read_str(&tester.testing_channel, response_tail));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* check result */
+    ASSERT_INT_EQUALS(expected_error_code, completion_error_code);
+    if (expected_error_code == AWS_ERROR_SUCCESS) {
+        ASSERT_BIN_ARRAYS_EQUALS(s_decompressed_body, strlen(s_decompressed_body), body_buffer.buffer, body_buffer.len);
+    }
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+    aws_byte_buf_clean_up(&body_buffer);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+H1_CLIENT_TEST_CASE(h1_client_response_body_gzip_content_encoding_decompressed) {
+    (void)ctx;
+    return s_test_decompress_response(
+        allocator,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Encoding: gzip\r\n"
+        "Content-Length: 39\r\n"
+        "\r\n",
+        aws_byte_cursor_from_array(s_gzip_body, sizeof(s_gzip_body)),
+        "",
+        AWS_ERROR_SUCCESS);
+}
+
+H1_CLIENT_TEST_CASE(h1_client_response_body_deflate_transfer_encoding_decompressed) {
+    (void)ctx;
+    return s_test_decompress_response(
+        allocator,
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: deflate, chunked\r\n"
+        "\r\n"
+        "1B\r\n",
+        aws_byte_cursor_from_array(s_deflate_body, sizeof(s_deflate_body)),
+        "\r\n"
+        "0\r\n"
+        "\r\n",
+        AWS_ERROR_SUCCESS);
+}
+
+/* The stream should fail if the compressed data is cut short */
+H1_CLIENT_TEST_CASE(h1_client_response_body_truncated_gzip_is_error) {
+    (void)ctx;
+    return s_test_decompress_response(
+        allocator,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Encoding: gzip\r\n"
+        "Content-Length: 30\r\n"
+        "\r\n",
+        aws_byte_cursor_from_array(s_gzip_body, 30),
+        "",
+        AWS_ERROR_HTTP_COMPRESSION);
+}
+
+struct wire_bytes_recorder {
+    struct aws_byte_buf body;
+    size_t wire_bytes;
+    int completion_error_code;
+};
+
+static int s_wire_bytes_recorder_on_body(
+    struct aws_http_stream *stream,
+    const struct aws_byte_cursor *data,
+    void *user_data) {
+
+    struct wire_bytes_recorder *recorder = user_data;
+    recorder->wire_bytes += aws_http_stream_get_incoming_body_wire_bytes(stream);
+    return aws_byte_buf_append_dynamic(&recorder->body, data);
+}
+
+static void s_wire_bytes_recorder_on_complete(struct aws_http_stream *stream, int error_code, void *user_data) {
+    (void)stream;
+    struct wire_bytes_recorder *recorder = user_data;
+    recorder->completion_error_code = error_code;
+}
+
+/* With manual window management, a decompressed body should shrink the window by its size on the wire,
+ * and the user should be told that size so they can re-open the window */
+H1_CLIENT_TEST_CASE(h1_client_response_body_gzip_manual_window) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct wire_bytes_recorder recorder = {.completion_error_code = -1};
+    ASSERT_SUCCESS(aws_byte_buf_init(&recorder.body, allocator, 128));
+
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .on_response_body = s_wire_bytes_recorder_on_body,
+        .on_complete = s_wire_bytes_recorder_on_complete,
+        .user_data = &recorder,
+        .decompress_response_body = true,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(stream));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    ASSERT_SUCCESS(testing_channel_push_read_str(
+        &tester.testing_channel,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Encoding: gzip\r\n"
+        "Content-Length: 39\r\n"
+        "\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* Send the compressed body in pieces. Whatever part of a piece isn't reported to the user
+     * (ex: the gzip header, which decompresses to nothing) should have its window re-opened automatically */
+    struct aws_byte_cursor compressed = aws_byte_cursor_from_array(s_gzip_body, sizeof(s_gzip_body));
+    while (compressed.len > 0) {
+        struct aws_byte_cursor piece = aws_byte_cursor_advance(&compressed, aws_min_size(compressed.len, 5));
+        size_t prev_wire_bytes = recorder.wire_bytes;
+
+        ASSERT_SUCCESS(testing_channel_push_read_data(&tester.testing_channel, piece));
+        testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+        size_t reported = recorder.wire_bytes - prev_wire_bytes;
+        ASSERT_TRUE(reported <= piece.len);
+        if (reported < piece.len) {
+            ASSERT_UINT_EQUALS(piece.len - reported, testing_channel_last_window_update(&tester.testing_channel));
+        }
+    }
+
+    /* check result */
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, recorder.completion_error_code);
+    ASSERT_BIN_ARRAYS_EQUALS(s_decompressed_body, strlen(s_decompressed_body), recorder.body.buffer, recorder.body.len);
+
+    /* the reported wire bytes are what's left to re-open, and they're less than the data delivered */
+    ASSERT_TRUE(recorder.wire_bytes > 0);
+    ASSERT_TRUE(recorder.wire_bytes < recorder.body.len);
+    aws_http_stream_update_window(stream, recorder.wire_bytes);
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_UINT_EQUALS(recorder.wire_bytes, testing_channel_last_window_update(&tester.testing_channel));
+
+    /* clean up */
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+    aws_byte_buf_clean_up(&recorder.body);
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+#endif /* AWS_HTTP_HAS_ZLIB */
+
+struct header_block_recorder {
+    size_t num_blocks;
+    enum aws_http_header_block block_types[3];
+    size_t num_headers[3];
+    enum aws_http_header_name first_name_ids[3];
+    enum aws_http_header_name last_name_ids[3];
+    struct aws_byte_buf last_values[3];
+    size_t num_single_header_calls;
+};
+
+static int s_header_block_recorder_on_header_block(
+    struct aws_http_stream *stream,
+    enum aws_http_header_block header_block,
+    const struct aws_http_header *header_array,
+    const enum aws_http_header_name *header_name_ids,
+    size_t num_headers,
+    void *user_data) {
+    (void)stream;
+
+    struct header_block_recorder *recorder = user_data;
+    AWS_FATAL_ASSERT(recorder->num_blocks < AWS_ARRAY_SIZE(recorder->block_types));
+    AWS_FATAL_ASSERT(num_headers > 0);
+
+    size_t i = recorder->num_blocks++;
+    recorder->block_types[i] = header_block;
+    recorder->num_headers[i] = num_headers;
+    recorder->first_name_ids[i] = header_name_ids[0];
+    recorder->last_name_ids[i] = header_name_ids[num_headers - 1];
+    return aws_byte_buf_init_copy_from_cursor(
+        &recorder->last_values[i], aws_default_allocator(), header_array[num_headers - 1].value);
+}
+
+static int s_header_block_recorder_on_headers(
+    struct aws_http_stream *stream,
+    enum aws_http_header_block header_block,
+    const struct aws_http_header *header_array,
+    size_t num_headers,
+    void *user_data) {
+    (void)stream;
+    (void)header_block;
+    (void)header_array;
+    (void)num_headers;
+
+    struct header_block_recorder *recorder = user_data;
+    recorder->num_single_header_calls++;
+    return AWS_OP_SUCCESS;
+}
+
+/* Check that each header block is delivered all at once, with the IDs of well-known header names */
+H1_CLIENT_TEST_CASE(h1_client_response_header_block_delivered_at_once) {
+    (void)ctx;
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator));
+
+    struct header_block_recorder recorder;
+    AWS_ZERO_STRUCT(recorder);
+
+    /* send request */
+    struct aws_http_message *request = s_new_default_get_request(allocator);
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .user_data = &recorder,
+        .on_response_headers = s_header_block_recorder_on_headers,
+        .on_response_header_block = s_header_block_recorder_on_header_block,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    aws_http_stream_activate(stream);
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* send response */
+    ASSERT_SUCCESS(testing_channel_push_read_str(
+        &tester.testing_channel,
+        "HTTP/1.1 100 Continue\r\n"
+        "Date: Fri, 01 Mar 2019 17:18:55 GMT\r\n"
+        "\r\n"
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "X-Custom: momo\r\n"
+        "\r\n"
+        "9\r\n"
+        "Call Momo\r\n"
+        "0\r\n"
+        "Expires: never\r\n"
+        "\r\n"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    /* check result */
+    ASSERT_UINT_EQUALS(3, recorder.num_blocks);
+    ASSERT_UINT_EQUALS(4, recorder.num_single_header_calls);
+
+    ASSERT_INT_EQUALS(AWS_HTTP_HEADER_BLOCK_INFORMATIONAL, recorder.block_types[0]);
+    ASSERT_UINT_EQUALS(1, recorder.num_headers[0]);
+    ASSERT_INT_EQUALS(AWS_HTTP_HEADER_UNKNOWN, recorder.first_name_ids[0]);
+    ASSERT_TRUE(aws_byte_buf_eq_c_str(&recorder.last_values[0], "Fri, 01 Mar 2019 17:18:55 GMT"));
+
+    ASSERT_INT_EQUALS(AWS_HTTP_HEADER_BLOCK_MAIN, recorder.block_types[1]);
+    ASSERT_UINT_EQUALS(2, recorder.num_headers[1]);
+    ASSERT_INT_EQUALS(AWS_HTTP_HEADER_TRANSFER_ENCODING, recorder.first_name_ids[1]);
+    ASSERT_INT_EQUALS(AWS_HTTP_HEADER_UNKNOWN, recorder.last_name_ids[1]);
+    ASSERT_TRUE(aws_byte_buf_eq_c_str(&recorder.last_values[1], "momo"));
+
+    ASSERT_INT_EQUALS(AWS_HTTP_HEADER_BLOCK_TRAILING, recorder.block_types[2]);
+    ASSERT_UINT_EQUALS(1, recorder.num_headers[2]);
+    ASSERT_TRUE(aws_byte_buf_eq_c_str(&recorder.last_values[2], "never"));
+
+    /* clean up */
+    for (size_t i = 0; i < recorder.num_blocks; ++i) {
+        aws_byte_buf_clean_up(&recorder.last_values[i]);
+    }
+    aws_http_message_destroy(request);
+    aws_http_stream_release(stream);
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Wraps another allocator, counting how many times memory is acquired */
+struct counting_allocator {
+    struct aws_allocator base;
+    struct aws_allocator *wrapped;
+    size_t num_acquires;
+};
+
+static void *s_counting_allocator_acquire(struct aws_allocator *allocator, size_t size) {
+    struct counting_allocator *counter = allocator->impl;
+    counter->num_acquires++;
+    return aws_mem_acquire(counter->wrapped, size);
+}
+
+static void s_counting_allocator_release(struct aws_allocator *allocator, void *ptr) {
+    struct counting_allocator *counter = allocator->impl;
+    aws_mem_release(counter->wrapped, ptr);
+}
+
+static void s_on_complete_set_bool(struct aws_http_stream *stream, int error_code, void *user_data) {
+    (void)stream;
+    (void)error_code;
+    *(bool *)user_data = true;
+}
+
+/* Run a request and response, with or without arenas, and report how many times the connection's allocator was hit */
+static int s_count_request_allocations(struct aws_allocator *allocator, bool use_arena, size_t *out_num_acquires) {
+    struct counting_allocator counter = {
+        .base =
+            {
+                .mem_acquire = s_counting_allocator_acquire,
+                .mem_release = s_counting_allocator_release,
+                .impl = &counter,
+            },
+        .wrapped = allocator,
+    };
+
+    struct tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, &counter.base));
+    size_t num_acquires_before = counter.num_acquires;
+
+    struct aws_allocator *message_alloc = &counter.base;
+    if (use_arena) {
+        message_alloc = aws_http_arena_allocator_new(&counter.base, 0);
+        ASSERT_NOT_NULL(message_alloc);
+    }
+
+    struct aws_http_message *request = s_new_default_get_request(message_alloc);
+    for (size_t i = 0; i < 8; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "X-Header-%zu", i);
+        struct aws_http_header header = {
+            .name = aws_byte_cursor_from_c_str(name),
+            .value = aws_byte_cursor_from_c_str("some value"),
+        };
+        ASSERT_SUCCESS(aws_http_message_add_header(request, header));
+    }
+
+    bool complete = false;
+    struct aws_http_make_request_options opt = {
+        .self_size = sizeof(opt),
+        .request = request,
+        .user_data = &complete,
+        .on_complete = s_on_complete_set_bool,
+        .arena_block_size = use_arena ? AWS_HTTP_ARENA_DEFAULT_BLOCK_SIZE : 0,
+    };
+    struct aws_http_stream *stream = aws_http_connection_make_request(tester.connection, &opt);
+    ASSERT_NOT_NULL(stream);
+    aws_http_stream_activate(stream);
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+
+    ASSERT_SUCCESS(testing_channel_push_read_str(
+        &tester.testing_channel,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 9\r\n"
+        "Date: Fri, 01 Mar 2019 17:18:55 GMT\r\n"
+        "\r\n"
+        "Call Momo"));
+    testing_channel_drain_queued_tasks(&tester.testing_channel);
+    ASSERT_TRUE(complete);
+
+    aws_http_stream_release(stream);
+    aws_http_message_destroy(request);
+    if (use_arena) {
+        aws_http_arena_allocator_destroy(message_alloc);
+    }
+
+    *out_num_acquires = counter.num_acquires - num_acquires_before;
+
+    ASSERT_SUCCESS(s_tester_clean_up(&tester));
+    return AWS_OP_SUCCESS;
+}
+
+/* Check that a stream and message using arenas go to the connection's allocator less often */
+H1_CLIENT_TEST_CASE(h1_client_request_with_arena_allocates_less) {
+    (void)ctx;
+    size_t num_acquires_without_arena;
+    ASSERT_SUCCESS(s_count_request_allocations(allocator, false /*use_arena*/, &num_acquires_without_arena));
+
+    size_t num_acquires_with_arena;
+    ASSERT_SUCCESS(s_count_request_allocations(allocator, true /*use_arena*/, &num_acquires_with_arena));
+
+    ASSERT_TRUE(num_acquires_with_arena < num_acquires_without_arena);
+    return AWS_OP_SUCCESS;
+}
+
 static int s_test_content_length_mismatch_is_error(
     struct aws_allocator *allocator,
     const char *body,
@@ -138,6 +138,7 @@ static void s_common_decoder_setup(
 
     params->alloc = allocator;
     params->scratch_space_initial_size = scratch_space_size;
+    params->max_line_size = 0;
     params->is_decoding_requests = type;
     params->user_data = user_data;
     params->vtable.on_header = s_on_header_stub;
@@ -268,6 +269,50 @@ static int s_h1_test_overflow_scratch_space(struct aws_allocator *allocator, voi
     return AWS_OP_SUCCESS;
 }
 
+/* Lines over the limit are rejected, whether they arrive whole or split across multiple calls */
+AWS_TEST_CASE(h1_test_line_too_long, s_h1_test_line_too_long);
+static int s_h1_test_line_too_long(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    s_test_init(allocator);
+
+    /* "Server: some-server\r\n" is the longest line, at 21 bytes */
+    struct aws_h1_decoder_params params;
+    s_common_decoder_setup(allocator, 4, &params, s_response, NULL);
+
+    /* at the limit is OK, even when every line is split across calls */
+    params.max_line_size = 21;
+    struct aws_h1_decoder *decoder = aws_h1_decoder_new(&params);
+    struct aws_byte_cursor msg = s_typical_response;
+    while (msg.len > 0) {
+        struct aws_byte_cursor one_byte = aws_byte_cursor_advance(&msg, 1);
+        ASSERT_SUCCESS(aws_h1_decode(decoder, &one_byte));
+    }
+    aws_h1_decoder_destroy(decoder);
+
+    /* over the limit fails, when line arrives whole */
+    params.max_line_size = 20;
+    decoder = aws_h1_decoder_new(&params);
+    msg = s_typical_response;
+    ASSERT_FAILS(aws_h1_decode(decoder, &msg));
+    ASSERT_INT_EQUALS(AWS_ERROR_HTTP_PROTOCOL_ERROR, aws_last_error());
+    aws_h1_decoder_destroy(decoder);
+
+    /* over the limit fails, when line is split */
+    decoder = aws_h1_decoder_new(&params);
+    msg = s_typical_response;
+    int err = AWS_OP_SUCCESS;
+    while (msg.len > 0 && !err) {
+        struct aws_byte_cursor one_byte = aws_byte_cursor_advance(&msg, 1);
+        err = aws_h1_decode(decoder, &one_byte);
+    }
+    ASSERT_INT_EQUALS(AWS_OP_ERR, err);
+    ASSERT_INT_EQUALS(AWS_ERROR_HTTP_PROTOCOL_ERROR, aws_last_error());
+    aws_h1_decoder_destroy(decoder);
+
+    s_test_clean_up();
+    return AWS_OP_SUCCESS;
+}
+
 struct s_header_params {
     int index;
     int max_index;
@@ -21,6 +21,7 @@
 
 #include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
+#include <aws/common/date_time.h>
 #include <aws/common/log_writer.h>
 #include <aws/common/uuid.h>
 #include <aws/io/channel_bootstrap.h>
@@ -173,7 +174,7 @@ static struct aws_http_stream *s_tester_on_incoming_request(struct aws_http_conn
     return tester->requests[index].request_handler;
 }
 
-static int s_tester_init(struct aws_allocator *alloc) {
+static int s_tester_init_common(struct aws_allocator *alloc, bool add_date_header) {
 
     aws_http_library_init(alloc);
 
@@ -198,6 +199,7 @@ static int s_tester_init(struct aws_allocator *alloc) {
     struct aws_http_server_connection_options options = AWS_HTTP_SERVER_CONNECTION_OPTIONS_INIT;
     options.connection_user_data = &s_tester;
     options.on_incoming_request = s_tester_on_incoming_request;
+    options.add_date_header = add_date_header;
 
     ASSERT_SUCCESS(aws_http_connection_configure_server(s_tester.server_connection, &options));
 
@@ -213,6 +215,10 @@ static int s_tester_init(struct aws_allocator *alloc) {
     return AWS_OP_SUCCESS;
 }
 
+static int s_tester_init(struct aws_allocator *alloc) {
+    return s_tester_init_common(alloc, false /*add_date_header*/);
+}
+
 static int s_server_request_clean_up(void) {
     for (int i = 0; i < s_tester.request_num; i++) {
         aws_http_stream_release(s_tester.requests[i].request_handler);
@@ -505,6 +511,72 @@ TEST_CASE(h1_server_send_response_headers) {
     return AWS_OP_SUCCESS;
 }
 
+TEST_CASE(h1_server_send_response_with_date_header) {
+    (void)ctx;
+    ASSERT_SUCCESS(s_tester_init_common(allocator, true /*add_date_header*/));
+
+    const char *incoming_requests = "GET / HTTP/1.1\r\n"
+                                    "\r\n"
+                                    "GET / HTTP/1.1\r\n"
+                                    "\r\n";
+    ASSERT_SUCCESS(s_send_message_c_str(incoming_requests));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+    ASSERT_INT_EQUALS(2, s_tester.request_num);
+
+    /* 1st response gets a Date header added */
+    struct aws_http_message *response_without_date;
+    ASSERT_SUCCESS(s_create_response(&response_without_date, 200, NULL, 0, NULL));
+    ASSERT_SUCCESS(aws_http_stream_send_response(s_tester.requests[0].request_handler, response_without_date));
+
+    /* 2nd response already has one, it must not get another.
+     * Its status code has no known text, so the response-line isn't pre-rendered */
+    struct aws_http_header date_header = {
+        .name = aws_byte_cursor_from_c_str("date"),
+        .value = aws_byte_cursor_from_c_str("Fri, 01 Mar 2019 17:18:55 GMT"),
+    };
+    struct aws_http_message *response_with_date;
+    ASSERT_SUCCESS(s_create_response(&response_with_date, 299, &date_header, 1, NULL));
+    ASSERT_SUCCESS(aws_http_stream_send_response(s_tester.requests[1].request_handler, response_with_date));
+
+    uint64_t before_ns;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&before_ns));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+    uint64_t after_ns;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&after_ns));
+
+    struct aws_byte_buf written;
+    ASSERT_SUCCESS(aws_byte_buf_init(&written, allocator, 128));
+    ASSERT_SUCCESS(testing_channel_drain_written_messages(&s_tester.testing_channel, &written));
+    struct aws_byte_cursor written_cursor = aws_byte_cursor_from_buf(&written);
+
+    const char *expected_prefix = "HTTP/1.1 200 OK\r\n"
+                                  "Date: ";
+    const char *expected_suffix = "\r\n"
+                                  "\r\n"
+                                  "HTTP/1.1 299 \r\n"
+                                  "date: Fri, 01 Mar 2019 17:18:55 GMT\r\n"
+                                  "\r\n";
+    size_t prefix_len = strlen(expected_prefix);
+    size_t suffix_len = strlen(expected_suffix);
+    ASSERT_UINT_EQUALS(prefix_len + 29 + suffix_len, written_cursor.len);
+    ASSERT_BIN_ARRAYS_EQUALS(expected_prefix, prefix_len, written_cursor.ptr, prefix_len);
+    ASSERT_BIN_ARRAYS_EQUALS(expected_suffix, suffix_len, written_cursor.ptr + prefix_len + 29, suffix_len);
+
+    /* Date must be current */
+    struct aws_byte_cursor date_value = aws_byte_cursor_from_array(written_cursor.ptr + prefix_len, 29);
+    struct aws_date_time date_time;
+    ASSERT_SUCCESS(aws_date_time_init_from_str_cursor(&date_time, &date_value, AWS_DATE_FORMAT_RFC822));
+    uint64_t date_secs = (uint64_t)aws_date_time_as_epoch_secs(&date_time);
+    ASSERT_TRUE(date_secs >= aws_timestamp_convert(before_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL));
+    ASSERT_TRUE(date_secs <= aws_timestamp_convert(after_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL));
+
+    aws_byte_buf_clean_up(&written);
+    aws_http_message_destroy(response_without_date);
+    aws_http_message_destroy(response_with_date);
+    ASSERT_SUCCESS(s_server_tester_clean_up());
+    return AWS_OP_SUCCESS;
+}
+
 TEST_CASE(h1_server_send_response_body) {
 
     (void)ctx;
@@ -1038,6 +1110,51 @@ TEST_CASE(h1_server_send_response_large_body) {
     return AWS_OP_SUCCESS;
 }
 
+#ifndef _WIN32
+
+/* Response body should come from the requested range of the file */
+TEST_CASE(h1_server_send_response_body_from_fd) {
+
+    (void)ctx;
+    ASSERT_SUCCESS(s_tester_init(allocator));
+
+    const char *incoming_request = "GET / HTTP/1.1\r\n"
+                                   "\r\n";
+    ASSERT_SUCCESS(s_send_message_c_str(incoming_request));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    ASSERT_TRUE(s_tester.request_num == 1);
+
+    struct tester_request *request = s_tester.requests;
+
+    FILE *file = tmpfile();
+    ASSERT_NOT_NULL(file);
+    ASSERT_TRUE(fputs("skip this|write more tests|and this", file) >= 0);
+    ASSERT_INT_EQUALS(0, fflush(file));
+
+    /* send response */
+    struct aws_http_message *response;
+    ASSERT_SUCCESS(s_create_response(&response, 200, NULL, 0, NULL));
+    ASSERT_SUCCESS(aws_http_message_set_body_from_fd(response, fileno(file), 10, 16));
+
+    ASSERT_SUCCESS(aws_http_stream_send_response(request->request_handler, response));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    const char *expected = "HTTP/1.1 200 OK\r\n"
+                           "Content-Length: 16\r\n"
+                           "\r\n"
+                           "write more tests";
+
+    ASSERT_SUCCESS(testing_channel_check_written_messages_str(&s_tester.testing_channel, allocator, expected));
+
+    aws_http_message_destroy(response);
+    fclose(file);
+    ASSERT_SUCCESS(s_server_tester_clean_up());
+    return AWS_OP_SUCCESS;
+}
+
+#endif /* _WIN32 */
+
 /* Send a response whose headers doesn't fit in a single aws_io_message */
 TEST_CASE(h1_server_send_response_large_head) {
 
@@ -16,6 +16,7 @@
 #include "h2_test_helper.h"
 #include "stream_test_helper.h"
 #include <aws/http/private/h2_connection.h>
+#include <aws/http/private/h2_stream_scheduler.h>
 #include <aws/http/request_response.h>
 #include <aws/testing/io_testing_channel.h>
 
@@ -34,8 +35,11 @@ struct tester {
     struct h2_fake_peer peer;
 } s_tester;
 
-static int s_tester_init(struct aws_allocator *alloc, void *ctx) {
-    (void)ctx;
+static int s_tester_init_common(
+    struct aws_allocator *alloc,
+    bool manual_window_management,
+    size_t initial_window_size,
+    enum aws_http2_stream_scheduler stream_scheduler) {
     aws_http_library_init(alloc);
 
     s_tester.alloc = alloc;
@@ -44,7 +48,8 @@ static int s_tester_init(struct aws_allocator *alloc, void *ctx) {
 
     ASSERT_SUCCESS(testing_channel_init(&s_tester.testing_channel, alloc, &options));
 
-    s_tester.connection = aws_http_connection_new_http2_client(alloc, true, SIZE_MAX);
+    s_tester.connection = aws_http_connection_new_http2_client(
+        alloc, manual_window_management, initial_window_size, 0 /*max_window_size*/, stream_scheduler);
     ASSERT_NOT_NULL(s_tester.connection);
 
     { /* re-enact marriage vows of http-connection and channel (handled by http-bootstrap in real world) */
@@ -66,6 +71,15 @@ static int s_tester_init(struct aws_allocator *alloc, void *ctx) {
     return AWS_OP_SUCCESS;
 }
 
+static int s_tester_init(struct aws_allocator *alloc, void *ctx) {
+    (void)ctx;
+    return s_tester_init_common(
+        alloc,
+        true /*manual_window_management*/,
+        SIZE_MAX /*initial_window_size*/,
+        AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN);
+}
+
 static int s_tester_clean_up(void) {
     h2_fake_peer_clean_up(&s_tester.peer);
     aws_http_connection_release(s_tester.connection);
@@ -557,4 +571,666 @@ TEST_CASE(h2_client_stream_err_receive_data_before_headers) {
     aws_http_message_release(request);
     client_stream_tester_clean_up(&stream_tester);
     return s_tester_clean_up();
-}
\ No newline at end of file
+}
+/* Send a GET request and have the fake peer respond with headers, but not end the stream */
+static int s_start_stream_with_response_headers(
+    struct client_stream_tester *stream_tester,
+    struct aws_http_message *request) {
+
+    /* fake peer sends connection preface */
+    ASSERT_SUCCESS(h2_fake_peer_send_connection_preface_default_settings(&s_tester.peer));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    struct aws_http_header request_headers_src[] = {
+        DEFINE_HEADER(":method", "GET"),
+        DEFINE_HEADER(":scheme", "https"),
+        DEFINE_HEADER(":path", "/"),
+    };
+    ASSERT_SUCCESS(
+        aws_http_message_add_header_array(request, request_headers_src, AWS_ARRAY_SIZE(request_headers_src)));
+
+    ASSERT_SUCCESS(s_stream_tester_init(stream_tester, request));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    /* fake peer sends response headers */
+    struct aws_http_header response_headers_src[] = {
+        DEFINE_HEADER(":status", "200"),
+    };
+
+    struct aws_http_headers *response_headers = aws_http_headers_new(s_tester.alloc);
+    ASSERT_SUCCESS(
+        aws_http_headers_add_array(response_headers, response_headers_src, AWS_ARRAY_SIZE(response_headers_src)));
+
+    struct aws_h2_frame *response_frame = aws_h2_frame_new_headers(
+        s_tester.alloc, aws_http_stream_get_id(stream_tester->stream), response_headers, false /*end_stream*/, 0, NULL);
+    ASSERT_SUCCESS(h2_fake_peer_send_frame(&s_tester.peer, response_frame));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    aws_http_headers_release(response_headers);
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that the connection preface opens the connection's flow-control window to the size requested by the user */
+TEST_CASE(h2_client_connection_preface_opens_window) {
+    ASSERT_SUCCESS(s_tester_init(allocator, ctx));
+
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+
+    /* SETTINGS frame is first, followed by WINDOW_UPDATE for the connection */
+    ASSERT_TRUE(h2_decode_tester_frame_count(&s_tester.peer.decode) >= 2);
+    struct h2_decoded_frame *window_update_frame = h2_decode_tester_get_frame(&s_tester.peer.decode, 1);
+    ASSERT_SUCCESS(h2_decoded_frame_check_finished(window_update_frame, AWS_H2_FRAME_T_WINDOW_UPDATE, 0));
+    ASSERT_UINT_EQUALS(AWS_H2_WINDOW_UPDATE_MAX - 65535, window_update_frame->window_size_increment);
+
+    return s_tester_clean_up();
+}
+
+/* With manual window management, WINDOW_UPDATE is only sent when the user asks for it */
+TEST_CASE(h2_client_stream_manual_window_update) {
+    ASSERT_SUCCESS(s_tester_init(allocator, ctx));
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    struct client_stream_tester stream_tester;
+    ASSERT_SUCCESS(s_start_stream_with_response_headers(&stream_tester, request));
+    uint32_t stream_id = aws_http_stream_get_id(stream_tester.stream);
+
+    ASSERT_SUCCESS(h2_fake_peer_send_data_frame_str(&s_tester.peer, stream_id, "hello", false /*end_stream*/));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+    ASSERT_TRUE(aws_byte_buf_eq_c_str(&stream_tester.response_body, "hello"));
+
+    /* no WINDOW_UPDATE for the stream yet */
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    struct h2_decoded_frame *latest_frame = h2_decode_tester_latest_frame(&s_tester.peer.decode);
+    ASSERT_FALSE(latest_frame->type == AWS_H2_FRAME_T_WINDOW_UPDATE && latest_frame->stream_id == stream_id);
+
+    /* user processed the body, and opens the window */
+    aws_http_stream_update_window(stream_tester.stream, 5);
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    latest_frame = h2_decode_tester_latest_frame(&s_tester.peer.decode);
+    ASSERT_SUCCESS(h2_decoded_frame_check_finished(latest_frame, AWS_H2_FRAME_T_WINDOW_UPDATE, stream_id));
+    ASSERT_UINT_EQUALS(5, latest_frame->window_size_increment);
+
+    /* clean up */
+    aws_http_message_release(request);
+    client_stream_tester_clean_up(&stream_tester);
+    return s_tester_clean_up();
+}
+
+/* Without manual window management, the stream's window is topped back up once it's half used */
+TEST_CASE(h2_client_stream_automatic_window_update) {
+    ASSERT_SUCCESS(s_tester_init_common(
+        allocator,
+        false /*manual_window_management*/,
+        10 /*initial_window_size*/,
+        AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN));
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    struct client_stream_tester stream_tester;
+    ASSERT_SUCCESS(s_start_stream_with_response_headers(&stream_tester, request));
+    uint32_t stream_id = aws_http_stream_get_id(stream_tester.stream);
+
+    ASSERT_SUCCESS(h2_fake_peer_send_data_frame_str(&s_tester.peer, stream_id, "hello!", false /*end_stream*/));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    struct h2_decoded_frame *latest_frame = h2_decode_tester_latest_frame(&s_tester.peer.decode);
+    ASSERT_SUCCESS(h2_decoded_frame_check_finished(latest_frame, AWS_H2_FRAME_T_WINDOW_UPDATE, stream_id));
+    ASSERT_UINT_EQUALS(6, latest_frame->window_size_increment);
+
+    /* clean up */
+    aws_http_message_release(request);
+    client_stream_tester_clean_up(&stream_tester);
+    return s_tester_clean_up();
+}
+
+/* A stream error of type FLOW_CONTROL_ERROR occurs if peer sends more DATA than the stream's window allows */
+TEST_CASE(h2_client_stream_err_receive_data_exceeds_window) {
+    ASSERT_SUCCESS(s_tester_init_common(
+        allocator,
+        true /*manual_window_management*/,
+        3 /*initial_window_size*/,
+        AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN));
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    struct client_stream_tester stream_tester;
+    ASSERT_SUCCESS(s_start_stream_with_response_headers(&stream_tester, request));
+    uint32_t stream_id = aws_http_stream_get_id(stream_tester.stream);
+
+    ASSERT_SUCCESS(h2_fake_peer_send_data_frame_str(&s_tester.peer, stream_id, "hello", true /*end_stream*/));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    /* validate that stream completed with error */
+    ASSERT_TRUE(stream_tester.complete);
+    ASSERT_INT_EQUALS(AWS_ERROR_HTTP_FLOW_CONTROL_ERROR, stream_tester.on_complete_error_code);
+    ASSERT_UINT_EQUALS(0, stream_tester.response_body.len);
+
+    /* a stream error should not affect the connection */
+    ASSERT_TRUE(aws_http_connection_is_open(s_tester.connection));
+
+    /* validate that stream sent RST_STREAM */
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    struct h2_decoded_frame *rst_stream_frame = h2_decode_tester_latest_frame(&s_tester.peer.decode);
+    ASSERT_SUCCESS(h2_decoded_frame_check_finished(rst_stream_frame, AWS_H2_FRAME_T_RST_STREAM, stream_id));
+    ASSERT_UINT_EQUALS(AWS_H2_ERR_FLOW_CONTROL_ERROR, rst_stream_frame->error_code);
+
+    /* clean up */
+    aws_http_message_release(request);
+    client_stream_tester_clean_up(&stream_tester);
+    return s_tester_clean_up();
+}
+
+/* Test that the request body waits for WINDOW_UPDATE once it's used up the peer's flow-control window */
+TEST_CASE(h2_client_stream_send_data_obeys_window) {
+    ASSERT_SUCCESS(s_tester_init(allocator, ctx));
+
+    /* fake peer sends connection preface, with a tiny initial window for streams */
+    struct aws_h2_frame_setting settings[] = {
+        {.id = AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE, .value = 5},
+    };
+    struct aws_h2_frame *settings_frame =
+        aws_h2_frame_new_settings(allocator, settings, AWS_ARRAY_SIZE(settings), false /*ack*/);
+    ASSERT_NOT_NULL(settings_frame);
+    ASSERT_SUCCESS(h2_fake_peer_send_connection_preface(&s_tester.peer, settings_frame));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    /* send request with body */
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+
+    struct aws_http_header request_headers_src[] = {
+        DEFINE_HEADER(":method", "PUT"),
+        DEFINE_HEADER(":scheme", "https"),
+        DEFINE_HEADER(":path", "/"),
+    };
+    ASSERT_SUCCESS(
+        aws_http_message_add_header_array(request, request_headers_src, AWS_ARRAY_SIZE(request_headers_src)));
+
+    const char *body_src = "hello world";
+    struct aws_byte_cursor body_cursor = aws_byte_cursor_from_c_str(body_src);
+    struct aws_input_stream *body_stream = aws_input_stream_new_from_cursor(allocator, &body_cursor);
+    ASSERT_NOT_NULL(body_stream);
+    aws_http_message_set_body_stream(request, body_stream);
+
+    struct client_stream_tester stream_tester;
+    ASSERT_SUCCESS(s_stream_tester_init(&stream_tester, request));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+    uint32_t stream_id = aws_http_stream_get_id(stream_tester.stream);
+
+    /* only as much DATA as the window allows should be sent, without END_STREAM */
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    struct h2_decoded_frame *latest_frame = h2_decode_tester_latest_frame(&s_tester.peer.decode);
+    ASSERT_SUCCESS(h2_decoded_frame_check_finished(latest_frame, AWS_H2_FRAME_T_DATA, stream_id));
+    ASSERT_FALSE(latest_frame->end_stream);
+    ASSERT_SUCCESS(h2_decode_tester_check_data_str_across_frames(
+        &s_tester.peer.decode, stream_id, "hello", false /*expect_end_stream*/));
+
+    /* fake peer opens the window, and the rest of the body should be sent */
+    struct aws_h2_frame *window_update_frame = aws_h2_frame_new_window_update(allocator, stream_id, 100);
+    ASSERT_SUCCESS(h2_fake_peer_send_frame(&s_tester.peer, window_update_frame));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    ASSERT_SUCCESS(h2_decode_tester_check_data_str_across_frames(
+        &s_tester.peer.decode, stream_id, body_src, true /*expect_end_stream*/));
+
+    /* fake peer sends complete response */
+    struct aws_http_header response_headers_src[] = {
+        DEFINE_HEADER(":status", "200"),
+    };
+    struct aws_http_headers *response_headers = aws_http_headers_new(allocator);
+    ASSERT_SUCCESS(
+        aws_http_headers_add_array(response_headers, response_headers_src, AWS_ARRAY_SIZE(response_headers_src)));
+    struct aws_h2_frame *response_frame =
+        aws_h2_frame_new_headers(allocator, stream_id, response_headers, true /*end_stream*/, 0, NULL);
+    ASSERT_SUCCESS(h2_fake_peer_send_frame(&s_tester.peer, response_frame));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    ASSERT_TRUE(stream_tester.complete);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, stream_tester.on_complete_error_code);
+    ASSERT_INT_EQUALS(200, stream_tester.response_status);
+
+    /* clean up */
+    aws_http_headers_release(response_headers);
+    aws_http_message_release(request);
+    client_stream_tester_clean_up(&stream_tester);
+    aws_input_stream_destroy(body_stream);
+    return s_tester_clean_up();
+}
+
+/* Test that automatically managed windows grow when DATA received during a round-trip nearly fills them */
+TEST_CASE(h2_client_stream_window_autotune_grows) {
+    ASSERT_SUCCESS(s_tester_init_common(
+        allocator,
+        false /*manual_window_management*/,
+        1000 /*initial_window_size*/,
+        AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN));
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    struct client_stream_tester stream_tester;
+    ASSERT_SUCCESS(s_start_stream_with_response_headers(&stream_tester, request));
+    uint32_t stream_id = aws_http_stream_get_id(stream_tester.stream);
+
+    /* DATA arrives, and client should send a PING to measure the round-trip */
+    struct aws_byte_buf body;
+    ASSERT_SUCCESS(aws_byte_buf_init(&body, allocator, 800));
+    memset(body.buffer, 'a', body.capacity);
+    body.len = body.capacity;
+
+    ASSERT_SUCCESS(h2_fake_peer_send_data_frame(
+        &s_tester.peer, stream_id, aws_byte_cursor_from_array(body.buffer, 100), false /*end_stream*/));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    struct h2_decoded_frame *ping_frame = h2_decode_tester_latest_frame(&s_tester.peer.decode);
+    ASSERT_SUCCESS(h2_decoded_frame_check_finished(ping_frame, AWS_H2_FRAME_T_PING, 0));
+    ASSERT_FALSE(ping_frame->ack);
+    uint8_t opaque_data[AWS_H2_PING_DATA_SIZE];
+    memcpy(opaque_data, ping_frame->ping_opaque_data, AWS_H2_PING_DATA_SIZE);
+
+    /* Most of the window arrives before the PING ACK. Window is topped up to its initial size */
+    ASSERT_SUCCESS(h2_fake_peer_send_data_frame(
+        &s_tester.peer, stream_id, aws_byte_cursor_from_buf(&body), false /*end_stream*/));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    struct h2_decoded_frame *latest_frame = h2_decode_tester_latest_frame(&s_tester.peer.decode);
+    ASSERT_SUCCESS(h2_decoded_frame_check_finished(latest_frame, AWS_H2_FRAME_T_WINDOW_UPDATE, stream_id));
+    ASSERT_UINT_EQUALS(900, latest_frame->window_size_increment);
+
+    /* PING ACK shows the window is too small for the round-trip, so it should grow */
+    struct aws_h2_frame *ping_ack_frame = aws_h2_frame_new_ping(allocator, true /*ack*/, opaque_data);
+    ASSERT_SUCCESS(h2_fake_peer_send_frame(&s_tester.peer, ping_ack_frame));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    struct aws_array_list stats_list;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&stats_list, allocator, 1, sizeof(void *)));
+    s_tester.connection->channel_handler.vtable->gather_statistics(&s_tester.connection->channel_handler, &stats_list);
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&stats_list));
+    struct aws_crt_statistics_http2_channel *stats = NULL;
+    ASSERT_SUCCESS(aws_array_list_get_at(&stats_list, &stats, 0));
+    ASSERT_INT_EQUALS(AWSCRT_STAT_CAT_HTTP2_CHANNEL, stats->category);
+    ASSERT_UINT_EQUALS(2000, stats->stream_window_size);
+    ASSERT_UINT_EQUALS(65535, stats->connection_window_size);
+    ASSERT_TRUE(stats->max_bandwidth_bytes_per_sec > 0);
+    aws_array_list_clean_up(&stats_list);
+
+    /* Next time the window is topped up, it's topped up to the new size */
+    ASSERT_SUCCESS(h2_fake_peer_send_data_frame(
+        &s_tester.peer, stream_id, aws_byte_cursor_from_buf(&body), false /*end_stream*/));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    latest_frame = h2_decode_tester_latest_frame(&s_tester.peer.decode);
+    ASSERT_SUCCESS(h2_decoded_frame_check_finished(latest_frame, AWS_H2_FRAME_T_WINDOW_UPDATE, stream_id));
+    ASSERT_UINT_EQUALS(1800, latest_frame->window_size_increment);
+
+    /* clean up */
+    aws_byte_buf_clean_up(&body);
+    aws_http_message_release(request);
+    client_stream_tester_clean_up(&stream_tester);
+    return s_tester_clean_up();
+}
+
+enum {
+    SCHEDULER_TEST_BULK_BODY_SIZE = 4 * 1024 * 1024,
+    SCHEDULER_TEST_SMALL_BODY_SIZE = 100,
+    SCHEDULER_TEST_NUM_SMALL_STREAMS = 100,
+};
+
+/* Request with a body of BODY_SIZE bytes, sent with the given priority */
+struct scheduler_test_request {
+    struct aws_http_message *request;
+    struct aws_input_stream *body_stream;
+    struct aws_http_stream *stream;
+};
+
+static int s_scheduler_test_request_init(
+    struct scheduler_test_request *test_request,
+    struct aws_byte_cursor body,
+    const struct aws_http2_stream_priority *priority) {
+
+    test_request->request = aws_http_message_new_request(s_tester.alloc);
+    ASSERT_NOT_NULL(test_request->request);
+
+    struct aws_http_header headers[] = {
+        DEFINE_HEADER(":method", "PUT"),
+        DEFINE_HEADER(":scheme", "https"),
+        DEFINE_HEADER(":path", "/"),
+    };
+    ASSERT_SUCCESS(aws_http_message_add_header_array(test_request->request, headers, AWS_ARRAY_SIZE(headers)));
+
+    test_request->body_stream = aws_input_stream_new_from_cursor(s_tester.alloc, &body);
+    ASSERT_NOT_NULL(test_request->body_stream);
+    aws_http_message_set_body_stream(test_request->request, test_request->body_stream);
+
+    struct aws_http_make_request_options options = {
+        .self_size = sizeof(options),
+        .request = test_request->request,
+        .http2_priority = priority,
+    };
+    test_request->stream = aws_http_connection_make_request(s_tester.connection, &options);
+    ASSERT_NOT_NULL(test_request->stream);
+    ASSERT_SUCCESS(aws_http_stream_activate(test_request->stream));
+    return AWS_OP_SUCCESS;
+}
+
+static void s_scheduler_test_request_clean_up(struct scheduler_test_request *test_request) {
+    aws_http_stream_release(test_request->stream);
+    aws_http_message_release(test_request->request);
+    aws_input_stream_destroy(test_request->body_stream);
+}
+
+static int s_compare_size(const void *a, const void *b) {
+    const size_t size_a = *(const size_t *)a;
+    const size_t size_b = *(const size_t *)b;
+    return (size_a > size_b) - (size_a < size_b);
+}
+
+/* Fake peer opens flow-control windows wide, so only the scheduler decides who sends */
+static int s_scheduler_test_open_windows(struct aws_allocator *allocator) {
+    struct aws_h2_frame_setting settings[] = {
+        {.id = AWS_H2_SETTINGS_INITIAL_WINDOW_SIZE, .value = AWS_H2_WINDOW_UPDATE_MAX},
+    };
+    struct aws_h2_frame *settings_frame =
+        aws_h2_frame_new_settings(allocator, settings, AWS_ARRAY_SIZE(settings), false /*ack*/);
+    ASSERT_NOT_NULL(settings_frame);
+    ASSERT_SUCCESS(h2_fake_peer_send_connection_preface(&s_tester.peer, settings_frame));
+    struct aws_h2_frame *window_update_frame =
+        aws_h2_frame_new_window_update(allocator, 0 /*stream_id*/, AWS_H2_WINDOW_UPDATE_MAX - 65535);
+    ASSERT_SUCCESS(h2_fake_peer_send_frame(&s_tester.peer, window_update_frame));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+    return AWS_OP_SUCCESS;
+}
+
+/**
+ * While a bulk upload is underway, many small uploads begin.
+ * Measure how many bytes of bulk DATA each small upload waits behind, from its HEADERS to its END_STREAM,
+ * and report the 99th percentile.
+ */
+static int s_scheduler_test_small_stream_latency(
+    struct aws_allocator *allocator,
+    enum aws_http2_stream_scheduler stream_scheduler,
+    const struct aws_http2_stream_priority *bulk_priority,
+    const struct aws_http2_stream_priority *small_priority,
+    size_t *out_p99_bulk_bytes) {
+
+    ASSERT_SUCCESS(s_tester_init_common(
+        allocator, true /*manual_window_management*/, SIZE_MAX /*initial_window_size*/, stream_scheduler));
+    ASSERT_SUCCESS(s_scheduler_test_open_windows(allocator));
+
+    struct aws_byte_buf bulk_body;
+    ASSERT_SUCCESS(aws_byte_buf_init(&bulk_body, allocator, SCHEDULER_TEST_BULK_BODY_SIZE));
+    memset(bulk_body.buffer, 'a', bulk_body.capacity);
+    bulk_body.len = bulk_body.capacity;
+
+    uint8_t small_body[SCHEDULER_TEST_SMALL_BODY_SIZE];
+    memset(small_body, 'b', sizeof(small_body));
+
+    /* bulk upload gets going */
+    struct scheduler_test_request bulk;
+    ASSERT_SUCCESS(s_scheduler_test_request_init(&bulk, aws_byte_cursor_from_buf(&bulk_body), bulk_priority));
+    uint32_t bulk_stream_id = aws_http_stream_get_id(bulk.stream);
+    for (size_t i = 0; i < 4; ++i) {
+        testing_channel_run_currently_queued_tasks(&s_tester.testing_channel);
+    }
+
+    /* small uploads begin */
+    struct scheduler_test_request small[SCHEDULER_TEST_NUM_SMALL_STREAMS];
+    for (size_t i = 0; i < SCHEDULER_TEST_NUM_SMALL_STREAMS; ++i) {
+        ASSERT_SUCCESS(s_scheduler_test_request_init(
+            &small[i], aws_byte_cursor_from_array(small_body, sizeof(small_body)), small_priority));
+    }
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    /* walk through frames in the order they were sent */
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    size_t bulk_bytes_sent = 0;
+    bool bulk_complete = false;
+    size_t bulk_bytes_at_headers[SCHEDULER_TEST_NUM_SMALL_STREAMS];
+    size_t latency_samples[SCHEDULER_TEST_NUM_SMALL_STREAMS];
+    size_t num_latency_samples = 0;
+    for (size_t frame_i = 0; frame_i < h2_decode_tester_frame_count(&s_tester.peer.decode); ++frame_i) {
+        struct h2_decoded_frame *frame = h2_decode_tester_get_frame(&s_tester.peer.decode, frame_i);
+        if (frame->stream_id == bulk_stream_id) {
+            if (frame->type == AWS_H2_FRAME_T_DATA) {
+                bulk_bytes_sent += frame->data.len;
+                bulk_complete = frame->end_stream;
+            }
+            continue;
+        }
+
+        for (size_t small_i = 0; small_i < SCHEDULER_TEST_NUM_SMALL_STREAMS; ++small_i) {
+            if (frame->stream_id != aws_http_stream_get_id(small[small_i].stream)) {
+                continue;
+            }
+
+            if (frame->type == AWS_H2_FRAME_T_HEADERS) {
+                /* bulk upload must still be underway, or this test isn't measuring anything */
+                ASSERT_FALSE(bulk_complete);
+                bulk_bytes_at_headers[small_i] = bulk_bytes_sent;
+            } else if (frame->type == AWS_H2_FRAME_T_DATA && frame->end_stream) {
+                latency_samples[num_latency_samples++] = bulk_bytes_sent - bulk_bytes_at_headers[small_i];
+            }
+        }
+    }
+    ASSERT_TRUE(bulk_complete);
+    ASSERT_UINT_EQUALS(SCHEDULER_TEST_BULK_BODY_SIZE, bulk_bytes_sent);
+    ASSERT_UINT_EQUALS(SCHEDULER_TEST_NUM_SMALL_STREAMS, num_latency_samples);
+
+    qsort(latency_samples, num_latency_samples, sizeof(size_t), s_compare_size);
+    *out_p99_bulk_bytes = latency_samples[(num_latency_samples * 99) / 100 - 1];
+
+    /* shutdown channel so requests can be released */
+    aws_channel_shutdown(s_tester.testing_channel.channel, AWS_ERROR_SUCCESS);
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+    ASSERT_TRUE(testing_channel_is_shutdown_completed(&s_tester.testing_channel));
+
+    s_scheduler_test_request_clean_up(&bulk);
+    for (size_t i = 0; i < SCHEDULER_TEST_NUM_SMALL_STREAMS; ++i) {
+        s_scheduler_test_request_clean_up(&small[i]);
+    }
+    aws_byte_buf_clean_up(&bulk_body);
+    return s_tester_clean_up();
+}
+
+/* Round-robin gives the bulk upload a turn between small uploads, so small uploads wait behind its DATA */
+TEST_CASE(h2_client_stream_scheduler_round_robin_interleaves) {
+    (void)ctx;
+    size_t p99_bulk_bytes = 0;
+    ASSERT_SUCCESS(s_scheduler_test_small_stream_latency(
+        allocator, AWS_HTTP2_STREAM_SCHEDULER_ROUND_ROBIN, NULL, NULL, &p99_bulk_bytes));
+
+    ASSERT_TRUE(p99_bulk_bytes > 0);
+    ASSERT_TRUE(p99_bulk_bytes <= AWS_H2_STREAM_SCHEDULER_QUANTUM);
+    return AWS_OP_SUCCESS;
+}
+
+/* With RFC-7540 weights, heavy small uploads get nearly all the bandwidth while they have DATA to send */
+TEST_CASE(h2_client_stream_scheduler_dependency_favors_weight) {
+    (void)ctx;
+    struct aws_http2_stream_priority bulk_priority = AWS_HTTP2_STREAM_PRIORITY_INIT;
+    bulk_priority.weight = 1;
+    struct aws_http2_stream_priority small_priority = AWS_HTTP2_STREAM_PRIORITY_INIT;
+    small_priority.weight = 256;
+
+    size_t p99_bulk_bytes = 0;
+    ASSERT_SUCCESS(s_scheduler_test_small_stream_latency(
+        allocator, AWS_HTTP2_STREAM_SCHEDULER_DEPENDENCY, &bulk_priority, &small_priority, &p99_bulk_bytes));
+
+    ASSERT_UINT_EQUALS(0, p99_bulk_bytes);
+    return AWS_OP_SUCCESS;
+}
+
+/* A stream only gets bandwidth once no stream it depends on, directly or indirectly, has DATA to send */
+TEST_CASE(h2_client_stream_scheduler_dependency_chain_goes_in_order) {
+    (void)ctx;
+    ASSERT_SUCCESS(s_tester_init_common(
+        allocator,
+        true /*manual_window_management*/,
+        SIZE_MAX /*initial_window_size*/,
+        AWS_HTTP2_STREAM_SCHEDULER_DEPENDENCY));
+    ASSERT_SUCCESS(s_scheduler_test_open_windows(allocator));
+
+    struct aws_byte_buf body;
+    ASSERT_SUCCESS(aws_byte_buf_init(&body, allocator, 4 * AWS_H2_STREAM_SCHEDULER_QUANTUM));
+    memset(body.buffer, 'a', body.capacity);
+    body.len = body.capacity;
+
+    /* each stream depends on the one before it, and all are activated before any DATA is sent */
+    enum { CHAIN_LENGTH = 3 };
+    struct scheduler_test_request chain[CHAIN_LENGTH];
+    struct aws_http2_stream_priority priority = AWS_HTTP2_STREAM_PRIORITY_INIT;
+    for (size_t i = 0; i < CHAIN_LENGTH; ++i) {
+        ASSERT_SUCCESS(s_scheduler_test_request_init(&chain[i], aws_byte_cursor_from_buf(&body), &priority));
+        priority.dependency_stream_id = aws_http_stream_get_id(chain[i].stream);
+    }
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    /* all of a stream's DATA is sent before any of its dependent's */
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    size_t chain_i = 0;
+    size_t bytes_sent = 0;
+    for (size_t frame_i = 0; frame_i < h2_decode_tester_frame_count(&s_tester.peer.decode); ++frame_i) {
+        struct h2_decoded_frame *frame = h2_decode_tester_get_frame(&s_tester.peer.decode, frame_i);
+        if (frame->type != AWS_H2_FRAME_T_DATA) {
+            continue;
+        }
+
+        ASSERT_TRUE(chain_i < CHAIN_LENGTH);
+        ASSERT_UINT_EQUALS(aws_http_stream_get_id(chain[chain_i].stream), frame->stream_id);
+        bytes_sent += frame->data.len;
+        if (frame->end_stream) {
+            ASSERT_UINT_EQUALS(body.len, bytes_sent);
+            bytes_sent = 0;
+            ++chain_i;
+        }
+    }
+    ASSERT_UINT_EQUALS(CHAIN_LENGTH, chain_i);
+
+    /* shutdown channel so requests can be released */
+    aws_channel_shutdown(s_tester.testing_channel.channel, AWS_ERROR_SUCCESS);
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+    ASSERT_TRUE(testing_channel_is_shutdown_completed(&s_tester.testing_channel));
+
+    for (size_t i = 0; i < CHAIN_LENGTH; ++i) {
+        s_scheduler_test_request_clean_up(&chain[i]);
+    }
+    aws_byte_buf_clean_up(&body);
+    return s_tester_clean_up();
+}
+
+/* With urgency, small uploads are sent before the less urgent bulk upload gets any more bandwidth */
+TEST_CASE(h2_client_stream_scheduler_urgency_favors_urgent) {
+    (void)ctx;
+    struct aws_http2_stream_priority bulk_priority = AWS_HTTP2_STREAM_PRIORITY_INIT;
+    bulk_priority.urgency = 7;
+    struct aws_http2_stream_priority small_priority = AWS_HTTP2_STREAM_PRIORITY_INIT;
+    small_priority.urgency = 0;
+
+    size_t p99_bulk_bytes = 0;
+    ASSERT_SUCCESS(s_scheduler_test_small_stream_latency(
+        allocator, AWS_HTTP2_STREAM_SCHEDULER_URGENCY, &bulk_priority, &small_priority, &p99_bulk_bytes));
+
+    ASSERT_UINT_EQUALS(0, p99_bulk_bytes);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_check_headers_sent(uint32_t stream_id, bool expect_sent) {
+    ASSERT_SUCCESS(h2_fake_peer_decode_messages_from_testing_channel(&s_tester.peer));
+    bool sent = false;
+    for (size_t i = 0; i < h2_decode_tester_frame_count(&s_tester.peer.decode); ++i) {
+        struct h2_decoded_frame *frame = h2_decode_tester_get_frame(&s_tester.peer.decode, i);
+        if (frame->type == AWS_H2_FRAME_T_HEADERS && frame->stream_id == stream_id) {
+            sent = true;
+        }
+    }
+    ASSERT_INT_EQUALS(expect_sent, sent);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_send_complete_response(uint32_t stream_id) {
+    struct aws_http_header response_headers_src[] = {
+        DEFINE_HEADER(":status", "200"),
+    };
+    struct aws_http_headers *response_headers = aws_http_headers_new(s_tester.alloc);
+    ASSERT_SUCCESS(
+        aws_http_headers_add_array(response_headers, response_headers_src, AWS_ARRAY_SIZE(response_headers_src)));
+    struct aws_h2_frame *response_frame =
+        aws_h2_frame_new_headers(s_tester.alloc, stream_id, response_headers, true /*end_stream*/, 0, NULL);
+    ASSERT_SUCCESS(h2_fake_peer_send_frame(&s_tester.peer, response_frame));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+    aws_http_headers_release(response_headers);
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that streams beyond peer's SETTINGS_MAX_CONCURRENT_STREAMS wait, and are opened in order as others complete */
+TEST_CASE(h2_client_stream_waits_for_max_concurrent_streams) {
+    ASSERT_SUCCESS(s_tester_init(allocator, ctx));
+
+    /* fake peer only allows 1 stream at a time */
+    struct aws_h2_frame_setting settings[] = {
+        {.id = AWS_H2_SETTINGS_MAX_CONCURRENT_STREAMS, .value = 1},
+    };
+    struct aws_h2_frame *settings_frame =
+        aws_h2_frame_new_settings(allocator, settings, AWS_ARRAY_SIZE(settings), false /*ack*/);
+    ASSERT_NOT_NULL(settings_frame);
+    ASSERT_SUCCESS(h2_fake_peer_send_connection_preface(&s_tester.peer, settings_frame));
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    /* make 3 requests */
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    struct aws_http_header request_headers_src[] = {
+        DEFINE_HEADER(":method", "GET"),
+        DEFINE_HEADER(":scheme", "https"),
+        DEFINE_HEADER(":path", "/"),
+    };
+    ASSERT_SUCCESS(
+        aws_http_message_add_header_array(request, request_headers_src, AWS_ARRAY_SIZE(request_headers_src)));
+
+    enum { NUM_STREAMS = 3 };
+    struct client_stream_tester stream_testers[NUM_STREAMS];
+    uint32_t stream_ids[NUM_STREAMS];
+    for (size_t i = 0; i < NUM_STREAMS; ++i) {
+        ASSERT_SUCCESS(s_stream_tester_init(&stream_testers[i], request));
+        stream_ids[i] = aws_http_stream_get_id(stream_testers[i].stream);
+    }
+    testing_channel_drain_queued_tasks(&s_tester.testing_channel);
+
+    /* only the 1st should be sent, the rest wait */
+    ASSERT_SUCCESS(s_check_headers_sent(stream_ids[0], true));
+    ASSERT_SUCCESS(s_check_headers_sent(stream_ids[1], false));
+    ASSERT_UINT_EQUALS(2, aws_http_connection_get_pending_stream_count(s_tester.connection));
+
+    /* as each completes, the next should be sent */
+    for (size_t i = 0; i < NUM_STREAMS; ++i) {
+        ASSERT_SUCCESS(s_send_complete_response(stream_ids[i]));
+        ASSERT_TRUE(stream_testers[i].complete);
+        ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, stream_testers[i].on_complete_error_code);
+        ASSERT_INT_EQUALS(200, stream_testers[i].response_status);
+
+        if (i + 1 < NUM_STREAMS) {
+            ASSERT_SUCCESS(s_check_headers_sent(stream_ids[i + 1], true));
+        }
+
+        size_t expected_pending = 0;
+        if (i + 2 < NUM_STREAMS) {
+            ASSERT_SUCCESS(s_check_headers_sent(stream_ids[i + 2], false));
+            expected_pending = NUM_STREAMS - (i + 2);
+        }
+        ASSERT_UINT_EQUALS(expected_pending, aws_http_connection_get_pending_stream_count(s_tester.connection));
+    }
+
+    /* clean up */
+    for (size_t i = 0; i < NUM_STREAMS; ++i) {
+        client_stream_tester_clean_up(&stream_testers[i]);
+    }
+    aws_http_message_release(request);
+    return s_tester_clean_up();
+}
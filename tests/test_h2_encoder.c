@@ -92,6 +92,8 @@ TEST_CASE(h2_encoder_data) {
     };
     /* clang-format on */
 
+    int32_t stream_window = 100;
+    size_t connection_window = 200;
     bool body_complete;
     ASSERT_SUCCESS(aws_h2_encode_data_frame(
         &encoder,
@@ -99,12 +101,101 @@ TEST_CASE(h2_encoder_data) {
         body,
         true /*body_ends_stream*/,
         2 /*pad_length*/,
+        &stream_window,
+        &connection_window,
         &output,
         &body_complete));
 
     ASSERT_BIN_ARRAYS_EQUALS(expected, sizeof(expected), output.buffer, output.len);
     ASSERT_UINT_EQUALS(true, body_complete);
 
+    /* Whole payload, padding included, counts against flow-control windows */
+    ASSERT_INT_EQUALS(92, stream_window);
+    ASSERT_UINT_EQUALS(192, connection_window);
+
+    aws_byte_buf_clean_up(&output);
+    aws_input_stream_destroy(body);
+    aws_h2_frame_encoder_clean_up(&encoder);
+    return AWS_OP_SUCCESS;
+}
+
+/* DATA frames must not exceed the smaller of the stream and connection flow-control windows */
+TEST_CASE(h2_encoder_data_obeys_flow_control_window) {
+    (void)ctx;
+
+    struct aws_h2_frame_encoder encoder;
+    ASSERT_SUCCESS(aws_h2_frame_encoder_init(&encoder, allocator, NULL /*logging_id*/));
+
+    struct aws_byte_buf output;
+    ASSERT_SUCCESS(aws_byte_buf_init(&output, allocator, 1024));
+
+    struct aws_byte_cursor body_src = aws_byte_cursor_from_c_str("hello");
+    struct aws_input_stream *body = aws_input_stream_new_from_cursor(allocator, &body_src);
+    ASSERT_NOT_NULL(body);
+
+    /* clang-format off */
+    uint8_t expected[] = {
+        0x00, 0x00, 0x03,           /* Length (24) */
+        AWS_H2_FRAME_T_DATA,        /* Type (8) */
+        0x0,                        /* Flags (8) */
+        0x00, 0x00, 0x00, 0x01,     /* Reserved (1) | Stream Identifier (31) */
+        /* DATA */
+        'h', 'e', 'l',              /* Data (*) */
+    };
+    /* clang-format on */
+
+    /* Connection window is the limit */
+    int32_t stream_window = 100;
+    size_t connection_window = 3;
+    bool body_complete;
+    ASSERT_SUCCESS(aws_h2_encode_data_frame(
+        &encoder,
+        1 /*stream_id*/,
+        body,
+        true /*body_ends_stream*/,
+        0 /*pad_length*/,
+        &stream_window,
+        &connection_window,
+        &output,
+        &body_complete));
+
+    ASSERT_BIN_ARRAYS_EQUALS(expected, sizeof(expected), output.buffer, output.len);
+    ASSERT_FALSE(body_complete);
+    ASSERT_INT_EQUALS(97, stream_window);
+    ASSERT_UINT_EQUALS(0, connection_window);
+
+    /* Nothing is encoded while a window is exhausted */
+    ASSERT_SUCCESS(aws_h2_encode_data_frame(
+        &encoder,
+        1 /*stream_id*/,
+        body,
+        true /*body_ends_stream*/,
+        0 /*pad_length*/,
+        &stream_window,
+        &connection_window,
+        &output,
+        &body_complete));
+
+    ASSERT_UINT_EQUALS(sizeof(expected), output.len);
+    ASSERT_FALSE(body_complete);
+
+    /* Stream window can go negative (peer may shrink SETTINGS_INITIAL_WINDOW_SIZE), nothing is encoded then either */
+    connection_window = 100;
+    stream_window = -5;
+    ASSERT_SUCCESS(aws_h2_encode_data_frame(
+        &encoder,
+        1 /*stream_id*/,
+        body,
+        true /*body_ends_stream*/,
+        0 /*pad_length*/,
+        &stream_window,
+        &connection_window,
+        &output,
+        &body_complete));
+
+    ASSERT_UINT_EQUALS(sizeof(expected), output.len);
+    ASSERT_FALSE(body_complete);
+
     aws_byte_buf_clean_up(&output);
     aws_input_stream_destroy(body);
     aws_h2_frame_encoder_clean_up(&encoder);
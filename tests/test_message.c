@@ -14,10 +14,15 @@
  */
 
 #include <aws/common/string.h>
+#include <aws/http/arena.h>
+#include <aws/http/private/http_impl.h>
 #include <aws/http/request_response.h>
 #include <aws/http/status_code.h>
+#include <aws/io/stream.h>
 #include <aws/testing/aws_test_allocators.h>
 
+#include <ctype.h>
+
 #define TEST_CASE(NAME)                                                                                                \
     AWS_TEST_CASE(NAME, s_test_##NAME);                                                                                \
     static int s_test_##NAME(struct aws_allocator *allocator, void *ctx)
@@ -114,6 +119,68 @@ TEST_CASE(message_response_status) {
     return AWS_OP_SUCCESS;
 }
 
+TEST_CASE(http_str_to_header_name) {
+    (void)allocator;
+    (void)ctx;
+
+    struct {
+        const char *str;
+        enum aws_http_header_name name;
+    } known[] = {
+        {":method", AWS_HTTP_HEADER_METHOD},
+        {":scheme", AWS_HTTP_HEADER_SCHEME},
+        {":authority", AWS_HTTP_HEADER_AUTHORITY},
+        {":path", AWS_HTTP_HEADER_PATH},
+        {":status", AWS_HTTP_HEADER_STATUS},
+        {"connection", AWS_HTTP_HEADER_CONNECTION},
+        {"content-length", AWS_HTTP_HEADER_CONTENT_LENGTH},
+        {"expect", AWS_HTTP_HEADER_EXPECT},
+        {"transfer-encoding", AWS_HTTP_HEADER_TRANSFER_ENCODING},
+        {"cookie", AWS_HTTP_HEADER_COOKIE},
+        {"content-encoding", AWS_HTTP_HEADER_CONTENT_ENCODING},
+        {"date", AWS_HTTP_HEADER_DATE},
+    };
+    ASSERT_UINT_EQUALS(AWS_HTTP_HEADER_COUNT - 1, AWS_ARRAY_SIZE(known));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(known); ++i) {
+        struct aws_byte_cursor lowercase = aws_byte_cursor_from_c_str(known[i].str);
+        ASSERT_INT_EQUALS(known[i].name, aws_http_str_to_header_name(lowercase));
+        ASSERT_INT_EQUALS(known[i].name, aws_http_lowercase_str_to_header_name(lowercase));
+
+        char uppercase_buf[32];
+        for (size_t c = 0; c <= lowercase.len; ++c) {
+            uppercase_buf[c] = (char)toupper((unsigned char)known[i].str[c]);
+        }
+        struct aws_byte_cursor uppercase = aws_byte_cursor_from_c_str(uppercase_buf);
+        ASSERT_INT_EQUALS(known[i].name, aws_http_str_to_header_name(uppercase));
+        ASSERT_INT_EQUALS(AWS_HTTP_HEADER_UNKNOWN, aws_http_lowercase_str_to_header_name(uppercase));
+    }
+
+    /* Near misses. '[' and '{' are next to 'Z' and 'z', check they aren't folded */
+    const char *unknown[] = {"", "x", "content-lengt", "content_length", "content-lengtH1", "[ookie", "{ookie"};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(unknown); ++i) {
+        ASSERT_INT_EQUALS(AWS_HTTP_HEADER_UNKNOWN, aws_http_str_to_header_name(aws_byte_cursor_from_c_str(unknown[i])));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+TEST_CASE(http_str_to_method) {
+    (void)allocator;
+    (void)ctx;
+
+    ASSERT_INT_EQUALS(AWS_HTTP_METHOD_GET, aws_http_str_to_method(aws_byte_cursor_from_c_str("GET")));
+    ASSERT_INT_EQUALS(AWS_HTTP_METHOD_HEAD, aws_http_str_to_method(aws_byte_cursor_from_c_str("HEAD")));
+    ASSERT_INT_EQUALS(AWS_HTTP_METHOD_CONNECT, aws_http_str_to_method(aws_byte_cursor_from_c_str("CONNECT")));
+
+    /* Methods are case-sensitive */
+    ASSERT_INT_EQUALS(AWS_HTTP_METHOD_UNKNOWN, aws_http_str_to_method(aws_byte_cursor_from_c_str("get")));
+    ASSERT_INT_EQUALS(AWS_HTTP_METHOD_UNKNOWN, aws_http_str_to_method(aws_byte_cursor_from_c_str("POST")));
+    ASSERT_INT_EQUALS(AWS_HTTP_METHOD_UNKNOWN, aws_http_str_to_method(aws_byte_cursor_from_c_str("")));
+
+    return AWS_OP_SUCCESS;
+}
+
 static struct aws_http_header s_make_header(const char *name, const char *value) {
     return (struct aws_http_header){
         .name = aws_byte_cursor_from_c_str(name),
@@ -332,6 +399,193 @@ TEST_CASE(headers_clear) {
     return AWS_OP_SUCCESS;
 }
 
+/* Strings must keep their address as more headers are added, and storage should be reused after a clear */
+TEST_CASE(headers_string_storage_is_stable_and_reused) {
+    (void)ctx;
+    struct aws_http_headers *headers = aws_http_headers_new(allocator);
+    ASSERT_NOT_NULL(headers);
+
+    ASSERT_SUCCESS(
+        aws_http_headers_add(headers, aws_byte_cursor_from_c_str("Host"), aws_byte_cursor_from_c_str("example.com")));
+    struct aws_http_header first;
+    ASSERT_SUCCESS(aws_http_headers_get_index(headers, 0, &first));
+
+    /* Add enough headers to fill many chunks, including a header too long for any chunk */
+    char name_buf[32];
+    char value_buf[4096];
+    memset(value_buf, 'v', sizeof(value_buf) - 1);
+    value_buf[sizeof(value_buf) - 1] = '\0';
+    ASSERT_SUCCESS(aws_http_headers_add(
+        headers, aws_byte_cursor_from_c_str("Long-Header"), aws_byte_cursor_from_c_str(value_buf)));
+    for (size_t i = 0; i < 256; ++i) {
+        snprintf(name_buf, sizeof(name_buf), "Name-%zu", i);
+        ASSERT_SUCCESS(
+            aws_http_headers_add(headers, aws_byte_cursor_from_c_str(name_buf), aws_byte_cursor_from_c_str("value")));
+    }
+
+    struct aws_http_header first_again;
+    ASSERT_SUCCESS(aws_http_headers_get_index(headers, 0, &first_again));
+    ASSERT_PTR_EQUALS(first.name.ptr, first_again.name.ptr);
+    ASSERT_SUCCESS(s_check_header_eq(first_again, "Host", "example.com"));
+
+    /* Set a header, using the existing value's memory as the source of the new value */
+    ASSERT_SUCCESS(aws_http_headers_set(headers, aws_byte_cursor_from_c_str("host"), first_again.value));
+    struct aws_byte_cursor host_value;
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Host"), &host_value));
+    ASSERT_SUCCESS(s_check_value_eq(host_value, "example.com"));
+
+    /* After a clear, new strings should be stored in the memory used before */
+    aws_http_headers_clear(headers);
+    ASSERT_SUCCESS(
+        aws_http_headers_add(headers, aws_byte_cursor_from_c_str("Host"), aws_byte_cursor_from_c_str("example.com")));
+    ASSERT_SUCCESS(aws_http_headers_get_index(headers, 0, &first_again));
+    ASSERT_PTR_EQUALS(first.name.ptr, first_again.name.ptr);
+
+    aws_http_headers_release(headers);
+    return AWS_OP_SUCCESS;
+}
+
+/* Wraps another allocator, tracking the most allocations that were ever outstanding at once */
+struct outstanding_allocator {
+    struct aws_allocator base;
+    struct aws_allocator *wrapped;
+    size_t num_outstanding;
+    size_t max_outstanding;
+};
+
+static void *s_outstanding_allocator_acquire(struct aws_allocator *allocator, size_t size) {
+    struct outstanding_allocator *tracker = allocator->impl;
+    void *mem = aws_mem_acquire(tracker->wrapped, size);
+    if (mem) {
+        tracker->num_outstanding++;
+        if (tracker->num_outstanding > tracker->max_outstanding) {
+            tracker->max_outstanding = tracker->num_outstanding;
+        }
+    }
+    return mem;
+}
+
+static void s_outstanding_allocator_release(struct aws_allocator *allocator, void *ptr) {
+    struct outstanding_allocator *tracker = allocator->impl;
+    tracker->num_outstanding--;
+    aws_mem_release(tracker->wrapped, ptr);
+}
+
+/* Setting and erasing headers that aren't the most recently added can't reuse their string storage in place.
+ * Memory must still stay bounded, no matter how many times it's done. */
+TEST_CASE(headers_repeated_set_and_erase_memory_is_bounded) {
+    (void)ctx;
+    struct outstanding_allocator tracker = {
+        .base =
+            {
+                .mem_acquire = s_outstanding_allocator_acquire,
+                .mem_release = s_outstanding_allocator_release,
+                .impl = &tracker,
+            },
+        .wrapped = allocator,
+    };
+
+    struct aws_http_headers *headers = aws_http_headers_new(&tracker.base);
+    ASSERT_NOT_NULL(headers);
+    ASSERT_SUCCESS(
+        aws_http_headers_add(headers, aws_byte_cursor_from_c_str("Host"), aws_byte_cursor_from_c_str("example.com")));
+
+    char value_buf[64];
+    for (size_t i = 0; i < 10000; ++i) {
+        snprintf(value_buf, sizeof(value_buf), "value-%zu", i);
+        struct aws_byte_cursor value = aws_byte_cursor_from_c_str(value_buf);
+
+        /* Replaces the previous iteration's header, which is no longer the most recent */
+        ASSERT_SUCCESS(aws_http_headers_set(headers, aws_byte_cursor_from_c_str("Set-Me"), value));
+
+        /* Erase a header from the middle */
+        ASSERT_SUCCESS(aws_http_headers_add(headers, aws_byte_cursor_from_c_str("Erase-Me"), value));
+        ASSERT_SUCCESS(aws_http_headers_add(headers, aws_byte_cursor_from_c_str("After"), value));
+        ASSERT_SUCCESS(aws_http_headers_erase(headers, aws_byte_cursor_from_c_str("Erase-Me")));
+        ASSERT_SUCCESS(aws_http_headers_erase(headers, aws_byte_cursor_from_c_str("After")));
+    }
+
+    /* The headers struct, its array, and a few string chunks. Without reclaiming storage, this would be hundreds. */
+    ASSERT_TRUE(tracker.max_outstanding <= 8);
+
+    /* Strings must have survived being moved around */
+    ASSERT_UINT_EQUALS(2, aws_http_headers_count(headers));
+    struct aws_byte_cursor get;
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Host"), &get));
+    ASSERT_SUCCESS(s_check_value_eq(get, "example.com"));
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Set-Me"), &get));
+    ASSERT_SUCCESS(s_check_value_eq(get, "value-9999"));
+
+    aws_http_headers_release(headers);
+    ASSERT_UINT_EQUALS(0, tracker.num_outstanding);
+    return AWS_OP_SUCCESS;
+}
+
+/* Exercise lookups on a header set large enough to be indexed, and check the index keeps up with changes */
+TEST_CASE(headers_large_set_lookup) {
+    (void)ctx;
+    struct aws_http_headers *headers = aws_http_headers_new(allocator);
+    ASSERT_NOT_NULL(headers);
+
+    char name_buf[32];
+    char value_buf[32];
+    for (size_t i = 0; i < 100; ++i) {
+        snprintf(name_buf, sizeof(name_buf), "Name-%zu", i);
+        snprintf(value_buf, sizeof(value_buf), "%zu", i);
+        ASSERT_SUCCESS(
+            aws_http_headers_add(headers, aws_byte_cursor_from_c_str(name_buf), aws_byte_cursor_from_c_str(value_buf)));
+    }
+
+    /* Duplicate name, get() should still find the first one */
+    ASSERT_SUCCESS(
+        aws_http_headers_add(headers, aws_byte_cursor_from_c_str("name-7"), aws_byte_cursor_from_c_str("second")));
+
+    struct aws_byte_cursor value;
+    for (size_t i = 0; i < 100; ++i) {
+        snprintf(name_buf, sizeof(name_buf), "NAME-%zu", i); /* ignore case */
+        snprintf(value_buf, sizeof(value_buf), "%zu", i);
+        ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str(name_buf), &value));
+        ASSERT_SUCCESS(s_check_value_eq(value, value_buf));
+    }
+    ASSERT_FALSE(aws_http_headers_has(headers, aws_byte_cursor_from_c_str("Name-100")));
+    ASSERT_FALSE(aws_http_headers_has(headers, aws_byte_cursor_from_c_str("Name-")));
+
+    /* Erasing shifts everything after it */
+    ASSERT_SUCCESS(aws_http_headers_erase_index(headers, 0));
+    ASSERT_FALSE(aws_http_headers_has(headers, aws_byte_cursor_from_c_str("Name-0")));
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Name-99"), &value));
+    ASSERT_SUCCESS(s_check_value_eq(value, "99"));
+
+    ASSERT_SUCCESS(aws_http_headers_erase_value(
+        headers, aws_byte_cursor_from_c_str("Name-7"), aws_byte_cursor_from_c_str("7")));
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Name-7"), &value));
+    ASSERT_SUCCESS(s_check_value_eq(value, "second"));
+
+    ASSERT_SUCCESS(aws_http_headers_erase(headers, aws_byte_cursor_from_c_str("Name-7")));
+    ASSERT_FALSE(aws_http_headers_has(headers, aws_byte_cursor_from_c_str("Name-7")));
+    ASSERT_ERROR(
+        AWS_ERROR_HTTP_HEADER_NOT_FOUND, aws_http_headers_erase(headers, aws_byte_cursor_from_c_str("Name-7")));
+
+    ASSERT_SUCCESS(
+        aws_http_headers_set(headers, aws_byte_cursor_from_c_str("Name-50"), aws_byte_cursor_from_c_str("x")));
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Name-50"), &value));
+    ASSERT_SUCCESS(s_check_value_eq(value, "x"));
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Name-51"), &value));
+    ASSERT_SUCCESS(s_check_value_eq(value, "51"));
+    ASSERT_UINT_EQUALS(98, aws_http_headers_count(headers));
+
+    /* After a clear, nothing should be found, and new headers should be */
+    aws_http_headers_clear(headers);
+    ASSERT_FALSE(aws_http_headers_has(headers, aws_byte_cursor_from_c_str("Name-51")));
+    ASSERT_SUCCESS(
+        aws_http_headers_add(headers, aws_byte_cursor_from_c_str("Host"), aws_byte_cursor_from_c_str("example.com")));
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("host"), &value));
+    ASSERT_SUCCESS(s_check_value_eq(value, "example.com"));
+
+    aws_http_headers_release(headers);
+    return AWS_OP_SUCCESS;
+}
+
 TEST_CASE(message_refcounts) {
     (void)ctx;
     struct aws_http_message *message = aws_http_message_new_request(allocator);
@@ -453,3 +707,126 @@ TEST_CASE(message_handles_oom) {
     aws_timebomb_allocator_clean_up(&timebomb_alloc);
     return AWS_OP_SUCCESS;
 }
+
+/* Build a message whose memory comes from an arena with tiny blocks, so that blocks fill and lists get reallocated */
+TEST_CASE(message_from_arena_allocator) {
+    (void)ctx;
+    struct aws_allocator *arena = aws_http_arena_allocator_new(allocator, 64);
+    ASSERT_NOT_NULL(arena);
+
+    struct aws_http_message *request = aws_http_message_new_request(arena);
+    ASSERT_NOT_NULL(request);
+    ASSERT_SUCCESS(aws_http_message_set_request_path(request, aws_byte_cursor_from_c_str("/")));
+
+    char name_buf[32];
+    char value_buf[128];
+    for (size_t i = 0; i < 64; ++i) {
+        snprintf(name_buf, sizeof(name_buf), "Name-%zu", i);
+        snprintf(value_buf, sizeof(value_buf), "%0100zu", i); /* bigger than a block */
+        ASSERT_SUCCESS(aws_http_message_add_header(request, s_make_header(name_buf, value_buf)));
+    }
+
+    ASSERT_UINT_EQUALS(64, aws_http_message_get_header_count(request));
+    for (size_t i = 0; i < 64; ++i) {
+        snprintf(name_buf, sizeof(name_buf), "Name-%zu", i);
+        snprintf(value_buf, sizeof(value_buf), "%0100zu", i);
+        struct aws_http_header header;
+        ASSERT_SUCCESS(aws_http_message_get_header(request, &header, i));
+        ASSERT_SUCCESS(s_check_header_eq(header, name_buf, value_buf));
+    }
+
+    aws_http_message_destroy(request);
+    aws_http_arena_allocator_destroy(arena);
+    return AWS_OP_SUCCESS;
+}
+
+TEST_CASE(message_pool_recycles_messages) {
+    (void)ctx;
+    struct aws_http_message_pool *pool = aws_http_message_pool_new(allocator, 1 /*max_pooled_messages*/);
+    ASSERT_NOT_NULL(pool);
+
+    /* Fill out a request, release it, and get it back blank */
+    struct aws_http_message *request = aws_http_message_pool_acquire_request(pool);
+    ASSERT_NOT_NULL(request);
+    ASSERT_TRUE(aws_http_message_is_request(request));
+    ASSERT_SUCCESS(aws_http_message_set_request_method(request, aws_http_method_get));
+    ASSERT_SUCCESS(aws_http_message_set_request_path(request, aws_byte_cursor_from_c_str("/")));
+    ASSERT_SUCCESS(aws_http_message_add_header(request, s_make_header("Host", "example.com")));
+    struct aws_http_headers *headers = aws_http_message_get_headers(request);
+    aws_http_message_release(request);
+
+    struct aws_http_message *recycled = aws_http_message_pool_acquire_request(pool);
+    ASSERT_PTR_EQUALS(request, recycled);
+    ASSERT_PTR_EQUALS(headers, aws_http_message_get_headers(recycled));
+    ASSERT_UINT_EQUALS(0, aws_http_message_get_header_count(recycled));
+    struct aws_byte_cursor cursor;
+    ASSERT_ERROR(AWS_ERROR_HTTP_DATA_NOT_AVAILABLE, aws_http_message_get_request_method(recycled, &cursor));
+    ASSERT_ERROR(AWS_ERROR_HTTP_DATA_NOT_AVAILABLE, aws_http_message_get_request_path(recycled, &cursor));
+
+    /* Responses are pooled separately */
+    struct aws_http_message *response = aws_http_message_pool_acquire_response(pool);
+    ASSERT_NOT_NULL(response);
+    ASSERT_TRUE(aws_http_message_is_response(response));
+    ASSERT_SUCCESS(aws_http_message_set_response_status(response, 200));
+    aws_http_message_release(response);
+    struct aws_http_message *recycled_response = aws_http_message_pool_acquire_response(pool);
+    ASSERT_PTR_EQUALS(response, recycled_response);
+    int status;
+    ASSERT_ERROR(AWS_ERROR_HTTP_DATA_NOT_AVAILABLE, aws_http_message_get_response_status(recycled_response, &status));
+    aws_http_message_release(recycled_response);
+
+    /* Headers still held by someone else must not be reused */
+    ASSERT_SUCCESS(aws_http_message_add_header(recycled, s_make_header("Host", "example.com")));
+    headers = aws_http_message_get_headers(recycled);
+    aws_http_headers_acquire(headers);
+    aws_http_message_release(recycled);
+    ASSERT_UINT_EQUALS(1, aws_http_headers_count(headers));
+
+    recycled = aws_http_message_pool_acquire_request(pool);
+    ASSERT_TRUE(aws_http_message_get_headers(recycled) != headers);
+    ASSERT_UINT_EQUALS(0, aws_http_message_get_header_count(recycled));
+    aws_http_headers_release(headers);
+
+    /* This fills the pool, so when `recycled` is released it's beyond max_pooled_messages and simply freed */
+    struct aws_http_message *extra = aws_http_message_pool_acquire_request(pool);
+    ASSERT_NOT_NULL(extra);
+    aws_http_message_release(extra);
+
+    /* Messages still in use keep the pool alive */
+    aws_http_message_pool_release(pool);
+    ASSERT_SUCCESS(aws_http_message_set_request_path(recycled, aws_byte_cursor_from_c_str("/")));
+    aws_http_message_release(recycled);
+    return AWS_OP_SUCCESS;
+}
+
+#ifdef AWS_HTTP_HAS_ZLIB
+
+/* A body that's already encoded should have the compression's coding listed after the existing ones */
+TEST_CASE(message_compressed_body_appends_content_encoding) {
+    (void)ctx;
+    struct aws_byte_cursor body = aws_byte_cursor_from_c_str("already brotli'd");
+    struct aws_input_stream *body_stream = aws_input_stream_new_from_cursor(allocator, &body);
+    ASSERT_NOT_NULL(body_stream);
+
+    struct aws_http_message *request = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(request);
+    ASSERT_SUCCESS(aws_http_message_add_header(request, s_make_header("Content-Encoding", "br")));
+    ASSERT_SUCCESS(aws_http_message_add_header(request, s_make_header("Content-Length", "16")));
+    ASSERT_SUCCESS(aws_http_message_add_header(request, s_make_header("Host", "example.com")));
+    ASSERT_SUCCESS(aws_http_message_set_compressed_body_stream(request, body_stream, AWS_HTTP_BODY_COMPRESSION_GZIP));
+
+    struct aws_http_headers *headers = aws_http_message_get_headers(request);
+    ASSERT_UINT_EQUALS(3, aws_http_headers_count(headers));
+    struct aws_byte_cursor value;
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Content-Encoding"), &value));
+    ASSERT_TRUE(aws_byte_cursor_eq_c_str(&value, "br, gzip"));
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("Transfer-Encoding"), &value));
+    ASSERT_TRUE(aws_byte_cursor_eq_c_str(&value, "chunked"));
+    ASSERT_FALSE(aws_http_headers_has(headers, aws_byte_cursor_from_c_str("Content-Length")));
+
+    aws_http_message_destroy(request);
+    aws_input_stream_destroy(body_stream);
+    return AWS_OP_SUCCESS;
+}
+
+#endif /* AWS_HTTP_HAS_ZLIB */
@@ -148,6 +148,43 @@ static int s_strutil_trim_http_whitespace(struct aws_allocator *allocator, void
     return 0;
 }
 
+AWS_TEST_CASE(strutil_scan_for_newline, s_strutil_scan_for_newline);
+static int s_strutil_scan_for_newline(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    struct test {
+        const char *input;
+        size_t expected_newline;
+        size_t expected_colon;
+    };
+
+    /* Include inputs longer than 32 bytes so the vectorized paths are exercised */
+    struct test tests[] = {
+        {"", 0, SIZE_MAX},
+        {"\n", 0, SIZE_MAX},
+        {":", 1, 0},
+        {"Host: a:b\r\n", 10, 4},
+        {"Host\r\n", 5, SIZE_MAX},
+        {"a\nb:", 1, SIZE_MAX},
+        {"0123456789abcdef0123456789abcdef:\r\n", 34, 32},
+        {"0123456789abcdef0123456789abcde\n:", 31, SIZE_MAX},
+        {"0123456789abcdef0123456789abcdef0123456789abcdef\n", 48, SIZE_MAX},
+        {"x-amz-meta-0123456789abcdef: 0123456789abcdef0123456789abcdef\r\n", 62, 27},
+        {"0123456789abcdef0123456789abcdef0123456789abcdef", 48, SIZE_MAX},
+    };
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(tests); ++i) {
+        struct aws_byte_cursor input = aws_byte_cursor_from_c_str(tests[i].input);
+        size_t colon_index = 0;
+        size_t newline_index = aws_strutil_scan_for_newline(input, &colon_index);
+        ASSERT_UINT_EQUALS(tests[i].expected_newline, newline_index);
+        ASSERT_UINT_EQUALS(tests[i].expected_colon, colon_index);
+    }
+
+    return 0;
+}
+
 AWS_TEST_CASE(strutil_is_http_token, s_strutil_is_http_token);
 static int s_strutil_is_http_token(struct aws_allocator *allocator, void *ctx) {
     (void)allocator;